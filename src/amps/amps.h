@@ -1,4 +1,5 @@
 #include "../libgoertzel/goertzel.h"
+#include "../libbitbuf/bitbuf.h"
 #include "../libmobile/sender.h"
 #include <osmocom/core/timer.h>
 #include "../libcompandor/compandor.h"
@@ -71,7 +72,8 @@ struct amps {
 	double			fsk_bitduration;	/* duration of one bit in samples */
 	double			fsk_bitstep;		/* fraction of one bit each sample */
 	/* tx bits generation */
-	char			fsk_tx_frame[FSK_MAX_BITS + 1];	/* +1 because 0-termination */
+	bitbuf_t		fsk_tx_frame;		/* bits of frame to transmit */
+	bitbuf_t		fsk_tx_frame_bi;	/* marks the busy/idle bits of the frame */
 	int			fsk_tx_frame_pos;	/* current position sending bits */
 	sample_t		*fsk_tx_buffer;		/* tx buffer for one data block */
 	int			fsk_tx_buffer_size;	/* size of tx buffer (in samples) */
@@ -106,9 +108,8 @@ struct amps {
 	int			fsk_rx_window_end;	/* where to end detecting level */
 	int			fsk_rx_window_pos;	/* current position in buffer */
 	/* the rx buffer received one frame until rx length */
-	char			fsk_rx_frame[FSK_MAX_BITS + 1];	/* +1 because 0-termination */
+	bitbuf_t		fsk_rx_frame;		/* bits of received frame */
 	int			fsk_rx_frame_length;	/* length of expected frame */
-	int			fsk_rx_frame_count;	/* count number of received bit */
 	double			fsk_rx_frame_level;	/* sum of level of all bits */
 	double			fsk_rx_frame_quality;	/* sum of quality of all bits */
 	/* RECC frame states */
@@ -151,7 +152,7 @@ struct amps {
 	/* SAT tone */
 	int			sat;			/* use SAT tone 0..2 */
 	int			sat_samples;		/* number of samples in buffer for supervisory detection */
-	goertzel_t		sat_goertzel[5];	/* filter for SAT signal decoding */
+	goertzel_bank_t		sat_bank;		/* filter for SAT signal decoding */
 	sample_t		*sat_filter_spl;	/* array with sample buffer for supervisory detection */
 	int			sat_filter_pos;		/* current sample position in filter_spl */
 	double			sat_phaseshift65536[3];	/* how much the phase of sine wave changes per sample */
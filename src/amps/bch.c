@@ -0,0 +1,136 @@
+/* AMPS BCH coding
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * The words of forward and reverse channel are shortened BCH(63,51) codes
+ * with 12 bits of redundancy: BCH(40,28) and BCH(48,36). The distance is 5,
+ * so two bit errors can be corrected.
+ *
+ * The encoder divides the data by the generator polynomial. Instead of one
+ * bit, 8 bits are processed at once, using a table of 256 remainders. Leading
+ * zeros do not change the remainder, so the data is processed from the next
+ * byte boundary above its length.
+ *
+ * The decoder calculates the syndrome, which is the redundancy of the
+ * received data XORed with the received redundancy. If there is no error, it
+ * is 0. Each single and double bit error results in a different syndrome, so
+ * a table of 4096 entries gives the position of the bits to be corrected. If
+ * there is no entry, there are more bit errors than can be corrected.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bch.h"
+
+#define BCH_POLY	0x539	/* generator polynomial without the highest order term */
+
+static uint16_t bch_table[256];
+static uint16_t bch_error[1 << BCH_REDUN];	/* positions + 1 of first (lower byte) and second error (upper byte) */
+
+/* bit by bit encoding, used to generate the tables */
+static uint16_t bch_encode_bits(uint64_t data, int length)
+{
+	uint16_t redun = 0;
+	int i, feedback;
+
+	for (i = length - 1; i >= 0; i--) {
+		feedback = ((data >> i) & 1) ^ (redun >> 11);
+		redun = (redun << 1) & 0xfff;
+		if (feedback)
+			redun ^= BCH_POLY;
+	}
+
+	return redun;
+}
+
+/* return syndrome of an error at given bit position of a word (0 = LSB) */
+static uint16_t bch_syndrome_bit(int pos)
+{
+	if (pos < BCH_REDUN)
+		return 1 << pos;
+	return bch_encode_bits(1ULL << (pos - BCH_REDUN), pos - BCH_REDUN + 1);
+}
+
+void bch_init(void)
+{
+	uint16_t syndrome1, syndrome2;
+	int i, j;
+
+	for (i = 0; i < 256; i++)
+		bch_table[i] = bch_encode_bits(i, 8);
+
+	memset(bch_error, 0, sizeof(bch_error));
+	for (i = 0; i < BCH_MAX_WORD; i++) {
+		syndrome1 = bch_syndrome_bit(i);
+		bch_error[syndrome1] = i + 1;
+		for (j = i + 1; j < BCH_MAX_WORD; j++) {
+			syndrome2 = syndrome1 ^ bch_syndrome_bit(j);
+			if (bch_error[syndrome2]) {
+				fprintf(stderr, "Syndrome of bit errors %d and %d is not unique, please fix!\n", i, j);
+				abort();
+			}
+			bch_error[syndrome2] = (i + 1) | ((j + 1) << 8);
+		}
+	}
+}
+
+/* do BCH(length+12,length,5) encoding:
+ * given data and length, return 12 bits redundancy
+ * all values are MSB first.
+ */
+uint16_t bch_encode(uint64_t data, int length)
+{
+	uint16_t redun = 0;
+	int shift;
+
+	data &= (1ULL << length) - 1;
+	for (shift = (length + 7) / 8 * 8 - 8; shift >= 0; shift -= 8)
+		redun = ((redun << 8) & 0xfff) ^ bch_table[((redun >> 4) ^ (data >> shift)) & 0xff];
+
+	return redun;
+}
+
+/* check and correct word of given data length, the redundancy is in the lower 12 bits
+ * return the number of corrected bits or -1, if the word cannot be corrected */
+int bch_decode(uint64_t *word, int length)
+{
+	uint16_t syndrome, error;
+	int pos1, pos2;
+
+	syndrome = bch_encode(*word >> BCH_REDUN, length) ^ (*word & 0xfff);
+	if (!syndrome)
+		return 0;
+
+	/* the error must be inside the word */
+	error = bch_error[syndrome];
+	pos1 = error & 0xff;
+	pos2 = error >> 8;
+	if (!pos1 || pos1 > length + BCH_REDUN || pos2 > length + BCH_REDUN)
+		return -1;
+
+	*word ^= 1ULL << (pos1 - 1);
+	if (!pos2)
+		return 1;
+	*word ^= 1ULL << (pos2 - 1);
+	return 2;
+}
+
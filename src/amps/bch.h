@@ -0,0 +1,8 @@
+
+#define BCH_REDUN	12	/* number of redundancy bits */
+#define BCH_MAX_WORD	48	/* maximum length of word, including redundancy */
+
+void bch_init(void);
+uint16_t bch_encode(uint64_t data, int length);
+int bch_decode(uint64_t *word, int length);
+
@@ -192,6 +192,7 @@ static void sat_reset(amps_t *amps, const char *reason);
 int dsp_init_sender(amps_t *amps, int tolerant)
 {
 	sample_t *spl;
+	double bank_freq[5];
 	int i;
 	int rc;
 	int half;
@@ -261,12 +262,16 @@ int dsp_init_sender(amps_t *amps, int tolerant)
 
 	/* count SAT tones */
 	for (i = 0; i < 4; i++) {
-		audio_goertzel_init(&amps->sat_goertzel[i], sat_freq[i], amps->sender.samplerate);
+		bank_freq[i] = sat_freq[i];
 		if (i < 3)
 			amps->sat_phaseshift65536[i] = 65536.0 / ((double)amps->sender.samplerate / sat_freq[i]);
 	}
 	/* signaling tone */
-	audio_goertzel_init(&amps->sat_goertzel[4], (!tacs) ? 10000.0 : 8000.0, amps->sender.samplerate);
+	bank_freq[4] = (!tacs) ? 10000.0 : 8000.0;
+	/* all tones are filtered in one pass */
+	rc = goertzel_bank_init(&amps->sat_bank, bank_freq, 5, amps->sender.samplerate, amps->sat_samples);
+	if (rc < 0)
+		return rc;
 	sat_reset(amps, "Initial state");
 
 	/* be more tolerant when syncing */
@@ -300,6 +305,7 @@ void dsp_cleanup_sender(amps_t *amps)
 		free(amps->sat_filter_spl);
 		amps->sat_filter_spl = NULL;
 	}
+	goertzel_bank_exit(&amps->sat_bank);
 #if 0
 	if (amps->frame_spl) {
 		free(amps->frame_spl);
@@ -396,22 +402,21 @@ again:
 
 	/* start of new bit, so generate buffer for one bit */
 	if (pos == 0) {
-		c = amps->fsk_tx_frame[amps->fsk_tx_frame_pos];
 		/* start new frame, so we generate one */
-		if (c == '\0') {
+		if (amps->fsk_tx_frame_pos == amps->fsk_tx_frame.length) {
 			if (amps->dsp_mode == DSP_MODE_AUDIO_RX_FRAME_TX)
-				rc = amps_encode_frame_fvc(amps, amps->fsk_tx_frame);
+				rc = amps_encode_frame_fvc(amps, &amps->fsk_tx_frame, &amps->fsk_tx_frame_bi);
 			else
-				rc = amps_encode_frame_focc(amps, amps->fsk_tx_frame);
+				rc = amps_encode_frame_focc(amps, &amps->fsk_tx_frame, &amps->fsk_tx_frame_bi);
 			/* check if we have no bit string (change to tx audio / silence)
 			 * we may not store fsk_tx_buffer_pos, because is was reset on a mode change */
 			if (rc)
 				return count;
 			amps->fsk_tx_frame_pos = 0;
-			c = amps->fsk_tx_frame[0];
 		}
-		if (c == 'i')
-			c = (amps->channel_busy) ? '0' : '1';
+		c = bitbuf_bit(&amps->fsk_tx_frame, amps->fsk_tx_frame_pos);
+		if (bitbuf_bit(&amps->fsk_tx_frame_bi, amps->fsk_tx_frame_pos))
+			c = (amps->channel_busy) ? 0 : 1;
 		/* invert, if polarity of the cell is negative */
 		if (amps->flip_polarity)
 			c ^= 1;
@@ -583,7 +588,7 @@ static void fsk_rx_bit(amps_t *amps, sample_t *spl, int len, int pos, int begin,
 #endif
 			amps->fsk_rx_sync = FSK_SYNC_POSITIVE;
 prepare_frame:
-			amps->fsk_rx_frame_count = 0;
+			bitbuf_clear(&amps->fsk_rx_frame);
 			amps->fsk_rx_frame_quality = 0.0;
 			amps->fsk_rx_frame_level = 0.0;
 			amps->fsk_rx_sync_register = 0x555;
@@ -625,21 +630,20 @@ prepare_frame:
 		bit = 1 - bit;
 
 	/* read next bit. after all bits, we reset to FSK_SYNC_NONE */
-	amps->fsk_rx_frame[amps->fsk_rx_frame_count++] = bit + '0';
-	if (amps->fsk_rx_frame_count > FSK_MAX_BITS) {
-		fprintf(stderr, "our fsk_tx_count (%d) is larger than our max bits we can handle, please fix!\n", amps->fsk_rx_frame_count);
+	if (amps->fsk_rx_frame.length == FSK_MAX_BITS) {
+		fprintf(stderr, "our fsk_tx_count (%d) is larger than our max bits we can handle, please fix!\n", amps->fsk_rx_frame.length + 1);
 		abort();
 	}
-	if (amps->fsk_rx_frame_count == amps->fsk_rx_frame_length) {
+	bitbuf_append(&amps->fsk_rx_frame, bit, 1);
+	if (amps->fsk_rx_frame.length == amps->fsk_rx_frame_length) {
 		int more;
 
 		/* update measurements */
-		display_measurements_update(amps->dmp_frame_level, amps->fsk_rx_frame_level / (double)amps->fsk_rx_frame_count * 100.0, 0.0);
-		display_measurements_update(amps->dmp_frame_quality, amps->fsk_rx_frame_quality / (double)amps->fsk_rx_frame_count * 100.0, 0.0);
+		display_measurements_update(amps->dmp_frame_level, amps->fsk_rx_frame_level / (double)amps->fsk_rx_frame.length * 100.0, 0.0);
+		display_measurements_update(amps->dmp_frame_quality, amps->fsk_rx_frame_quality / (double)amps->fsk_rx_frame.length * 100.0, 0.0);
 
 		/* a complete frame was received, so we process it */
-		amps->fsk_rx_frame[amps->fsk_rx_frame_count] = '\0';
-		more = amps_decode_frame(amps, amps->fsk_rx_frame, amps->fsk_rx_frame_count, amps->fsk_rx_frame_level / (double)amps->fsk_rx_frame_count, amps->fsk_rx_frame_quality / amps->fsk_rx_frame_level, (amps->fsk_rx_sync == FSK_SYNC_NEGATIVE));
+		more = amps_decode_frame(amps, &amps->fsk_rx_frame, amps->fsk_rx_frame_level / (double)amps->fsk_rx_frame.length, amps->fsk_rx_frame_quality / amps->fsk_rx_frame_level, (amps->fsk_rx_sync == FSK_SYNC_NEGATIVE));
 		if (more) {
 			/* switch to next word length without DCC included */
 			amps->fsk_rx_frame_length = 240;
@@ -754,13 +758,14 @@ static void sender_receive_frame(amps_t *amps, sample_t *samples, int length)
 
 /* decode SAT and signaling tone */
 /* compare supervisory signal against noise floor at 5790 Hz */
-static void sat_decode(amps_t *amps, sample_t *samples, int length)
+static void sat_decode(amps_t *amps, sample_t *samples, int __attribute__((unused)) length)
 {
-	double result[3], sat_quality, sig_quality, sat_level, sig_level;
+	double bank_result[5], result[3], sat_quality, sig_quality, sat_level, sig_level;
 
-	audio_goertzel(&amps->sat_goertzel[amps->sat], samples, length, 0, &result[0], 1);
-	audio_goertzel(&amps->sat_goertzel[3], samples, length, 0, &result[1], 1);
-	audio_goertzel(&amps->sat_goertzel[4], samples, length, 0, &result[2], 1);
+	goertzel_bank(&amps->sat_bank, samples, 0, bank_result);
+	result[0] = bank_result[amps->sat];
+	result[1] = bank_result[3];
+	result[2] = bank_result[4];
 
 	/* normalize sat level and signaling tone level */
 	sat_level = result[0] / ((!tacs) ? AMPS_SAT_DEVIATION : TACS_SAT_DEVIATION);
@@ -977,7 +982,7 @@ void amps_set_dsp_mode(amps_t *amps, enum dsp_mode mode, int frame_length)
 
 	/* reset transmitter */
 	amps->fsk_tx_buffer_pos = 0;
-	amps->fsk_tx_frame[0] = '\0';
+	amps->fsk_tx_frame.length = 0;
 	amps->fsk_tx_frame_pos = 0;
 }
 
@@ -997,7 +1002,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 
 	if (amps->dsp_mode == DSP_MODE_AUDIO_RX_AUDIO_TX) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&amps->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&amps->sender.dejitter, jf);
 	}
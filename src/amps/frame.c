@@ -32,6 +32,7 @@
 #include "amps.h"
 #include "dsp.h"
 #include "frame.h"
+#include "bch.h"
 #include "main.h"
 
 /* uncomment this to debug bits */
@@ -53,63 +54,6 @@ static uint64_t cut_bits[37] = {
 	0x1ffffffff, 0x3ffffffff, 0x7ffffffff, 0xfffffffff,
 };
 
-static char gp[12] = { 0, 1, 0, 1, 0, 0, 1, 1, 1, 0, 0, 1 };
-
-/* do BCH(length+12,length,5) encoding:
- * given data and length, return 12 bits redundancy
- * all arrays are MSB first.
- */
-static const char *encode_bch(const char *data, int length)
-{
-	static char redun[13];
-	int i, j, feedback;
-
-	for (i = 0; i < 12; i++)
-		redun[i] = 0;
-
-	for (i = 0; i < length; i++) {
-		feedback = (data[i] & 1) ^ redun[0];
-		if (feedback) {
-			for (j = 11; j > 0; j--) {
-				if (gp[11 - j])
-					redun[11 - j] = redun[12 - j] ^ feedback;
-				else
-					redun[11 - j] = redun[12 - j];
-			}
-			redun[11] = gp[11];
-		} else {
-			for (j = 11; j > 0; j--)
-				redun[11 - j] = redun[12 - j];
-			redun[11] = 0;
-		}
-	}
-	for (i = 0; i < 12; i++)
-		redun[i] += '0';
-	redun[12] = '\0';
-
-	return redun;
-}
-
-/* same as above, but with binary data (without parity space holder) */
-static uint16_t encode_bch_binary(uint64_t value, int length)
-{
-	char data[length + 1];
-	const char *redun;
-	uint16_t p = 0;
-	int i;
-
-	for (i = 0; i < length; i++)
-		data[i] = '0' + ((value >> (length - 1 - i)) & 1);
-	data[i] = '\0';
-
-	redun = encode_bch(data, length);
-
-	for (i = 0; i < 12; i++)
-		p = (p << 1) | ((*redun++) & 1);
-
-	return p;
-}
-
 /*
  * helper
  */
@@ -2693,6 +2637,9 @@ void init_frame(void)
 
 	/* generate table 4 */
 	gen_table4();
+
+	/* generate BCH encoding and error correction tables */
+	bch_init();
 }
 
 
@@ -2725,7 +2672,7 @@ static uint64_t amps_encode_word(frame_t *frame, struct def_word *w, int debug)
 	for (i = 0; w->ie[i].name; i++) {
 		bits = w->ie[i].bits;
 		if (w->ie[i].name[0] == 'P' && w->ie[i].name[1] == '\0')
-			value = encode_bch_binary(word, sum_bits - bits);
+			value = bch_encode(word, sum_bits - bits);
 		else
 			value = frame->ie[w->ie[i].ie];
 		word = (word << bits) | (value & cut_bits[bits]);
@@ -3354,100 +3301,95 @@ done:
  * encode and decode bits
  */
 
-static const char *dotting = "10101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101010101";
-static const char *sync_word = "11100010010";
+#define DOTTING		0xaaaaaaaaaaaaaaaaULL	/* 101010... */
+#define SYNC_WORD	0x712			/* 11100010010 */
 
-char *test1 = "101011101000111001101110100111011111111110100000";
-char *test2 = "000100000011011010000000000110101101001110101011";
-
-#if 0
-static uint64_t string2bin(const char *string)
+/* append dotting sequence that starts with a '1' */
+static void append_dotting(bitbuf_t *bits, int num)
 {
-	uint64_t bin = 0;
+	int chunk;
 
-	while (*string)
-		bin = (bin << 1) | ((*string++) & 1);
+	while (num) {
+		chunk = (num > 64) ? 64 : num;
+		bitbuf_append(bits, DOTTING >> (64 - chunk), chunk);
+		num -= chunk;
+	}
+}
 
-	return bin;
+/* append a busy/idle bit, it is marked, so it is set by the transmitter */
+static void append_busy_idle(bitbuf_t *bits, bitbuf_t *busy_idle)
+{
+	bitbuf_set(busy_idle, bits->length, 1, 1);
+	bitbuf_append(bits, 0, 1);
 }
-#endif
 
-static void amps_encode_focc_bits(uint64_t word_a, uint64_t word_b, char *bits)
+static void amps_encode_focc_bits(uint64_t word_a, uint64_t word_b, bitbuf_t *bits, bitbuf_t *busy_idle)
 {
-	int i, j, k;
+	int i, j;
 
-	memcpy(bits + 0, dotting, 10);
-	bits[10] = 'i';
-	memcpy(bits + 11, sync_word, 11);
-	bits[22] = 'i';
-	k = 23;
+	bitbuf_clear(bits);
+	bitbuf_clear(busy_idle);
+	append_dotting(bits, 10);
+	append_busy_idle(bits, busy_idle);
+	bitbuf_append(bits, SYNC_WORD, 11);
+	append_busy_idle(bits, busy_idle);
 	for (i = 0; i < 5; i++) {
 		/* WORD A (msb first) */
-		for (j = 39; j >= 0; j--) {
-			bits[k++] = ((word_a >> j) & 1) + '0';
-			if ((j % 10) == 0)
-				bits[k++] = 'i';
+		for (j = 30; j >= 0; j -= 10) {
+			bitbuf_append(bits, word_a >> j, 10);
+			append_busy_idle(bits, busy_idle);
 		}
 		/* WORD B (msb first) */
-		for (j = 39; j >= 0; j--) {
-			bits[k++] = ((word_b >> j) & 1) + '0';
-			if ((j % 10) == 0)
-				bits[k++] = 'i';
+		for (j = 30; j >= 0; j -= 10) {
+			bitbuf_append(bits, word_b >> j, 10);
+			append_busy_idle(bits, busy_idle);
 		}
 	}
+	busy_idle->length = bits->length;
 
-	if (k != 463)
+	if (bits->length != 463)
 		abort();
-	bits[k] = '\0';
 
 #ifdef BIT_DEBUGGING
 	if (loglevel == LOGL_DEBUG) {
 		char text[64];
 
-		strncpy(text, bits, 23);
-		text[23] = '\0';
-		LOGP(DFRAME, LOGL_INFO, "TX FOCC: %s\n", text);
-		for (i = 0; i < 10; i++) {
-			strncpy(text, bits + 23 + i * 44, 44);
-			text[44] = '\0';
-			LOGP(DFRAME, LOGL_DEBUG, "  word %c - %s\n", (i & 1) ? 'b' : 'a', text);
-		}
+		LOGP(DFRAME, LOGL_INFO, "TX FOCC: %s\n", bitbuf_string(bits, 0, 23, text));
+		for (i = 0; i < 10; i++)
+			LOGP(DFRAME, LOGL_DEBUG, "  word %c - %s\n", (i & 1) ? 'b' : 'a', bitbuf_string(bits, 23 + i * 44, 44, text));
 	}
 #endif
 }
 
-static void amps_encode_fvc_bits(uint64_t word_a, char *bits)
+static void amps_encode_fvc_bits(uint64_t word_a, bitbuf_t *bits, bitbuf_t *busy_idle)
 {
-	int i, j, k;
+	int i;
 
-	
-	k = 0;
+	bitbuf_clear(bits);
+	bitbuf_clear(busy_idle);
 	for (i = 0; i < 11; i++) {
-		if (i == 0) {
-			memcpy(bits + k, dotting, 101);
-			k += 101;
-		} else {
-			memcpy(bits + k, dotting, 37);
-			k += 37;
-		}
-		memcpy(bits + k, sync_word, 11);
-		k += 11;
-		for (j = 39; j >= 0; j--)
-			bits[k++] = ((word_a >> j) & 1) + '0';
+		if (i == 0)
+			append_dotting(bits, 101);
+		else
+			append_dotting(bits, 37);
+		bitbuf_append(bits, SYNC_WORD, 11);
+		bitbuf_append(bits, word_a, 40);
 	}
+	busy_idle->length = bits->length;
 
-	if (k != 1032)
+	if (bits->length != 1032)
 		abort();
-	bits[k] = '\0';
 
 #ifdef BIT_DEBUGGING
 	if (loglevel == LOGL_DEBUG) {
-		LOGP(DFRAME, LOGL_INFO, "TX FVC: %s\n", bits);
+		char text[1033];
+
+		LOGP(DFRAME, LOGL_INFO, "TX FVC: %s\n", bitbuf_string(bits, 0, bits->length, text));
 	}
 #endif
 }
 
-int amps_encode_frame_focc(amps_t *amps, char *bits)
+int amps_encode_frame_focc(amps_t *amps, bitbuf_t *bits, bitbuf_t *busy_idle)
 {
 	uint64_t word;
 	int debug = !amps->tx_focc_debugged;
@@ -3516,12 +3458,12 @@ int amps_encode_frame_focc(amps_t *amps, char *bits)
 	amps->tx_focc_debugged = 1;
 
 send:
-	amps_encode_focc_bits(word, word, bits);
+	amps_encode_focc_bits(word, word, bits, busy_idle);
 
 	return 0;
 }
 
-int amps_encode_frame_fvc(amps_t *amps, char *bits)
+int amps_encode_frame_fvc(amps_t *amps, bitbuf_t *bits, bitbuf_t *busy_idle)
 {
 	uint64_t word;
 
@@ -3581,46 +3523,73 @@ int amps_encode_frame_fvc(amps_t *amps, char *bits)
 	} else
 		return 1;
 
-	amps_encode_fvc_bits(word, bits);
+	amps_encode_fvc_bits(word, bits, busy_idle);
 
 	return 0;
 }
 
+/* select one of the repeated words
+ * a word without errors is taken, if any. a corrected word is only taken, if
+ * another repetition is corrected to the same word, because noise is often
+ * corrected to a valid word too.
+ * return index or -1, if no word is valid */
+static int select_word(const uint64_t *word, const int *errors, int num)
+{
+	int i, j;
+
+	for (i = 0; i < num; i++) {
+		if (errors[i] == 0)
+			return i;
+	}
+	for (i = 0; i < num; i++) {
+		if (errors[i] < 0)
+			continue;
+		for (j = i + 1; j < num; j++) {
+			if (errors[j] >= 0 && word[j] == word[i])
+				return i;
+		}
+	}
+
+	return -1;
+}
+
+static const char *crc_result(int errors)
+{
+	if (errors < 0)
+		return " BAD CRC!";
+	if (errors == 1)
+		return " ok (1 bit corrected)";
+	if (errors == 2)
+		return " ok (2 bits corrected)";
+	return " ok";
+}
+
 /* assemble FOCC bits */
-static void amps_decode_bits_focc(amps_t *amps, const char *bits)
+static void amps_decode_bits_focc(amps_t *amps, const bitbuf_t *bits)
 {
-	char word_string[41];
 	uint64_t word_a[5], word_b[5], word;
-	int crc_a_ok[5], crc_b_ok[5], crc_ok;
+	int errors_a[5], errors_b[5], errors;
 	int idle;
-	int i, j, k, crc_i, crc_j;
+	int i, j, pos, crc_i, crc_j;
 
-	bits++; /* skip B/I after sync */
+	pos = 1; /* skip B/I after sync */
 	idle = 0;
 	for (i = 0; i < 10; i++) {
 		word = 0;
-		for (j = 0, k = 0; j < 44; j++) {
-			if (j % 11 == 10) {
-				idle += (*bits++) & 1;
-				continue;
-			}
-			word_string[k++] = *bits;
-			word = (word << 1) | ((*bits++) & 1);
+		for (j = 0; j < 4; j++) {
+			word = (word << 10) | bitbuf_extract(bits, pos, 10);
+			idle += bitbuf_bit(bits, pos + 10);
+			pos += 11;
 		}
-		word_string[k] = '\0';
-		if (!strncmp(encode_bch(word_string, 28), word_string + 28, 12))
-			crc_ok = 1;
-		else
-			crc_ok = 0;
+		errors = bch_decode(&word, 28);
 		if ((i & 1) == 0) {
 			word_a[i >> 1] = word;
-			crc_a_ok[i >> 1] = crc_ok;
+			errors_a[i >> 1] = errors;
 		} else {
 			word_b[i >> 1] = word;
-			crc_b_ok[i >> 1] = crc_ok;
+			errors_b[i >> 1] = errors;
 		}
 	}
-	bits -= 440;
 
 	if (idle > 20)
 		idle = 1;
@@ -3632,127 +3601,96 @@ static void amps_decode_bits_focc(amps_t *amps, const char *bits)
 		char text[64];
 
 		for (i = 0; i < 10; i++) {
-			strncpy(text, bits + i * 44, 44);
-			text[44] = '\0';
+			bitbuf_string(bits, 1 + i * 44, 44, text);
 			if ((i & 1) == 0)
-				LOGP_CHAN(DFRAME, LOGL_DEBUG, "  word a - %s%s\n", text, (crc_a_ok[i >> 1]) ? " ok" : " BAD CRC!");
+				LOGP_CHAN(DFRAME, LOGL_DEBUG, "  word a - %s%s\n", text, crc_result(errors_a[i >> 1]));
 			else
-				LOGP_CHAN(DFRAME, LOGL_DEBUG, "  word b - %s%s\n", text, (crc_b_ok[i >> 1]) ? " ok" : " BAD CRC!");
+				LOGP_CHAN(DFRAME, LOGL_DEBUG, "  word b - %s%s\n", text, crc_result(errors_b[i >> 1]));
 		}
 	}
 
-	for (crc_i = 0; crc_i < 5; crc_i++) {
-		if (crc_a_ok[crc_i])
-			break;
-	}
-	if (crc_i < 5) {
+	crc_i = select_word(word_a, errors_a, 5);
+	if (crc_i >= 0) {
 		amps_decode_word_focc(amps, word_a[crc_i]);
 	}
-	for (crc_j = 0; crc_j < 5; crc_j++) {
-		if (crc_b_ok[crc_j])
-			break;
-	}
-	if (crc_j < 5 && word_b[crc_j] != word_a[crc_i]) {
+	crc_j = select_word(word_b, errors_b, 5);
+	if (crc_j >= 0 && (crc_i < 0 || word_b[crc_j] != word_a[crc_i])) {
 		amps_decode_word_focc(amps, word_b[crc_j]);
 	}
 }
 
 /* assemble RECC bits, return true, if more bits are expected */
-static int amps_decode_bits_recc(amps_t *amps, const char *bits, int first)
+static int amps_decode_bits_recc(amps_t *amps, const bitbuf_t *bits, int first)
 {
-	char word_string[49];
 	int8_t dcc = -1;
 	uint64_t word_a[5], word;
-	int crc_a_ok[5], crc_ok, crc_ok_count = 0;
-	int i, j, k, crc_i;
-	const char *bits_ = bits; /* for extra check */
+	int errors_a[5], crc_ok, crc_ok_count = 0, corrected_count = 0;
+	int i, j, pos, crc_i;
 
 	/* decode color code */
+	pos = 0;
 	if (first) {
-		dcc = 0;
-		for (j = 0; j < 7; j++) {
-			dcc = (dcc << 1) | ((*bits++) & 1);
-		}
-		dcc = dcc_decode[dcc];
+		dcc = dcc_decode[bitbuf_extract(bits, 0, 7)];
+		pos = 7;
 	}
 
 	/* assemble word */
 	for (i = 0; i < 5; i++) {
-		word = 0;
-		for (j = 0, k = 0; j < 48; j++) {
-			word_string[k++] = *bits;
-			word = (word << 1) | ((*bits++) & 1);
-		}
-		word_string[k] = '\0';
-		if (!strncmp(encode_bch(word_string, 36), word_string + 36, 12)) {
-			crc_ok = 1;
+		word = bitbuf_extract(bits, pos + i * 48, 48);
+		errors_a[i] = bch_decode(&word, 36);
+		if (errors_a[i] == 0)
 			crc_ok_count++;
-		} else
-			crc_ok = 0;
+		if (errors_a[i] > 0)
+			corrected_count++;
 		word_a[i] = word;
-		crc_a_ok[i] = crc_ok;
 	}
-	bits -= 240;
+	crc_i = select_word(word_a, errors_a, 5);
 
-	if (crc_ok_count == 0) {
+	if (crc_i < 0) {
 		/* check if we receive frame in a loop */
 		crc_ok = 0;
-		bits_++; /* skip B/I after sync */
 		for (i = 0; i < 5; i++) {
 			word = 0;
-			for (j = 0, k = 0; j < 44; j++) {
-				if (j % 11 == 10) {
-					bits_++;
-					continue;
-				}
-				word_string[k++] = *bits_;
-				word = (word << 1) | ((*bits_++) & 1);
+			for (j = 0; j < 4; j++) {
+				/* skip B/I after sync and after each 10 bits */
+				word = (word << 10) | bitbuf_extract(bits, 1 + i * 44 + j * 11, 10);
 			}
-			word_string[k] = '\0';
-			if (!strncmp(encode_bch(word_string, 28), word_string + 28, 12))
+			if (bch_encode(word >> 12, 28) == (word & 0xfff))
 				crc_ok++;
 		}
 		if (crc_ok) {
 			LOGP_CHAN(DFRAME, LOGL_NOTICE, "Seems we RX FOCC frame due to loopback, ignoring!\n");
 			return 0;
 		}
-		bits_ -= 221;
-	}
-
-	for (crc_i = 0; crc_i < 5; crc_i++) {
-		if (crc_a_ok[crc_i])
-			break;
 	}
 
 	if (first) {
-		if (loglevel == LOGL_DEBUG || crc_ok_count > 0) {
-			LOGP_CHAN(DFRAME, LOGL_INFO, "RX RECC: DCC=%d (%d of 5 CRCs are ok)\n", dcc, crc_ok_count);
+		if (loglevel == LOGL_DEBUG || crc_i >= 0) {
+			LOGP_CHAN(DFRAME, LOGL_INFO, "RX RECC: DCC=%d (%d of 5 CRCs are ok, %d corrected)\n", dcc, crc_ok_count, corrected_count);
 			if (dcc != amps->si.dcc) {
 				LOGP(DFRAME, LOGL_INFO, "received DCC=%d mismatches the base station's DCC=%d\n", dcc, amps->si.dcc);
 				return 0;
 			}
 		}
 	} else {
-		if (loglevel == LOGL_DEBUG || crc_ok_count > 0)
-			LOGP_CHAN(DFRAME, LOGL_INFO, "RX RECC: (%d of 5 CRCs are ok)\n", crc_ok_count);
+		if (loglevel == LOGL_DEBUG || crc_i >= 0)
+			LOGP_CHAN(DFRAME, LOGL_INFO, "RX RECC: (%d of 5 CRCs are ok, %d corrected)\n", crc_ok_count, corrected_count);
 	}
 	if (loglevel == LOGL_DEBUG) {
 		char text[64];
 
-		for (i = 0; i < 5; i++) {
-			strncpy(text, bits + i * 48, 48);
-			text[48] = '\0';
-			LOGP_CHAN(DFRAME, LOGL_DEBUG, "  word - %s%s\n", text, (crc_a_ok[i]) ? " ok" : " BAD CRC!");
-		}
+		for (i = 0; i < 5; i++)
+			LOGP_CHAN(DFRAME, LOGL_DEBUG, "  word - %s%s\n", bitbuf_string(bits, pos + i * 48, 48, text), crc_result(errors_a[i]));
 	}
 
-	if (crc_ok_count > 0)
+	if (crc_i >= 0)
 		return amps_decode_word_recc(amps, word_a[crc_i], first);
 	return 0;
 }
 
-int amps_decode_frame(amps_t *amps, const char *bits, int count, double level, double quality, int negative)
+int amps_decode_frame(amps_t *amps, const bitbuf_t *bits, double level, double quality, int negative)
 {
+	int count = bits->length;
 	int more = 0;
 
 	/* not if additional words are received without sync */
@@ -3771,4 +3709,3 @@ int amps_decode_frame(amps_t *amps, const char *bits, int count, double level, d
 
 	return more;
 }
-
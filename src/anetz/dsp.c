@@ -437,7 +437,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 
 	if (anetz->dsp_mode == DSP_MODE_AUDIO) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&anetz->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&anetz->sender.dejitter, jf);
 	}
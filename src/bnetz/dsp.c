@@ -450,7 +450,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 	if (bnetz->dsp_mode == DSP_MODE_AUDIO
 	 || bnetz->dsp_mode == DSP_MODE_AUDIO_METER) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&bnetz->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&bnetz->sender.dejitter, jf);
 	}
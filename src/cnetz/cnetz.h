@@ -2,7 +2,9 @@
 #include <osmocom/core/timer.h>
 #include "../libmobile/sender.h"
 #include "../libscrambler/scrambler.h"
+#include "../libbitbuf/bitbuf.h"
 typedef struct cnetz cnetz_t;
+#include "fsk_slope.h"
 #include "fsk_demod.h"
 #include "transaction.h"
 
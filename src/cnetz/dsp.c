@@ -145,6 +145,7 @@ int dsp_init_sender(cnetz_t *cnetz, int measure_speed, double clock_speed[2], en
 	}
 
 	/* reinit the sample rate to shrink/expand audio */
+	exit_samplerate(&cnetz->sender.srstate);
 	init_samplerate(&cnetz->sender.srstate, 8000.0, (double)cnetz->sender.samplerate / (1.1 / (1.0 + clock_speed[0] / 1000000.0)), 3300.0); /* 66 <-> 60 */
 
 	rc = fsk_fm_init(&cnetz->fsk_demod, cnetz, cnetz->sender.samplerate, (double)BITRATE / (1.0 + clock_speed[0] / 1000000.0), demod);
@@ -287,13 +288,13 @@ static int fsk_nothing_encode(cnetz_t *cnetz)
  * input: 184 data bits (including barker code)
  * output: samples
  * return number of samples */
-static int fsk_block_encode(cnetz_t *cnetz, const char *bits, int ogk)
+static int fsk_block_encode(cnetz_t *cnetz, const bitbuf_t *bits, int ogk)
 {
 	/* alloc samples, add 1 in case there is a rest */
 	sample_t *spl;
 	double phase, bitstep, deviation;
 	int i, count;
-	char last;
+	int bit, last;
 
 	deviation = cnetz->fsk_deviation;
 	spl = cnetz->fsk_tx_buffer;
@@ -309,11 +310,12 @@ static int fsk_block_encode(cnetz_t *cnetz, const char *bits, int ogk)
 		phase -= 256.0;
 	}
 	/* add 184 bits */
-	last = ' ';
+	last = -1;
 	for (i = 0; i < 184; i++) {
+		bit = bitbuf_bit(bits, i);
 		switch (last) {
-		case ' ':
-			if (bits[i] == '1') {
+		case -1:
+			if (bit) {
 				/* ramp up from 0 */
 				do {
 					*spl++ = cnetz->fsk_ramp_up[(uint8_t)phase] / 2 + deviation / 2;
@@ -329,8 +331,8 @@ static int fsk_block_encode(cnetz_t *cnetz, const char *bits, int ogk)
 				phase -= 256.0;
 			}
 			break;
-		case '1':
-			if (bits[i] == '1') {
+		case 1:
+			if (bit) {
 				/* stay up */
 				do {
 					*spl++ = deviation;
@@ -346,8 +348,8 @@ static int fsk_block_encode(cnetz_t *cnetz, const char *bits, int ogk)
 				phase -= 256.0;
 			}
 			break;
-		case '0':
-			if (bits[i] == '1') {
+		case 0:
+			if (bit) {
 				/* ramp up */
 				do {
 					*spl++ = cnetz->fsk_ramp_up[(uint8_t)phase];
@@ -364,10 +366,10 @@ static int fsk_block_encode(cnetz_t *cnetz, const char *bits, int ogk)
 			}
 			break;
 		}
-		last = bits[i];
+		last = bit;
 	}
 	/* add 7 bits of pause */
-	if (last == '0') {
+	if (last == 0) {
 		/* ramp up to 0 */
 		do {
 			*spl++ = cnetz->fsk_ramp_up[(uint8_t)phase] / 2 - deviation / 2;
@@ -419,13 +421,13 @@ static int fsk_block_encode(cnetz_t *cnetz, const char *bits, int ogk)
  * the marker marks the point where the speech is ramped up, so the phone
  * will see the speech completely ramped up after the 6th bit
  */
-static int fsk_distributed_encode(cnetz_t *cnetz, const char *bits)
+static int fsk_distributed_encode(cnetz_t *cnetz, const bitbuf_t *bits)
 {
 	/* alloc samples, add 1 in case there is a rest */
 	sample_t *spl, *marker;
 	double phase, bitstep, deviation;
 	int i, j, count;
-	char last;
+	int bit, last;
 
 	deviation = cnetz->fsk_deviation;
 	spl = cnetz->fsk_tx_buffer;
@@ -459,11 +461,12 @@ static int fsk_distributed_encode(cnetz_t *cnetz, const char *bits)
 			phase += bitstep;
 		} while (phase < 256.0);
 		phase -= 256.0;
-		last = ' ';
+		last = -1;
 		for (j = 0; j < 4; j++) {
+			bit = bitbuf_bit(bits, i * 4 + j);
 			switch (last) {
-			case ' ':
-				if (bits[i * 4 + j] == '1') {
+			case -1:
+				if (bit) {
 					/* ramp up from 0 */
 					do {
 						*spl++ = cnetz->fsk_ramp_up[(uint8_t)phase] / 2 + deviation / 2;
@@ -479,8 +482,8 @@ static int fsk_distributed_encode(cnetz_t *cnetz, const char *bits)
 					phase -= 256.0;
 				}
 				break;
-			case '1':
-				if (bits[i * 4 + j] == '1') {
+			case 1:
+				if (bit) {
 					/* stay up */
 					do {
 						*spl++ = deviation;
@@ -496,8 +499,8 @@ static int fsk_distributed_encode(cnetz_t *cnetz, const char *bits)
 					phase -= 256.0;
 				}
 				break;
-			case '0':
-				if (bits[i * 4 + j] == '1') {
+			case 0:
+				if (bit) {
 					/* ramp up */
 					do {
 						*spl++ = cnetz->fsk_ramp_up[(uint8_t)phase];
@@ -514,10 +517,10 @@ static int fsk_distributed_encode(cnetz_t *cnetz, const char *bits)
 				}
 				break;
 			}
-			last = bits[i * 4 + j];
+			last = bit;
 		}
 		/* ramp down */
-		if (last == '0') {
+		if (last == 0) {
 			/* ramp up to 0 */
 			do {
 				*spl++ = cnetz->fsk_ramp_up[(uint8_t)phase] / 2 - deviation / 2;
@@ -608,7 +611,7 @@ static int fsk_telegramm(cnetz_t *cnetz, sample_t *samples, uint8_t *power, int
 {
 	int count = 0, pos, copy, i, speech_length, speech_pos;
 	sample_t *spl, *speech_buffer;
-	const char *bits;
+	bitbuf_t bits;
 
 	speech_buffer = cnetz->dsp_speech_buffer;
 	speech_length = cnetz->dsp_speech_length;
@@ -667,17 +670,15 @@ again:
 						cnetz->negative_polarity = (cnetz->sched_ts & 7) >> 2;
 					/* set last time slot, so we know to which time slot the message from mobile station belongs to */
 					cnetz->sched_last_ts = cnetz->sched_ts;
-					bits = cnetz_encode_telegramm(cnetz);
-					if (bits) {
+					if (cnetz_encode_telegramm(cnetz, &bits) == 0) {
 						LOGP_CHAN(DDSP, LOGL_DEBUG, "Transmitting 'Rufblock' at timeslot %d\n", cnetz->sched_ts);
-						fsk_block_encode(cnetz, bits, 1);
+						fsk_block_encode(cnetz, &bits, 1);
 					} else
 						fsk_nothing_encode(cnetz);
 				} else {
-					bits = cnetz_encode_telegramm(cnetz);
-					if (bits) {
+					if (cnetz_encode_telegramm(cnetz, &bits) == 0) {
 						LOGP_CHAN(DDSP, LOGL_DEBUG, "Transmitting 'Meldeblock' at timeslot %d\n", cnetz->sched_ts);
-						fsk_block_encode(cnetz, bits, 1);
+						fsk_block_encode(cnetz, &bits, 1);
 					} else
 						fsk_nothing_encode(cnetz);
 				}
@@ -686,18 +687,16 @@ again:
 			}
 			break;
 		case DSP_MODE_SPK_K:
-			bits = cnetz_encode_telegramm(cnetz);
-			if (bits) {
+			if (cnetz_encode_telegramm(cnetz, &bits) == 0) {
 				LOGP_CHAN(DDSP, LOGL_DEBUG, "Transmitting 'Konzentrierte Signalisierung' at timeslot %d.%d\n", cnetz->sched_ts, cnetz->sched_r_m * 5);
-				fsk_block_encode(cnetz, bits, 0);
+				fsk_block_encode(cnetz, &bits, 0);
 			} else
 				fsk_nothing_encode(cnetz);
 			break;
 		case DSP_MODE_SPK_V:
-			bits = cnetz_encode_telegramm(cnetz);
-			if (bits) {
+			if (cnetz_encode_telegramm(cnetz, &bits) == 0) {
 				LOGP_CHAN(DDSP, LOGL_DEBUG, "Transmitting 'Verteilte Signalisierung' starting at timeslot %d\n", cnetz->sched_ts);
-				fsk_distributed_encode(cnetz, bits);
+				fsk_distributed_encode(cnetz, &bits);
 			} else
 				fsk_nothing_encode(cnetz);
 			break;
@@ -895,7 +894,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 
 	if (cnetz->dsp_mode == DSP_MODE_SPK_V) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&cnetz->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&cnetz->sender.dejitter, jf);
 	}
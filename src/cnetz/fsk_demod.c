@@ -67,7 +67,9 @@
  * (next sample), check if change level matches the threshold and highest slope
  * is in the middle and so forth. Only if the highest slope is exactly in the
  * middle, we declare a change.  This means that we detect a slope about half of
- * a bit duration later.
+ * a bit duration later. Level range and highest slope are not searched for
+ * each sample, but tracked while samples are added to the window, see
+ * fsk_slope.c.
  *
  * When we are not synced:
  * 
@@ -172,6 +174,8 @@ int fsk_fm_init(fsk_fm_demod_t *fsk, cnetz_t *cnetz, int samplerate, double bitr
 
 	fsk->bit_buffer_len = len;
 	fsk->bit_buffer_half = half;
+	if (demod == FSK_DEMOD_SLOPE && fsk_slope_init(&fsk->slope, len, half) < 0)
+		goto error;
 	fsk->bits_per_sample = bitrate / (double)samplerate;
 
 	fsk->speech_size = samplerate * 60 / bitrate + 10; /* 60 bits duration, add 10 to be safe */
@@ -210,6 +214,7 @@ void fsk_fm_exit(fsk_fm_demod_t *fsk)
 		free(fsk->bit_buffer_spl);
 		fsk->bit_buffer_spl = NULL;
 	}
+	fsk_slope_exit(&fsk->slope);
 	if (fsk->speech_buffer) {
 		free(fsk->speech_buffer);
 		fsk->speech_buffer = NULL;
@@ -372,7 +377,7 @@ got_sync:
 //			printf("sync (change min=%.0f%% max=%.0f%% avg=%.0f%% sync_time=%.2f stddev=%.0f%% probes=%d)\n", min * 100, max * 100, avg * 100, fsk->sync_time, fsk->sync_stddev / avg, probes);
 			fsk->level_threshold = (double)avg;
 			fsk->rx_sync = 0;
-			fsk->rx_buffer_count = 0;
+			bitbuf_clear(&fsk->rx_buffer);
 			break;
 		}
 		if (detect_sync(fsk->rx_sync ^ 0xfffffffff)) {
@@ -384,8 +389,8 @@ got_sync:
 		bit = 1 - bit;
 		/* FALLTHRU */
 	case FSK_SYNC_POSITIVE:
-		fsk->rx_buffer[fsk->rx_buffer_count] = bit + '0';
-		if (++fsk->rx_buffer_count == 150) {
+		bitbuf_append(&fsk->rx_buffer, bit, 1);
+		if (fsk->rx_buffer.length == 150) {
 			fsk->sync = FSK_SYNC_NONE;
 #ifdef DEBUG_DECODER
 			if (debug)
@@ -402,7 +407,7 @@ got_sync:
 			display_measurements_update(fsk->dmp_frame_level, fabs(fsk->sync_level) / fsk->cnetz->fsk_deviation * 100.0, 0.0);
 			display_measurements_update(fsk->dmp_frame_stddev, fsk->sync_stddev / fabs(fsk->sync_level) * 100.0, 0.0);
 			/* receive frame */
-			cnetz_decode_telegramm(fsk->cnetz, fsk->rx_buffer, fsk->sync_level, fsk->sync_time, fsk->sync_stddev);
+			cnetz_decode_telegramm(fsk->cnetz, &fsk->rx_buffer, fsk->sync_level, fsk->sync_time, fsk->sync_stddev);
 		}
 		break;
 	}
@@ -411,37 +416,15 @@ got_sync:
 /* find bit change by checking slope within a window */
 static inline void find_change_slope(fsk_fm_demod_t *fsk)
 {
-	sample_t level_min = 0, level_max = 0, change_max = -1;
-	int change_at = -1, change_positive = -1;
-	sample_t s, last_s = 0;
+	sample_t level = 0;
+	int change_positive;
 	sample_t threshold;
-	int i;
-	
-	/* get level range (level_min and level_max) and also
-	 * get maximum slope (change_max) and where it was
-	 * (change_at) and what direction it went (change_positive)
+
+	/* get level range (level) and check if maximum slope is
+	 * in the middle of the window and what direction it went
+	 * (change_positive)
 	 */
-	for (i = 0; i < fsk->bit_buffer_len; i++) {
-		last_s = s;
-		s = fsk->bit_buffer_spl[fsk->bit_buffer_pos++];
-		if (fsk->bit_buffer_pos == fsk->bit_buffer_len)
-			fsk->bit_buffer_pos = 0;
-		if (i > 0) {
-			if (s - last_s > change_max) {
-				change_max = s - last_s;
-				change_at = i;
-				change_positive = 1;
-			} else if (last_s - s > change_max) {
-				change_max = last_s - s;
-				change_at = i;
-				change_positive = 0;
-			}
-		}
-		if (i == 0 || s > level_max)
-			level_max = s;
-		if (i == 0 || s < level_min)
-			level_min = s;
-	}
+	change_positive = fsk_slope_get(&fsk->slope, &level);
 	/* for first bit, we have only half of the modulation deviation, so we divide the threshold by two */
 	if (fsk->cnetz->dsp_mode == DSP_MODE_SPK_V && fsk->bit_count == 0)
 		threshold = fsk->level_threshold / 2.0;
@@ -454,20 +437,20 @@ static inline void find_change_slope(fsk_fm_demod_t *fsk)
 	 * if we are in sync, we remember last change. after 1.5
 	 * bits after sync average, we measure the first bit
 	 * and then all subsequent bits after 1.0 bits */
-	if (level_max - level_min > threshold && change_at == fsk->bit_buffer_half) {
+	if (change_positive >= 0 && level > threshold) {
 #ifdef DEBUG_DECODER
 		if (debug) {
 			fprintf(fsk->debug_fp, " CHANGE %d->%d (level=%.3f, threshold=%.3f)",
 				fsk->last_change_positive,
 				change_positive,
-				level_max - level_min,
+				level,
 				threshold);
 		}
 #endif
 		fsk->last_change_positive = change_positive;
 		if (!fsk->sync) {
 			fsk->next_bit = 1.5;
-			got_bit(fsk, change_positive, (level_max - level_min) / 2.0);
+			got_bit(fsk, change_positive, level / 2.0);
 		}
 	}
 	if (fsk->next_bit <= 0.0) {
@@ -497,7 +480,7 @@ static inline void find_change_level(fsk_fm_demod_t *fsk)
 
 	/* just sample first bit in distributed mode */
 	if (fsk->cnetz->dsp_mode == DSP_MODE_SPK_V && fsk->bit_count == 0) {
-		if (fmod(fsk->bit_time, BITS_PER_SPK_BLOCK) < 1.5)
+		if (fsk->spk_slot == SPK_SLOT_FIRST_BIT)
 			goto done;
 
 #ifdef DEBUG_DECODER
@@ -554,11 +537,43 @@ done:
 	return;
 }
 
+/* get the part of SPK block at current bit time
+ *
+ * fmod() is not calculated for every sample. Instead we calculate how many
+ * samples the current part lasts at least. One sample less is used, so that
+ * rounding errors of bit_time will not make us miss the next part. */
+static inline enum spk_slot get_spk_slot(fsk_fm_demod_t *fsk)
+{
+	/* note that we start from 0.5, because we detect change 0.5 bits later,
+	 * because the detector of the change is in the middle of the 1 bit
+	 * search window */
+	static const double slot_end[] = { 0.5, 1.5, 5.5, 65.5, BITS_PER_SPK_BLOCK };
+	enum spk_slot slot;
+	double t;
+
+	if (fsk->spk_slot_count > 0) {
+		fsk->spk_slot_count--;
+		return fsk->spk_slot;
+	}
+
+	t = fmod(fsk->bit_time, BITS_PER_SPK_BLOCK);
+	for (slot = SPK_SLOT_START; slot < SPK_SLOT_END; slot++) {
+		if (t < slot_end[slot])
+			break;
+	}
+	fsk->spk_slot = slot;
+	fsk->spk_slot_count = (int)((slot_end[slot] - t) / fsk->bits_per_sample) - 1;
+
+	return slot;
+}
+
 /* receive FM signal from receiver */
 void fsk_fm_demod(fsk_fm_demod_t *fsk, sample_t *samples, int length)
 {
 	int i;
-	double t = 0.0;
+
+	/* bit time may have been changed or counted without samples */
+	fsk->spk_slot_count = 0;
 
 	/* process signaling block, sample by sample */
 	for (i = 0; i < length; i++) {
@@ -567,6 +582,8 @@ void fsk_fm_demod(fsk_fm_demod_t *fsk, sample_t *samples, int length)
 			fsk->bit_buffer_spl[fsk->bit_buffer_pos++] = samples[i];
 			if (fsk->bit_buffer_pos == fsk->bit_buffer_len)
 				fsk->bit_buffer_pos = 0;
+			if (fsk->demod_type == FSK_DEMOD_SLOPE)
+				fsk_slope_add(&fsk->slope, samples[i]);
 
 #ifdef DEBUG_DECODER
 			/* show deviation of center sample in window */
@@ -578,6 +595,7 @@ void fsk_fm_demod(fsk_fm_demod_t *fsk, sample_t *samples, int length)
 
 			/* for each sample process buffer */
 			if (fsk->cnetz->dsp_mode != DSP_MODE_SPK_V) {
+				fsk->spk_slot_count = 0;
 				if (fsk->demod_type == FSK_DEMOD_SLOPE)
 					find_change_slope(fsk);
 				else
@@ -589,25 +607,23 @@ void fsk_fm_demod(fsk_fm_demod_t *fsk, sample_t *samples, int length)
 #endif
 				/* in distributed signaling, measure over 5 bits, but ignore 5th bit.
 				 * also reset next_bit, as soon as we reach the window */
-				/* note that we start from 0.5, because we detect change 0.5 bits later,
-				 * because the detector of the change is in the middle of the 1 bit
-				 * search window */
-				t = fmod(fsk->bit_time, BITS_PER_SPK_BLOCK);
-				if (t < 0.5) {
+				switch (get_spk_slot(fsk)) {
+				case SPK_SLOT_START:
 					fsk->next_bit = 1.0 - fsk->bits_per_sample;
 #ifdef DEBUG_DECODER
 					if (debug && fsk->bit_count)
 						fprintf(fsk->debug_fp, "\n---- SPK(V) BLOCK START ----");
 #endif
 					fsk->bit_count = 0;
-				} else
-				if (t >= 0.5 && t < 5.5) {
+					break;
+				case SPK_SLOT_FIRST_BIT:
+				case SPK_SLOT_BITS:
 					if (fsk->demod_type == FSK_DEMOD_SLOPE)
 						find_change_slope(fsk);
 					else
 						find_change_level(fsk);
-				} else
-				if (t >= 5.5 && t < 65.5) {
+					break;
+				case SPK_SLOT_SPEECH:
 #ifdef DEBUG_DECODER
 					if (debug && !fsk->speech_count)
 						fprintf(fsk->debug_fp, " (start recording speech)");
@@ -617,8 +633,8 @@ void fsk_fm_demod(fsk_fm_demod_t *fsk, sample_t *samples, int length)
 					 * has been restarted. */
 					if (fsk->speech_count < fsk->speech_size)
 						fsk->speech_buffer[fsk->speech_count++] = fsk->bit_buffer_spl[(fsk->bit_buffer_pos + fsk->bit_buffer_half) % fsk->bit_buffer_len];
-				} else
-				if (t >= 65.5) {
+					break;
+				case SPK_SLOT_END:
 #ifdef DEBUG_DECODER
 					if (debug && fsk->speech_count)
 						fprintf(fsk->debug_fp, " (stop recording speech)");
@@ -627,8 +643,8 @@ void fsk_fm_demod(fsk_fm_demod_t *fsk, sample_t *samples, int length)
 						unshrink_speech(fsk->cnetz, fsk->speech_buffer, fsk->speech_count);
 						fsk->speech_count = 0;
 					}
+					break;
 				}
-
 			}
 		}
 		fsk->bit_time += fsk->bits_per_sample;
@@ -651,12 +667,14 @@ void fsk_fm_demod(fsk_fm_demod_t *fsk, sample_t *samples, int length)
 void fsk_correct_sync(fsk_fm_demod_t *fsk, double offset)
 {
 	fsk->bit_time = fmod(fsk->bit_time - offset + BITS_PER_SUPERFRAME, BITS_PER_SUPERFRAME);
+	fsk->spk_slot_count = 0;
 }
 
 /* copy sync from one instance to another (used to sync RX of SpK to OgK) */
 void fsk_copy_sync(fsk_fm_demod_t *fsk_to, fsk_fm_demod_t *fsk_from)
 {
 	fsk_to->bit_time = fsk_from->bit_time;
+	fsk_to->spk_slot_count = 0;
 	fsk_demod_reset(fsk_to);
 }
 
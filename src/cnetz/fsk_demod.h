@@ -10,6 +10,15 @@ enum fsk_sync {
 	FSK_SYNC_NEGATIVE,
 };
 
+/* parts of SPK block, see fsk_fm_demod() */
+enum spk_slot {
+	SPK_SLOT_START = 0,	/* reset bit detection */
+	SPK_SLOT_FIRST_BIT,	/* first bit of data chunk */
+	SPK_SLOT_BITS,		/* other bits of data chunk */
+	SPK_SLOT_SPEECH,	/* record speech */
+	SPK_SLOT_END,		/* process recorded speech */
+};
+
 enum demod_type {
 	FSK_DEMOD_AUTO, /* auto selection of the demod type below */
 	FSK_DEMOD_SLOPE, /* check for highest slope (good for sound cards) */
@@ -22,6 +31,8 @@ typedef struct fsk_fm_demod {
 	/* clock */
 	double		bit_time;		/* current time in bits inside superframe */
 	double		bit_time_uncorrected;	/* same as above, but not corrected by sync */
+	enum spk_slot	spk_slot;		/* part of SPK block at current bit time */
+	int		spk_slot_count;		/* number of samples, spk_slot is still valid */
 
 	/* bit detection */
 	enum demod_type	demod_type;		/* how to demodulate bits */
@@ -29,6 +40,7 @@ typedef struct fsk_fm_demod {
 	int		bit_buffer_len;		/* number of samples in ring buffer */
 	int		bit_buffer_half;	/* half of ring buffer */
 	int		bit_buffer_pos;		/* current position to write next sample */
+	fsk_slope_t	slope;			/* level range and highest slope inside ring buffer */
 	double		level_threshold;	/* threshold for detection of next level change */
 	double		bits_per_sample;	/* duration of one sample in bits */
 	double		next_bit;		/* count time to detect bits */
@@ -46,8 +58,7 @@ typedef struct fsk_fm_demod {
 
 	/* bit decoder */
 	uint64_t	rx_sync;		/* sync shift register */
-	char		rx_buffer[151];		/* 150 bits + termination */
-	int		rx_buffer_count;	/* counter when receiving bits */
+	bitbuf_t	rx_buffer;		/* 150 bits */
 
 	/* statistics */
 	double		change_levels[256];	/* ring buffer to store levels */
@@ -0,0 +1,226 @@
+/* sliding window slope detection for the FSK decoder
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * The FSK decoder looks at a window of one bit duration. It needs the
+ * highest and lowest level inside the window and it needs to know if the
+ * highest slope (difference between two subsequent samples) is exactly in
+ * the middle of the window. Searching the whole window for every sample
+ * takes time that grows with the window length.
+ *
+ * Instead we use a monotonic deque of the slopes. When a new slope is added
+ * to the end of the deque, all entries that are lower than the new slope are
+ * removed from the end first, because they can never become the maximum, as
+ * long as the new slope is inside the window. Entries that have left the
+ * window are removed from the start. The deque is always sorted and the first
+ * entry is the highest slope of the window. Each slope is added and removed
+ * once, so it takes constant time per sample on average. The magnitude of the
+ * slope is used as key, so positive and negative slopes are found.
+ *
+ * The decoder used to search the window from start to end. The slope in the
+ * middle is the highest slope found by that search, if it is higher than all
+ * slopes left of it and not lower than all slopes right of it. Because equal
+ * keys are kept in the deque, the first entry is the first highest slope.
+ *
+ * The search started with a highest slope of -1, so a negative first slope
+ * above -1 was taken as a positive slope with a negative value. Then every
+ * following slope was taken, as long as the slopes are negative and rising.
+ * The search begins for real at the first slope that is not negative or not
+ * rising. We keep a queue of these slopes, so we know where the search
+ * begins for real. Slopes left of it are removed from the deque. They cannot
+ * be used by any later search, because a later search will begin at the same
+ * slope, until they have left the window. This way the decisions are exactly
+ * the same as they were with the search.
+ *
+ * The highest and lowest level is only required when the slope is in the
+ * middle of the window, which happens about once per bit. Then the samples
+ * of the window are searched.
+ *
+ * The window is initially filled with zeroes.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "fsk_slope.h"
+
+/* get size of ring buffer that can hold the given number of entries */
+static uint32_t ring_size(int num)
+{
+	uint32_t size = 1;
+
+	while (size < (uint32_t)num)
+		size <<= 1;
+
+	return size;
+}
+
+static int deque_init(fsk_slope_deque_t *dq, int size)
+{
+	dq->mask = ring_size(size) - 1;
+	dq->entry = calloc(dq->mask + 1, sizeof(*dq->entry));
+	if (!dq->entry)
+		return -1;
+	dq->size = size;
+
+	return 0;
+}
+
+static void deque_exit(fsk_slope_deque_t *dq)
+{
+	free(dq->entry);
+	dq->entry = NULL;
+}
+
+/* add value with given key and remove the first entry, if it has left the window */
+static inline void deque_add(fsk_slope_deque_t *dq, sample_t key, uint32_t index)
+{
+	struct fsk_slope_entry *entry = dq->entry;
+	uint32_t mask = dq->mask;
+
+	if (!dq->size)
+		return;
+
+	/* remove all lower entries from the end */
+	while (dq->last != dq->first && entry[(dq->last - 1) & mask].key < key)
+		dq->last--;
+
+	/* the window holds 'size' values, so one entry may be too old */
+	if (dq->last != dq->first && index - entry[dq->first & mask].index >= dq->size)
+		dq->first++;
+
+	entry[dq->last & mask].key = key;
+	entry[dq->last & mask].index = index;
+	dq->last++;
+}
+
+int fsk_slope_init(fsk_slope_t *slope, int len, int half)
+{
+	int i;
+
+	memset(slope, 0, sizeof(*slope));
+
+	if (len < 2 || half < 1 || half >= len) {
+		LOGP(DDSP, LOGL_ERROR, "Window of %d samples with middle at %d is not supported, please fix!\n", len, half);
+		return -1;
+	}
+	slope->len = len;
+	slope->half = half;
+	slope->mask = ring_size(len) - 1;
+	slope->spl = calloc(slope->mask + 1, sizeof(*slope->spl));
+	slope->change = calloc(slope->mask + 1, sizeof(*slope->change));
+	slope->start = calloc(slope->mask + 1, sizeof(*slope->start));
+	if (!slope->spl || !slope->change || !slope->start
+	 || deque_init(&slope->change_max, len - 1) < 0) {
+		LOGP(DDSP, LOGL_ERROR, "No mem!\n");
+		fsk_slope_exit(slope);
+		return -1;
+	}
+
+	/* fill window with zeroes */
+	for (i = 0; i < len; i++)
+		fsk_slope_add(slope, 0);
+
+	return 0;
+}
+
+void fsk_slope_exit(fsk_slope_t *slope)
+{
+	free(slope->spl);
+	slope->spl = NULL;
+	free(slope->change);
+	slope->change = NULL;
+	free(slope->start);
+	slope->start = NULL;
+	deque_exit(&slope->change_max);
+}
+
+/* add next sample to window */
+void fsk_slope_add(fsk_slope_t *slope, sample_t s)
+{
+	uint32_t index = slope->index++;
+	sample_t change = s - slope->last;
+
+	slope->last = s;
+	slope->spl[index & slope->mask] = s;
+
+	/* the search begins for real at a slope that is not negative or not rising */
+	if (change >= 0 || change <= slope->change[(index - 1) & slope->mask])
+		slope->start[slope->start_last++ & slope->mask] = index;
+	/* remove indices of the first slope in window and older */
+	while (slope->start_last != slope->start_first && index - slope->start[slope->start_first & slope->mask] >= (uint32_t)slope->len - 2)
+		slope->start_first++;
+
+	slope->change[index & slope->mask] = change;
+	deque_add(&slope->change_max, (change < 0) ? -change : change, index);
+}
+
+/* check if the highest slope is in the middle of the window
+ * returns -1 if not, otherwise 1 for a positive slope and 0 for a negative slope
+ * level is set to the difference between highest and lowest level in the window */
+int fsk_slope_get(fsk_slope_t *slope, sample_t *level)
+{
+	uint32_t last = slope->index - 1;
+	uint32_t middle = last - (slope->len - 1 - slope->half);
+	fsk_slope_deque_t *dq = &slope->change_max;
+	sample_t first, change, s, level_max, level_min;
+	uint32_t start, i;
+	int change_positive;
+
+	/* get slope between first and second sample in window */
+	first = slope->change[(last - (slope->len - 2)) & slope->mask];
+	change = slope->change[middle & slope->mask];
+
+	if (first > -1 && first < 0) {
+		if (slope->start_last == slope->start_first) {
+			/* all slopes are negative and rising, so the search ends at the last slope */
+			if (middle != last)
+				return -1;
+			change_positive = 1;
+			goto done;
+		}
+		start = slope->start[slope->start_first & slope->mask];
+	} else
+		start = last - (slope->len - 2);
+
+	/* slopes left of the beginning are ignored by all following searches */
+	while (dq->last != dq->first && (int32_t)(dq->entry[dq->first & dq->mask].index - start) < 0)
+		dq->first++;
+	/* the first entry is the first highest slope right of the beginning */
+	if (dq->last == dq->first || dq->entry[dq->first & dq->mask].index != middle)
+		return -1;
+	change_positive = !(change < 0);
+
+done:
+	/* search highest and lowest level in window */
+	level_max = level_min = slope->spl[(last - (slope->len - 1)) & slope->mask];
+	for (i = last - (slope->len - 2); i != last + 1; i++) {
+		s = slope->spl[i & slope->mask];
+		if (s > level_max)
+			level_max = s;
+		if (s < level_min)
+			level_min = s;
+	}
+	*level = level_max - level_min;
+
+	return change_positive;
+}
@@ -0,0 +1,34 @@
+
+struct fsk_slope_entry {
+	sample_t	key;			/* value to compare */
+	uint32_t	index;			/* sample index of value */
+};
+
+/* monotonic deque of values inside a sliding window */
+typedef struct fsk_slope_deque {
+	struct fsk_slope_entry *entry;		/* ring buffer, keys decreasing from first to last entry */
+	uint32_t	mask;			/* size of ring buffer - 1 */
+	uint32_t	size;			/* window size */
+	uint32_t	first;			/* position of first entry, not wrapped */
+	uint32_t	last;			/* position after last entry, not wrapped */
+} fsk_slope_deque_t;
+
+typedef struct fsk_slope {
+	int		len;			/* window length in samples */
+	int		half;			/* position of slope in the middle of the window */
+	uint32_t	index;			/* index of next sample */
+	sample_t	last;			/* previous sample, to get the slope */
+	sample_t	*spl;			/* ring buffer of samples, indexed by sample index */
+	sample_t	*change;		/* ring buffer of slopes, indexed by sample index */
+	uint32_t	mask;			/* size of ring buffers - 1 */
+	uint32_t	*start;			/* ring buffer of indices where the search may start */
+	uint32_t	start_first;		/* position of first index, not wrapped */
+	uint32_t	start_last;		/* position after last index, not wrapped */
+	fsk_slope_deque_t change_max;	/* highest slope in window */
+} fsk_slope_t;
+
+int fsk_slope_init(fsk_slope_t *slope, int len, int half);
+void fsk_slope_exit(fsk_slope_t *slope);
+void fsk_slope_add(fsk_slope_t *slope, sample_t s);
+int fsk_slope_get(fsk_slope_t *slope, sample_t *level);
+
@@ -618,12 +618,11 @@ static void debug_parameter(char digit, uint64_t value)
 /* encode telegram to 70 bits
  * bit order MSB
  */
-static char *assemble_telegramm(const telegramm_t *telegramm, int debug)
+static void assemble_telegramm(const telegramm_t *telegramm, bitbuf_t *bits, int debug)
 {
-	static char bits[71]; /* + termination char for debug */
 	char parameter;
 	const char *string;
-	uint64_t value, val;
+	uint64_t value;
 	int i, j;
 	int rc;
 
@@ -635,18 +634,17 @@ static char *assemble_telegramm(const telegramm_t *telegramm, int debug)
 	if (debug)
 		LOGP(DFRAME, LOGL_INFO, "Coding %s %s\n", definition_opcode[telegramm->opcode].message_name, definition_opcode[telegramm->opcode].message_text);
 
-	/* copy opcode */
-	for (i = 0; i < 6; i++)
-		bits[5 - i] = (telegramm->opcode & (1 << i)) ? '1' : '0';
+	/* copy opcode, unused bits are 0 */
+	bitbuf_clear(bits);
+	bitbuf_append(bits, telegramm->opcode, 6);
+	bits->length = 70;
 
 	/* copy parameters */
 	string = definition_opcode[telegramm->opcode].no_auth_bits;
 	for (i = 0; i < 64; i++) {
 		parameter = string[63 - i];
-		if (parameter == '-') {
-			bits[69 - i] = '0';
+		if (parameter == '-')
 			continue;
-		}
 		switch (parameter) {
 		case 'A':
 			value = telegramm->fuz_fuvst_nr;
@@ -811,29 +809,25 @@ static char *assemble_telegramm(const telegramm_t *telegramm, int debug)
 		}
 		if (debug && loglevel <= LOGL_DEBUG)
 			debug_parameter(parameter, value);
-		val = value;
-		for (j = 0; string[63 - i - j] == parameter; j++) {
-			bits[69 - i - j] = (val & 1) ? '1' : '0';
-			val >>= 1;
-		}
-		if (val)
+		for (j = 0; i + j < 64 && string[63 - i - j] == parameter; j++);
+		bitbuf_set(bits, 70 - i - j, value, j);
+		if (j < 64 && (value >> j))
 			LOGP(DFRAME, LOGL_ERROR, "Parameter '%c' value '0x%" PRIx64 "' exceeds bit range!\n", parameter, value);
 		i += j - 1;
 	}
-	bits[70] = '\0';
 
 	if (debug) {
+		char debug_bits[71];
+
 		LOGP(DFRAME, LOGL_DEBUG, "OOOOOO%s\n", string);
-		LOGP(DFRAME, LOGL_DEBUG, "%s\n", bits);
+		LOGP(DFRAME, LOGL_DEBUG, "%s\n", bitbuf_string(bits, 0, 70, debug_bits));
 	}
-
-	return bits;
 }
 
 /* decode telegram from 70 bits
  * bit order MSB
  */
-static void disassemble_telegramm(telegramm_t *telegramm, const char *bits, int auth)
+static void disassemble_telegramm(telegramm_t *telegramm, const bitbuf_t *bits, int auth)
 {
 	uint64_t value;
 	const char *string;
@@ -843,15 +837,12 @@ static void disassemble_telegramm(telegramm_t *telegramm, const char *bits, int
 	memset(telegramm, 0, sizeof(*telegramm));
 
 	/* copy opcode */
-	value = 0;
-	for (i = 0; i < 6; i++)
-		value = (value << 1) | (bits[i] == '1');
-	telegramm->opcode = value;
+	telegramm->opcode = bitbuf_extract(bits, 0, 6);
 
 	LOGP(DFRAME, LOGL_INFO, "Decoding %s %s\n", definition_opcode[telegramm->opcode].message_name, definition_opcode[telegramm->opcode].message_text);
 
 	/* copy parameters */
-	if (auth && bits[1]) /* auth flag and chip card flag */
+	if (auth) /* auth flag */
 		string = definition_opcode[telegramm->opcode].auth_bits;
 	else
 		string = definition_opcode[telegramm->opcode].no_auth_bits;
@@ -859,10 +850,8 @@ static void disassemble_telegramm(telegramm_t *telegramm, const char *bits, int
 		parameter = string[63 - i];
 		if (parameter == '-')
 			continue;
-		value = 0;
-		for (j = 0; i + j < 64 && string[63 - i - j] == parameter; j++)
-			value = (value >> 1) | ((uint64_t)(bits[69 - i - j] == '1') << 63);
-		value >>= 64 - j;
+		for (j = 0; i + j < 64 && string[63 - i - j] == parameter; j++);
+		value = bitbuf_extract(bits, 70 - i - j, j);
 		i += j - 1;
 		if (loglevel <= LOGL_DEBUG)
 			debug_parameter(parameter, value);
@@ -1029,15 +1018,12 @@ static void disassemble_telegramm(telegramm_t *telegramm, const char *bits, int
 	if (loglevel <= LOGL_DEBUG) {
 		char debug_bits[71];
 
-		memcpy(debug_bits, bits, 70);
-		debug_bits[70] = '\0';
 		LOGP(DFRAME, LOGL_DEBUG, "OOOOOO%s\n", string);
-		LOGP(DFRAME, LOGL_DEBUG, "%s\n", debug_bits);
+		LOGP(DFRAME, LOGL_DEBUG, "%s\n", bitbuf_string(bits, 0, 70, debug_bits));
 	}
 
 }
 
-static const char *barker_string = "11100010010";
 static int16_t barker_code = 0x712; /* 11 bits: 11100010010 */
 static uint8_t barker_decode[2048]; /* detected bits */
 
@@ -1292,67 +1278,47 @@ int detect_sync(uint64_t bitstream)
  * input: 70 data bits MSB first
  * output: 10*15 code words (LSB first)
  * FTZ 171 TR 60 / 5.1.1.3 */
-static char *encode(const char *input)
+static void encode(const bitbuf_t *input, bitbuf_t *output)
 {
-	static char output[150];
-	int16_t word;
-	int i, j;
+	uint16_t word;
+	int i;
 
 #ifdef DEBUG_CODER
 	printf("Encoding block to transmit:\n");
 	printf("0123456.01234567\n");
 #endif
+	bitbuf_clear(output);
 	for (i = 0; i < 10; i++) {
-		word = 0;
-		for (j = 0; j < 7; j++)
-			word = (word << 1) | (input[(9 - i) * 7 + j] == '1');
-		word = block_code[word];
-		for (j = 0; j < 15; j++) {
-			output[i * 15 + j] = ((word >> j) & 1) + '0';
+		word = block_code[bitbuf_extract(input, (9 - i) * 7, 7)];
+		bitbuf_append(output, bitbuf_reverse(word, 15), 15);
 #ifdef DEBUG_CODER
-			printf("%c", output[i * 15 + j]);
-			if (j == 6)
-				printf(".");
-#endif
-		}
-#ifdef DEBUG_CODER
-		printf("\n");
+		char text[16];
+		bitbuf_string(output, i * 15, 15, text);
+		printf("%.7s.%s\n", text, text + 7);
 #endif
 	}
-
-	return output;
 }
 
 /* decode data block
  * input: 10*15 code words (LSB first)
  * output: 70 data bits MSB first
  * FTZ 171 TR 60 / 5.1.1.3 */
-static const char *decode(const char *input, int *_bit_errors)
+static int decode(const bitbuf_t *input, bitbuf_t *output, int *_bit_errors)
 {
 	int failed = 0, warn = 0;
 	char fail_str[11];
-	static char output[70];
 	uint16_t word;
-	int i, j;
+	int i;
 
 #ifdef DEBUG_CODER
 	printf("Decoding received block:\n");
 	printf("0123456.01234567 Without errors:  Error bits:\n");
 #endif
+	bitbuf_clear(output);
+	output->length = 70;
 	for (i = 0; i < 10; i++) {
-		word = 0;
-		for (j = 0; j < 15; j++) {
-			word = (word << 1) | (input[i * 15 + 14 - j] == '1');
-#ifdef DEBUG_CODER
-			printf("%c", input[i * 15 + j]);
-			if (j == 6)
-				printf(".");
-#endif
-		}
-		word = block_decode[word];
-		for (j = 0; j < 7; j++) {
-			output[(9 - i) * 7 + j] = ((word >> (6 - j)) & 1) + '0';
-		}
+		word = block_decode[bitbuf_reverse(bitbuf_extract(input, i * 15, 15), 15)];
+		bitbuf_set(output, (9 - i) * 7, word, 7);
 		if (word > 0x2ff) {
 			failed = 1;
 			fail_str[i] = 'X';
@@ -1367,6 +1333,10 @@ static const char *decode(const char *input, int *_bit_errors)
 		} else
 			fail_str[i] = '.';
 #ifdef DEBUG_CODER
+		char text[16];
+		int j;
+		bitbuf_string(input, i * 15, 15, text);
+		printf("%.7s.%s", text, text + 7);
 		if (word > 0x2ff)
 			printf("decode failed");
 		else {
@@ -1378,7 +1348,7 @@ static const char *decode(const char *input, int *_bit_errors)
 			}
 			printf(" ");
 			for (j = 0; j < 15; j++) {
-				if (blockcode[word & 0x7f][j] != input[i * 15 + j])
+				if (blockcode[word & 0x7f][j] != text[j])
 					printf("*");
 				else
 					printf("-");
@@ -1399,103 +1369,72 @@ static const char *decode(const char *input, int *_bit_errors)
 		LOGP(DFRAME, LOGL_DEBUG, "Received Telegram with no block errors.\n");
 
 	if (failed)
-		return NULL;
+		return -EINVAL;
 	*_bit_errors = warn;
-	return output;
+	return 0;
 }
 
 /* interleving of code words
  * input: 10*15 code words (LSB first)
  * output: stream of 33 sync + 1 + 150 interleaved bits
  * FTZ 171 TR 60 / 5.1.1.2 and 5.1.1.2 */
-static char *interleave(const char *input)
+static void interleave(const bitbuf_t *input, bitbuf_t *output)
 {
-	static char output[185]; /* + termination char for debug */
-	int i, j;
+	bitbuf_clear(output);
+	bitbuf_append(output, barker_code, 11);
+	bitbuf_append(output, barker_code, 11);
+	bitbuf_append(output, barker_code, 11);
 
-	strcpy(output, barker_string);
-	strcpy(output + 11, barker_string);
-	strcpy(output + 22, barker_string);
+	bitbuf_append(output, 1, 1);
 
-	output[33] = '1';
-
-#ifdef DEBUG_BLOCK
-	printf("Interleaving block to transmit:\n");
-#endif
-	for (i = 0; i < 10; i++) {
-		for (j = 0; j < 15; j++) {
-			output[i + j * 10 + 34] = input[j + i * 15];
-#ifdef DEBUG_BLOCK
-			printf("%c", input[j + i * 15]);
-#endif
-		}
-#ifdef DEBUG_BLOCK
-		printf("\n");
-#endif
-	}
+	/* write code words as rows, send columns */
+	bitbuf_interleave(output, input, 0, 10, 15);
 
 #ifdef DEBUG_RAW
-	output[184] = '\0';
-	printf("Raw TX: %s\n", output + 34);
+	char debug_bits[151];
+	printf("Raw TX: %s\n", bitbuf_string(output, 34, 150, debug_bits));
 #endif
-
-	return output;
 }
 
 /* deinterleave of code words
  * input: stream of 150 interleaved bits
  * output: 10*15 code words (LSB first)
  * FTZ 171 TR 60 / 5.1.1.4 */
-static const char *deinterleave(const char *input)
+static void deinterleave(const bitbuf_t *input, bitbuf_t *output)
 {
-	static char output[150];
-	int i, j;
-
 #ifdef DEBUG_RAW
 	char debug_bits[151];
-
-	memcpy(debug_bits, input, 150);
-	debug_bits[151] = '\0';
-	printf("Raw RX: %s\n", debug_bits);
+	printf("Raw RX: %s\n", bitbuf_string(input, 0, 150, debug_bits));
 #endif
 
+	bitbuf_clear(output);
+	bitbuf_interleave(output, input, 0, 15, 10);
+
 #ifdef DEBUG_BLOCK
+	char text[16];
+	int i;
 	printf("Deinterleaving received block:\n");
+	for (i = 0; i < 10; i++)
+		printf("%s\n", bitbuf_string(output, i * 15, 15, text));
 #endif
-	for (i = 0; i < 10; i++) {
-		for (j = 0; j < 15; j++) {
-			output[j + i * 15] = input[i + j * 10];
-#ifdef DEBUG_BLOCK
-			printf("%c", output[j + i * 15]);
-#endif
-		}
-#ifdef DEBUG_BLOCK
-		printf("\n");
-#endif
-	}
-
-	return output;
 }
 
-void cnetz_decode_telegramm(cnetz_t *cnetz, const char *bits, double level, double sync_time, double stddev)
+void cnetz_decode_telegramm(cnetz_t *cnetz, const bitbuf_t *bits, double level, double sync_time, double stddev)
 {
 	telegramm_t telegramm;
+	bitbuf_t block, data;
 	uint8_t opcode;
-	int i;
-	int block;
+	int zeros;
+	int block_nr;
 	int bit_errors;
 
-	bits = deinterleave(bits);
-	bits = decode(bits, &bit_errors);
-	if (!bits)
+	deinterleave(bits, &block);
+	if (decode(&block, &data, &bit_errors) < 0)
 		return;
 
 	/* filter out mysterious zero-telegramm */
-	for (i = 0; i < 70; i++) {
-		if (bits[i] != bits[0])
-			break;
-	}
-	if (i == 70) {
+	zeros = bitbuf_correlate(&data, 0, 0, 64) + bitbuf_correlate(&data, 64, 0, 6);
+	if (zeros == 0 || zeros == 70) {
 		LOGP(DFRAME, LOGL_INFO, "Ignoring mysterious unmodulated telegramm (noise from phone's transmitter)\n");
 		return;
 	}
@@ -1504,7 +1443,7 @@ void cnetz_decode_telegramm(cnetz_t *cnetz, const char *bits, double level, doub
 	if (bit_errors)
 		LOGP_CHAN(DDSP, LOGL_INFO, " -> Frame has %d bit errors.\n", bit_errors);
 
-	disassemble_telegramm(&telegramm, bits, si.authentifikationsbit);
+	disassemble_telegramm(&telegramm, &data, si.authentifikationsbit);
 	opcode = telegramm.opcode;
 	telegramm.level = level;
 	telegramm.sync_time = sync_time;
@@ -1550,10 +1489,10 @@ void cnetz_decode_telegramm(cnetz_t *cnetz, const char *bits, double level, doub
 		/* determine block by last timeslot sent and by message type
 		 * this is needed to sync the time of the receiver
 		 */
-		block = cnetz->sched_last_ts * 2;
+		block_nr = cnetz->sched_last_ts * 2;
 		if (definition_opcode[opcode].block == BLOCK_M)
-			block++;
-		cnetz_receive_telegramm_ogk(cnetz, &telegramm, block);
+			block_nr++;
+		cnetz_receive_telegramm_ogk(cnetz, &telegramm, block_nr);
 		break;
 	case DSP_MODE_SPK_K:
 		if (definition_opcode[opcode].block != BLOCK_K) {
@@ -1574,11 +1513,11 @@ void cnetz_decode_telegramm(cnetz_t *cnetz, const char *bits, double level, doub
 	}
 }
 
-const char *cnetz_encode_telegramm(cnetz_t *cnetz)
+int cnetz_encode_telegramm(cnetz_t *cnetz, bitbuf_t *bits)
 {
 	const telegramm_t *telegramm = NULL;
+	bitbuf_t data, block;
 	uint8_t opcode;
-	char *bits;
 	int debug = 1;
 
 	switch (cnetz->dsp_mode) {
@@ -1599,24 +1538,20 @@ const char *cnetz_encode_telegramm(cnetz_t *cnetz)
 	}
 
 	if (!telegramm)
-		return NULL;
+		return -ENOENT;
 
 	opcode = telegramm->opcode;
 	if (opcode == OPCODE_LR_R && cnetz->sched_lr_debugged)
 		debug = 0;
 	if (opcode == OPCODE_MLR_M && cnetz->sched_mlr_debugged)
 		debug = 0;
-	bits = assemble_telegramm(telegramm, debug);
-	bits = encode(bits);
-	bits = interleave(bits);
+	assemble_telegramm(telegramm, &data, debug);
+	encode(&data, &block);
+	interleave(&block, bits);
 
 	/* invert, if polarity of the cell is negative */
-	if (cnetz->negative_polarity) {
-		int i;
-
-		for (i = 0; i < 184; i++)
-			bits[i] ^= 1;
-	}
+	if (cnetz->negative_polarity)
+		bitbuf_invert(bits);
 
 	if (opcode == OPCODE_LR_R && !cnetz->sched_lr_debugged)
 		cnetz->sched_lr_debugged = 1;
@@ -1625,6 +1560,6 @@ const char *cnetz_encode_telegramm(cnetz_t *cnetz)
 		LOGP(DFRAME, LOGL_INFO, "Subsequent IDLE frames are not shown, to prevent flooding the output.\n");
 	}
 
-	return bits;
+	return 0;
 }
 
@@ -125,6 +125,6 @@ int match_fuz(telegramm_t *telegramm);
 int match_futln(telegramm_t *telegramm, uint8_t futln_nat, uint8_t futln_fuvst, uint16_t futln_rest);
 
 int detect_sync(uint64_t bitstream);
-void cnetz_decode_telegramm(cnetz_t *cnetz, const char *bits, double level, double sync_time, double stddev);
-const char *cnetz_encode_telegramm(cnetz_t *cnetz);
+void cnetz_decode_telegramm(cnetz_t *cnetz, const bitbuf_t *bits, double level, double sync_time, double stddev);
+int cnetz_encode_telegramm(cnetz_t *cnetz, bitbuf_t *bits);
 
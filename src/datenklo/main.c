@@ -33,6 +33,7 @@
 #include "../liboptions/options.h"
 #include "../liblogging/logging.h"
 #include "../libfsk/fsk.h"
+#include "../libfilter/iir_filter.h"
 #include "am791x.h"
 #include "uart.h"
 #include "datenklo.h"
@@ -279,6 +280,8 @@ int main(int argc, char *argv[])
 	/* inits */
 	datenklo_init_global();
 	fm_init(fast_math);
+	/* select filter kernels once, before any thread uses them */
+	iir_kernel_select(IIR_KERNEL_AUTO);
 
 	if (stereo) {
 		num_kanal = 2;
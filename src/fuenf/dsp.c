@@ -667,7 +667,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 
 	if (fuenf->state == FUENF_STATE_DURCHSAGE) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&fuenf->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&fuenf->sender.dejitter, jf);
 	}
@@ -77,15 +77,23 @@ const char *cnetz_number_valid(const char *number)
 	return NULL;
 }
 
+/* MTP encodes and decodes whole bytes, the modem sends and receives bits, LSB first */
 static int send_bit(void *inst)
 {
 	fuvst_t *fuvst = (fuvst_t *)inst;
+	int bit;
 
 #ifdef DIGITAL_LOOPBACK
 	return 0;
-#else
-	return mtp_send_bit(&fuvst->mtp);
 #endif
+	if (!fuvst->tx_bit_count) {
+		mtp_send_block(&fuvst->mtp, &fuvst->tx_byte, 1);
+		fuvst->tx_bit_count = 8;
+	}
+	bit = fuvst->tx_byte & 1;
+	fuvst->tx_byte >>= 1;
+	fuvst->tx_bit_count--;
+	return bit;
 }
 
 static void receive_bit(void *inst, int bit)
@@ -94,7 +102,11 @@ static void receive_bit(void *inst, int bit)
 #ifdef DIGITAL_LOOPBACK
 	mtp_receive_bit(&fuvst->mtp, mtp_send_bit(&fuvst->mtp));
 #else
-	mtp_receive_bit(&fuvst->mtp, bit);
+	fuvst->rx_byte = (fuvst->rx_byte >> 1) | ((bit & 1) << 7);
+	if (++fuvst->rx_bit_count == 8) {
+		mtp_receive_block(&fuvst->mtp, &fuvst->rx_byte, 1);
+		fuvst->rx_bit_count = 0;
+	}
 #endif
 }
 
@@ -1314,7 +1326,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 
 	if (fuvst->callref) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&fuvst->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&fuvst->sender.dejitter, jf);
 	}
@@ -13,6 +13,10 @@ typedef struct fuvst {
 	sender_t		sender;
 	v27modem_t		modem;
 	mtp_t			mtp;
+	uint8_t			tx_byte; /* byte from MTP, sent bit by bit to the modem */
+	int			tx_bit_count; /* bits left in tx_byte */
+	uint8_t			rx_byte; /* bits from the modem, given to MTP as byte */
+	int			rx_bit_count; /* bits in rx_byte */
 
 	int			chan_num; /* number of SPK or ZZK */
 	enum fuvst_chan_type	chan_type; /* ZZK or SPK */
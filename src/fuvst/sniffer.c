@@ -38,6 +38,10 @@ typedef struct sniffer {
 	sender_t		sender;
 	v27modem_t		modem;
 	mtp_t			mtp;
+	uint8_t			tx_byte; /* byte from MTP, sent bit by bit to the modem */
+	int			tx_bit_count; /* bits left in tx_byte */
+	uint8_t			rx_byte; /* bits from the modem, given to MTP as byte */
+	int			rx_bit_count; /* bits in rx_byte */
 	uint8_t			last_fsn;
 } sniffer_t;
 
@@ -135,23 +139,34 @@ static void receive_msu(mtp_t *mtp, uint8_t bsn, uint8_t bib, uint8_t fsn, uint8
 	sniffer->last_fsn = fsn;
 }
 
-/* a bit is sent to the modem */
+/* a bit is sent to the modem, MTP encodes whole bytes, LSB first */
 static int send_bit(void *inst)
 {
 	sniffer_t *sniffer = (sniffer_t *)inst;
+	int bit;
 
-	if (sniffer->sender.loopback)
-		return mtp_send_bit(&sniffer->mtp);
-	else
+	if (!sniffer->sender.loopback)
 		return 0;
+	if (!sniffer->tx_bit_count) {
+		mtp_send_block(&sniffer->mtp, &sniffer->tx_byte, 1);
+		sniffer->tx_bit_count = 8;
+	}
+	bit = sniffer->tx_byte & 1;
+	sniffer->tx_byte >>= 1;
+	sniffer->tx_bit_count--;
+	return bit;
 }
 
-/* a bit is received from the modem */
+/* a bit is received from the modem, MTP decodes whole bytes, LSB first */
 static void receive_bit(void *inst, int bit)
 {
 	sniffer_t *sniffer = (sniffer_t *)inst;
 
-	mtp_receive_bit(&sniffer->mtp, bit);
+	sniffer->rx_byte = (sniffer->rx_byte >> 1) | ((bit & 1) << 7);
+	if (++sniffer->rx_bit_count == 8) {
+		mtp_receive_block(&sniffer->mtp, &sniffer->rx_byte, 1);
+		sniffer->rx_bit_count = 0;
+	}
 }
 
 /* Destroy transceiver instance and unlink from list. */
@@ -99,6 +99,8 @@ void dsp_cleanup_sender(gsc_t *gsc)
 		free(gsc->fsk_tx_buffer);
 		gsc->fsk_tx_buffer = NULL;
 	}
+
+	exit_samplerate(&gsc->wave_tx_upsample);
 }
 
 
@@ -204,6 +206,7 @@ again:
 		if (!gsc->wave_tx_play.left) {
 			LOGP_CHAN(DDSP, LOGL_INFO, "Voice message sent.\n");
 			wave_destroy_playback(&gsc->wave_tx_play);
+			exit_samplerate(&gsc->wave_tx_upsample);
 			return;
 		}
 		return;
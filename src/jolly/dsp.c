@@ -27,6 +27,7 @@
 #include <math.h>
 
 #include "../libsample/sample.h"
+#include "../libsamplestore/samplestore.h"
 #include <osmocom/core/timer.h>
 #include "../liblogging/logging.h"
 #include "../libmobile/call.h"
@@ -53,6 +54,81 @@
 #define ACK_TIME	0.15	/* Time to play the ack tone */
 #define REPEATER_TIME	5.0	/* Time to transmit in repeater mode */
 
+/* voice samples, resampled to the sample rate of the DSP */
+jolly_voice_t jolly_voice;
+
+#define GAIN	2.5
+
+static const char *voice_name[13] = {
+	"jolly_digit_0", "jolly_digit_1", "jolly_digit_2", "jolly_digit_3", "jolly_digit_4",
+	"jolly_digit_5", "jolly_digit_6", "jolly_digit_7", "jolly_digit_8", "jolly_digit_9",
+	"jolly_incoming", "jolly_outgoing", "jolly_released",
+};
+
+/* load voice sample from sample store and convert it to the sample rate */
+static int load_voice(int i, int samplerate)
+{
+	samplerate_t srstate;
+	const int16_t *spl;
+	sample_t *spl_in, *spl_out;
+	int s, size, output_num;
+	int rc;
+
+	/* without voice samples, nothing is spoken */
+	spl = samplestore_get(voice_name[i], &size);
+	if (!spl || size <= 0) {
+		LOGP(DDSP, LOGL_NOTICE, "Voice sample '%s' not available.\n", voice_name[i]);
+		return 0;
+	}
+
+	rc = init_samplerate(&srstate, 8000.0, (double)samplerate, 3400.0);
+	if (rc < 0) {
+		LOGP(DDSP, LOGL_ERROR, "Failed to init sample rate conversion!\n");
+		return -1;
+	}
+
+	output_num = samplerate_upsample_output_num(&srstate, size);
+	spl_in = malloc(size * sizeof(*spl_in));
+	spl_out = calloc(output_num, sizeof(*spl_out));
+	if (!spl_in || !spl_out) {
+		LOGP(DDSP, LOGL_ERROR, "No mem!\n");
+		free(spl_out);
+		rc = -1;
+		goto out;
+	}
+	for (s = 0; s < size; s ++)
+		spl_in[s] = (double)spl[s] / 32767.0 * GAIN;
+	samplerate_upsample(&srstate, spl_in, size, spl_out, output_num);
+	jolly_voice.spl[i] = spl_out;
+	jolly_voice.size[i] = output_num;
+	rc = 0;
+
+out:
+	exit_samplerate(&srstate);
+	free(spl_in);
+	return rc;
+}
+
+/* voice samples are converted when they are spoken the first time */
+int init_voice(int samplerate)
+{
+	memset(&jolly_voice, 0, sizeof(jolly_voice));
+	jolly_voice.samplerate = samplerate;
+
+	return 0;
+}
+
+static const sample_t *get_voice(int i, int *size)
+{
+	if (!jolly_voice.loaded[i]) {
+		jolly_voice.loaded[i] = 1;
+		load_voice(i, jolly_voice.samplerate);
+	}
+	*size = jolly_voice.size[i];
+
+	return jolly_voice.spl[i];
+}
+
 /* table for fast sine generation */
 static sample_t dsp_info_tone[65536];
 static sample_t dsp_ack_tone[65536];
@@ -158,7 +234,7 @@ void reset_speech_string(jolly_t *jolly)
 /* Generate audio stream from voice samples. */
 static int speak_voice(jolly_t *jolly, sample_t *samples, int length)
 {
-	sample_t *spl;
+	const sample_t *spl;
 	int size;
 	int i;
 	int count = 0;
@@ -171,26 +247,22 @@ again:
 	/* select sample */
 	switch (jolly->speech_string[jolly->speech_digit]) {
 	case 'i':
-		spl = jolly_voice.spl[10];
-		size = jolly_voice.size[10];
+		spl = get_voice(10, &size);
 		if (!jolly->speech_pos)
 			LOGP(DDSP, LOGL_DEBUG, "speaking 'incoming'.\n");
 		break;
 	case 'o':
-		spl = jolly_voice.spl[11];
-		size = jolly_voice.size[11];
+		spl = get_voice(11, &size);
 		if (!jolly->speech_pos)
 			LOGP(DDSP, LOGL_DEBUG, "speaking 'outgoing'.\n");
 		break;
 	case 'r':
-		spl = jolly_voice.spl[12];
-		size = jolly_voice.size[12];
+		spl = get_voice(12, &size);
 		if (!jolly->speech_pos)
 			LOGP(DDSP, LOGL_DEBUG, "speaking 'released'.\n");
 		break;
 	case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
-		spl = jolly_voice.spl[jolly->speech_string[jolly->speech_digit] - '0'];
-		size = jolly_voice.size[jolly->speech_string[jolly->speech_digit] - '0'];
+		spl = get_voice(jolly->speech_string[jolly->speech_digit] - '0', &size);
 		if (!jolly->speech_pos)
 			LOGP(DDSP, LOGL_DEBUG, "speaking digit '%c'.\n", jolly->speech_string[jolly->speech_digit]);
 		break;
@@ -320,7 +392,7 @@ void sender_receive(sender_t *sender, sample_t *samples, int length, double rf_l
 	/* if repeater mode, store sample in jitter buffer */
 	if (jolly->repeater) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(NULL, NULL, (uint8_t *)samples, length * sizeof(*samples), 0, jolly->repeater_sequence, jolly->repeater_timestamp, 123);
+		jf = jitter_frame_alloc(&jolly->repeater_dejitter, NULL, NULL, (uint8_t *)samples, length * sizeof(*samples), 0, jolly->repeater_sequence, jolly->repeater_timestamp, 123);
 		if (jf)
 			jitter_save(&jolly->repeater_dejitter, jf);
 		jolly->repeater_sequence += 1;
@@ -426,7 +498,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 
 	if (jolly->state == STATE_CALL || jolly->state == STATE_CALL_DIALING) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&jolly->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&jolly->sender.dejitter, jf);
 	}
@@ -1,9 +1,4 @@
-#include <stdio.h>
-#include <stdint.h>
-#include <stdlib.h>
-#include "../libsample/sample.h"
-#include "../libsamplerate/samplerate.h"
-#include "voice.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static int16_t digit_0[] = {
 	0xfff0, 0xfffc, 0xfffe, 0x0001, 0xfffe, 0xfffb, 0xfffe, 0xfffd,
@@ -11062,63 +11057,3 @@ static int16_t released[] = {
 	0x0007, 0xfff8, 0x000c, 0xfff5, 0x0006, 0x0000, 0xfff6, 0x0013,
 	0xffe8, 0x0018, 0xffee, 0x000d, 0xfff3, 0x000d, 0xfff2, 0x0014,
 };
-
-jolly_voice_t jolly_voice;
-
-#define GAIN	2.5
-
-int init_voice(int samplerate)
-{
-	int i;
-
-	jolly_voice.spl[0] = (sample_t *)digit_0;
-	jolly_voice.size[0] = sizeof(digit_0) / sizeof(int16_t);
-	jolly_voice.spl[1] = (sample_t *)digit_1;
-	jolly_voice.size[1] = sizeof(digit_1) / sizeof(int16_t);
-	jolly_voice.spl[2] = (sample_t *)digit_2;
-	jolly_voice.size[2] = sizeof(digit_2) / sizeof(int16_t);
-	jolly_voice.spl[3] = (sample_t *)digit_3;
-	jolly_voice.size[3] = sizeof(digit_3) / sizeof(int16_t);
-	jolly_voice.spl[4] = (sample_t *)digit_4;
-	jolly_voice.size[4] = sizeof(digit_4) / sizeof(int16_t);
-	jolly_voice.spl[5] = (sample_t *)digit_5;
-	jolly_voice.size[5] = sizeof(digit_5) / sizeof(int16_t);
-	jolly_voice.spl[6] = (sample_t *)digit_6;
-	jolly_voice.size[6] = sizeof(digit_6) / sizeof(int16_t);
-	jolly_voice.spl[7] = (sample_t *)digit_7;
-	jolly_voice.size[7] = sizeof(digit_7) / sizeof(int16_t);
-	jolly_voice.spl[8] = (sample_t *)digit_8;
-	jolly_voice.size[8] = sizeof(digit_8) / sizeof(int16_t);
-	jolly_voice.spl[9] = (sample_t *)digit_9;
-	jolly_voice.size[9] = sizeof(digit_9) / sizeof(int16_t);
-	jolly_voice.spl[10] = (sample_t *)incoming;
-	jolly_voice.size[10] = sizeof(incoming) / sizeof(int16_t);
-	jolly_voice.spl[11] = (sample_t *)outgoing;
-	jolly_voice.size[11] = sizeof(outgoing) / sizeof(int16_t);
-	jolly_voice.spl[12] = (sample_t *)released;
-	jolly_voice.size[12] = sizeof(released) / sizeof(int16_t);
-
-	for (i = 0; i < 13; i++) {
-		samplerate_t srstate;
-		sample_t spl_in[jolly_voice.size[i]], *spl_out;
-		int s, output_num;
-		int rc;
-
-		rc = init_samplerate(&srstate, 8000.0, (double)samplerate, 3400.0);
-		if (rc < 0) {
-			fprintf(stderr, "Failed to init sample rate conversion!\n");
-			return -1;
-		}
-
-		output_num = samplerate_upsample_output_num(&srstate, jolly_voice.size[i]);
-		spl_out = calloc(output_num, sizeof(*spl_out));
-		for (s = 0; s < jolly_voice.size[i]; s ++)
-			spl_in[s] = (double)(((int16_t *)(jolly_voice.spl[i]))[s]) / 32767.0 * GAIN;
-		samplerate_upsample(&srstate, spl_in, jolly_voice.size[i], spl_out, output_num);
-		jolly_voice.spl[i] = spl_out;
-		jolly_voice.size[i] = output_num;
-	}
-
-	return 0;
-}
-
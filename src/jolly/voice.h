@@ -1,5 +1,7 @@
 
 typedef struct jolly_voice {
+	int		samplerate;
+	int		loaded[13];
 	sample_t	*spl[13];
 	int		size[13];
 } jolly_voice_t;
@@ -187,8 +187,7 @@ void am_demodulate_complex(am_demod_t *demod, sample_t *amplitude, int length, f
 	demod->phase = phase;
 
 	/* filter bandwidth */
-	iir_process(&demod->lp[0], I, length);
-	iir_process(&demod->lp[1], Q, length);
+	iir_process_dual(&demod->lp[0], &demod->lp[1], I, Q, length);
 
 	/* demod */
 	for (s = 0; s < length; s++)
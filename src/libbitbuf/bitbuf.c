@@ -0,0 +1,202 @@
+/* packed bit buffer for frame coding
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * The bits of a frame are stored in 64 bit words. The first bit of the frame
+ * is the MSB of the first word. A field of up to 64 bits is never spread over
+ * more than two words, so it can be stored or extracted with two shift
+ * operations, instead of handling each bit.
+ *
+ * The buffer has a fixed size and is part of the structure, so it can be put
+ * on the stack or into the instance of a transceiver. No static buffers are
+ * required, so the frame coders can be used by multiple threads.
+ *
+ * Values are given MSB first, as the bits appear in the buffer. Protocols
+ * that send fields LSB first can use bitbuf_reverse() to swap the order.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bitbuf.h"
+
+static void check_range(int pos, int num)
+{
+	if (pos < 0 || num < 0 || num > 64 || pos + num > BITBUF_MAX) {
+		fprintf(stderr, "Bit position %d with %d bits exceeds bit buffer, please fix!\n", pos, num);
+		abort();
+	}
+}
+
+/* remove all bits */
+void bitbuf_clear(bitbuf_t *buf)
+{
+	memset(buf->word, 0, sizeof(buf->word));
+	buf->length = 0;
+}
+
+/* overwrite 'num' bits at given position with the lower bits of 'value'
+ * the length of the buffer is not changed */
+void bitbuf_set(bitbuf_t *buf, int pos, uint64_t value, int num)
+{
+	int w = pos >> 6, s = pos & 63;
+	uint64_t mask;
+
+	check_range(pos, num);
+	if (!num)
+		return;
+
+	/* align value and mask to the MSB */
+	value <<= 64 - num;
+	mask = ~0ULL << (64 - num);
+	buf->word[w] = (buf->word[w] & ~(mask >> s)) | (value >> s);
+	if (s + num > 64)
+		buf->word[w + 1] = (buf->word[w + 1] & ~(mask << (64 - s))) | (value << (64 - s));
+}
+
+/* append 'num' (up to 64) lower bits of 'value' */
+void bitbuf_append(bitbuf_t *buf, uint64_t value, int num)
+{
+	bitbuf_set(buf, buf->length, value, num);
+	buf->length += num;
+}
+
+/* append 'num' bits of another buffer, starting at given position */
+void bitbuf_append_buf(bitbuf_t *buf, const bitbuf_t *src, int pos, int num)
+{
+	int chunk;
+
+	while (num) {
+		chunk = (num > 64) ? 64 : num;
+		bitbuf_append(buf, bitbuf_extract(src, pos, chunk), chunk);
+		pos += chunk;
+		num -= chunk;
+	}
+}
+
+/* append 'num' bits of a byte array, MSB of first byte first */
+void bitbuf_append_bytes(bitbuf_t *buf, const uint8_t *bytes, int num)
+{
+	for (; num >= 8; num -= 8)
+		bitbuf_append(buf, *bytes++, 8);
+	if (num)
+		bitbuf_append(buf, *bytes >> (8 - num), num);
+}
+
+/* return 'num' (up to 64) bits at given position as lower bits */
+uint64_t bitbuf_extract(const bitbuf_t *buf, int pos, int num)
+{
+	int w = pos >> 6, s = pos & 63;
+	uint64_t value;
+
+	check_range(pos, num);
+	if (!num)
+		return 0;
+
+	value = buf->word[w] << s;
+	if (s + num > 64)
+		value |= buf->word[w + 1] >> (64 - s);
+
+	return value >> (64 - num);
+}
+
+/* store 'num' bits at given position into a byte array, MSB of first byte first
+ * unused bits of the last byte are set to 0 */
+void bitbuf_extract_bytes(const bitbuf_t *buf, int pos, int num, uint8_t *bytes)
+{
+	for (; num >= 8; num -= 8, pos += 8)
+		*bytes++ = bitbuf_extract(buf, pos, 8);
+	if (num)
+		*bytes = bitbuf_extract(buf, pos, num) << (8 - num);
+}
+
+/* invert all bits of the buffer */
+void bitbuf_invert(bitbuf_t *buf)
+{
+	int i, words = (buf->length + 63) >> 6;
+
+	for (i = 0; i < words; i++)
+		buf->word[i] = ~buf->word[i];
+	/* keep unused bits of the last word cleared */
+	if ((buf->length & 63))
+		buf->word[words - 1] &= ~0ULL << (64 - (buf->length & 63));
+}
+
+/* append 'rows' * 'columns' bits of another buffer, starting at given position
+ * the bits are read row by row and appended column by column */
+void bitbuf_interleave(bitbuf_t *buf, const bitbuf_t *src, int pos, int rows, int columns)
+{
+	uint64_t row[rows];
+	int r, c;
+	uint64_t value;
+
+	if (columns > 64) {
+		fprintf(stderr, "Interleaver with %d columns exceeds 64 bits, please fix!\n", columns);
+		abort();
+	}
+
+	for (r = 0; r < rows; r++)
+		row[r] = bitbuf_extract(src, pos + r * columns, columns);
+	for (c = columns - 1; c >= 0; c--) {
+		for (r = 0, value = 0; r < rows; r++)
+			value = (value << 1) | ((row[r] >> c) & 1);
+		bitbuf_append(buf, value, rows);
+	}
+}
+
+/* return the number of bits at given position that match the lower 'num' bits of 'pattern' */
+int bitbuf_correlate(const bitbuf_t *buf, int pos, uint64_t pattern, int num)
+{
+	uint64_t diff;
+
+	diff = bitbuf_extract(buf, pos, num) ^ pattern;
+	if (num < 64)
+		diff &= (1ULL << num) - 1;
+
+	return num - __builtin_popcountll(diff);
+}
+
+/* reverse the order of the lower 'num' bits */
+uint64_t bitbuf_reverse(uint64_t value, int num)
+{
+	uint64_t result = 0;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		result = (result << 1) | (value & 1);
+		value >>= 1;
+	}
+
+	return result;
+}
+
+/* write 'num' bits at given position as '0' and '1' characters, for debugging
+ * the string must have space for 'num' + 1 characters */
+const char *bitbuf_string(const bitbuf_t *buf, int pos, int num, char *string)
+{
+	int i;
+
+	for (i = 0; i < num; i++)
+		string[i] = '0' + bitbuf_bit(buf, pos + i);
+	string[i] = '\0';
+
+	return string;
+}
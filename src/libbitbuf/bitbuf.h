@@ -0,0 +1,33 @@
+#ifndef _LIB_BITBUF_H
+#define _LIB_BITBUF_H
+
+#include <stdint.h>
+
+#define BITBUF_MAX	2048	/* maximum number of bits in a buffer */
+
+/* bits are stored MSB first, first bit is the MSB of the first word */
+typedef struct bitbuf {
+	uint64_t	word[BITBUF_MAX / 64];	/* packed bits */
+	int		length;			/* number of bits in buffer */
+} bitbuf_t;
+
+void bitbuf_clear(bitbuf_t *buf);
+void bitbuf_set(bitbuf_t *buf, int pos, uint64_t value, int num);
+void bitbuf_append(bitbuf_t *buf, uint64_t value, int num);
+void bitbuf_append_buf(bitbuf_t *buf, const bitbuf_t *src, int pos, int num);
+void bitbuf_append_bytes(bitbuf_t *buf, const uint8_t *bytes, int num);
+uint64_t bitbuf_extract(const bitbuf_t *buf, int pos, int num);
+void bitbuf_extract_bytes(const bitbuf_t *buf, int pos, int num, uint8_t *bytes);
+void bitbuf_invert(bitbuf_t *buf);
+void bitbuf_interleave(bitbuf_t *buf, const bitbuf_t *src, int pos, int rows, int columns);
+int bitbuf_correlate(const bitbuf_t *buf, int pos, uint64_t pattern, int num);
+uint64_t bitbuf_reverse(uint64_t value, int num);
+const char *bitbuf_string(const bitbuf_t *buf, int pos, int num, char *string);
+
+/* get a single bit */
+static inline int bitbuf_bit(const bitbuf_t *buf, int pos)
+{
+	return (buf->word[pos >> 6] >> (63 - (pos & 63))) & 1;
+}
+
+#endif /* _LIB_BITBUF_H */
@@ -0,0 +1,371 @@
+/* Polyphase FFT channelizer and combiner
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * The wideband IQ signal is split into 'bins' equally spaced frequency bins.
+ * Each bin is shifted down to 0 Hz, low-pass filtered by a prototype filter
+ * and decimated. Instead of doing this for each bin, the filter is split into
+ * polyphase branches and the shifting is done by one FFT for all bins.
+ *
+ * We advance the input by half of the FFT size for each output sample, so
+ * the bins overlap and each bin has twice the sample rate of its spacing.
+ * This way a channel that does not sit in the center of a bin is still inside
+ * the pass band of its bin. The remaining offset to the center of the bin is
+ * shifted by the demodulator at the (low) sample rate of the bin.
+ *
+ * Because the input advances by half of the FFT size, the phase of each odd
+ * bin must be inverted at every second output.
+ *
+ * The combiner does the same in reverse order: The (low rate) IQ samples of
+ * all channels are put into their bins and shifted to their frequencies by
+ * one inverse FFT. The result is weighted by the prototype filter and added
+ * to the overlapping output of the previous FFTs. Each FFT generates half of
+ * the FFT size of output samples.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "../libfft/fft.h"
+#include "channelizer.h"
+
+#define MAX_M		16	/* more than 65536 bins is nonsense */
+
+/* generate prototype low-pass (windowed sinc, Blackman window) */
+static void prototype(double *taps, int ntaps, double cutoff)
+{
+	double t, sum;
+	int i;
+
+	for (i = 0; i < ntaps; i++) {
+		t = (double)i - (double)(ntaps - 1) / 2.0;
+		if (t == 0.0)
+			taps[i] = 2.0 * cutoff;
+		else
+			taps[i] = sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+		taps[i] *= 0.42 - 0.50 * cos(2.0 * M_PI * (double)i / (double)(ntaps - 1))
+				+ 0.08 * cos(4.0 * M_PI * (double)i / (double)(ntaps - 1));
+	}
+
+	/* normalize to unity gain at 0 Hz */
+	sum = 0.0;
+	for (i = 0; i < ntaps; i++)
+		sum += taps[i];
+	for (i = 0; i < ntaps; i++)
+		taps[i] /= sum;
+}
+
+/* get number of bins and filter length for given bandwidth of each channel (both sidebands) */
+static int design(double samplerate, double bandwidth, int *bins_p, int *m_p, int *taps_per_bin_p)
+{
+	double transition;
+	int bins, m, taps_per_bin;
+
+	/* use as many bins as possible, so that each bin is twice the channel's bandwidth */
+	for (m = 1, bins = 2; m < MAX_M; m++, bins <<= 1) {
+		if ((double)(bins * 2) * bandwidth * 2.0 > samplerate)
+			break;
+	}
+	if (bins < 4) {
+		fprintf(stderr, "Bandwidth of %.0f Hz is too wide to use channelizer at sample rate of %.0f Hz!\n", bandwidth, samplerate);
+		return -EINVAL;
+	}
+
+	/* The filter passes the bandwidth of a channel plus the largest offset
+	 * to the center of a bin. It must stop at the frequency where aliasing
+	 * would fall into that pass band of the next output. The cutoff is at
+	 * the center of this transition band, which is the spacing of the bins. */
+	transition = samplerate / (double)bins - bandwidth;
+	taps_per_bin = ceil(5.5 * samplerate / transition / (double)bins);
+	if (taps_per_bin < 2)
+		taps_per_bin = 2;
+
+	*bins_p = bins;
+	*m_p = m;
+	*taps_per_bin_p = taps_per_bin;
+
+	return 0;
+}
+
+/* get bin for given frequency offset and the remaining offset to the center of the bin */
+static int get_bin(double samplerate, int bins, double offset, double *residual)
+{
+	double spacing = samplerate / (double)bins;
+	int bin;
+
+	bin = lround(offset / spacing);
+	if (residual)
+		*residual = offset - (double)bin * spacing;
+	if (bin < 0)
+		bin += bins;
+
+	return bin;
+}
+
+/* init channelizer, bandwidth is the bandwidth of each channel (both sidebands) */
+int channelizer_init(channelizer_t *chan, double samplerate, double bandwidth)
+{
+	int rc;
+
+	memset(chan, 0, sizeof(*chan));
+
+	rc = design(samplerate, bandwidth, &chan->bins, &chan->m, &chan->taps_per_bin);
+	if (rc < 0)
+		return rc;
+	chan->samplerate = samplerate;
+	chan->decimation = chan->bins / 2;
+	chan->ntaps = chan->taps_per_bin * chan->bins;
+
+	chan->taps = calloc(chan->ntaps, sizeof(*chan->taps));
+	chan->history = calloc(chan->ntaps * 2 * 2, sizeof(*chan->history));
+	chan->fft_x = calloc(chan->bins * 2, sizeof(*chan->fft_x));
+	if (!chan->taps || !chan->history || !chan->fft_x) {
+		fprintf(stderr, "No mem!\n");
+		channelizer_exit(chan);
+		return -ENOMEM;
+	}
+	chan->fft_y = chan->fft_x + chan->bins;
+	chan->fft = fft_plan_get(chan->m, -1);
+
+	prototype(chan->taps, chan->ntaps, 1.0 / (double)chan->bins);
+
+	/* first output is generated with the first sample */
+	chan->fill = chan->decimation - 1;
+
+	return 0;
+}
+
+void channelizer_exit(channelizer_t *chan)
+{
+	free(chan->taps);
+	chan->taps = NULL;
+	free(chan->history);
+	chan->history = NULL;
+	free(chan->fft_x);
+	chan->fft_x = chan->fft_y = NULL;
+}
+
+/* get bin for given frequency offset and the remaining offset to the center of the bin */
+int channelizer_bin(channelizer_t *chan, double offset, double *residual)
+{
+	return get_bin(chan->samplerate, chan->bins, offset, residual);
+}
+
+/* sample rate of each bin */
+double channelizer_samplerate(channelizer_t *chan)
+{
+	return chan->samplerate / (double)chan->decimation;
+}
+
+/* number of samples that will be generated for given number of input samples */
+int channelizer_output_num(channelizer_t *chan, int input_num)
+{
+	return (chan->fill + input_num) / chan->decimation;
+}
+
+/* split baseband into bins and store the IQ samples of the given bins to output
+ * returns the number of output samples for each bin */
+int channelizer_process(channelizer_t *chan, float *baseband, int length, int *bin, float **output, int num)
+{
+	int bins = chan->bins, ntaps = chan->ntaps, decimation = chan->decimation;
+	double *taps = chan->taps, *fft_x = chan->fft_x, *fft_y = chan->fft_y;
+	float *history = chan->history, *w;
+	int pos = chan->history_pos, fill = chan->fill;
+	double x, y;
+	int s, m, p, c, k, count = 0;
+
+	for (s = 0; s < length; s++) {
+		/* store sample in front of history, so history is in reverse order */
+		if (--pos < 0)
+			pos = ntaps - 1;
+		history[pos * 2] = history[(pos + ntaps) * 2] = *baseband++;
+		history[pos * 2 + 1] = history[(pos + ntaps) * 2 + 1] = *baseband++;
+		if (++fill < decimation)
+			continue;
+		fill = 0;
+
+		/* weight history by filter and sum up all branches of each bin */
+		w = history + pos * 2;
+		for (m = 0; m < bins; m++) {
+			x = y = 0.0;
+			for (p = m; p < ntaps; p += bins) {
+				x += taps[p] * w[p * 2];
+				y += taps[p] * w[p * 2 + 1];
+			}
+			fft_x[m] = x;
+			fft_y[m] = y;
+		}
+
+		/* shift all bins down to 0 Hz */
+		fft_execute_split(chan->fft, fft_x, fft_y);
+
+		for (c = 0; c < num; c++) {
+			k = bin[c];
+			if (chan->odd && (k & 1)) {
+				output[c][count * 2] = -fft_x[k];
+				output[c][count * 2 + 1] = -fft_y[k];
+			} else {
+				output[c][count * 2] = fft_x[k];
+				output[c][count * 2 + 1] = fft_y[k];
+			}
+		}
+		chan->odd = !chan->odd;
+		count++;
+	}
+
+	chan->history_pos = pos;
+	chan->fill = fill;
+
+	return count;
+}
+
+/* init combiner, bandwidth is the bandwidth of each channel (both sidebands)
+ * buffer_size is the maximum number of samples to be combined at once */
+int combiner_init(combiner_t *comb, double samplerate, double bandwidth, int buffer_size)
+{
+	int i, rc;
+
+	memset(comb, 0, sizeof(*comb));
+
+	rc = design(samplerate, bandwidth, &comb->bins, &comb->m, &comb->taps_per_bin);
+	if (rc < 0)
+		return rc;
+	comb->samplerate = samplerate;
+	comb->interpolation = comb->bins / 2;
+	comb->ntaps = comb->taps_per_bin * comb->bins;
+
+	comb->taps = calloc(comb->ntaps, sizeof(*comb->taps));
+	comb->accu = calloc(comb->ntaps * 2, sizeof(*comb->accu));
+	comb->fifo_size = buffer_size + comb->interpolation;
+	comb->fifo = calloc(comb->fifo_size * 2, sizeof(*comb->fifo));
+	comb->fft_x = calloc(comb->bins * 2, sizeof(*comb->fft_x));
+	if (!comb->taps || !comb->accu || !comb->fifo || !comb->fft_x) {
+		fprintf(stderr, "No mem!\n");
+		combiner_exit(comb);
+		return -ENOMEM;
+	}
+	comb->fft_y = comb->fft_x + comb->bins;
+	comb->fft = fft_plan_get(comb->m, -1);
+
+	/* interpolation filter requires a gain of the interpolation factor */
+	prototype(comb->taps, comb->ntaps, 1.0 / (double)comb->bins);
+	for (i = 0; i < comb->ntaps; i++)
+		comb->taps[i] *= (double)comb->interpolation;
+
+	return 0;
+}
+
+void combiner_exit(combiner_t *comb)
+{
+	free(comb->taps);
+	comb->taps = NULL;
+	free(comb->accu);
+	comb->accu = NULL;
+	free(comb->fifo);
+	comb->fifo = NULL;
+	free(comb->fft_x);
+	comb->fft_x = comb->fft_y = NULL;
+}
+
+int combiner_bin(combiner_t *comb, double offset, double *residual)
+{
+	return get_bin(comb->samplerate, comb->bins, offset, residual);
+}
+
+/* sample rate of each bin */
+double combiner_samplerate(combiner_t *comb)
+{
+	return comb->samplerate / (double)comb->interpolation;
+}
+
+/* number of input samples that are required to get given number of output samples */
+int combiner_input_num(combiner_t *comb, int output_num)
+{
+	if (output_num <= comb->fifo_fill)
+		return 0;
+	return (output_num - comb->fifo_fill + comb->interpolation - 1) / comb->interpolation;
+}
+
+/* combine IQ samples of all channels (at given bins) into baseband
+ * input_num must be the value returned by combiner_input_num() */
+void combiner_process(combiner_t *comb, float **input, int *bin, int num, int input_num, float *baseband, int length)
+{
+	int bins = comb->bins, ntaps = comb->ntaps, interpolation = comb->interpolation;
+	double *taps = comb->taps, *fft_x = comb->fft_x, *fft_y = comb->fft_y;
+	double *accu = comb->accu;
+	int pos = comb->accu_pos;
+	float *fifo;
+	int size;
+	int s, l, c, k;
+
+	/* make sure that fifo can hold all samples and that we get enough samples */
+	size = comb->fifo_fill + input_num * interpolation;
+	if (size > comb->fifo_size || size < length) {
+		fprintf(stderr, "Wrong number of input samples for combiner, please fix!\n");
+		abort();
+	}
+	fifo = comb->fifo + comb->fifo_fill * 2;
+
+	for (s = 0; s < input_num; s++) {
+		/* put samples into their bins */
+		memset(fft_x, 0, sizeof(*fft_x) * bins * 2);
+		for (c = 0; c < num; c++) {
+			k = bin[c];
+			if (comb->odd && (k & 1)) {
+				fft_x[k] -= input[c][s * 2];
+				fft_y[k] -= input[c][s * 2 + 1];
+			} else {
+				fft_x[k] += input[c][s * 2];
+				fft_y[k] += input[c][s * 2 + 1];
+			}
+		}
+		comb->odd = !comb->odd;
+
+		/* shift all bins up to their frequencies */
+		fft_execute_split(comb->fft, fft_x, fft_y);
+
+		/* weight by filter and add to ring buffer, the FFT output repeats every 'bins' samples */
+		for (l = 0; l < ntaps; l++) {
+			accu[pos * 2] += taps[l] * fft_x[l & (bins - 1)];
+			accu[pos * 2 + 1] += taps[l] * fft_y[l & (bins - 1)];
+			if (++pos == ntaps)
+				pos = 0;
+		}
+
+		/* samples are complete now, because next FFT is added behind them */
+		for (l = 0; l < interpolation; l++) {
+			*fifo++ = accu[pos * 2];
+			*fifo++ = accu[pos * 2 + 1];
+			accu[pos * 2] = 0.0;
+			accu[pos * 2 + 1] = 0.0;
+			if (++pos == ntaps)
+				pos = 0;
+		}
+	}
+	comb->accu_pos = pos;
+
+	/* take output from fifo */
+	memcpy(baseband, comb->fifo, length * 2 * sizeof(*baseband));
+	comb->fifo_fill = size - length;
+	memmove(comb->fifo, comb->fifo + length * 2, comb->fifo_fill * 2 * sizeof(*comb->fifo));
+}
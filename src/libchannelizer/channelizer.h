@@ -0,0 +1,80 @@
+#ifndef _LIB_CHANNELIZER_H
+#define _LIB_CHANNELIZER_H
+
+typedef struct channelizer {
+	double	samplerate;	/* sample rate of wideband input */
+	int	bins;		/* number of filter bank bins (size of FFT) */
+	int	m;		/* bins = 2^m */
+	int	decimation;	/* input samples per output sample (bins / 2) */
+	int	taps_per_bin;	/* length of each polyphase branch */
+	int	ntaps;		/* length of prototype filter (bins * taps_per_bin) */
+	double	*taps;		/* prototype low-pass filter */
+	float	*history;	/* IQ history, stored twice, so it can be read without wrap */
+	int	history_pos;	/* position of most recent sample in history */
+	int	fill;		/* samples received since last output */
+	int	odd;		/* set for every second output (phase correction) */
+	double	*fft_x, *fft_y;	/* FFT buffers */
+	const struct fft_plan *fft; /* FFT plan */
+} channelizer_t;
+
+int channelizer_init(channelizer_t *chan, double samplerate, double bandwidth);
+void channelizer_exit(channelizer_t *chan);
+int channelizer_bin(channelizer_t *chan, double offset, double *residual);
+double channelizer_samplerate(channelizer_t *chan);
+int channelizer_output_num(channelizer_t *chan, int input_num);
+int channelizer_process(channelizer_t *chan, float *baseband, int length, int *bin, float **output, int num);
+
+typedef struct combiner {
+	double	samplerate;	/* sample rate of wideband output */
+	int	bins;		/* number of filter bank bins (size of FFT) */
+	int	m;		/* bins = 2^m */
+	int	interpolation;	/* output samples per input sample (bins / 2) */
+	int	taps_per_bin;	/* length of each polyphase branch */
+	int	ntaps;		/* length of prototype filter (bins * taps_per_bin) */
+	double	*taps;		/* prototype low-pass filter */
+	double	*accu;		/* IQ ring buffer to overlap and add the output of each FFT */
+	int	accu_pos;	/* position of next output sample in ring buffer */
+	float	*fifo;		/* IQ output samples, that have not been taken yet */
+	int	fifo_size;	/* maximum number of samples in fifo */
+	int	fifo_fill;	/* number of samples in fifo */
+	int	odd;		/* set for every second input (phase correction) */
+	double	*fft_x, *fft_y;	/* FFT buffers */
+	const struct fft_plan *fft; /* FFT plan */
+} combiner_t;
+
+int combiner_init(combiner_t *comb, double samplerate, double bandwidth, int buffer_size);
+void combiner_exit(combiner_t *comb);
+int combiner_bin(combiner_t *comb, double offset, double *residual);
+double combiner_samplerate(combiner_t *comb);
+int combiner_input_num(combiner_t *comb, int output_num);
+void combiner_process(combiner_t *comb, float **input, int *bin, int num, int input_num, float *baseband, int length);
+
+#define DECIMATOR_MAX_STAGES	16
+
+typedef struct decimator_stage {
+	int	n;		/* number of coefficients at each side of the center */
+	int	taps;		/* length of half-band filter (4 * n - 1) */
+	float	*coeff;		/* coefficients at odd distances from center */
+	float	*buf_i, *buf_q;	/* history of 'taps - 1' samples, followed by input samples */
+	int	phase;		/* position of next output sample behind history (0 or 1) */
+} decimator_stage_t;
+
+typedef struct decimator {
+	double	samplerate;	/* sample rate of wideband input */
+	int	decimation;	/* input samples per output sample (2 ^ stages) */
+	int	stages;		/* number of half-band stages */
+	decimator_stage_t stage[DECIMATOR_MAX_STAGES];
+	float	*out_i, *out_q;	/* output of last stage */
+	uint32_t phase;		/* phase of oscillator to shift channel to 0 Hz */
+	uint32_t step;		/* phase increment of oscillator per sample */
+	double	rot_i[5], rot_q[5]; /* rotation by 0..4 samples */
+	int	max_length;	/* maximum number of input samples to process */
+} decimator_t;
+
+int decimator_init(decimator_t *dec, double samplerate, double offset, double bandwidth, int max_length, int stages);
+void decimator_exit(decimator_t *dec);
+double decimator_samplerate(decimator_t *dec);
+int decimator_output_num(decimator_t *dec, int input_num);
+int decimator_process(decimator_t *dec, float *baseband, int length, float *output);
+
+#endif /* _LIB_CHANNELIZER_H */
@@ -0,0 +1,352 @@
+/* Half-band decimator to receive a single channel
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * The wideband IQ signal is shifted, so that the channel is at 0 Hz. Then
+ * it is decimated by a cascade of half-band filters. Each stage halves the
+ * sample rate, until the sample rate is between two and four times the
+ * bandwidth of the channel. The demodulator runs at this low sample rate.
+ * The number of stages can also be given, so that the output has exactly the
+ * sample rate that is required.
+ *
+ * Every second coefficient of a half-band filter is zero, except the center
+ * coefficient, which is 0.5. Because the filter is symmetric, only one
+ * multiplication is required for every two non-zero coefficients. Also
+ * only every second output sample is calculated.
+ *
+ * The IQ samples are stored as separate I and Q buffers, so that four output
+ * samples can be calculated at once by vector operations.
+ *
+ * A stage must only attenuate the frequencies that alias into the pass band
+ * when its output is decimated. These are the frequencies within half of the
+ * channel's bandwidth around half of the input sample rate. All other
+ * frequencies are removed by later stages or by the filter of the
+ * demodulator. At the first stages, where the channel is narrow compared to
+ * the sample rate, a filter with three coefficients is sufficient. The length
+ * of each filter is increased until it attenuates the aliasing band enough.
+ *
+ * Four phasors rotate in parallel to shift the channel. The oscillator phase
+ * is restored at the start of each block, so rounding errors of the rotating
+ * phasors do not add up.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "channelizer.h"
+
+typedef int32_t v4si __attribute__ ((vector_size (16)));
+typedef float v4sf __attribute__ ((vector_size (16)));
+
+#define MAX_N		64	/* half-band filter of 255 taps */
+#define ATTENUATION	80.0	/* attenuation of the band that aliases into the pass band */
+#define MIX_BLOCK	256	/* samples to mix before the oscillator phase is restored */
+
+/* generate half-band coefficients at odd distances from center (windowed sinc, Blackman window) */
+static void halfband(float *coeff, int n)
+{
+	double t, h, sum, len = 4 * n;
+	int k;
+
+	sum = 0.0;
+	for (k = 0; k < n; k++) {
+		t = 2 * k + 1;
+		h = sin(M_PI * t / 2.0) / (M_PI * t);
+		h *= 0.42 + 0.50 * cos(2.0 * M_PI * t / len) + 0.08 * cos(4.0 * M_PI * t / len);
+		coeff[k] = h;
+		sum += h;
+	}
+
+	/* normalize to unity gain at 0 Hz: the center is 0.5, so each side is 0.25 */
+	for (k = 0; k < n; k++)
+		coeff[k] *= 0.25 / sum;
+}
+
+/* get highest response of half-band filter within the band that aliases into the pass band */
+static double alias_response(float *coeff, int n, double samplerate, double bandwidth)
+{
+	double f, h, max = 0.0;
+	int i, k;
+
+	for (i = 0; i <= 32; i++) {
+		f = samplerate / 2.0 - bandwidth / 2.0 * (double)i / 32.0;
+		h = 0.5;
+		for (k = 0; k < n; k++)
+			h += 2.0 * coeff[k] * cos(2.0 * M_PI * f * (double)(2 * k + 1) / samplerate);
+		if (fabs(h) > max)
+			max = fabs(h);
+	}
+
+	return max;
+}
+
+/* create shortest filter for the given input sample rate of the stage */
+static int stage_init(decimator_stage_t *st, double samplerate, double bandwidth, int max_length)
+{
+	double limit = pow(10.0, -ATTENUATION / 20.0);
+
+	st->coeff = calloc(MAX_N, sizeof(*st->coeff));
+	if (!st->coeff)
+		return -ENOMEM;
+	for (st->n = 1; st->n < MAX_N; st->n++) {
+		halfband(st->coeff, st->n);
+		if (alias_response(st->coeff, st->n, samplerate, bandwidth) < limit)
+			break;
+	}
+	st->taps = 4 * st->n - 1;
+
+	/* vectors may read and write beyond the input samples */
+	st->buf_i = calloc(st->taps - 1 + max_length + 8, sizeof(*st->buf_i));
+	st->buf_q = calloc(st->taps - 1 + max_length + 8, sizeof(*st->buf_q));
+	if (!st->buf_i || !st->buf_q)
+		return -ENOMEM;
+
+	return 0;
+}
+
+/* init decimator, bandwidth is the bandwidth of the channel (both sidebands)
+ * stages is the number of half-band stages, use 0 to select them by bandwidth */
+int decimator_init(decimator_t *dec, double samplerate, double offset, double bandwidth, int max_length, int stages)
+{
+	double rate, angle;
+	int s, k, rc;
+
+	memset(dec, 0, sizeof(*dec));
+
+	if (stages > DECIMATOR_MAX_STAGES) {
+		fprintf(stderr, "Decimation by %d half-band stages exceeds maximum of %d stages!\n", stages, DECIMATOR_MAX_STAGES);
+		return -EINVAL;
+	}
+	if (stages)
+		dec->stages = stages;
+	else {
+		/* halve the sample rate, as long as it stays at least twice the bandwidth */
+		for (rate = samplerate; dec->stages < DECIMATOR_MAX_STAGES; dec->stages++) {
+			if (rate / 2.0 < bandwidth * 2.0)
+				break;
+			rate /= 2.0;
+		}
+	}
+	if (dec->stages < 1) {
+		fprintf(stderr, "Bandwidth of %.0f Hz is too wide to use decimator at sample rate of %.0f Hz!\n", bandwidth, samplerate);
+		return -EINVAL;
+	}
+	dec->samplerate = samplerate;
+	dec->decimation = 1 << dec->stages;
+	dec->max_length = max_length;
+
+	for (s = 0, rate = samplerate; s < dec->stages; s++, rate /= 2.0) {
+		rc = stage_init(&dec->stage[s], rate, bandwidth, max_length);
+		if (rc < 0) {
+			fprintf(stderr, "No mem!\n");
+			decimator_exit(dec);
+			return rc;
+		}
+		max_length = (max_length + 1) / 2;
+	}
+	dec->out_i = calloc(max_length, sizeof(*dec->out_i));
+	dec->out_q = calloc(max_length, sizeof(*dec->out_q));
+	if (!dec->out_i || !dec->out_q) {
+		fprintf(stderr, "No mem!\n");
+		decimator_exit(dec);
+		return -ENOMEM;
+	}
+
+	/* oscillator turns backwards to shift the channel down to 0 Hz */
+	dec->step = (uint32_t)(int32_t)llround(-offset / samplerate * 4294967296.0);
+	angle = 2.0 * M_PI * (double)(int32_t)dec->step / 4294967296.0;
+	for (k = 0; k <= 4; k++) {
+		dec->rot_i[k] = cos(angle * (double)k);
+		dec->rot_q[k] = sin(angle * (double)k);
+	}
+
+	return 0;
+}
+
+void decimator_exit(decimator_t *dec)
+{
+	int s;
+
+	for (s = 0; s < DECIMATOR_MAX_STAGES; s++) {
+		free(dec->stage[s].coeff);
+		dec->stage[s].coeff = NULL;
+		free(dec->stage[s].buf_i);
+		dec->stage[s].buf_i = NULL;
+		free(dec->stage[s].buf_q);
+		dec->stage[s].buf_q = NULL;
+	}
+	free(dec->out_i);
+	dec->out_i = NULL;
+	free(dec->out_q);
+	dec->out_q = NULL;
+}
+
+/* sample rate of the channel */
+double decimator_samplerate(decimator_t *dec)
+{
+	return dec->samplerate / (double)dec->decimation;
+}
+
+/* number of samples that will be generated for given number of input samples */
+int decimator_output_num(decimator_t *dec, int input_num)
+{
+	int s;
+
+	for (s = 0; s < dec->stages; s++)
+		input_num = (input_num + 1 - dec->stage[s].phase) / 2;
+
+	return input_num;
+}
+
+/* deinterleave and shift channel to 0 Hz, four samples at once */
+static void mix(decimator_t *dec, float *baseband, int length, float *I, float *Q)
+{
+	float rot_i = dec->rot_i[4], rot_q = dec->rot_q[4];
+	v4sf lo, hi, i, q, p_i, p_q, t;
+	float tail[8];
+	double c, s;
+	int n, b, k;
+
+	while (length) {
+		n = (length > MIX_BLOCK) ? MIX_BLOCK : length;
+		c = cos(2.0 * M_PI * (double)dec->phase / 4294967296.0);
+		s = sin(2.0 * M_PI * (double)dec->phase / 4294967296.0);
+		for (k = 0; k < 4; k++) {
+			p_i[k] = c * dec->rot_i[k] - s * dec->rot_q[k];
+			p_q[k] = c * dec->rot_q[k] + s * dec->rot_i[k];
+		}
+		for (b = 0; b < n; b += 4) {
+			if (n - b < 4) {
+				/* the last chunk: do not read beyond the baseband */
+				memset(tail, 0, sizeof(tail));
+				memcpy(tail, baseband + b * 2, (n - b) * 2 * sizeof(*tail));
+				memcpy(&lo, tail, sizeof(lo));
+				memcpy(&hi, tail + 4, sizeof(hi));
+			} else {
+				memcpy(&lo, baseband + b * 2, sizeof(lo));
+				memcpy(&hi, baseband + b * 2 + 4, sizeof(hi));
+			}
+			i = __builtin_shuffle(lo, hi, (v4si){ 0, 2, 4, 6 });
+			q = __builtin_shuffle(lo, hi, (v4si){ 1, 3, 5, 7 });
+			t = i * p_i - q * p_q;
+			q = i * p_q + q * p_i;
+			memcpy(I + b, &t, sizeof(t));
+			memcpy(Q + b, &q, sizeof(q));
+			t = p_i * rot_i - p_q * rot_q;
+			p_q = p_i * rot_q + p_q * rot_i;
+			p_i = t;
+		}
+		dec->phase += dec->step * (uint32_t)n;
+		baseband += n * 2;
+		I += n;
+		Q += n;
+		length -= n;
+	}
+}
+
+/* load every second sample */
+static inline v4sf load_even(const float *x)
+{
+	v4sf lo, hi;
+
+	memcpy(&lo, x, sizeof(lo));
+	memcpy(&hi, x + 4, sizeof(hi));
+	return __builtin_shuffle(lo, hi, (v4si){ 0, 2, 4, 6 });
+}
+
+/* filter samples x, starting with the history, and calculate every second output sample, four at once */
+static int filter(const float *coeff, int n, const float *x, int phase, int length, float *y)
+{
+	int center = 2 * n - 1, j, k, count = 0;
+	const float *w;
+	v4sf sum;
+	float s;
+
+	for (j = phase; j + 6 < length; j += 8) {
+		w = x + j + center;
+		sum = load_even(w) * 0.5f;
+		for (k = 0; k < n; k++)
+			sum += (load_even(w - 2 * k - 1) + load_even(w + 2 * k + 1)) * coeff[k];
+		memcpy(y + count, &sum, sizeof(sum));
+		count += 4;
+	}
+	for (; j < length; j += 2) {
+		w = x + j + center;
+		s = 0.5f * w[0];
+		for (k = 0; k < n; k++)
+			s += (w[-2 * k - 1] + w[2 * k + 1]) * coeff[k];
+		y[count++] = s;
+	}
+
+	return count;
+}
+
+/* filter input samples that are stored behind the history and take every second sample */
+static int stage_process(decimator_stage_t *st, int length, float *out_i, float *out_q)
+{
+	int history = st->taps - 1, count;
+
+	count = filter(st->coeff, st->n, st->buf_i, st->phase, length, out_i);
+	filter(st->coeff, st->n, st->buf_q, st->phase, length, out_q);
+	st->phase += count * 2 - length;
+
+	/* keep history for next call */
+	memmove(st->buf_i, st->buf_i + length, history * sizeof(*st->buf_i));
+	memmove(st->buf_q, st->buf_q + length, history * sizeof(*st->buf_q));
+
+	return count;
+}
+
+/* shift channel to 0 Hz and decimate
+ * returns the number of output samples */
+int decimator_process(decimator_t *dec, float *baseband, int length, float *output)
+{
+	decimator_stage_t *st = dec->stage;
+	float *out_i, *out_q;
+	int s, i;
+
+	if (length > dec->max_length) {
+		fprintf(stderr, "exceeding maximum length given by decimator_init(), please fix!\n");
+		abort();
+	}
+
+	/* each stage writes its output behind the history of the next stage */
+	mix(dec, baseband, length, st[0].buf_i + st[0].taps - 1, st[0].buf_q + st[0].taps - 1);
+	for (s = 0; s < dec->stages; s++) {
+		if (s + 1 < dec->stages) {
+			out_i = st[s + 1].buf_i + st[s + 1].taps - 1;
+			out_q = st[s + 1].buf_q + st[s + 1].taps - 1;
+		} else {
+			out_i = dec->out_i;
+			out_q = dec->out_q;
+		}
+		length = stage_process(&st[s], length, out_i, out_q);
+	}
+
+	for (i = 0; i < length; i++) {
+		*output++ = dec->out_i[i];
+		*output++ = dec->out_q[i];
+	}
+
+	return length;
+}
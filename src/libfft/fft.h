@@ -1,3 +1,30 @@
+#ifndef _FFT_H
+#define _FFT_H
+
+#define FFT_MAX_M	24
+
+typedef struct fft_plan {
+	int	m;		/* number of points of complex transformation = 2^m */
+	int	n;
+	int	dir;		/* 1 = forward (scaled by 1/n), -1 = reverse */
+	int	real;		/* set for real transformation of 2*n samples */
+	int	*bitrev;	/* bit reversal table */
+	double	*twiddle;	/* twiddle factors w^k (interleaved complex) */
+	float	*twiddle_float;
+	double	*real_twiddle;	/* twiddle factors to separate real transformation */
+	float	*real_twiddle_float;
+} fft_plan_t;
+
+fft_plan_t *fft_plan_init(int m, int dir);
+fft_plan_t *fft_plan_real_init(int m, int dir);
+void fft_plan_exit(fft_plan_t *plan);
+const fft_plan_t *fft_plan_get(int m, int dir);
+void fft_execute_split(const fft_plan_t *plan, double *x, double *y);
+void fft_execute(const fft_plan_t *plan, double *data);
+void fft_execute_float(const fft_plan_t *plan, float *data);
+void fft_execute_real(const fft_plan_t *plan, const double *in, double *out);
+void fft_execute_real_float(const fft_plan_t *plan, const float *in, float *out);
 
 void fft_process(int dir, int m, double *x, double *y);
 
+#endif /* _FFT_H */
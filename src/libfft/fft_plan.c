@@ -0,0 +1,396 @@
+/* Fast Fourier Transformation (FFT) with precomputed plans
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * A plan holds the bit reversal table and the twiddle factors for one size
+ * and direction, so they are calculated only once.
+ *
+ * The transformation is done in place: First the samples are reordered by
+ * bit reversal. (The forward transformation is scaled by 1/n at the same
+ * time.) If m is odd, one radix-2 stage is done. Then radix-4 stages are
+ * done, each of them replaces two radix-2 stages and saves one of four
+ * complex multiplications.
+ *
+ * The same code is compiled for split arrays (like fft_process() uses) and
+ * for interleaved complex samples of double or float (like the baseband of
+ * libsdr).
+ *
+ * The real transformation of n = 2^m samples is done by a complex
+ * transformation of n/2 points, where even samples are used as real part and
+ * odd samples are used as imaginary part. The spectrum is separated
+ * afterwards. The forward transformation gives n/2+1 complex values (DC to
+ * half of the sample rate), the inverse transformation takes them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include "fft.h"
+
+static int plan_tables(fft_plan_t *plan, int m, int dir)
+{
+	int i, j, k, n;
+	double sign = (dir == 1) ? -1.0 : 1.0;
+
+	plan->m = m;
+	plan->n = n = 1 << m;
+	plan->dir = (dir == 1) ? 1 : -1;
+
+	plan->bitrev = calloc(n, sizeof(*plan->bitrev));
+	plan->twiddle = calloc(n * 2, sizeof(*plan->twiddle));
+	plan->twiddle_float = calloc(n * 2, sizeof(*plan->twiddle_float));
+	if (!plan->bitrev || !plan->twiddle || !plan->twiddle_float) {
+		fprintf(stderr, "No mem!\n");
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < n; i++) {
+		for (j = 0, k = 0; k < m; k++)
+			j |= ((i >> k) & 1) << (m - 1 - k);
+		plan->bitrev[i] = j;
+	}
+
+	for (i = 0; i < n; i++) {
+		plan->twiddle[i * 2] = cos(2.0 * M_PI * (double)i / (double)n);
+		plan->twiddle[i * 2 + 1] = sign * sin(2.0 * M_PI * (double)i / (double)n);
+		plan->twiddle_float[i * 2] = plan->twiddle[i * 2];
+		plan->twiddle_float[i * 2 + 1] = plan->twiddle[i * 2 + 1];
+	}
+
+	return 0;
+}
+
+/* create plan for a complex transformation of 2^m points
+ * dir =  1 gives forward transform (scaled by 1/n)
+ * dir = -1 gives reverse transform (not scaled)
+ */
+fft_plan_t *fft_plan_init(int m, int dir)
+{
+	fft_plan_t *plan;
+
+	plan = calloc(1, sizeof(*plan));
+	if (!plan) {
+		fprintf(stderr, "No mem!\n");
+		return NULL;
+	}
+	if (plan_tables(plan, m, dir) < 0) {
+		fft_plan_exit(plan);
+		return NULL;
+	}
+
+	return plan;
+}
+
+/* create plan for a real transformation of 2^m samples (m >= 1) */
+fft_plan_t *fft_plan_real_init(int m, int dir)
+{
+	fft_plan_t *plan;
+	int i, h;
+	double sign = (dir == 1) ? -1.0 : 1.0;
+
+	if (m < 1)
+		m = 1;
+
+	plan = calloc(1, sizeof(*plan));
+	if (!plan) {
+		fprintf(stderr, "No mem!\n");
+		return NULL;
+	}
+	/* complex transformation of half size */
+	if (plan_tables(plan, m - 1, dir) < 0) {
+		fft_plan_exit(plan);
+		return NULL;
+	}
+	plan->real = 1;
+
+	h = plan->n;
+	plan->real_twiddle = calloc((h + 1) * 2, sizeof(*plan->real_twiddle));
+	plan->real_twiddle_float = calloc((h + 1) * 2, sizeof(*plan->real_twiddle_float));
+	if (!plan->real_twiddle || !plan->real_twiddle_float) {
+		fprintf(stderr, "No mem!\n");
+		fft_plan_exit(plan);
+		return NULL;
+	}
+	for (i = 0; i <= h; i++) {
+		plan->real_twiddle[i * 2] = cos(M_PI * (double)i / (double)h);
+		plan->real_twiddle[i * 2 + 1] = sign * sin(M_PI * (double)i / (double)h);
+		plan->real_twiddle_float[i * 2] = plan->real_twiddle[i * 2];
+		plan->real_twiddle_float[i * 2 + 1] = plan->real_twiddle[i * 2 + 1];
+	}
+
+	return plan;
+}
+
+void fft_plan_exit(fft_plan_t *plan)
+{
+	if (!plan)
+		return;
+	free(plan->bitrev);
+	free(plan->twiddle);
+	free(plan->twiddle_float);
+	free(plan->real_twiddle);
+	free(plan->real_twiddle_float);
+	free(plan);
+}
+
+/*
+ * complex transformation
+ *
+ * 're' and 'im' point to the first real and imaginary value, 'S' is the
+ * distance between two complex values (1 for split arrays, 2 for interleaved)
+ */
+
+#define FFT_KERNEL(name, type, TWIDDLE, S) \
+static void name(const fft_plan_t *plan, type *re, type *im) \
+{ \
+	const type *tw = plan->TWIDDLE; \
+	const int *bitrev = plan->bitrev; \
+	int n = plan->n; \
+	type sign = (type)plan->dir; \
+	int i, j, l1, l2, step; \
+	type tr, ti, scale; \
+	type w1r, w1i, w2r, w2i, w3r, w3i; \
+	type ar, ai, br, bi, cr, ci, dr, di; \
+	\
+	/* bit reversal, scale forward transformation */ \
+	if (plan->dir == 1) { \
+		scale = (type)1.0 / (type)n; \
+		for (i = 0; i < n; i++) { \
+			j = bitrev[i]; \
+			if (i < j) { \
+				tr = re[i * S]; \
+				ti = im[i * S]; \
+				re[i * S] = re[j * S] * scale; \
+				im[i * S] = im[j * S] * scale; \
+				re[j * S] = tr * scale; \
+				im[j * S] = ti * scale; \
+			} else if (i == j) { \
+				re[i * S] *= scale; \
+				im[i * S] *= scale; \
+			} \
+		} \
+	} else { \
+		for (i = 0; i < n; i++) { \
+			j = bitrev[i]; \
+			if (i < j) { \
+				tr = re[i * S]; \
+				ti = im[i * S]; \
+				re[i * S] = re[j * S]; \
+				im[i * S] = im[j * S]; \
+				re[j * S] = tr; \
+				im[j * S] = ti; \
+			} \
+		} \
+	} \
+	\
+	/* radix-2 stage, if m is odd */ \
+	l1 = 1; \
+	if ((plan->m & 1)) { \
+		for (i = 0; i < n; i += 2) { \
+			tr = re[(i + 1) * S]; \
+			ti = im[(i + 1) * S]; \
+			re[(i + 1) * S] = re[i * S] - tr; \
+			im[(i + 1) * S] = im[i * S] - ti; \
+			re[i * S] += tr; \
+			im[i * S] += ti; \
+		} \
+		l1 = 2; \
+	} \
+	\
+	/* radix-4 stages: the four blocks of l1 values hold the transformations \
+	 * of samples with index 0, 2, 1 and 3 (modulo 4) */ \
+	for (; l1 < n; l1 = l2) { \
+		l2 = l1 * 4; \
+		step = n / l2; \
+		for (j = 0; j < l1; j++) { \
+			w1r = tw[j * step * 2]; \
+			w1i = tw[j * step * 2 + 1]; \
+			w2r = tw[j * step * 4]; \
+			w2i = tw[j * step * 4 + 1]; \
+			w3r = tw[j * step * 6]; \
+			w3i = tw[j * step * 6 + 1]; \
+			for (i = j; i < n; i += l2) { \
+				type *r0 = re + i * S, *i0 = im + i * S; \
+				type *r1 = r0 + l1 * S, *i1 = i0 + l1 * S; \
+				type *r2 = r1 + l1 * S, *i2 = i1 + l1 * S; \
+				type *r3 = r2 + l1 * S, *i3 = i2 + l1 * S; \
+				/* b = w^2 * x1, c = w * x2, d = w^3 * x3 */ \
+				br = *r1 * w2r - *i1 * w2i; \
+				bi = *r1 * w2i + *i1 * w2r; \
+				cr = *r2 * w1r - *i2 * w1i; \
+				ci = *r2 * w1i + *i2 * w1r; \
+				dr = *r3 * w3r - *i3 * w3i; \
+				di = *r3 * w3i + *i3 * w3r; \
+				/* a + b, a - b, c + d, (c - d) * -j (forward) or * j (reverse) */ \
+				ar = *r0 - br; \
+				ai = *i0 - bi; \
+				tr = *r0 + br; \
+				ti = *i0 + bi; \
+				br = cr + dr; \
+				bi = ci + di; \
+				cr -= dr; \
+				ci -= di; \
+				dr = ci * sign; \
+				di = -cr * sign; \
+				*r0 = tr + br; \
+				*i0 = ti + bi; \
+				*r2 = tr - br; \
+				*i2 = ti - bi; \
+				*r1 = ar + dr; \
+				*i1 = ai + di; \
+				*r3 = ar - dr; \
+				*i3 = ai - di; \
+			} \
+		} \
+	} \
+}
+
+FFT_KERNEL(kernel_split, double, twiddle, 1)
+FFT_KERNEL(kernel_double, double, twiddle, 2)
+FFT_KERNEL(kernel_float, float, twiddle_float, 2)
+
+/* transform split arrays of real and imaginary values */
+void fft_execute_split(const fft_plan_t *plan, double *x, double *y)
+{
+	kernel_split(plan, x, y);
+}
+
+/* transform interleaved complex values (real, imaginary, real, ...) */
+void fft_execute(const fft_plan_t *plan, double *data)
+{
+	kernel_double(plan, data, data + 1);
+}
+
+void fft_execute_float(const fft_plan_t *plan, float *data)
+{
+	kernel_float(plan, data, data + 1);
+}
+
+/*
+ * real transformation
+ *
+ * forward: 'in' holds n real samples, 'out' gets n/2+1 complex values
+ * reverse: 'in' holds n/2+1 complex values, 'out' gets n real samples
+ */
+
+#define FFT_REAL(name, type, TWIDDLE, KERNEL) \
+void name(const fft_plan_t *plan, const type *in, type *out) \
+{ \
+	const type *tw = plan->TWIDDLE; \
+	int h = plan->n; \
+	int k; \
+	type zr, zi, yr, yi, er, ei, odr, odi, tr, ti; \
+	\
+	if (plan->dir == 1) { \
+		/* transform even and odd samples as real and imaginary part */ \
+		if (out != in) \
+			memcpy(out, in, h * 2 * sizeof(*out)); \
+		KERNEL(plan, out, out + 1); \
+		/* separate spectrum of even and odd samples, combine them */ \
+		zr = out[0]; \
+		zi = out[1]; \
+		out[0] = (zr + zi) * (type)0.5; \
+		out[1] = 0; \
+		out[h * 2] = (zr - zi) * (type)0.5; \
+		out[h * 2 + 1] = 0; \
+		for (k = 1; k <= h / 2; k++) { \
+			zr = out[k * 2]; \
+			zi = out[k * 2 + 1]; \
+			yr = out[(h - k) * 2]; \
+			yi = out[(h - k) * 2 + 1]; \
+			/* even = (z[k] + conj(z[h-k])) / 2, odd = (z[k] - conj(z[h-k])) / 2j */ \
+			er = (zr + yr) * (type)0.5; \
+			ei = (zi - yi) * (type)0.5; \
+			odr = (zi + yi) * (type)0.5; \
+			odi = (yr - zr) * (type)0.5; \
+			/* x[k] = (even + w^k * odd) / 2 */ \
+			tr = odr * tw[k * 2] - odi * tw[k * 2 + 1]; \
+			ti = odr * tw[k * 2 + 1] + odi * tw[k * 2]; \
+			out[k * 2] = (er + tr) * (type)0.5; \
+			out[k * 2 + 1] = (ei + ti) * (type)0.5; \
+			/* x[h-k] = conj(even - w^k * odd) / 2 */ \
+			out[(h - k) * 2] = (er - tr) * (type)0.5; \
+			out[(h - k) * 2 + 1] = (ti - ei) * (type)0.5; \
+		} \
+	} else { \
+		/* combine spectrum of even and odd samples */ \
+		zr = in[0]; \
+		yr = in[h * 2]; \
+		out[0] = zr + yr; \
+		out[1] = zr - yr; \
+		for (k = 1; k <= h / 2; k++) { \
+			zr = in[k * 2]; \
+			zi = in[k * 2 + 1]; \
+			yr = in[(h - k) * 2]; \
+			yi = in[(h - k) * 2 + 1]; \
+			/* even = x[k] + conj(x[h-k]), odd = (x[k] - conj(x[h-k])) * w^k */ \
+			er = zr + yr; \
+			ei = zi - yi; \
+			tr = zr - yr; \
+			ti = zi + yi; \
+			odr = tr * tw[k * 2] - ti * tw[k * 2 + 1]; \
+			odi = tr * tw[k * 2 + 1] + ti * tw[k * 2]; \
+			/* z[k] = even + j * odd, z[h-k] = conj(even - j * odd) */ \
+			out[k * 2] = er - odi; \
+			out[k * 2 + 1] = ei + odr; \
+			out[(h - k) * 2] = er + odi; \
+			out[(h - k) * 2 + 1] = odr - ei; \
+		} \
+		KERNEL(plan, out, out + 1); \
+	} \
+}
+
+FFT_REAL(fft_execute_real, double, real_twiddle, kernel_double)
+FFT_REAL(fft_execute_real_float, float, real_twiddle_float, kernel_float)
+
+/*
+ * plan cache
+ *
+ * Plans are created when used the first time and are kept until the
+ * program exits. If two threads create the same plan at the same time, one
+ * of them is dropped.
+ */
+
+static fft_plan_t *plan_cache[2][FFT_MAX_M + 1];
+
+const fft_plan_t *fft_plan_get(int m, int dir)
+{
+	fft_plan_t **slot, *plan, *expected = NULL;
+
+	if (m < 0 || m > FFT_MAX_M) {
+		fprintf(stderr, "FFT size 2^%d not supported, please fix!\n", m);
+		abort();
+	}
+	slot = &plan_cache[(dir == 1) ? 0 : 1][m];
+	plan = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+	if (plan)
+		return plan;
+	plan = fft_plan_init(m, dir);
+	if (!plan)
+		abort();
+	if (!__atomic_compare_exchange_n(slot, &expected, plan, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		fft_plan_exit(plan);
+		plan = expected;
+	}
+
+	return plan;
+}
@@ -0,0 +1,418 @@
+/* FFT based (overlap-save) and polyphase FIR filter
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How the FFT filter works:
+ *
+ * The taps of a FIR filter (see fir_filter.c) are split into partitions of
+ * 'block' taps. Each partition is padded with zeroes to the FFT size of
+ * 2 * 'block' and transformed into a spectrum once.
+ *
+ * Input samples are collected until a block is complete. Then the previous
+ * and the current block are transformed and the spectrum is stored in a
+ * ring buffer (frequency domain delay line). Each spectrum in this ring
+ * buffer is multiplied with the spectrum of the according partition and all
+ * products are summed up. (The spectrum of the most recent block is
+ * multiplied with the first partition, the spectrum of the block before with
+ * the second partition, ...) The inverse FFT of the sum gives two blocks of
+ * samples, of which the first one is discarded (overlap-save) and the second
+ * one is the filtered output.
+ *
+ * If the block size is not given, a single partition is used, so the
+ * block size is the smallest power of two that holds all taps. This gives
+ * the highest throughput. A smaller block size reduces the latency, but
+ * requires more partitions to be multiplied and summed.
+ *
+ * Because output is available after each block only, the output is delayed
+ * by 'block' samples, in addition to the delay of the filter itself.
+ *
+ * The baseband variant filters complex (I/Q) samples. Because the FFT is
+ * complex anyway, this costs as much as filtering real samples.
+ *
+ * How the polyphase filter works:
+ *
+ * The decimator calculates only every 'factor'th output sample of the FIR
+ * filter, so it requires 1 / 'factor' of the multiplications.
+ *
+ * The interpolator inserts 'factor' - 1 zeroes between the input samples and
+ * filters the result. Instead of multiplying the zeroes, the taps are split
+ * into 'factor' phases, each phase calculates one of the 'factor' output
+ * samples from the input samples only. The output is multiplied by 'factor'
+ * to compensate the inserted zeroes.
+ *
+ * The dual decimator filters two signals with equal taps (like I and Q) in
+ * one pass, using vectors of two taps. Because the sums are split, the
+ * result may differ from the single decimator in the last bits.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "../libsample/sample.h"
+#include "../libfft/fft.h"
+#include "fir_filter.h"
+
+typedef double v2df __attribute__ ((vector_size (16)));
+
+/*
+ * FFT (overlap-save) filter
+ */
+
+fir_fft_t *fir_fft_init(fir_filter_t *fir, int block)
+{
+	fir_fft_t *fft;
+	int size, p, i;
+
+	fft = calloc(1, sizeof(*fft));
+	if (!fft) {
+		fprintf(stderr, "No memory creating FFT filter!\n");
+		return NULL;
+	}
+
+	/* use the smallest power of two, so that all taps fit into one partition */
+	if (block <= 0 || block > fir->ntaps)
+		block = fir->ntaps;
+	fft->m = 1;
+	while ((1 << (fft->m - 1)) < block)
+		fft->m++;
+	fft->block = 1 << (fft->m - 1);
+	size = fft->block * 2;
+	fft->ntaps = fir->ntaps;
+	fft->partitions = (fir->ntaps + fft->block - 1) / fft->block;
+	fft->delay = fir->delay + fft->block;
+
+	fft->h_re = calloc(fft->partitions * size, sizeof(*fft->h_re));
+	fft->h_im = calloc(fft->partitions * size, sizeof(*fft->h_im));
+	fft->x_re = calloc(fft->partitions * size, sizeof(*fft->x_re));
+	fft->x_im = calloc(fft->partitions * size, sizeof(*fft->x_im));
+	fft->in_re = calloc(size, sizeof(*fft->in_re));
+	fft->in_im = calloc(size, sizeof(*fft->in_im));
+	fft->out_re = calloc(fft->block, sizeof(*fft->out_re));
+	fft->out_im = calloc(fft->block, sizeof(*fft->out_im));
+	fft->fft_x = calloc(size, sizeof(*fft->fft_x));
+	fft->fft_y = calloc(size, sizeof(*fft->fft_y));
+	if (!fft->h_re || !fft->h_im || !fft->x_re || !fft->x_im || !fft->in_re || !fft->in_im
+	 || !fft->out_re || !fft->out_im || !fft->fft_x || !fft->fft_y) {
+		fprintf(stderr, "No memory creating FFT filter!\n");
+		fir_fft_exit(fft);
+		return NULL;
+	}
+
+	fft->forward = fft_plan_get(fft->m, 1);
+	fft->reverse = fft_plan_get(fft->m, -1);
+
+	/* transform each partition, the taps are reversed, because fir_process() starts with the oldest sample
+	 * the spectrum is not scaled, so the scaling of the forward transform of the input is compensated */
+	for (p = 0; p < fft->partitions; p++) {
+		memset(fft->fft_x, 0, size * sizeof(*fft->fft_x));
+		memset(fft->fft_y, 0, size * sizeof(*fft->fft_y));
+		for (i = 0; i < fft->block && p * fft->block + i < fir->ntaps; i++)
+			fft->fft_x[i] = fir->taps[fir->ntaps - 1 - (p * fft->block + i)] * (double)size;
+		fft_execute_split(fft->forward, fft->fft_x, fft->fft_y);
+		memcpy(fft->h_re + p * size, fft->fft_x, size * sizeof(*fft->h_re));
+		memcpy(fft->h_im + p * size, fft->fft_y, size * sizeof(*fft->h_im));
+	}
+
+	return fft;
+}
+
+void fir_fft_exit(fir_fft_t *fft)
+{
+	if (!fft)
+		return;
+	free(fft->h_re);
+	free(fft->h_im);
+	free(fft->x_re);
+	free(fft->x_im);
+	free(fft->in_re);
+	free(fft->in_im);
+	free(fft->out_re);
+	free(fft->out_im);
+	free(fft->fft_x);
+	free(fft->fft_y);
+	free(fft);
+}
+
+/* process one complete block of input */
+static void fft_block(fir_fft_t *fft)
+{
+	int size = fft->block * 2;
+	double *x_re, *x_im, *h_re, *h_im;
+	int p, pos, i;
+
+	/* transform previous and current block into frequency domain delay line */
+	if (--fft->x_pos < 0)
+		fft->x_pos = fft->partitions - 1;
+	x_re = fft->x_re + fft->x_pos * size;
+	x_im = fft->x_im + fft->x_pos * size;
+	memcpy(x_re, fft->in_re, size * sizeof(*x_re));
+	memcpy(x_im, fft->in_im, size * sizeof(*x_im));
+	fft_execute_split(fft->forward, x_re, x_im);
+
+	/* multiply and accumulate spectra, starting with the most recent one */
+	memset(fft->fft_x, 0, size * sizeof(*fft->fft_x));
+	memset(fft->fft_y, 0, size * sizeof(*fft->fft_y));
+	pos = fft->x_pos;
+	for (p = 0; p < fft->partitions; p++) {
+		x_re = fft->x_re + pos * size;
+		x_im = fft->x_im + pos * size;
+		h_re = fft->h_re + p * size;
+		h_im = fft->h_im + p * size;
+		for (i = 0; i < size; i++) {
+			fft->fft_x[i] += x_re[i] * h_re[i] - x_im[i] * h_im[i];
+			fft->fft_y[i] += x_re[i] * h_im[i] + x_im[i] * h_re[i];
+		}
+		if (++pos == fft->partitions)
+			pos = 0;
+	}
+
+	/* transform back, keep second half */
+	fft_execute_split(fft->reverse, fft->fft_x, fft->fft_y);
+	memcpy(fft->out_re, fft->fft_x + fft->block, fft->block * sizeof(*fft->out_re));
+	memcpy(fft->out_im, fft->fft_y + fft->block, fft->block * sizeof(*fft->out_im));
+
+	/* current block becomes previous block */
+	memcpy(fft->in_re, fft->in_re + fft->block, fft->block * sizeof(*fft->in_re));
+	memcpy(fft->in_im, fft->in_im + fft->block, fft->block * sizeof(*fft->in_im));
+}
+
+void fir_fft_process(fir_fft_t *fft, sample_t *samples, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		fft->in_re[fft->block + fft->fill] = samples[i];
+		samples[i] = fft->out_re[fft->fill];
+		if (++fft->fill == fft->block) {
+			fft_block(fft);
+			fft->fill = 0;
+		}
+	}
+}
+
+void fir_fft_process_baseband(fir_fft_t *fft, float *baseband, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++) {
+		fft->in_re[fft->block + fft->fill] = baseband[i * 2];
+		fft->in_im[fft->block + fft->fill] = baseband[i * 2 + 1];
+		baseband[i * 2] = fft->out_re[fft->fill];
+		baseband[i * 2 + 1] = fft->out_im[fft->fill];
+		if (++fft->fill == fft->block) {
+			fft_block(fft);
+			fft->fill = 0;
+		}
+	}
+}
+
+int fir_fft_get_delay(fir_fft_t *fft)
+{
+	return fft->delay;
+}
+
+/*
+ * polyphase decimator and interpolator
+ */
+
+static fir_poly_t *poly_init(int ntaps, int factor, int buffer_size)
+{
+	fir_poly_t *poly;
+
+	poly = calloc(1, sizeof(*poly));
+	if (!poly) {
+		fprintf(stderr, "No memory creating polyphase filter!\n");
+		return NULL;
+	}
+
+	poly->factor = factor;
+	poly->taps_per_phase = (ntaps + factor - 1) / factor;
+	poly->ntaps = poly->taps_per_phase * factor;
+	poly->buffer_size = buffer_size;
+
+	poly->taps = calloc(poly->ntaps, sizeof(*poly->taps));
+	/* history is stored twice, so it can be read without wrap */
+	poly->buffer = calloc(poly->buffer_size * 2, sizeof(*poly->buffer));
+	if (!poly->taps || !poly->buffer) {
+		fprintf(stderr, "No memory creating polyphase filter!\n");
+		fir_poly_exit(poly);
+		return NULL;
+	}
+
+	return poly;
+}
+
+fir_poly_t *fir_decimator_init(fir_filter_t *fir, int factor)
+{
+	fir_poly_t *poly;
+
+	if (factor < 1)
+		factor = 1;
+	poly = poly_init(fir->ntaps, factor, fir->ntaps);
+	if (!poly)
+		return NULL;
+
+	/* taps in order of fir_process(), starting with the oldest sample */
+	memcpy(poly->taps, fir->taps, fir->ntaps * sizeof(*poly->taps));
+	poly->delay = fir->delay;
+
+	return poly;
+}
+
+fir_poly_t *fir_interpolator_init(fir_filter_t *fir, int factor)
+{
+	fir_poly_t *poly;
+	int p, r, t;
+
+	if (factor < 1)
+		factor = 1;
+	/* history of input samples, one for each tap of a phase */
+	poly = poly_init(fir->ntaps, factor, (fir->ntaps + factor - 1) / factor);
+	if (!poly)
+		return NULL;
+
+	/* split taps into phases, each phase starts with the oldest input sample,
+	 * so tap 'r' of phase 'p' multiplies the input sample that is 'taps_per_phase - 1 - r' samples old */
+	for (p = 0; p < factor; p++) {
+		for (r = 0; r < poly->taps_per_phase; r++) {
+			t = fir->ntaps - 1 - p - (poly->taps_per_phase - 1 - r) * factor;
+			if (t >= 0)
+				poly->taps[p * poly->taps_per_phase + r] = fir->taps[t] * (double)factor;
+		}
+	}
+	poly->delay = fir->delay;
+
+	return poly;
+}
+
+void fir_poly_exit(fir_poly_t *poly)
+{
+	if (!poly)
+		return;
+	free(poly->taps);
+	free(poly->buffer);
+	free(poly);
+}
+
+/* store sample in history, so that the oldest sample is at 'buffer_pos' afterwards */
+static inline void poly_store(fir_poly_t *poly, double sample)
+{
+	poly->buffer[poly->buffer_pos] = sample;
+	poly->buffer[poly->buffer_pos + poly->buffer_size] = sample;
+	if (++poly->buffer_pos == poly->buffer_size)
+		poly->buffer_pos = 0;
+}
+
+/* decimate samples in place, return number of output samples */
+int fir_decimate(fir_poly_t *poly, sample_t *samples, int num)
+{
+	const double *taps = poly->taps, *history;
+	int ntaps = poly->buffer_size;
+	int i, j, out = 0;
+	double y;
+
+	for (i = 0; i < num; i++) {
+		poly_store(poly, samples[i]);
+		if (++poly->phase < poly->factor)
+			continue;
+		poly->phase = 0;
+		/* convolve with contiguous history, starting with oldest */
+		history = poly->buffer + poly->buffer_pos;
+		y = 0;
+		for (j = 0; j < ntaps; j++)
+			y += history[j] * taps[j];
+		samples[out++] = y;
+	}
+
+	return out;
+}
+
+/* decimate two sample buffers in place, both filters must have equal taps
+ * two vector sums for each buffer are used, so that the additions do not wait for each other */
+int fir_decimate_dual(fir_poly_t *poly_a, fir_poly_t *poly_b, sample_t *samples_a, sample_t *samples_b, int num)
+{
+	const double *taps = poly_a->taps, *history_a, *history_b;
+	int ntaps = poly_a->buffer_size;
+	v2df t0, t1, h, a0, a1, b0, b1;
+	int i, j, out = 0;
+	double ya, yb;
+
+	for (i = 0; i < num; i++) {
+		poly_store(poly_a, samples_a[i]);
+		poly_store(poly_b, samples_b[i]);
+		if (++poly_a->phase < poly_a->factor)
+			continue;
+		poly_a->phase = 0;
+		/* convolve with contiguous history, starting with oldest */
+		history_a = poly_a->buffer + poly_a->buffer_pos;
+		history_b = poly_b->buffer + poly_b->buffer_pos;
+		a0 = a1 = b0 = b1 = (v2df){ 0.0, 0.0 };
+		for (j = 0; j + 4 <= ntaps; j += 4) {
+			memcpy(&t0, taps + j, sizeof(t0));
+			memcpy(&t1, taps + j + 2, sizeof(t1));
+			memcpy(&h, history_a + j, sizeof(h));
+			a0 += h * t0;
+			memcpy(&h, history_a + j + 2, sizeof(h));
+			a1 += h * t1;
+			memcpy(&h, history_b + j, sizeof(h));
+			b0 += h * t0;
+			memcpy(&h, history_b + j + 2, sizeof(h));
+			b1 += h * t1;
+		}
+		a0 += a1;
+		b0 += b1;
+		ya = a0[0] + a0[1];
+		yb = b0[0] + b0[1];
+		for (; j < ntaps; j++) {
+			ya += history_a[j] * taps[j];
+			yb += history_b[j] * taps[j];
+		}
+		samples_a[out] = ya;
+		samples_b[out++] = yb;
+	}
+	poly_b->phase = poly_a->phase;
+
+	return out;
+}
+
+/* interpolate input samples, output must hold num * factor samples */
+void fir_interpolate(fir_poly_t *poly, sample_t *input, int num, sample_t *output)
+{
+	const double *taps, *history;
+	int tpp = poly->taps_per_phase;
+	int i, p, j;
+	double y;
+
+	for (i = 0; i < num; i++) {
+		poly_store(poly, input[i]);
+		history = poly->buffer + poly->buffer_pos;
+		for (p = 0; p < poly->factor; p++) {
+			taps = poly->taps + p * tpp;
+			y = 0;
+			for (j = 0; j < tpp; j++)
+				y += history[j] * taps[j];
+			*output++ = y;
+		}
+	}
+}
+
+int fir_poly_get_delay(fir_poly_t *poly)
+{
+	return poly->delay;
+}
@@ -17,5 +17,47 @@ void fir_exit(fir_filter_t *fir);
 void fir_process(fir_filter_t *fir, sample_t *samples, int num);
 int fir_get_delay(fir_filter_t *fir);
 
+typedef struct fir_fft {
+	int	ntaps;		/* number of taps of FIR filter */
+	int	delay;		/* delay of filter, including one block */
+	int	block;		/* samples per block = taps per partition */
+	int	m;		/* FFT size = 2^m = 2 * block */
+	int	partitions;	/* number of partitions */
+	double	*h_re, *h_im;	/* spectrum of each partition */
+	double	*x_re, *x_im;	/* spectrum of recent input blocks (frequency domain delay line) */
+	int	x_pos;		/* position of most recent spectrum */
+	double	*in_re, *in_im;	/* previous and current input block */
+	double	*out_re, *out_im; /* filtered output of last block */
+	int	fill;		/* samples in current input block */
+	double	*fft_x, *fft_y;	/* FFT buffers */
+	const struct fft_plan *forward, *reverse; /* FFT plans */
+} fir_fft_t;
+
+fir_fft_t *fir_fft_init(fir_filter_t *fir, int block);
+void fir_fft_exit(fir_fft_t *fft);
+void fir_fft_process(fir_fft_t *fft, sample_t *samples, int num);
+void fir_fft_process_baseband(fir_fft_t *fft, float *baseband, int num);
+int fir_fft_get_delay(fir_fft_t *fft);
+
+typedef struct fir_poly {
+	int	ntaps;		/* number of taps, padded to a multiple of factor */
+	int	delay;		/* delay of filter (at higher sample rate) */
+	int	factor;		/* decimation or interpolation factor */
+	int	taps_per_phase;	/* taps of each phase */
+	double	*taps;		/* taps, interpolator: ordered by phase */
+	double	*buffer;	/* history of input samples, stored twice, so it can be read without wrap */
+	int	buffer_size;	/* number of samples in history */
+	int	buffer_pos;	/* position of oldest sample in history */
+	int	phase;		/* decimator: input samples since last output */
+} fir_poly_t;
+
+fir_poly_t *fir_decimator_init(fir_filter_t *fir, int factor);
+fir_poly_t *fir_interpolator_init(fir_filter_t *fir, int factor);
+void fir_poly_exit(fir_poly_t *poly);
+int fir_decimate(fir_poly_t *poly, sample_t *samples, int num);
+int fir_decimate_dual(fir_poly_t *poly_a, fir_poly_t *poly_b, sample_t *samples_a, sample_t *samples_b, int num);
+void fir_interpolate(fir_poly_t *poly, sample_t *input, int num, sample_t *output);
+int fir_poly_get_delay(fir_poly_t *poly);
+
 #endif /* _FIR_FILTER_H */
 
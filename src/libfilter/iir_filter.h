@@ -14,4 +14,17 @@ void iir_notch_init(iir_filter_t *filter, double frequency, int samplerate, int
 void iir_process(iir_filter_t *filter, sample_t *samples, int length);
 void iir_process_baseband(iir_filter_t *filter, float *baseband, int length);
 
+enum iir_kernel {
+	IIR_KERNEL_AUTO = 0,	/* fastest bit exact kernel */
+	IIR_KERNEL_SCALAR,	/* iir_process() for each signal */
+	IIR_KERNEL_VECTOR,	/* two double lanes (SSE2/NEON) */
+	IIR_KERNEL_AVX2,	/* four double lanes, stages pipelined */
+	IIR_KERNEL_FLOAT,	/* four float lanes, stages pipelined, not bit exact */
+};
+
+int iir_kernel_select(enum iir_kernel kernel);
+const char *iir_kernel_name(enum iir_kernel kernel);
+void iir_process_iq(iir_filter_t *filter_i, iir_filter_t *filter_q, float *baseband, int length);
+void iir_process_dual(iir_filter_t *filter_a, iir_filter_t *filter_b, sample_t *samples_a, sample_t *samples_b, int length);
+
 #endif /* _FILTER_H */
@@ -0,0 +1,337 @@
+/* vectorized biquad cascade, processing I and Q (or two channels) in lockstep
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * Both filters must have equal coefficients, so the same operation can be
+ * done on both signals (lanes) at the same time.
+ *
+ * The 'vector' kernel uses two double lanes. The compiler translates this
+ * to SSE2 on x86_64 and to NEON on ARM64. The operations are the same as done
+ * by iir_process(), so the result is bit exact.
+ *
+ * The 'avx2' kernel uses four double lanes. Because each stage of the cascade
+ * depends on the previous stage, the second stage processes the previous
+ * sample while the first stage processes the current sample. This is only
+ * done for filters with two iterations (fourth order), the other filters use
+ * the 'vector' kernel. The result is bit exact too. This kernel only exists
+ * on x86 CPUs.
+ *
+ * The 'float' kernel works like the 'avx2' kernel, but uses four float lanes
+ * and float states. This fits into one SSE2 or NEON register. The result
+ * differs from the double precision filter by the precision of float (about
+ * -100 dB relative to a full scale signal).
+ *
+ * The kernel is selected by iir_kernel_select() once at program start,
+ * before any thread is started. (See main_mobile_init().)
+ *
+ * Note: If the compiler fuses multiply and add (e.g. on ARM64), the results
+ * of the 'vector' and 'avx2' kernel may differ in the last bit of precision.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "../libsample/sample.h"
+#include "iir_filter.h"
+
+typedef double v2df __attribute__ ((vector_size (16)));
+typedef double v4df __attribute__ ((vector_size (32)));
+typedef float v4sf __attribute__ ((vector_size (16)));
+
+/* add a small value, otherwise the filter will perform really bad on denormals */
+#define	SMALL_VALUE	0.000000001
+
+static const char *kernel_names[] = {
+	"auto",
+	"scalar",
+	"vector",
+	"avx2",
+	"float",
+};
+
+static int has_avx2(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return 0;
+#endif
+}
+
+/*
+ * scalar kernel (reference)
+ */
+
+static void iq_scalar(iir_filter_t *filter_i, iir_filter_t *filter_q, float *baseband, int length)
+{
+	iir_process_baseband(filter_i, baseband, length);
+	iir_process_baseband(filter_q, baseband + 1, length);
+}
+
+static void dual_scalar(iir_filter_t *filter_a, iir_filter_t *filter_b, sample_t *samples_a, sample_t *samples_b, int length)
+{
+	iir_process(filter_a, samples_a, length);
+	iir_process(filter_b, samples_b, length);
+}
+
+/*
+ * two lanes of double
+ */
+
+#define LOAD_COEFF(type, elem_t, f) \
+	type a0 = (type){} + (elem_t)f->a0, a1 = (type){} + (elem_t)f->a1, a2 = (type){} + (elem_t)f->a2; \
+	type b1 = (type){} + (elem_t)f->b1, b2 = (type){} + (elem_t)f->b2;
+
+#define BIQUAD(in, out, z1, z2) \
+	out = in * a0 + z1; \
+	z1 = in * a1 + z2 - b1 * out; \
+	z2 = in * a2 - b2 * out;
+
+__attribute__ ((noinline))
+static void iq_vector(iir_filter_t *filter_i, iir_filter_t *filter_q, float *baseband, int length)
+{
+	LOAD_COEFF(v2df, double, filter_i)
+	int iterations = filter_i->iter;
+	v2df z1[iterations], z2[iterations];
+	v2df in, out;
+	int i, j;
+
+	for (j = 0; j < iterations; j++) {
+		z1[j] = (v2df){ filter_i->z1[j], filter_q->z1[j] };
+		z2[j] = (v2df){ filter_i->z2[j], filter_q->z2[j] };
+	}
+
+	for (i = 0; i < length; i++) {
+		in = (v2df){ baseband[0], baseband[1] } + SMALL_VALUE;
+		for (j = 0; j < iterations; j++) {
+			BIQUAD(in, out, z1[j], z2[j])
+			in = out;
+		}
+		*baseband++ = in[0];
+		*baseband++ = in[1];
+	}
+
+	for (j = 0; j < iterations; j++) {
+		filter_i->z1[j] = z1[j][0];
+		filter_q->z1[j] = z1[j][1];
+		filter_i->z2[j] = z2[j][0];
+		filter_q->z2[j] = z2[j][1];
+	}
+}
+
+__attribute__ ((noinline))
+static void dual_vector(iir_filter_t *filter_a, iir_filter_t *filter_b, sample_t *samples_a, sample_t *samples_b, int length)
+{
+	LOAD_COEFF(v2df, double, filter_a)
+	int iterations = filter_a->iter;
+	v2df z1[iterations], z2[iterations];
+	v2df in, out;
+	int i, j;
+
+	for (j = 0; j < iterations; j++) {
+		z1[j] = (v2df){ filter_a->z1[j], filter_b->z1[j] };
+		z2[j] = (v2df){ filter_a->z2[j], filter_b->z2[j] };
+	}
+
+	for (i = 0; i < length; i++) {
+		in = (v2df){ samples_a[i], samples_b[i] } + SMALL_VALUE;
+		for (j = 0; j < iterations; j++) {
+			BIQUAD(in, out, z1[j], z2[j])
+			in = out;
+		}
+		samples_a[i] = in[0];
+		samples_b[i] = in[1];
+	}
+
+	for (j = 0; j < iterations; j++) {
+		filter_a->z1[j] = z1[j][0];
+		filter_b->z1[j] = z1[j][1];
+		filter_a->z2[j] = z2[j][0];
+		filter_b->z2[j] = z2[j][1];
+	}
+}
+
+/*
+ * four lanes: I and Q of first stage (current sample) and second stage (previous sample)
+ *
+ * The first sample is only processed by the first stage, so the states of
+ * the second stage must be kept. The last sample is only processed by the
+ * second stage, so the states of the first stage must be kept.
+ */
+
+#define PIPELINE(type, elem_t, load_a, load_b, store_a, store_b, filter_a, filter_b, length) \
+	LOAD_COEFF(type, elem_t, filter_a) \
+	type z1 = { filter_a->z1[0], filter_b->z1[0], filter_a->z1[1], filter_b->z1[1] }; \
+	type z2 = { filter_a->z2[0], filter_b->z2[0], filter_a->z2[1], filter_b->z2[1] }; \
+	type in, out, z1_keep, z2_keep; \
+	int i; \
+	\
+	/* first sample: first stage only */ \
+	z1_keep = z1; \
+	z2_keep = z2; \
+	in = (type){ (elem_t)(load_a(0)) + (elem_t)SMALL_VALUE, (elem_t)(load_b(0)) + (elem_t)SMALL_VALUE, 0.0, 0.0 }; \
+	BIQUAD(in, out, z1, z2) \
+	z1 = (type){ z1[0], z1[1], z1_keep[2], z1_keep[3] }; \
+	z2 = (type){ z2[0], z2[1], z2_keep[2], z2_keep[3] }; \
+	\
+	for (i = 1; i < length; i++) { \
+		in = (type){ (elem_t)(load_a(i)) + (elem_t)SMALL_VALUE, (elem_t)(load_b(i)) + (elem_t)SMALL_VALUE, out[0], out[1] }; \
+		BIQUAD(in, out, z1, z2) \
+		store_a(i - 1, out[2]); \
+		store_b(i - 1, out[3]); \
+	} \
+	\
+	/* last sample: second stage only */ \
+	z1_keep = z1; \
+	z2_keep = z2; \
+	in = (type){ 0.0, 0.0, out[0], out[1] }; \
+	BIQUAD(in, out, z1, z2) \
+	z1 = (type){ z1_keep[0], z1_keep[1], z1[2], z1[3] }; \
+	z2 = (type){ z2_keep[0], z2_keep[1], z2[2], z2[3] }; \
+	store_a(length - 1, out[2]); \
+	store_b(length - 1, out[3]); \
+	\
+	filter_a->z1[0] = z1[0]; \
+	filter_b->z1[0] = z1[1]; \
+	filter_a->z1[1] = z1[2]; \
+	filter_b->z1[1] = z1[3]; \
+	filter_a->z2[0] = z2[0]; \
+	filter_b->z2[0] = z2[1]; \
+	filter_a->z2[1] = z2[2]; \
+	filter_b->z2[1] = z2[3];
+
+#define LOAD_I(i)	baseband[(i) * 2]
+#define LOAD_Q(i)	baseband[(i) * 2 + 1]
+#define STORE_I(i, v)	baseband[(i) * 2] = v
+#define STORE_Q(i, v)	baseband[(i) * 2 + 1] = v
+#define LOAD_A(i)	samples_a[i]
+#define LOAD_B(i)	samples_b[i]
+#define STORE_A(i, v)	samples_a[i] = v
+#define STORE_B(i, v)	samples_b[i] = v
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__ ((target ("avx2")))
+static void iq_avx2(iir_filter_t *filter_i, iir_filter_t *filter_q, float *baseband, int length)
+{
+	if (filter_i->iter != 2 || length < 1) {
+		iq_vector(filter_i, filter_q, baseband, length);
+		return;
+	}
+	PIPELINE(v4df, double, LOAD_I, LOAD_Q, STORE_I, STORE_Q, filter_i, filter_q, length)
+}
+
+__attribute__ ((target ("avx2")))
+static void dual_avx2(iir_filter_t *filter_a, iir_filter_t *filter_b, sample_t *samples_a, sample_t *samples_b, int length)
+{
+	if (filter_a->iter != 2 || length < 1) {
+		dual_vector(filter_a, filter_b, samples_a, samples_b, length);
+		return;
+	}
+	PIPELINE(v4df, double, LOAD_A, LOAD_B, STORE_A, STORE_B, filter_a, filter_b, length)
+}
+#endif
+
+static void iq_float(iir_filter_t *filter_i, iir_filter_t *filter_q, float *baseband, int length)
+{
+	if (filter_i->iter != 2 || length < 1) {
+		iq_vector(filter_i, filter_q, baseband, length);
+		return;
+	}
+	PIPELINE(v4sf, float, LOAD_I, LOAD_Q, STORE_I, STORE_Q, filter_i, filter_q, length)
+}
+
+static void dual_float(iir_filter_t *filter_a, iir_filter_t *filter_b, sample_t *samples_a, sample_t *samples_b, int length)
+{
+	if (filter_a->iter != 2 || length < 1) {
+		dual_vector(filter_a, filter_b, samples_a, samples_b, length);
+		return;
+	}
+	PIPELINE(v4sf, float, LOAD_A, LOAD_B, STORE_A, STORE_B, filter_a, filter_b, length)
+}
+
+/*
+ * kernel selection
+ */
+
+/* The kernels are selected once at init, before any thread is started, because
+ * they are used by different threads. Until then, the vector kernel is used,
+ * which is supported by every CPU. */
+static void (*iq_kernel)(iir_filter_t *filter_i, iir_filter_t *filter_q, float *baseband, int length) = iq_vector;
+static void (*dual_kernel)(iir_filter_t *filter_a, iir_filter_t *filter_b, sample_t *samples_a, sample_t *samples_b, int length) = dual_vector;
+
+/* select kernel, IIR_KERNEL_AUTO selects the fastest bit exact kernel this CPU supports
+ * this must not be called while other threads process filters */
+int iir_kernel_select(enum iir_kernel kernel)
+{
+	if (kernel == IIR_KERNEL_AUTO)
+		kernel = (has_avx2()) ? IIR_KERNEL_AVX2 : IIR_KERNEL_VECTOR;
+
+	switch (kernel) {
+	case IIR_KERNEL_SCALAR:
+		iq_kernel = iq_scalar;
+		dual_kernel = dual_scalar;
+		break;
+	case IIR_KERNEL_VECTOR:
+		iq_kernel = iq_vector;
+		dual_kernel = dual_vector;
+		break;
+	case IIR_KERNEL_AVX2:
+#if defined(__x86_64__) || defined(__i386__)
+		if (!has_avx2())
+			return -ENOTSUP;
+		iq_kernel = iq_avx2;
+		dual_kernel = dual_avx2;
+		break;
+#else
+		/* AVX2 only exists on x86, other CPUs use the vector kernel */
+		return -ENOTSUP;
+#endif
+	case IIR_KERNEL_FLOAT:
+		iq_kernel = iq_float;
+		dual_kernel = dual_float;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+const char *iir_kernel_name(enum iir_kernel kernel)
+{
+	if (kernel < 0 || kernel >= (int)(sizeof(kernel_names) / sizeof(kernel_names[0])))
+		return "invalid";
+	return kernel_names[kernel];
+}
+
+/* filter interleaved I and Q of baseband, both filters must have equal coefficients */
+void iir_process_iq(iir_filter_t *filter_i, iir_filter_t *filter_q, float *baseband, int length)
+{
+	iq_kernel(filter_i, filter_q, baseband, length);
+}
+
+/* filter two sample buffers, both filters must have equal coefficients */
+void iir_process_dual(iir_filter_t *filter_a, iir_filter_t *filter_b, sample_t *samples_a, sample_t *samples_b, int length)
+{
+	dual_kernel(filter_a, filter_b, samples_a, samples_b, length);
+}
@@ -26,18 +26,39 @@
 #include "../libsample/sample.h"
 #include "fm.h"
 
+typedef uint32_t v4su __attribute__ ((vector_size (16)));
+typedef int32_t v4si __attribute__ ((vector_size (16)));
+typedef float v4sf __attribute__ ((vector_size (16)));
+typedef double v2df __attribute__ ((vector_size (16)));
+
+#define MOD_TAB_BITS	10	/* 8 KBytes fit into the L1 cache */
+#define MOD_TAB_SIZE	(1 << MOD_TAB_BITS)
+#define MOD_TAB_SHIFT	(32 - MOD_TAB_BITS)
+#define MOD_TAB_HALF	(1 << (MOD_TAB_SHIFT - 1))
+#define MOD_ANGLE	((float)(2.0 * M_PI / 4294967296.0))
+#define MOD_ROUND	(1099511627776.0 + 0.5)	/* add 2^40 turns, so truncation rounds to nearest */
+#define MOD_CHUNK	256	/* number of phases that are calculated at once */
+#define DEMOD_BLOCK	64	/* number of IQ samples that are filtered before discrimination */
+
 static int has_init = 0;
 static int fast_math = 0;
 static float *sin_tab = NULL, *cos_tab = NULL;
+static float mod_sin_tab[MOD_TAB_SIZE], mod_cos_tab[MOD_TAB_SIZE];
 
 /* global init */
 int fm_init(int _fast_math)
 {
+	int i;
+
 	fast_math = _fast_math;
 
-	if (fast_math) {
-		int i;
+	/* generate table for modulator */
+	for (i = 0; i < MOD_TAB_SIZE; i++) {
+		mod_sin_tab[i] = sin(2.0 * M_PI * (double)i / (double)MOD_TAB_SIZE);
+		mod_cos_tab[i] = cos(2.0 * M_PI * (double)i / (double)MOD_TAB_SIZE);
+	}
 
+	if (fast_math) {
 		sin_tab = calloc(65536+16384, sizeof(*sin_tab));
 		if (!sin_tab) {
 			fprintf(stderr, "No mem!\n");
@@ -80,6 +101,7 @@ int fm_mod_init(fm_mod_t *mod, double samplerate, double offset, double amplitud
 	mod->samplerate = samplerate;
 	mod->offset = offset;
 	mod->amplitude = amplitude;
+	mod->scale = 4294967296.0 / samplerate;
 
 	mod->ramp_length = samplerate * 0.001;
 	mod->ramp_tab = calloc(mod->ramp_length, sizeof(*mod->ramp_tab));
@@ -104,144 +126,173 @@ void fm_mod_exit(fm_mod_t *mod)
 	}
 }
 
+/* The modulator accumulates the phase in a 32 bit integer, so it wraps
+ * without any branch. While the transmitter is on, the phases of a chunk are
+ * accumulated first, then the phasors are calculated four at a time. During
+ * ramp up and down, each sample is modulated individually. */
+
+/* get phasor of given phase: the table entry next to the phase is corrected
+ * by the remaining angle, using second order taylor series */
+static inline void fm_phasor(uint32_t phase, float *_cos, float *_sin)
+{
+	uint32_t idx;
+	float d, c, s;
+
+	idx = ((phase + MOD_TAB_HALF) >> MOD_TAB_SHIFT) & (MOD_TAB_SIZE - 1);
+	d = (float)(int32_t)(phase - (idx << MOD_TAB_SHIFT)) * MOD_ANGLE;
+	c = mod_cos_tab[idx];
+	s = mod_sin_tab[idx];
+	*_cos = c * (1.0f - d * d * 0.5f) - s * d;
+	*_sin = s * (1.0f - d * d * 0.5f) + c * d;
+}
+
+/* accumulate phase of each sample */
+static inline uint32_t fm_phase(fm_mod_t *mod, sample_t *frequency, int length, uint32_t *phase)
+{
+	uint32_t p = mod->phase;
+	double scale = mod->scale, offset = mod->offset;
+	int i;
+
+	for (i = 0; i < length; i++) {
+		p += (uint32_t)(int64_t)((offset + frequency[i]) * scale + MOD_ROUND);
+		phase[i] = p;
+	}
+
+	return p;
+}
+
+/* get four phasors of given phases, see fm_phasor() */
+static inline void fm_phasor4(v4su phase, v4sf *_cos, v4sf *_sin)
+{
+	v4su idx, rem;
+	v4sf d, d2, c, s;
+
+	idx = ((phase + MOD_TAB_HALF) >> MOD_TAB_SHIFT) & (MOD_TAB_SIZE - 1);
+	rem = phase - (idx << MOD_TAB_SHIFT);
+	d = __builtin_convertvector((v4si)rem, v4sf) * MOD_ANGLE;
+	d2 = 1.0f - d * d * 0.5f;
+	c = (v4sf){ mod_cos_tab[idx[0]], mod_cos_tab[idx[1]], mod_cos_tab[idx[2]], mod_cos_tab[idx[3]] };
+	s = (v4sf){ mod_sin_tab[idx[0]], mod_sin_tab[idx[1]], mod_sin_tab[idx[2]], mod_sin_tab[idx[3]] };
+	*_cos = c * d2 - s * d;
+	*_sin = s * d2 + c * d;
+}
+
+/* synthesize and add phasors of given phases, four samples at once */
+static void fm_synth(const uint32_t *phase, int length, float amplitude, float *baseband)
+{
+	v4sf cos4, sin4, lo, hi, b;
+	int i;
+
+	for (i = 0; i + 4 <= length; i += 4, phase += 4, baseband += 8) {
+		fm_phasor4((v4su){ phase[0], phase[1], phase[2], phase[3] }, &cos4, &sin4);
+		cos4 *= amplitude;
+		sin4 *= amplitude;
+		/* interleave I and Q */
+		lo = (v4sf){ cos4[0], sin4[0], cos4[1], sin4[1] };
+		hi = (v4sf){ cos4[2], sin4[2], cos4[3], sin4[3] };
+		memcpy(&b, baseband, sizeof(b));
+		b += lo;
+		memcpy(baseband, &b, sizeof(b));
+		memcpy(&b, baseband + 4, sizeof(b));
+		b += hi;
+		memcpy(baseband + 4, &b, sizeof(b));
+	}
+	for (; i < length; i++, phase++, baseband += 2) {
+		float _cos, _sin;
+
+		fm_phasor(*phase, &_cos, &_sin);
+		baseband[0] += _cos * amplitude;
+		baseband[1] += _sin * amplitude;
+	}
+}
+
+/* modulate one sample during ramp */
+static inline void fm_modulate_ramp(fm_mod_t *mod, sample_t frequency, double gain, float *baseband)
+{
+	float _cos, _sin;
+
+	mod->phase += (uint32_t)(int64_t)((mod->offset + frequency) * mod->scale + MOD_ROUND);
+	fm_phasor(mod->phase, &_cos, &_sin);
+	baseband[0] += _cos * gain;
+	baseband[1] += _sin * gain;
+}
+
 /* do frequency modulation of samples and add them to existing baseband */
 void fm_modulate_complex(fm_mod_t *mod, sample_t *frequency, uint8_t *power, int length, float *baseband)
 {
-	double dev, rate, phase, offset;
-	int ramp, ramp_length;
-	double *ramp_tab;
-	double amplitude;
-
-	rate = mod->samplerate;
-	phase = mod->phase;
-	offset = mod->offset;
-	ramp = mod->ramp;
-	ramp_length = mod->ramp_length;
-	ramp_tab = mod->ramp_tab;
-	amplitude = mod->amplitude;
-
-again:
-	switch (mod->state) {
-	case MOD_STATE_ON:
-		/* modulate */
-		while (length) {
+	uint32_t phase[MOD_CHUNK];
+	int n, chunk;
+
+	while (length) {
+		switch (mod->state) {
+		case MOD_STATE_ON:
 			/* is power is not set, ramp down */
-			if (!(*power)) {
+			for (n = 0; n < length && power[n]; n++);
+			if (!n) {
 				mod->state = MOD_STATE_RAMP_DOWN;
 				break;
 			}
-			/* deviation is defined by the frequency value and the offset */
-			dev = offset + *frequency++;
-			power++;
-			length--;
-			if (fast_math) {
-				phase += 65536.0 * dev / rate;
-				if (phase < 0.0)
-					phase += 65536.0;
-				else if (phase >= 65536.0)
-					phase -= 65536.0;
-				*baseband++ += cos_tab[(uint16_t)phase] * amplitude;
-				*baseband++ += sin_tab[(uint16_t)phase] * amplitude;
-			} else {
-				phase += 2.0 * M_PI * dev / rate;
-				if (phase < 0.0)
-					phase += 2.0 * M_PI;
-				else if (phase >= 2.0 * M_PI)
-					phase -= 2.0 * M_PI;
-				*baseband++ += cos(phase) * amplitude;
-				*baseband++ += sin(phase) * amplitude;
-			}
-		}
-		break;
-	case MOD_STATE_RAMP_DOWN:
-		while (length) {
-			/* if power is set, ramp up */
-			if (*power) {
-				mod->state = MOD_STATE_RAMP_UP;
-				break;
+			power += n;
+			length -= n;
+			/* modulate: first the phases, then the phasors */
+			while (n) {
+				chunk = (n > MOD_CHUNK) ? MOD_CHUNK : n;
+				mod->phase = fm_phase(mod, frequency, chunk, phase);
+				fm_synth(phase, chunk, mod->amplitude, baseband);
+				frequency += chunk;
+				baseband += chunk * 2;
+				n -= chunk;
 			}
-			if (ramp == 0) {
-				mod->state = MOD_STATE_OFF;
-				break;
+			break;
+		case MOD_STATE_RAMP_DOWN:
+			while (length) {
+				/* if power is set, ramp up */
+				if (*power) {
+					mod->state = MOD_STATE_RAMP_UP;
+					break;
+				}
+				if (mod->ramp == 0) {
+					mod->state = MOD_STATE_OFF;
+					break;
+				}
+				fm_modulate_ramp(mod, *frequency++, mod->amplitude * mod->ramp_tab[mod->ramp], baseband);
+				baseband += 2;
+				power++;
+				length--;
+				mod->ramp--;
 			}
-			dev = offset + *frequency++;
-			power++;
-			length--;
-			if (fast_math) {
-				phase += 65536.0 * dev / rate;
-				if (phase < 0.0)
-					phase += 65536.0;
-				else if (phase >= 65536.0)
-					phase -= 65536.0;
-				*baseband++ += cos_tab[(uint16_t)phase] * amplitude * ramp_tab[ramp];
-				*baseband++ += sin_tab[(uint16_t)phase] * amplitude * ramp_tab[ramp];
-			} else {
-				phase += 2.0 * M_PI * dev / rate;
-				if (phase < 0.0)
-					phase += 2.0 * M_PI;
-				else if (phase >= 2.0 * M_PI)
-					phase -= 2.0 * M_PI;
-				*baseband++ += cos(phase) * amplitude * ramp_tab[ramp];
-				*baseband++ += sin(phase) * amplitude * ramp_tab[ramp];
-			}
-			ramp--;
-		}
-		break;
-	case MOD_STATE_OFF:
-		while (length) {
+			break;
+		case MOD_STATE_OFF:
+			/* just count, and add nothing */
+			for (n = 0; n < length && !power[n]; n++);
+			frequency += n;
+			power += n;
+			length -= n;
+			baseband += n * 2;
 			/* if power is set, ramp up */
-			if (*power) {
+			if (length)
 				mod->state = MOD_STATE_RAMP_UP;
-				break;
-			}
-			/* just count, and add nothing */
-			frequency++;
-			power++;
-			length--;
-			baseband += 2;
-		}
-		break;
-	case MOD_STATE_RAMP_UP:
-		while (length) {
-			/* is power is not set, ramp down */
-			if (!(*power)) {
-				mod->state = MOD_STATE_RAMP_DOWN;
-				break;
+			break;
+		case MOD_STATE_RAMP_UP:
+			while (length) {
+				/* is power is not set, ramp down */
+				if (!(*power)) {
+					mod->state = MOD_STATE_RAMP_DOWN;
+					break;
+				}
+				if (mod->ramp == mod->ramp_length - 1) {
+					mod->state = MOD_STATE_ON;
+					break;
+				}
+				fm_modulate_ramp(mod, *frequency++, mod->amplitude * mod->ramp_tab[mod->ramp], baseband);
+				baseband += 2;
+				power++;
+				length--;
+				mod->ramp++;
 			}
-			if (ramp == ramp_length - 1) {
-				mod->state = MOD_STATE_ON;
-				break;
-			}
-			/* deviation is defined by the frequency value and the offset */
-			dev = offset + *frequency++;
-			power++;
-			length--;
-			if (fast_math) {
-				phase += 65536.0 * dev / rate;
-				if (phase < 0.0)
-					phase += 65536.0;
-				else if (phase >= 65536.0)
-					phase -= 65536.0;
-				*baseband++ += cos_tab[(uint16_t)phase] * amplitude * ramp_tab[ramp];
-				*baseband++ += sin_tab[(uint16_t)phase] * amplitude * ramp_tab[ramp];
-			} else {
-				phase += 2.0 * M_PI * dev / rate;
-				if (phase < 0.0)
-					phase += 2.0 * M_PI;
-				else if (phase >= 2.0 * M_PI)
-					phase -= 2.0 * M_PI;
-				*baseband++ += cos(phase) * amplitude * ramp_tab[ramp];
-				*baseband++ += sin(phase) * amplitude * ramp_tab[ramp];
-			}
-			ramp++;
+			break;
 		}
-		break;
 	}
-	if (length)
-		goto again;
-
-	mod->phase = phase;
-	mod->ramp = ramp;
 }
 
 /* init FM demodulator, bandwidth is the 2 * (deviation + modulation) */
@@ -259,6 +310,7 @@ int fm_demod_init(fm_demod_t *demod, double samplerate, double offset, double ba
 		demod->rot = 65536.0 * -offset / samplerate;
 	else
 		demod->rot = 2 * M_PI * -offset / samplerate;
+	demod->nco_step = (uint32_t)(int64_t)(-offset * 4294967296.0 / samplerate + MOD_ROUND);
 
 	/* use fourth order (2 iter) filter, since it is as fast as second order (1 iter) filter */
 	iir_lowpass_init(&demod->lp[0], bandwidth / 2.0, samplerate, 2);
@@ -339,8 +391,7 @@ void fm_demodulate_complex(fm_demod_t *demod, sample_t *frequency, int length, f
 		Q[s] = i * _sin + q * _cos;
 	}
 	demod->phase = phase;
-	iir_process(&demod->lp[0], I, length);
-	iir_process(&demod->lp[1], Q, length);
+	iir_process_dual(&demod->lp[0], &demod->lp[1], I, Q, length);
 	last_phase = demod->last_phase;
 	for (s = 0; s < length; s++) {
 		if (fast_math)
@@ -391,8 +442,7 @@ void fm_demodulate_real(fm_demod_t *demod, sample_t *frequency, int length, samp
 		Q[s] = i * _sin;
 	}
 	demod->phase = phase;
-	iir_process(&demod->lp[0], I, length);
-	iir_process(&demod->lp[1], Q, length);
+	iir_process_dual(&demod->lp[0], &demod->lp[1], I, Q, length);
 	last_phase = demod->last_phase;
 	for (s = 0; s < length; s++) {
 		if (fast_math)
@@ -411,3 +461,164 @@ void fm_demodulate_real(fm_demod_t *demod, sample_t *frequency, int length, samp
 	demod->last_phase = last_phase;
 }
 
+/* select a where mask is set, else b */
+static inline v4sf v4sf_select(v4si mask, v4sf a, v4sf b)
+{
+	return (v4sf)((mask & (v4si)a) | (~mask & (v4si)b));
+}
+
+/* atan2 of four values without branches, error is below 2e-6 */
+static inline v4sf v4sf_atan2(v4sf y, v4sf x)
+{
+	const v4si abs_mask = (v4si){} + 0x7fffffff;
+	v4sf ax, ay, a, s, r;
+	v4si swap;
+
+	ax = (v4sf)((v4si)x & abs_mask);
+	ay = (v4sf)((v4si)y & abs_mask);
+	swap = ay > ax;
+	/* atan of the smaller by the larger value, so it is within 0..1 */
+	a = v4sf_select(swap, ax, ay) / (v4sf_select(swap, ay, ax) + 1e-30f);
+	s = a * a;
+	r = a * (0.99997726f + s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f + s * (0.05265332f + s * -0.01172120f)))));
+	r = v4sf_select(swap, (float)M_PI_2 - r, r);
+	r = v4sf_select(x < 0.0f, (float)M_PI - r, r);
+	/* use sign of y */
+	return (v4sf)((v4si)r | ((v4si)y & ~abs_mask));
+}
+
+/* do frequency demodulation of baseband and write them to samples
+ *
+ * This is an alternative to fm_demodulate_complex(), that mixes, filters and
+ * discriminates in one pass. Blocks of IQ samples are mixed and filtered into
+ * a small buffer, then the phase difference between each sample and the
+ * previous sample is the argument of the product of the sample and the
+ * conjugate of the previous sample. The argument is calculated for four
+ * samples at once. The I and Q output is not available, but the statistics
+ * of the signal are, if 'stats' is given.
+ *
+ * The output differs from fm_demodulate_complex() by a phase error below
+ * 4e-6 of each sample. This is 0.03 Hz at 50 kHz sample rate and it grows
+ * with the sample rate (see test_fm).
+ */
+void fm_demodulate_complex_fused(fm_demod_t *demod, sample_t *frequency, int length, float *baseband, fm_demod_stats_t *stats)
+{
+	iir_filter_t *lp_i = &demod->lp[0], *lp_q = &demod->lp[1];
+	int iterations = lp_i->iter;
+	v2df a0 = (v2df){} + lp_i->a0, a1 = (v2df){} + lp_i->a1, a2 = (v2df){} + lp_i->a2;
+	v2df b1 = (v2df){} + lp_i->b1, b2 = (v2df){} + lp_i->b2;
+	v2df z1[iterations], z2[iterations], in, out;
+	/* index 0 holds the last sample of the previous block */
+	float I[DEMOD_BLOCK + 4], Q[DEMOD_BLOCK + 4], tail[8];
+	uint32_t phase = demod->nco_phase, step = demod->nco_step;
+	v4sf i0, q0, i1, q1, lo, hi, c, si, f, scale, power_sum, freq_sum, freq_min, freq_max;
+	int s, n, k, j;
+
+	for (j = 0; j < iterations; j++) {
+		z1[j] = (v2df){ lp_i->z1[j], lp_q->z1[j] };
+		z2[j] = (v2df){ lp_i->z2[j], lp_q->z2[j] };
+	}
+	I[0] = demod->last_i;
+	Q[0] = demod->last_q;
+	scale = (v4sf){} + (float)(demod->samplerate / 2.0 / M_PI);
+	power_sum = freq_sum = (v4sf){};
+	freq_min = (v4sf){} + INFINITY;
+	freq_max = (v4sf){} - INFINITY;
+
+	for (s = 0; s < length; s += n) {
+		n = (length - s > DEMOD_BLOCK) ? DEMOD_BLOCK : length - s;
+
+		/* deinterleave and mix, four samples at once */
+		for (k = 0; k < n; k += 4) {
+			if (n - k < 4) {
+				/* the last chunk: do not read beyond the baseband */
+				memset(tail, 0, sizeof(tail));
+				memcpy(tail, baseband + k * 2, (n - k) * 2 * sizeof(*tail));
+				memcpy(&lo, tail, sizeof(lo));
+				memcpy(&hi, tail + 4, sizeof(hi));
+			} else {
+				memcpy(&lo, baseband + k * 2, sizeof(lo));
+				memcpy(&hi, baseband + k * 2 + 4, sizeof(hi));
+			}
+			i1 = (v4sf){ lo[0], lo[2], hi[0], hi[2] };
+			q1 = (v4sf){ lo[1], lo[3], hi[1], hi[3] };
+			if (step) {
+				fm_phasor4((v4su){ phase, phase + step, phase + step * 2, phase + step * 3 }, &c, &si);
+				phase += step * 4;
+				i0 = i1 * c - q1 * si;
+				q1 = i1 * si + q1 * c;
+				i1 = i0;
+			}
+			memcpy(I + k + 1, &i1, sizeof(i1));
+			memcpy(Q + k + 1, &q1, sizeof(q1));
+		}
+		/* rewind phase, if the last chunk is not complete */
+		phase -= step * (uint32_t)(k - n);
+		baseband += n * 2;
+
+		/* filter */
+		for (k = 1; k <= n; k++) {
+			in = (v2df){ I[k], Q[k] } + 0.000000001;
+			for (j = 0; j < iterations; j++) {
+				out = in * a0 + z1[j];
+				z1[j] = in * a1 + z2[j] - b1 * out;
+				z2[j] = in * a2 - b2 * out;
+				in = out;
+			}
+			I[k] = in[0];
+			Q[k] = in[1];
+		}
+		/* zero padding, so the last chunk can be processed as a whole */
+		for (k = n + 1; k < n + 4; k++)
+			I[k] = Q[k] = 0.0;
+
+		/* discriminate: arg(z[k] * conj(z[k - 1])) */
+		for (k = 0; k < n; k += 4) {
+			memcpy(&i0, I + k, sizeof(i0));
+			memcpy(&q0, Q + k, sizeof(q0));
+			memcpy(&i1, I + k + 1, sizeof(i1));
+			memcpy(&q1, Q + k + 1, sizeof(q1));
+			f = v4sf_atan2(q1 * i0 - i1 * q0, i1 * i0 + q1 * q0) * scale;
+			if (n - k < 4) {
+				/* the last chunk: only use valid values */
+				for (j = 0; j < n - k; j++) {
+					frequency[s + k + j] = f[j];
+					power_sum[j] += i1[j] * i1[j] + q1[j] * q1[j];
+					freq_sum[j] += f[j];
+					if (f[j] < freq_min[j])
+						freq_min[j] = f[j];
+					if (f[j] > freq_max[j])
+						freq_max[j] = f[j];
+				}
+				break;
+			}
+			frequency[s + k] = f[0];
+			frequency[s + k + 1] = f[1];
+			frequency[s + k + 2] = f[2];
+			frequency[s + k + 3] = f[3];
+			power_sum += i1 * i1 + q1 * q1;
+			freq_sum += f;
+			freq_min = v4sf_select(f < freq_min, f, freq_min);
+			freq_max = v4sf_select(f > freq_max, f, freq_max);
+		}
+		I[0] = I[n];
+		Q[0] = Q[n];
+	}
+
+	for (j = 0; j < iterations; j++) {
+		lp_i->z1[j] = z1[j][0];
+		lp_q->z1[j] = z1[j][1];
+		lp_i->z2[j] = z2[j][0];
+		lp_q->z2[j] = z2[j][1];
+	}
+	demod->last_i = I[0];
+	demod->last_q = Q[0];
+	demod->nco_phase = phase;
+
+	if (stats && length) {
+		stats->power = ((double)power_sum[0] + (double)power_sum[1] + (double)power_sum[2] + (double)power_sum[3]) / (double)length;
+		stats->offset = ((double)freq_sum[0] + (double)freq_sum[1] + (double)freq_sum[2] + (double)freq_sum[3]) / (double)length;
+		stats->min = fmin(fmin(freq_min[0], freq_min[1]), fmin(freq_min[2], freq_min[3]));
+		stats->max = fmax(fmax(freq_max[0], freq_max[1]), fmax(freq_max[2], freq_max[3]));
+	}
+}
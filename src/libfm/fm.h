@@ -17,7 +17,8 @@ typedef struct fm_mod {
 	double samplerate;	/* sample rate of in and out */
 	double offset;		/* offset to calculated center frequency */
 	double amplitude;	/* how much amplitude to add to the buff */
-	double phase;		/* current phase of FM (used to shift and modulate ) */
+	double scale;		/* phase step for one Hz */
+	uint32_t phase;		/* current phase of FM (used to shift and modulate), 2^32 is one turn */
 	enum fm_mod_state state;/* state of transmit power */
 	double *ramp_tab;	/* half cosine ramp up */
 	int ramp;		/* current ramp position */
@@ -34,11 +35,21 @@ typedef struct fm_demod {
 	double rot;		/* rotation step per sample to shift rx frequency (used to shift) */
 	double last_phase;	/* last phase of FM (used to demodulate) */
 	iir_filter_t lp[2];	/* filters received IQ signal */
+	uint32_t nco_phase;	/* current rotation phase, 2^32 is one turn (used by fused demodulator) */
+	uint32_t nco_step;	/* rotation step per sample (used by fused demodulator) */
+	float last_i, last_q;	/* last filtered IQ sample (used by fused demodulator) */
 } fm_demod_t;
 
+typedef struct fm_demod_stats {
+	double power;		/* mean square of filtered IQ signal */
+	double offset;		/* average frequency */
+	double min, max;	/* minimum and maximum frequency */
+} fm_demod_stats_t;
+
 int fm_demod_init(fm_demod_t *demod, double samplerate, double offset, double bandwidth);
 void fm_demod_exit(fm_demod_t *demod);
 void fm_demodulate_complex(fm_demod_t *demod, sample_t *frequency, int length, float *baseband, sample_t *I, sample_t *Q);
+void fm_demodulate_complex_fused(fm_demod_t *demod, sample_t *frequency, int length, float *baseband, fm_demod_stats_t *stats);
 void fm_demodulate_real(fm_demod_t *demod, sample_t *frequency, int length, sample_t *baseband, sample_t *I, sample_t *Q);
 
 #endif /* _LIB_FM_H */
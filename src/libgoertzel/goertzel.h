@@ -8,3 +8,34 @@ typedef struct goertzel {
 void audio_goertzel_init(goertzel_t *goertzel, double freq, int samplerate);
 void audio_goertzel(goertzel_t *goertzel, sample_t *samples, int length, int offset, double *result, int k);
 
+#define GOERTZEL_BANK_MAX	16
+
+typedef struct goertzel_bank {
+	int		k;				/* number of frequencies */
+	int		length;				/* block length in samples */
+	double		*window;			/* window for block length */
+	double		coeff[GOERTZEL_BANK_MAX];
+} goertzel_bank_t;
+
+int goertzel_bank_init(goertzel_bank_t *bank, const double *freq, int k, int samplerate, int length);
+void goertzel_bank_exit(goertzel_bank_t *bank);
+void goertzel_bank(goertzel_bank_t *bank, sample_t *samples, int offset, double *result);
+
+typedef struct goertzel_slide {
+	int		k;				/* number of frequencies */
+	int		length;				/* window length in samples */
+	sample_t	*history;			/* ring buffer of the last 'length' samples */
+	int		pos;				/* oldest sample in ring buffer */
+	double		rot_re[GOERTZEL_BANK_MAX];	/* rotation each sample */
+	double		rot_im[GOERTZEL_BANK_MAX];
+	double		out_re[GOERTZEL_BANK_MAX];	/* rotation of the sample that leaves the window */
+	double		out_im[GOERTZEL_BANK_MAX];
+	double		re[GOERTZEL_BANK_MAX];		/* current value of each frequency */
+	double		im[GOERTZEL_BANK_MAX];
+	double		norm;				/* converts value to level */
+} goertzel_slide_t;
+
+int goertzel_slide_init(goertzel_slide_t *slide, const double *freq, int k, int samplerate, int length);
+void goertzel_slide_exit(goertzel_slide_t *slide);
+void goertzel_slide(goertzel_slide_t *slide, sample_t *samples, int num, double *result);
+
@@ -0,0 +1,310 @@
+/* Goertzel filter bank, all tones in one pass
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * audio_goertzel() walks through the samples once for each tone. The bank
+ * walks through the samples once and processes all tones at each sample. The
+ * tones are put into lanes of four doubles, so up to four tones are processed
+ * with one vector operation. With AVX2 one operation is done by one
+ * instruction, else by two SSE2 or NEON instructions.
+ *
+ * The window is calculated for the block length at init time. It has the same
+ * values as the window that audio_goertzel() uses, and the same operations
+ * are done, so the result is bit exact.
+ *
+ * The sliding variant gives the level of the last 'length' samples after
+ * every sample. For each tone, a complex value is rotated by the frequency of
+ * the tone at each sample. The new sample is added and the sample that leaves
+ * the window is removed:
+ *
+ *	X(n) = r * e^(jw) * X(n-1) + x(n) - r^N * e^(jwN) * x(n-N)
+ *
+ * A rectangular window is used, so this costs the same for all window
+ * lengths. Rounding errors would accumulate forever, so the value is damped by
+ * 'r' a little. The level is corrected by the sum of the damped window.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "goertzel.h"
+
+typedef double v4df __attribute__ ((vector_size (32)));
+
+#define LANES		4
+#define GROUPS		(GOERTZEL_BANK_MAX / LANES)
+#define SLIDE_DAMPING	0.999999	/* time constant of about one million samples */
+
+static int has_avx2(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return 0;
+#endif
+}
+
+/* load 'k' values into groups of lanes, unused lanes are set to 0 */
+static void load_lanes(v4df *v, const double *values, int k)
+{
+	int i;
+
+	memset(v, 0, sizeof(*v) * GROUPS);
+	for (i = 0; i < k; i++)
+		v[i / LANES][i % LANES] = values[i];
+}
+
+static void store_lanes(double *values, const v4df *v, int k)
+{
+	int i;
+
+	for (i = 0; i < k; i++)
+		values[i] = v[i / LANES][i % LANES];
+}
+
+/*
+ * block variant
+ */
+
+int goertzel_bank_init(goertzel_bank_t *bank, const double *freq, int k, int samplerate, int length)
+{
+	int i, n;
+
+	memset(bank, 0, sizeof(*bank));
+
+	if (k < 1 || k > GOERTZEL_BANK_MAX || length < 1) {
+		LOGP(DDSP, LOGL_ERROR, "Goertzel bank with %d tones and %d samples is not supported!\n", k, length);
+		return -EINVAL;
+	}
+
+	bank->window = calloc(length, sizeof(*bank->window));
+	if (!bank->window) {
+		LOGP(DDSP, LOGL_ERROR, "No memory!\n");
+		return -ENOMEM;
+	}
+	bank->k = k;
+	bank->length = length;
+
+	/* same hamming window as used by audio_goertzel() */
+	for (n = 0; n < length; n++) {
+		i = n * 256 / length;
+		bank->window[n] = 0.54 - 0.46 * cos(2.0 * M_PI * (double)i / 256.0);
+	}
+	for (i = 0; i < k; i++)
+		bank->coeff[i] = 2.0 * cos(2.0 * M_PI * freq[i] / (double)samplerate);
+
+	return 0;
+}
+
+void goertzel_bank_exit(goertzel_bank_t *bank)
+{
+	free(bank->window);
+	bank->window = NULL;
+}
+
+static inline __attribute__ ((always_inline)) void bank_run(v4df *sk1, v4df *sk2, const v4df *coeff, int groups, const sample_t *samples, const double *window, int length)
+{
+	v4df x, sk;
+	int n, g;
+
+	for (n = 0; n < length; n++) {
+		x = (v4df){} + samples[n] * window[n];
+		for (g = 0; g < groups; g++) {
+			sk = (coeff[g] * sk1[g]) - sk2[g] + x;
+			sk2[g] = sk1[g];
+			sk1[g] = sk;
+		}
+	}
+}
+
+/* the number of groups is constant in each case, so the compiler keeps all states in registers */
+#define BANK_KERNEL(name, attr) \
+attr static void name(v4df *sk1, v4df *sk2, const v4df *coeff, int groups, const sample_t *samples, const double *window, int length) \
+{ \
+	switch (groups) { \
+	case 1: bank_run(sk1, sk2, coeff, 1, samples, window, length); break; \
+	case 2: bank_run(sk1, sk2, coeff, 2, samples, window, length); break; \
+	case 3: bank_run(sk1, sk2, coeff, 3, samples, window, length); break; \
+	default: bank_run(sk1, sk2, coeff, GROUPS, samples, window, length); \
+	} \
+}
+
+BANK_KERNEL(bank_vector, )
+BANK_KERNEL(bank_avx2, __attribute__ ((target ("avx2"))))
+
+static void (*bank_kernel)(v4df *sk1, v4df *sk2, const v4df *coeff, int groups, const sample_t *samples, const double *window, int length) = NULL;
+
+/* filter all frequencies of the bank and return their levels
+ *
+ * samples: pointer to sample buffer of the bank's length
+ * offset: for ring buffer, start here and wrap around to 0 when length has been hit
+ * result: array of result levels (peak value of the target frequency)
+ */
+void goertzel_bank(goertzel_bank_t *bank, sample_t *samples, int offset, double *result)
+{
+	v4df coeff[GROUPS], sk1[GROUPS], sk2[GROUPS];
+	double sk[GOERTZEL_BANK_MAX], sk2_[GOERTZEL_BANK_MAX];
+	int groups = (bank->k + LANES - 1) / LANES;
+	int length = bank->length;
+	int i;
+
+	if (!bank_kernel)
+		bank_kernel = (has_avx2()) ? bank_avx2 : bank_vector;
+
+	load_lanes(coeff, bank->coeff, bank->k);
+	memset(sk1, 0, sizeof(sk1));
+	memset(sk2, 0, sizeof(sk2));
+
+	/* walk from offset to the end, then from the start to offset */
+	bank_kernel(sk1, sk2, coeff, groups, samples + offset, bank->window, length - offset);
+	if (offset)
+		bank_kernel(sk1, sk2, coeff, groups, samples, bank->window + length - offset, offset);
+
+	/* compute level of signal */
+	store_lanes(sk, sk1, bank->k);
+	store_lanes(sk2_, sk2, bank->k);
+	for (i = 0; i < bank->k; i++) {
+		result[i] = sqrt(
+			(sk[i] * sk[i]) -
+			(bank->coeff[i] * sk[i] * sk2_[i]) +
+			(sk2_[i] * sk2_[i])
+				) / (double)length * 4 / 1.08;
+	}
+}
+
+/*
+ * sliding variant
+ */
+
+int goertzel_slide_init(goertzel_slide_t *slide, const double *freq, int k, int samplerate, int length)
+{
+	double w, gain;
+	int i;
+
+	memset(slide, 0, sizeof(*slide));
+
+	if (k < 1 || k > GOERTZEL_BANK_MAX || length < 1) {
+		LOGP(DDSP, LOGL_ERROR, "Sliding Goertzel with %d tones and %d samples is not supported!\n", k, length);
+		return -EINVAL;
+	}
+
+	slide->history = calloc(length, sizeof(*slide->history));
+	if (!slide->history) {
+		LOGP(DDSP, LOGL_ERROR, "No memory!\n");
+		return -ENOMEM;
+	}
+	slide->k = k;
+	slide->length = length;
+
+	gain = pow(SLIDE_DAMPING, length);
+	for (i = 0; i < k; i++) {
+		w = 2.0 * M_PI * freq[i] / (double)samplerate;
+		slide->rot_re[i] = SLIDE_DAMPING * cos(w);
+		slide->rot_im[i] = SLIDE_DAMPING * sin(w);
+		slide->out_re[i] = gain * cos(w * length);
+		slide->out_im[i] = gain * sin(w * length);
+	}
+	/* sum of the damped window: (1 - r^N) / (1 - r) */
+	slide->norm = 2.0 / ((1.0 - gain) / (1.0 - SLIDE_DAMPING));
+
+	return 0;
+}
+
+void goertzel_slide_exit(goertzel_slide_t *slide)
+{
+	free(slide->history);
+	slide->history = NULL;
+}
+
+static inline __attribute__ ((always_inline)) int slide_run(v4df *re, v4df *im, const v4df *rot_re, const v4df *rot_im, const v4df *out_re, const v4df *out_im, int groups, sample_t *history, int pos, int length, const sample_t *samples, int num)
+{
+	v4df x, old, tmp;
+	int n, g;
+
+	for (n = 0; n < num; n++) {
+		x = (v4df){} + samples[n];
+		old = (v4df){} + history[pos];
+		history[pos] = samples[n];
+		if (++pos == length)
+			pos = 0;
+		for (g = 0; g < groups; g++) {
+			tmp = rot_re[g] * re[g] - rot_im[g] * im[g] + x - out_re[g] * old;
+			im[g] = rot_re[g] * im[g] + rot_im[g] * re[g] - out_im[g] * old;
+			re[g] = tmp;
+		}
+	}
+
+	return pos;
+}
+
+#define SLIDE_KERNEL(name, attr) \
+attr static int name(v4df *re, v4df *im, const v4df *rot_re, const v4df *rot_im, const v4df *out_re, const v4df *out_im, int groups, sample_t *history, int pos, int length, const sample_t *samples, int num) \
+{ \
+	switch (groups) { \
+	case 1: return slide_run(re, im, rot_re, rot_im, out_re, out_im, 1, history, pos, length, samples, num); \
+	case 2: return slide_run(re, im, rot_re, rot_im, out_re, out_im, 2, history, pos, length, samples, num); \
+	case 3: return slide_run(re, im, rot_re, rot_im, out_re, out_im, 3, history, pos, length, samples, num); \
+	default: return slide_run(re, im, rot_re, rot_im, out_re, out_im, GROUPS, history, pos, length, samples, num); \
+	} \
+}
+
+SLIDE_KERNEL(slide_vector, )
+SLIDE_KERNEL(slide_avx2, __attribute__ ((target ("avx2"))))
+
+static int (*slide_kernel)(v4df *re, v4df *im, const v4df *rot_re, const v4df *rot_im, const v4df *out_re, const v4df *out_im, int groups, sample_t *history, int pos, int length, const sample_t *samples, int num) = NULL;
+
+/* feed samples and return the levels of the last 'length' samples
+ *
+ * samples: pointer to new samples
+ * num: number of new samples, may be any number
+ * result: array of result levels (peak value of the target frequency), may be NULL
+ */
+void goertzel_slide(goertzel_slide_t *slide, sample_t *samples, int num, double *result)
+{
+	v4df rot_re[GROUPS], rot_im[GROUPS], out_re[GROUPS], out_im[GROUPS], re[GROUPS], im[GROUPS];
+	int groups = (slide->k + LANES - 1) / LANES;
+	int i;
+
+	if (!slide_kernel)
+		slide_kernel = (has_avx2()) ? slide_avx2 : slide_vector;
+
+	load_lanes(rot_re, slide->rot_re, slide->k);
+	load_lanes(rot_im, slide->rot_im, slide->k);
+	load_lanes(out_re, slide->out_re, slide->k);
+	load_lanes(out_im, slide->out_im, slide->k);
+	load_lanes(re, slide->re, slide->k);
+	load_lanes(im, slide->im, slide->k);
+
+	slide->pos = slide_kernel(re, im, rot_re, rot_im, out_re, out_im, groups, slide->history, slide->pos, slide->length, samples, num);
+
+	store_lanes(slide->re, re, slide->k);
+	store_lanes(slide->im, im, slide->k);
+
+	if (!result)
+		return;
+	for (i = 0; i < slide->k; i++)
+		result[i] = sqrt(slide->re[i] * slide->re[i] + slide->im[i] * slide->im[i]) * slide->norm;
+}
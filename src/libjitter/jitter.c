@@ -21,7 +21,11 @@
  *
  * Storing:
  *
- * Each saved frame is sorted into the list of packages by their timestamp.
+ * Each saved frame is stored in a ring of slots. The slot is selected by the
+ * upper bits of the timestamp, so each slot covers a fixed number of samples.
+ * Multiple frames in a slot are sorted by their timestamp. Frames that fall
+ * out of the window are removed from the slots, when the window passes them,
+ * so a slot is never shared by frames of different ring cycles.
  *
  * The first packet will be stored with a timestamp offset of minimum jitter
  * window size or half of the target size, depending on the adaptive jitter
@@ -61,6 +65,13 @@
  * *TBD*
  *
  *
+ * Memory:
+ *
+ * Frames are allocated from a pool of each jitter buffer. Frames that are
+ * freed are put back into the pool, so no memory is allocated in steady
+ * state. The number of allocations per second is shown with the statistics.
+ *
+ *
  * Unlocking:
  *
  * If the buffer is created or reset, the buffer is locked, so no packets are
@@ -92,7 +103,7 @@ static int unnamed_count = 1;
 /* create jitter buffer */
 int jitter_create(jitter_t *jb, const char *name, double samplerate, double target_window_duration, double max_window_duration, uint32_t window_flags)
 {
-	int rc = 0;
+	int slots;
 
 	memset(jb, 0, sizeof(*jb));
 
@@ -108,6 +119,18 @@ int jitter_create(jitter_t *jb, const char *name, double samplerate, double targ
 	jb->max_window_size = (int)ceil(max_window_duration / jb->sample_duration);
 	jb->window_flags = window_flags;
 
+	/* a slot is not longer than 20ms, the ring covers twice the maximum window */
+	while ((2 << jb->ring_shift) <= jb->samples_20ms)
+		jb->ring_shift++;
+	for (slots = 1; (slots << jb->ring_shift) < 2 * (jb->max_window_size + (2 << jb->ring_shift)); slots <<= 1);
+	jb->ring_mask = slots - 1;
+	jb->ring_limit = (slots << jb->ring_shift) / 2 - (1 << jb->ring_shift);
+	jb->ring = calloc(slots, sizeof(*jb->ring));
+	if (!jb->ring) {
+		LOGP(DJITTER, LOGL_ERROR, "No memory for jitter buffer.\n");
+		return -ENOMEM;
+	}
+
 	jitter_reset(jb);
 
 	LOGP(DJITTER, LOGL_INFO, "%s Created jitter buffer. (samperate=%.0f, target_window=%.0fms, max_window=%.0fms, flag:latency=%s flag:repeat=%s)\n",
@@ -118,13 +141,46 @@ int jitter_create(jitter_t *jb, const char *name, double samplerate, double targ
 		(window_flags & JITTER_FLAG_LATENCY) ? "true" : "false",
 		(window_flags & JITTER_FLAG_REPEAT) ? "true" : "false");
 
-	return rc;
+	return 0;
+}
+
+/* remove frame from ring */
+static void ring_remove(jitter_t *jb, jitter_frame_t **jfp)
+{
+	jitter_frame_t *jf = *jfp;
+
+	*jfp = jf->next;
+	jb->ring_count--;
+	jitter_frame_free(jf);
+}
+
+/* remove frames from slots that the window has passed since last call
+ * frames in the past and frames beyond the ring limit are removed */
+static void ring_clean(jitter_t *jb, uint32_t slots)
+{
+	jitter_frame_t **jfp;
+	int32_t offset_timestamp;
+	uint32_t i;
+
+	if (slots > jb->ring_mask + 1)
+		slots = jb->ring_mask + 1;
+	for (i = 0; i < slots && jb->ring_count; i++) {
+		jfp = &jb->ring[(jb->ring_slot + i) & jb->ring_mask];
+		while (*jfp) {
+			offset_timestamp = (*jfp)->timestamp - jb->window_timestamp;
+			if (offset_timestamp < 0 || offset_timestamp >= jb->ring_limit)
+				ring_remove(jb, jfp);
+			else
+				jfp = &((*jfp)->next);
+		}
+	}
+	jb->ring_slot = jb->window_timestamp >> jb->ring_shift;
 }
 
 /* reset jitter buffer */
 void jitter_reset(jitter_t *jb)
 {
-	jitter_frame_t *jf, *temp;
+	uint32_t i;
 
 	LOGP(DJITTER, LOGL_INFO, "%s Reset jitter buffer.\n", jb->name);
 
@@ -135,37 +191,63 @@ void jitter_reset(jitter_t *jb)
 	jb->window_valid = false;
 
 	/* remove all pending frames */
-	jf = jb->frame_list;
-	while(jf) {
-		temp = jf;
-		jf = jf->next;
-		free(temp);
+	for (i = 0; jb->ring && i <= jb->ring_mask; i++) {
+		while (jb->ring[i])
+			ring_remove(jb, &jb->ring[i]);
 	}
-	jb->frame_list = NULL;
 
 	/* remove current sample buffer */
 	free(jb->spl_buf);
 	jb->spl_buf = NULL;
+	jb->spl_size = 0;
+	jb->spl_pos = 0;
 	jb->spl_valid = false;
 }
 
 void jitter_destroy(jitter_t *jb)
 {
+	jitter_frame_t *jf;
+
 	jitter_reset(jb);
 
+	/* remove pool */
+	while ((jf = jb->frame_pool)) {
+		jb->frame_pool = jf->next;
+		free(jf);
+	}
+	jb->pool_count = 0;
+
+	free(jb->ring);
+	jb->ring = NULL;
+
 	LOGP(DJITTER, LOGL_INFO, "%s Destroying jitter buffer.\n", jb->name);
 }
 
-jitter_frame_t *jitter_frame_alloc(void (*decoder)(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void *priv), void *decoder_priv, uint8_t *data, int size, uint8_t marker, uint16_t sequence, uint32_t timestamp, uint32_t ssrc)
+/* allocate frame from the pool of the jitter buffer, if the pool has no frame that is large enough, allocate memory */
+jitter_frame_t *jitter_frame_alloc(jitter_t *jb, void (*decoder)(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void *priv), void *decoder_priv, uint8_t *data, int size, uint8_t marker, uint16_t sequence, uint32_t timestamp, uint32_t ssrc)
 {
 	jitter_frame_t *jf;
 
-	jf = malloc(sizeof(*jf) + size);
+	jf = jb->frame_pool;
+	if (jf) {
+		jb->frame_pool = jf->next;
+		jb->pool_count--;
+		if (jf->capacity < size) {
+			free(jf);
+			jf = NULL;
+		}
+	}
 	if (!jf) {
-		LOGP(DJITTER, LOGL_ERROR, "No memory for frame.\n");
-		return NULL;
+		jf = malloc(sizeof(*jf) + size);
+		if (!jf) {
+			LOGP(DJITTER, LOGL_ERROR, "No memory for frame.\n");
+			return NULL;
+		}
+		jb->alloc_count++;
+		jf->capacity = size;
 	}
-	memset(jf, 0, sizeof(*jf)); // note: clear header only
+	jf->next = NULL;
+	jf->jb = jb;
 	jf->decoder = decoder;
 	jf->decoder_priv = decoder_priv;
 	memcpy(jf->data, data, size);
@@ -178,9 +260,18 @@ jitter_frame_t *jitter_frame_alloc(void (*decoder)(uint8_t *src_data, int src_le
 	return jf;
 }
 
+/* put frame back into the pool, the pool holds as many frames as the ring has slots */
 void jitter_frame_free(jitter_frame_t *jf)
 {
-	free(jf);
+	jitter_t *jb = jf->jb;
+
+	if ((uint32_t)jb->pool_count > jb->ring_mask) {
+		free(jf);
+		return;
+	}
+	jf->next = jb->frame_pool;
+	jb->frame_pool = jf;
+	jb->pool_count++;
 }
 
 void jitter_frame_get(jitter_frame_t *jf, void (**decoder)(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void *priv), void **decoder_priv, uint8_t **data, int *size, uint8_t *marker, uint16_t *sequence, uint32_t *timestamp, uint32_t *ssrc)
@@ -212,6 +303,7 @@ void jitter_save(jitter_t *jb, jitter_frame_t *jf)
 {
 	jitter_frame_t **jfp;
 	int32_t offset_timestamp;
+	uint32_t window_timestamp;
 
 	/* Do not store a frame with no size. Dejitter cannot handle this. Also it makes no sense to dejitter it. */
 	if (jf->size == 0) {
@@ -246,16 +338,20 @@ void jitter_save(jitter_t *jb, jitter_frame_t *jf)
 		jb->min_delay = -1;
 		jb->delay_counter = 0.0;
 		jb->delay_interval = INITIAL_DELAY_INTERVAL;
+		jb->ring_slot = jb->window_timestamp >> jb->ring_shift;
 	}
+	window_timestamp = jb->window_timestamp;
 
 	/* reduce delay */
 	if (jb->delay_counter >= jb->delay_interval) {
 		if (jb->min_delay >= 0)
-			LOGP(DJITTER, LOGL_DEBUG, "%s Statistics: target_window_delay=%.0fms max_window_delay=%.0fms  current min_delay=%.0fms\n",
+			LOGP(DJITTER, LOGL_DEBUG, "%s Statistics: target_window_delay=%.0fms max_window_delay=%.0fms  current min_delay=%.0fms  allocations=%.1f/s\n",
 				jb->name,
 				(double)jb->target_window_size * jb->sample_duration * 1000.0,
 				(double)jb->max_window_size * jb->sample_duration * 1000.0,
-				(double)jb->min_delay * jb->sample_duration * 1000.0);
+				(double)jb->min_delay * jb->sample_duration * 1000.0,
+				(double)(jb->alloc_count - jb->alloc_stat) / jb->delay_counter);
+		jb->alloc_stat = jb->alloc_count;
 		/* delay reduction, if minimum delay is greater than target jitter window size */
 		if ((jb->window_flags & JITTER_FLAG_LATENCY) && jb->min_delay > jb->target_window_size) {
 			LOGP(DJITTER, LOGL_DEBUG, "%s Reducing current minimum delay of %.0fms, because maximum delay is greater than target window size of %.0fms.\n",
@@ -271,20 +367,13 @@ void jitter_save(jitter_t *jb, jitter_frame_t *jf)
 		jb->min_delay = -1;
 	}
 
-	/* find location where to put frame into the list, depending on sequence number */
-	jfp = &jb->frame_list;
-	while(*jfp) {
-		offset_timestamp = (int16_t)(jf->timestamp - (*jfp)->timestamp);
-		/* found double entry */
-		if (offset_timestamp == 0) {
+	/* find double entry in the slot of the frame */
+	for (jfp = &jb->ring[(jf->timestamp >> jb->ring_shift) & jb->ring_mask]; *jfp; jfp = &((*jfp)->next)) {
+		if (jf->timestamp == (*jfp)->timestamp) {
 			LOGP(DJITTER, LOGL_DEBUG, "%s Dropping double packet (timestamp = %u)\n", jb->name, jf->timestamp);
 			jitter_frame_free(jf);
 			return;
 		}
-		/* offset is negative, so we found the position to insert frame */
-		if (offset_timestamp < 0)
-			break;
-		jfp = &((*jfp)->next);
 	}
 
 	offset_timestamp = jf->timestamp - jb->window_timestamp;
@@ -334,6 +423,19 @@ void jitter_save(jitter_t *jb, jitter_frame_t *jf)
 		}
 	}
 
+	/* if window has been moved, remove frames that are outside the window now */
+	if (jb->window_timestamp != window_timestamp)
+		ring_clean(jb, jb->ring_mask + 1);
+
+	/* find location where to put frame into the slot, depending on timestamp */
+	jfp = &jb->ring[(jf->timestamp >> jb->ring_shift) & jb->ring_mask];
+	while (*jfp) {
+		/* offset is negative, so we found the position to insert frame */
+		if ((int32_t)(jf->timestamp - (*jfp)->timestamp) < 0)
+			break;
+		jfp = &((*jfp)->next);
+	}
+
 	/* insert or append frame */
 #ifdef HEAVY_DEBUG
 	#include <time.h>
@@ -343,31 +445,39 @@ void jitter_save(jitter_t *jb, jitter_frame_t *jf)
 #endif
 	jf->next = *jfp;
 	*jfp = jf;
+	jb->ring_count++;
 }
 
 /* get offset to next chunk, return -1, if there is no */
 int32_t jitter_offset(jitter_t *jb)
 {
 	jitter_frame_t *jf;
-	int16_t offset_timestamp = 0;
+	int32_t offset_timestamp;
+	uint32_t slot, i;
 
 	/* now unlock jitter buffer */
 	jb->unlocked = true;
 
-	/* get timestamp of chunk that is not in the past */
-	for (jf = jb->frame_list; jf; jf = jf->next) {
-		offset_timestamp = jf->timestamp - jb->window_timestamp;
-		if (offset_timestamp >= 0)
-			break;
+	if (!jb->ring_count)
+		return -1;
+
+	/* get timestamp of chunk that is not in the past, search slots from window up to the ring limit */
+	slot = jb->window_timestamp >> jb->ring_shift;
+	for (i = 0; i <= (jb->ring_mask + 1) / 2; i++) {
+		for (jf = jb->ring[(slot + i) & jb->ring_mask]; jf; jf = jf->next) {
+			offset_timestamp = jf->timestamp - jb->window_timestamp;
+			if (offset_timestamp >= 0)
+				return offset_timestamp;
+		}
 	}
 
-	return (jf) ? offset_timestamp : -1;
+	return -1;
 }
 
 /* get next data chunk from jitterbuffer */
 jitter_frame_t *jitter_load(jitter_t *jb)
 {
-	jitter_frame_t *jf;
+	jitter_frame_t **jfp, *jf;
 	int32_t offset_timestamp;
 
 #ifdef HEAVY_DEBUG
@@ -379,23 +489,27 @@ jitter_frame_t *jitter_load(jitter_t *jb)
 	/* now unlock jitter buffer */
 	jb->unlocked = true;
 
-	/* get current chunk, free all chunks that are in the past */
-	while ((jf = jb->frame_list)) {
+	if (!jb->ring_count)
+		return NULL;
+
+	/* get current chunk, free all chunks of this slot that are in the past
+	 * chunks of slots before have been freed when the window passed them */
+	jfp = &jb->ring[(jb->window_timestamp >> jb->ring_shift) & jb->ring_mask];
+	while ((jf = *jfp)) {
 		offset_timestamp = jf->timestamp - jb->window_timestamp;
 		if (offset_timestamp >= 0)
 			break;
 		/* detach and free */
-		jb->frame_list = jf->next;
-		jitter_frame_free(jf);
+		ring_remove(jb, jfp);
 	}
 
 	/* next frame in the future */
-	if (jf && jf->timestamp != jb->window_timestamp)
+	if (!jf || jf->timestamp != jb->window_timestamp)
 		return NULL;
 
 	/* detach, and return */
-	if (jf)
-		jb->frame_list = jf->next;
+	*jfp = jf->next;
+	jb->ring_count--;
 	return jf;
 }
 
@@ -407,6 +521,9 @@ void jitter_advance(jitter_t *jb, uint32_t offset)
 
 	jb->window_timestamp += offset;
 
+	/* remove frames that have been passed, including the slot of the window */
+	ring_clean(jb, (jb->window_timestamp >> jb->ring_shift) - jb->ring_slot + 1);
+
 	/* increment timer to check delay */
 	jb->delay_counter += jb->sample_duration * (double)offset;
 }
@@ -429,8 +546,9 @@ void jitter_load_samples(jitter_t *jb, uint8_t *spl, int len, size_t sample_size
 	int32_t offset_timestamp;
 	char debug[jb->max_window_size + 32];
 	int last = 0;
+	uint32_t slot;
 	memset(debug, ' ', sizeof(debug));
-	for (jf = jb->frame_list; jf; jf = jf->next) {
+	for (slot = 0; slot <= jb->ring_mask; slot++) for (jf = jb->ring[slot]; jf; jf = jf->next) {
 		offset_timestamp = jf->timestamp - jb->window_timestamp;
 		if (offset_timestamp < 0)
 			continue;
@@ -488,6 +606,8 @@ copy_chunk:
 		if (!jb->spl_buf) {
 			jb->spl_len = jb->samples_20ms;
 			jb->spl_buf = calloc(jb->spl_len, sample_size);
+			jb->spl_size = jb->spl_len * sample_size;
+			jb->alloc_count++;
 		}
 		/* do until all samples are processed */
 		while (offset) {
@@ -519,23 +639,32 @@ copy_chunk:
 #endif
 	/* get data from frame */
 	jitter_frame_get(jf, &decoder, &decoder_priv, &payload, &payload_len, NULL, NULL, NULL, NULL);
-	/* free previous buffer */
-	free(jb->spl_buf);
-	jb->spl_buf = NULL;
 	jb->spl_pos = 0;
 	/* decode */
 	if (decoder) {
+		/* free previous buffer, the decoder allocates a new one */
+		free(jb->spl_buf);
+		jb->spl_buf = NULL;
 		decoder(payload, payload_len, &jb->spl_buf, &jb->spl_len, decoder_priv);
+		jb->alloc_count++;
 		if (!jb->spl_buf) {
+			jb->spl_size = 0;
 			jitter_frame_free(jf);
 			return;
 		}
+		jb->spl_size = jb->spl_len;
 	} else {
-		/* no decoder, so just copy as it is */
-		jb->spl_buf = malloc(payload_len);
-		if (!jb->spl_buf) {
-			jitter_frame_free(jf);
-			return;
+		/* no decoder, so just copy as it is, reuse previous buffer, if large enough */
+		if (jb->spl_size < payload_len) {
+			free(jb->spl_buf);
+			jb->spl_buf = malloc(payload_len);
+			jb->alloc_count++;
+			if (!jb->spl_buf) {
+				jb->spl_size = 0;
+				jitter_frame_free(jf);
+				return;
+			}
+			jb->spl_size = payload_len;
 		}
 		memcpy(jb->spl_buf, payload, payload_len);
 		jb->spl_len = payload_len;
@@ -13,6 +13,8 @@
 
 typedef struct jitter_frame {
 	struct jitter_frame *next;
+	struct jitter *jb;		/* jitter buffer that owns the frame (pool) */
+	int capacity;			/* size of data that fits into the frame */
 	void (*decoder)(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void *priv);
 	void *decoder_priv;
 	uint8_t marker;
@@ -44,11 +46,23 @@ typedef struct jitter {
 	double delay_counter;		/* current counter to count interval (seconds) */
 	int min_delay;			/* minimum delay measured during interval (frames) */
 
-	/* list of frames */
-	jitter_frame_t *frame_list;
+	/* ring of frames, indexed by timestamp */
+	jitter_frame_t **ring;		/* slots of ring, each slot has a list of frames */
+	int ring_shift;			/* duration of a slot (1 << ring_shift samples) */
+	uint32_t ring_mask;		/* number of slots - 1 */
+	int32_t ring_limit;		/* frames must be stored below this offset */
+	int ring_count;			/* number of frames in ring */
+	uint32_t ring_slot;		/* slot of window, slots before have been cleaned */
+
+	/* pool of unused frames */
+	jitter_frame_t *frame_pool;	/* list of unused frames */
+	int pool_count;			/* number of frames in pool */
+	int alloc_count;		/* number of memory allocations */
+	int alloc_stat;			/* number of memory allocations at last statistics */
 
 	/* sample buffer (optional) */
 	uint8_t *spl_buf;		/* current samples buffer */
+	int spl_size;			/* allocated size of buffer (bytes) */
 	int spl_pos;			/* position of in buffer */
 	int spl_len;			/* total buffer size */
 	bool spl_valid;			/* if buffer has valid frame (not repeated) */
@@ -58,7 +72,7 @@ typedef struct jitter {
 int jitter_create(jitter_t *jb, const char *name, double samplerate, double target_window_duration, double max_window_duration, uint32_t window_flags);
 void jitter_reset(jitter_t *jb);
 void jitter_destroy(jitter_t *jb);
-jitter_frame_t *jitter_frame_alloc(void (*decoder)(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void *priv), void *decoder_priv, uint8_t *data, int size, uint8_t marker, uint16_t sequence, uint32_t timestamp, uint32_t ssrc);
+jitter_frame_t *jitter_frame_alloc(jitter_t *jb, void (*decoder)(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void *priv), void *decoder_priv, uint8_t *data, int size, uint8_t marker, uint16_t sequence, uint32_t timestamp, uint32_t ssrc);
 void jitter_frame_free(jitter_frame_t *jf);
 void jitter_frame_get(jitter_frame_t *jf, void (**decoder)(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void *priv), void **decoder_priv, uint8_t **data, int *size, uint8_t *marker, uint16_t *sequence, uint32_t *timestamp, uint32_t *ssrc);
 void jitter_save(jitter_t *jb, jitter_frame_t *jf);
@@ -0,0 +1,262 @@
+/* Clock of the processing loop: sleep or wait for audio
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * In sleep mode, the processing loop sleeps for the rest of the interval.
+ * Samples that are received just after the loop went to sleep wait for up to
+ * one interval plus the time the loop takes.
+ *
+ * In event mode, every audio master gives file descriptors that become
+ * readable when samples of one interval can be read. (ALSA gives its poll
+ * descriptors with 'avail_min' set to one interval, SDR gives the eventfd of
+ * the ring buffer that is written by the read thread.) These are registered
+ * to the select loop, and osmo_select_main() is called, until one of them
+ * becomes readable. Timers and other file descriptors are handled meanwhile.
+ * After waking up, all descriptors are unregistered, so that the polling of
+ * the select loop does not return at once, until audio has been processed.
+ *
+ * If no audio arrives, a timeout makes sure that TX audio and the call clock
+ * are still processed. It is half of the time that is processed in advance,
+ * so the TX buffer does not run empty.
+ *
+ * The time between two processing cycles is the latency that the loop adds
+ * to received samples. It is measured in both modes and a histogram is
+ * logged on exit.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "sender.h"
+#include <osmocom/core/timer.h>
+#include <osmocom/core/select.h>
+#include "audio_clock.h"
+
+#define MAX_POLL_FDS		4	/* file descriptors of each audio master */
+#define HISTOGRAM_STEP		0.5	/* milliseconds each histogram entry */
+#define HISTOGRAM_SIZE		40
+
+/* file descriptors of one audio master */
+struct audio_clock_master {
+	sender_t		*sender;
+	struct pollfd		pfd[MAX_POLL_FDS];
+	int			num;
+};
+
+static struct audio_clock {
+	int			event;			/* wait for audio instead of sleeping */
+	double			interval;		/* interval in seconds */
+	int			timeout;		/* maximum wait for audio in microseconds */
+	struct audio_clock_master master[MAX_SENDER];
+	int			num_masters;
+	struct osmo_fd		ofd[MAX_SENDER * MAX_POLL_FDS];
+	int			num_fds;		/* number of registered file descriptors */
+	struct osmo_timer_list	timer;			/* timeout while waiting */
+	int			ready;			/* audio is ready or timeout */
+	double			last_tick;		/* time of last processing cycle */
+	uint32_t		histogram[HISTOGRAM_SIZE + 1]; /* last entry counts all above */
+	uint32_t		count;
+	double			sum, max;
+} audio_clock;
+
+/* get_time() uses real time clock, which may jump */
+static double get_time_monotonic(void)
+{
+	struct timespec tv;
+
+	clock_gettime(CLOCK_MONOTONIC, &tv);
+
+	return (double)tv.tv_sec + (double)tv.tv_nsec / 1000000000.0;
+}
+
+static int audio_clock_cb(struct osmo_fd *ofd, unsigned int what)
+{
+	struct audio_clock_master *m = ofd->data;
+	struct pollfd *pfd = &m->pfd[ofd->priv_nr];
+
+	pfd->revents = 0;
+	if ((what & OSMO_FD_READ))
+		pfd->revents |= POLLIN;
+	if ((what & OSMO_FD_WRITE))
+		pfd->revents |= POLLOUT;
+	if ((what & OSMO_FD_EXCEPT))
+		pfd->revents |= POLLPRI;
+
+	if (m->sender->audio_poll_revents(m->sender->audio, m->pfd, m->num))
+		audio_clock.ready = 1;
+
+	return 0;
+}
+
+static void audio_clock_timeout(void __attribute__((unused)) *data)
+{
+	audio_clock.ready = 1;
+}
+
+int audio_clock_init(int event, double interval, int buffer)
+{
+	sender_t *master;
+
+	memset(&audio_clock, 0, sizeof(audio_clock));
+	audio_clock.event = event;
+	audio_clock.interval = interval / 1000.0;
+	/* half of the buffer, but at least two intervals */
+	audio_clock.timeout = buffer * 1000 / 2;
+	if (audio_clock.timeout < interval * 2000.0)
+		audio_clock.timeout = interval * 2000.0;
+	osmo_timer_setup(&audio_clock.timer, audio_clock_timeout, NULL);
+
+	if (!event)
+		return 0;
+
+	for (master = sender_head; master; master = master->next) {
+		/* skip audio slaves */
+		if (master->master)
+			continue;
+		if (!master->audio_poll_fds || !master->audio_poll_revents) {
+			LOGP(DSENDER, LOGL_ERROR, "Audio device of channel %s cannot be used to clock the processing loop.\n", master->kanal);
+			return -ENOTSUP;
+		}
+	}
+
+	return 0;
+}
+
+static void unregister_fds(void)
+{
+	int i;
+
+	for (i = 0; i < audio_clock.num_fds; i++)
+		osmo_fd_unregister(&audio_clock.ofd[i]);
+	audio_clock.num_fds = 0;
+	audio_clock.num_masters = 0;
+}
+
+void audio_clock_exit(void)
+{
+	int i;
+
+	unregister_fds();
+	osmo_timer_del(&audio_clock.timer);
+
+	if (!audio_clock.count)
+		return;
+
+	LOGP(DSENDER, LOGL_INFO, "Processing loop (%s mode): %u cycles, average period %.3f ms, maximum %.3f ms\n", (audio_clock.event) ? "event" : "sleep", audio_clock.count, audio_clock.sum / audio_clock.count * 1000.0, audio_clock.max * 1000.0);
+	for (i = 0; i < HISTOGRAM_SIZE; i++) {
+		if (!audio_clock.histogram[i])
+			continue;
+		LOGP(DSENDER, LOGL_INFO, " %5.1f .. %5.1f ms: %8u (%5.1f %%)\n", HISTOGRAM_STEP * i, HISTOGRAM_STEP * (i + 1), audio_clock.histogram[i], (double)audio_clock.histogram[i] * 100.0 / audio_clock.count);
+	}
+	if (audio_clock.histogram[HISTOGRAM_SIZE])
+		LOGP(DSENDER, LOGL_INFO, " %5.1f ..       ms: %8u (%5.1f %%)\n", HISTOGRAM_STEP * HISTOGRAM_SIZE, audio_clock.histogram[HISTOGRAM_SIZE], (double)audio_clock.histogram[HISTOGRAM_SIZE] * 100.0 / audio_clock.count);
+}
+
+/* call at the beginning of each processing cycle */
+void audio_clock_tick(void)
+{
+	double now = get_time_monotonic(), period;
+	int index;
+
+	if (audio_clock.last_tick) {
+		period = now - audio_clock.last_tick;
+		index = period * 1000.0 / HISTOGRAM_STEP;
+		if (index > HISTOGRAM_SIZE)
+			index = HISTOGRAM_SIZE;
+		audio_clock.histogram[index]++;
+		audio_clock.count++;
+		audio_clock.sum += period;
+		if (period > audio_clock.max)
+			audio_clock.max = period;
+	}
+	audio_clock.last_tick = now;
+}
+
+/* register file descriptors of all audio masters, return 1 if audio can be read already */
+static int register_fds(void)
+{
+	sender_t *master;
+	struct audio_clock_master *m;
+	struct pollfd *pfd;
+	struct osmo_fd *ofd;
+	int num, i;
+
+	for (master = sender_head; master; master = master->next) {
+		/* skip audio slaves */
+		if (master->master)
+			continue;
+		/* keep descriptors of each master, so their events can be translated by the audio driver */
+		m = &audio_clock.master[audio_clock.num_masters];
+		num = master->audio_poll_fds(master->audio, m->pfd, MAX_POLL_FDS);
+		if (num < 0) {
+			LOGP(DSENDER, LOGL_ERROR, "Failed to get file descriptors of audio device (rc = %d), using sleep mode.\n", num);
+			audio_clock.event = 0;
+			return -EIO;
+		}
+		if (num == 0)
+			return 1;
+		m->sender = master;
+		m->num = num;
+		audio_clock.num_masters++;
+		for (i = 0; i < num; i++) {
+			pfd = &m->pfd[i];
+			pfd->revents = 0;
+			ofd = &audio_clock.ofd[audio_clock.num_fds++];
+			osmo_fd_setup(ofd, pfd->fd, ((pfd->events & POLLIN) ? OSMO_FD_READ : 0) | ((pfd->events & POLLOUT) ? OSMO_FD_WRITE : 0) | ((pfd->events & POLLPRI) ? OSMO_FD_EXCEPT : 0), audio_clock_cb, m, i);
+			osmo_fd_register(ofd);
+		}
+	}
+
+	return 0;
+}
+
+/* call at the end of each processing cycle */
+void audio_clock_wait(int *quit)
+{
+	double sleep;
+	int rc;
+
+	if (audio_clock.event) {
+		audio_clock.ready = 0;
+		rc = register_fds();
+		if (rc == 0) {
+			osmo_timer_schedule(&audio_clock.timer, audio_clock.timeout / 1000000, audio_clock.timeout % 1000000);
+			while (!audio_clock.ready && !(*quit))
+				osmo_select_main(0);
+			osmo_timer_del(&audio_clock.timer);
+		}
+		unregister_fds();
+		if (rc >= 0)
+			return;
+	}
+
+	/* sleep interval */
+	sleep = audio_clock.interval - (get_time_monotonic() - audio_clock.last_tick);
+	if (sleep > 0)
+		usleep(sleep * 1000000.0);
+}
+
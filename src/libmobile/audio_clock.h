@@ -0,0 +1,6 @@
+
+int audio_clock_init(int event, double interval, int buffer);
+void audio_clock_exit(void);
+void audio_clock_tick(void);
+void audio_clock_wait(int *quit);
+
@@ -102,6 +102,111 @@ static struct osmo_cc_helper_audio_codecs codecs[] = {
 
 static int no_l16 = 0;
 
+/* The encoders of the codecs allocate memory for each frame. To encode into a
+ * buffer of the caller, L16 is encoded directly and the encoders with one byte
+ * per sample (G.711) are replaced by a table. The table is generated once by
+ * encoding all 65536 sample values with the codec's encoder. */
+static struct encode_table {
+	void (*encoder)(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void *priv);
+	uint8_t *table;
+} encode_tables[] = {
+	{ g711_encode_alaw, NULL },
+	{ g711_encode_ulaw, NULL },
+	{ NULL, NULL },
+};
+
+static int encode_allocs = 0;	/* number of frames encoded with memory allocation */
+
+static void encode_tables_init(void)
+{
+	int16_t *spl;
+	uint8_t *data;
+	int i, len;
+
+	spl = malloc(65536 * sizeof(*spl));
+	if (!spl)
+		return;
+	for (i = 0; i < 65536; i++)
+		spl[i] = i;
+	for (i = 0; encode_tables[i].encoder; i++) {
+		data = NULL;
+		encode_tables[i].encoder((uint8_t *)spl, 65536 * sizeof(*spl), &data, &len, NULL);
+		if (data && len == 65536)
+			encode_tables[i].table = data;
+		else
+			free(data);
+	}
+	free(spl);
+}
+
+static void encode_tables_exit(void)
+{
+	int i;
+
+	for (i = 0; encode_tables[i].encoder; i++) {
+		free(encode_tables[i].table);
+		encode_tables[i].table = NULL;
+	}
+}
+
+/* encode samples into given payload buffer, it must hold 2 bytes per sample
+ * return length of payload */
+static int encode_audio(osmo_cc_session_codec_t *codec, int16_t *spl, int len, uint8_t *payload, void *priv)
+{
+	uint8_t *data, *table;
+	int data_len, i, t;
+
+	if (codec->encoder == encode_l16) {
+		for (i = 0; i < len; i++)
+			((uint16_t *)payload)[i] = htons(spl[i]);
+		return len * 2;
+	}
+
+	for (t = 0; encode_tables[t].encoder; t++) {
+		table = encode_tables[t].table;
+		if (codec->encoder == encode_tables[t].encoder && table) {
+			for (i = 0; i < len; i++)
+				payload[i] = table[(uint16_t)spl[i]];
+			return len;
+		}
+	}
+
+	/* other codecs */
+	data = NULL;
+	codec->encoder((uint8_t *)spl, len * 2, &data, &data_len, priv);
+	encode_allocs++;
+	if (!data)
+		return 0;
+	if (data_len > len * 2) {
+		LOGP(DCALL, LOGL_ERROR, "Encoded frame of %d bytes exceeds buffer, please fix!\n", data_len);
+		data_len = len * 2;
+	}
+	memcpy(payload, data, data_len);
+	free(data);
+	return data_len;
+}
+
+/* return 1, if the codec encodes each sample on its own, so that frames can
+ * be taken from a tone that is encoded once at any position */
+static int encode_per_sample(osmo_cc_session_codec_t *codec)
+{
+	int t;
+
+	if (codec->encoder == encode_l16)
+		return 1;
+	for (t = 0; encode_tables[t].encoder; t++) {
+		if (codec->encoder == encode_tables[t].encoder && encode_tables[t].table)
+			return 1;
+	}
+	return 0;
+}
+
+/* encode tone for all processes, see tones_read_encoded() */
+static int encode_tone(void *priv, int16_t *spl, int len, uint8_t *payload)
+{
+	return encode_audio(priv, spl, len, payload, NULL);
+}
+
 enum process_state {
 	PROCESS_IDLE = 0,	/* IDLE */
 	PROCESS_SETUP_RO,	/* call from radio to OSMO-CC */
@@ -452,7 +557,7 @@ void call_up_audio(int callref, sample_t *samples, int len)
 {
 	process_t *process;
 	int16_t spl[len];
-	uint8_t *payload;
+	uint8_t payload[len * 2];
 	int payload_len;
 
 	if (len != 160) {
@@ -479,37 +584,54 @@ void call_up_audio(int callref, sample_t *samples, int len)
 	/* real to integer */
 	samples_to_int16_speech(spl, samples, len);
 	/* encode and send via RTP */
-	process->codec->encoder((uint8_t *)spl, len * 2, &payload, &payload_len, process);
+	payload_len = encode_audio(process->codec, spl, len, payload, process);
 	osmo_cc_rtp_send(process->codec, payload, payload_len, 0, 1, len);
-	free(payload);
 	/* don't destroy process here in case of an error */
 }
 
 /* clock that is used to transmit patterns */
 void call_clock(void)
 {
+	static int clock_count = 0;
 	process_t *process = process_head;
 
 	call_down_clock();
 
+	/* show encoder allocations once a second (50 * 20ms) */
+	if (++clock_count == 50) {
+		clock_count = 0;
+		if (encode_allocs)
+			LOGP(DCALL, LOGL_DEBUG, "Encoder allocated memory %d times per second.\n", encode_allocs);
+		encode_allocs = 0;
+	}
+
 	while(process) {
 		if (process->tones.tone != TONES_TONE_OFF) {
 			int16_t spl[160];
-			uint8_t *payload;
+			uint8_t payload[160 * 2], *data = NULL;
 			int payload_len;
-			/* try to get patterns, else copy the samples we got */
-			tones_read_tone(&process->tones, spl, 160);
+#ifndef DEBUG_LEVEL
+			/* take the frame from the tone that is encoded once for all processes */
+			if (encode_per_sample(process->codec))
+				data = tones_read_encoded(&process->tones, (const void *)process->codec->encoder, encode_tone, process->codec, 160, &payload_len);
+#endif
+			if (!data) {
+				/* try to get patterns, silence between patterns */
+				memset(spl, 0, sizeof(spl));
+				tones_read_tone(&process->tones, spl, 160);
 #ifdef DEBUG_LEVEL
-			sample_t samples[160];
-			int16_to_samples(samples, (int16_t *)spl->data, 160);
-			double lev = level_of(samples, 160);
-			printf("   mobil-level: %s%.4f\n", debug_db(lev), (20 * log10(lev)));
-			samples_to_int16(spl, samples, 160);
+				sample_t samples[160];
+				int16_to_samples(samples, (int16_t *)spl->data, 160);
+				double lev = level_of(samples, 160);
+				printf("   mobil-level: %s%.4f\n", debug_db(lev), (20 * log10(lev)));
+				samples_to_int16(spl, samples, 160);
 #endif
-			/* encode and send via RTP */
-			process->codec->encoder((uint8_t *)spl, 160 * 2, &payload, &payload_len, process);
-			osmo_cc_rtp_send(process->codec, payload, payload_len, 0, 1, 160);
-			free(payload);
+				/* encode */
+				payload_len = encode_audio(process->codec, spl, 160, payload, process);
+				data = payload;
+			}
+			/* send via RTP */
+			osmo_cc_rtp_send(process->codec, data, payload_len, 0, 1, 160);
 			/* don't destroy process here in case of an error */
 		}
 		process = process->next;
@@ -776,6 +898,7 @@ int call_init(const char *name, int _send_patterns, int _release_on_disconnect,
 	release_on_disconnect = _release_on_disconnect;
 
 	g711_init();
+	encode_tables_init();
 	rc = tones_init(&call_tones, toneset, TONES_TDATA_SLIN16HOST);
 	if (rc > 0) {
 		LOGP(DCALL, LOGL_INFO, "Failed to initialize tone set '%s'. Please fix!\n", toneset);
@@ -796,6 +919,7 @@ int call_init(const char *name, int _send_patterns, int _release_on_disconnect,
 void call_exit(void)
 {
 	tones_exit(&call_tones);
+	encode_tables_exit();
 	if (ep) {
 		osmo_cc_delete(ep);
 		ep = NULL;
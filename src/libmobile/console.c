@@ -35,7 +35,7 @@
 #include <osmocom/cc/endpoint.h>
 #include <osmocom/cc/helper.h>
 #include <osmocom/cc/rtp.h>
-#include "testton.h"
+#include "../libsamplestore/samplestore.h"
 #include "console.h"
 #include "cause.h"
 #include "../libmobile/call.h"
@@ -97,20 +97,38 @@ static struct osmo_cc_helper_audio_codecs codecs[] = {
 	{ NULL, 0, 0, NULL, NULL},
 };
 
-/* stream test music */
-int16_t *test_spl = NULL;
-int test_size = 0;
-int test_max = 0;
+/* stream test music, taken from sample store when used the first time */
+static const int16_t *test_spl = NULL;
+static int test_size = 0;
+static int test_max = 0;
+static int test_loaded = 0;
+
+static void load_test_patterns(void)
+{
+	test_loaded = 1;
+	test_spl = samplestore_get("testton", &test_size);
+	if (!test_spl)
+		test_size = 0;
+	test_max = test_size;
+}
 
 static void get_test_patterns(int16_t *samples, int length)
 {
 	const int16_t *spl;
 	int size, max, pos;
 
+	if (!test_loaded)
+		load_test_patterns();
 	spl = test_spl;
 	size = test_size;
 	max = test_max;
 
+	/* no test music */
+	if (!size) {
+		memset(samples, 0, length * sizeof(*samples));
+		return;
+	}
+
 	/* stream sample */
 	pos = console.test_audio_pos;
 	while(length--) {
@@ -146,7 +164,7 @@ static void up_audio(struct osmo_cc_session_codec *codec, uint8_t marker, uint16
 	/* save audio from transceiver to jitter buffer */
 	if (console.sound) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(codec->decoder, &console, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&console.dejitter, codec->decoder, &console, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (!jf)
 			return;
 		jitter_save(&console.dejitter, jf);
@@ -349,8 +367,6 @@ int console_init(const char *audiodev, int samplerate, int buffer, int loopback,
 	int rc = 0;
 	int i;
 
-	init_testton();
-
 	/* Put scrolling window one line above bottom. */
 	logging_limit_scroll_bottom(1);
 
@@ -438,6 +454,12 @@ void console_cleanup(void)
 
 	jitter_destroy(&console.dejitter);
 
+	exit_samplerate(&console.srstate);
+
+	test_spl = NULL;
+	test_size = test_max = 0;
+	test_loaded = 0;
+
 	if (console.session) {
 		osmo_cc_free_session(console.session);
 		console.session = NULL;
@@ -0,0 +1,265 @@
+/* Worker pool to process audio of transceivers in parallel
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * Each audio master (transceiver that owns an audio device or SDR) is a job.
+ * Processing is done in three stages:
+ *
+ * 1. The main thread gets TX samples from the protocol of every instance.
+ * 2. The audio of all masters is processed in parallel: Emphasis, gain, wave
+ *    files, writing to and reading from audio device. (With SDR, this
+ *    includes modulation, demodulation and filtering.)
+ * 3. The main thread forwards RX samples to the protocol of every instance.
+ *
+ * So all protocol state, timers and call control are handled by the main
+ * thread only. Stage 2 does not touch anything but the audio master, its
+ * slaves and the audio device.
+ *
+ * The main thread starts stage 2 by incrementing the generation and waking
+ * up the worker threads. Then it takes jobs itself, until no job is left.
+ * After all jobs are done, it continues with stage 3. If one master takes
+ * long, others are processed by other threads meanwhile.
+ *
+ * The processing time of stage 2 is measured for each master and shown in the
+ * measurements display. The average and maximum are logged on exit.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#define __USE_GNU
+#include <pthread.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "sender.h"
+#include "dsp_pool.h"
+
+/* get_time() is not thread safe */
+static double get_time_thread(void)
+{
+	struct timespec tv;
+
+	clock_gettime(CLOCK_MONOTONIC, &tv);
+
+	return (double)tv.tv_sec + (double)tv.tv_nsec / 1000000000.0;
+}
+
+/* process jobs until all jobs are taken */
+static void dsp_pool_run(dsp_pool_t *pool)
+{
+	dsp_job_t *job;
+	double start, duration;
+
+	while (1) {
+		pthread_mutex_lock(&pool->mutex);
+		if (pool->next_job == pool->num_jobs) {
+			pthread_mutex_unlock(&pool->mutex);
+			break;
+		}
+		job = &pool->job[pool->next_job++];
+		pthread_mutex_unlock(&pool->mutex);
+
+		/* no TX samples and no RX processing, if getting TX samples failed */
+		if (job->count >= 0) {
+			start = get_time_thread();
+			job->count = sender_audio_device(job->sender, &job->quit, job->samples, job->power, job->count, pool->buffer_size, job->rf_level_db);
+			duration = get_time_thread() - start;
+			job->duration = duration;
+			job->time_sum += duration;
+			job->time_count++;
+			if (duration > job->time_max)
+				job->time_max = duration;
+		}
+
+		pthread_mutex_lock(&pool->mutex);
+		if (++pool->done_jobs == pool->num_jobs)
+			pthread_cond_signal(&pool->done_cond);
+		pthread_mutex_unlock(&pool->mutex);
+	}
+}
+
+static void *dsp_pool_child(void *arg)
+{
+	dsp_pool_t *pool = (dsp_pool_t *)arg;
+	int generation = 0;
+
+	pthread_mutex_lock(&pool->mutex);
+	while (1) {
+		while (!pool->exit && pool->generation == generation)
+			pthread_cond_wait(&pool->start_cond, &pool->mutex);
+		if (pool->exit)
+			break;
+		generation = pool->generation;
+		pthread_mutex_unlock(&pool->mutex);
+		dsp_pool_run(pool);
+		pthread_mutex_lock(&pool->mutex);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	return NULL;
+}
+
+int dsp_pool_init(dsp_pool_t *pool, int num_threads, int buffer_size, double interval)
+{
+	sender_t *master, *inst;
+	dsp_job_t *job;
+	pthread_t tid;
+	char tname[64];
+	int i;
+	int rc;
+
+	memset(pool, 0, sizeof(*pool));
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->start_cond, NULL);
+	pthread_cond_init(&pool->done_cond, NULL);
+	pool->buffer_size = buffer_size;
+
+	/* one job for each audio master */
+	for (master = sender_head; master; master = master->next) {
+		/* skip audio slaves */
+		if (master->master)
+			continue;
+		job = &pool->job[pool->num_jobs++];
+		job->sender = master;
+		for (job->num_chan = 0, inst = master; inst; job->num_chan++, inst = inst->slave);
+		job->samples = calloc(job->num_chan, sizeof(*job->samples));
+		job->power = calloc(job->num_chan, sizeof(*job->power));
+		job->rf_level_db = calloc(job->num_chan, sizeof(*job->rf_level_db));
+		if (!job->samples || !job->power || !job->rf_level_db) {
+			fprintf(stderr, "No mem!\n");
+			rc = -ENOMEM;
+			goto error;
+		}
+		for (i = 0; i < job->num_chan; i++) {
+			job->samples[i] = calloc(buffer_size, sizeof(**job->samples));
+			job->power[i] = calloc(buffer_size, sizeof(**job->power));
+			if (!job->samples[i] || !job->power[i]) {
+				fprintf(stderr, "No mem!\n");
+				rc = -ENOMEM;
+				goto error;
+			}
+		}
+		job->dmp_dsp_time = display_measurements_add(&master->dispmeas, "DSP Time", "%.3f ms", DISPLAY_MEAS_AVG, DISPLAY_MEAS_LEFT, 0.0, interval, interval);
+	}
+
+	/* the main thread processes jobs too */
+	if (num_threads > pool->num_jobs - 1)
+		num_threads = pool->num_jobs - 1;
+	if (num_threads < 1)
+		LOGP(DSENDER, LOGL_NOTICE, "Only one audio device is used, so there is nothing to process in parallel.\n");
+
+	for (i = 0; i < num_threads; i++) {
+		rc = pthread_create(&tid, NULL, dsp_pool_child, pool);
+		if (rc) {
+			LOGP(DSENDER, LOGL_ERROR, "Failed to create thread!\n");
+			rc = -rc;
+			goto error;
+		}
+		pool->tid[pool->num_threads++] = tid;
+		pthread_getname_np(tid, tname, sizeof(tname));
+		strncat(tname, "-dsp", sizeof(tname) - 4 - 1);
+		tname[sizeof(tname) - 1] = '\0';
+		pthread_setname_np(tid, tname);
+	}
+
+	LOGP(DSENDER, LOGL_INFO, "Processing audio of %d audio devices with %d worker threads.\n", pool->num_jobs, pool->num_threads);
+
+	return 0;
+
+error:
+	dsp_pool_exit(pool);
+	return rc;
+}
+
+void dsp_pool_exit(dsp_pool_t *pool)
+{
+	dsp_job_t *job;
+	int i, j;
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->exit = 1;
+	pthread_cond_broadcast(&pool->start_cond);
+	pthread_mutex_unlock(&pool->mutex);
+	for (i = 0; i < pool->num_threads; i++)
+		pthread_join(pool->tid[i], NULL);
+	pool->num_threads = 0;
+
+	for (i = 0; i < pool->num_jobs; i++) {
+		job = &pool->job[i];
+		if (job->time_count)
+			LOGP(DSENDER, LOGL_INFO, "Channel %s: average DSP time %.3f ms, maximum %.3f ms\n", job->sender->kanal, job->time_sum / job->time_count * 1000.0, job->time_max * 1000.0);
+		for (j = 0; j < job->num_chan; j++) {
+			if (job->samples)
+				free(job->samples[j]);
+			if (job->power)
+				free(job->power[j]);
+		}
+		free(job->samples);
+		free(job->power);
+		free(job->rf_level_db);
+	}
+	pool->num_jobs = 0;
+
+	pthread_cond_destroy(&pool->done_cond);
+	pthread_cond_destroy(&pool->start_cond);
+	pthread_mutex_destroy(&pool->mutex);
+}
+
+/* process audio of all transceivers, protocol is called by this (main) thread only */
+void dsp_pool_process(dsp_pool_t *pool, int *quit)
+{
+	dsp_job_t *job;
+	int i;
+
+	/* stage 1: get TX samples from protocol */
+	for (i = 0; i < pool->num_jobs; i++) {
+		job = &pool->job[i];
+		job->quit = 0;
+		job->duration = 0.0;
+		job->count = sender_audio_tx(job->sender, &job->quit, job->samples, job->power, pool->buffer_size);
+	}
+
+	/* stage 2: process audio devices in parallel */
+	pthread_mutex_lock(&pool->mutex);
+	pool->next_job = 0;
+	pool->done_jobs = 0;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->start_cond);
+	pthread_mutex_unlock(&pool->mutex);
+	dsp_pool_run(pool);
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->done_jobs < pool->num_jobs)
+		pthread_cond_wait(&pool->done_cond, &pool->mutex);
+	pthread_mutex_unlock(&pool->mutex);
+
+	/* stage 3: forward RX samples to protocol */
+	for (i = 0; i < pool->num_jobs; i++) {
+		job = &pool->job[i];
+		if (job->quit)
+			*quit = 1;
+		display_measurements_update(job->dmp_dsp_time, job->duration * 1000.0, 0.0);
+		if (job->count > 0)
+			sender_audio_rx(job->sender, job->samples, job->count, job->rf_level_db);
+	}
+}
+
@@ -0,0 +1,37 @@
+#include <pthread.h>
+
+/* job of one audio master */
+typedef struct dsp_job {
+	sender_t		*sender;		/* audio master */
+	int			num_chan;		/* number of channels (master and slaves) */
+	sample_t		**samples;		/* sample buffer for each channel */
+	uint8_t			**power;		/* power buffer for each channel */
+	double			*rf_level_db;		/* RF level of each channel */
+	int			count;			/* samples to send (before), samples received (after processing) */
+	int			quit;			/* set, if processing wants us to quit */
+	double			duration;		/* processing time of last cycle */
+	double			time_sum;		/* processing time statistics */
+	double			time_max;
+	int			time_count;
+	dispmeasparam_t		*dmp_dsp_time;		/* display processing time */
+} dsp_job_t;
+
+typedef struct dsp_pool {
+	pthread_mutex_t		mutex;
+	pthread_cond_t		start_cond;		/* signals new generation of jobs to workers */
+	pthread_cond_t		done_cond;		/* signals completion of all jobs to main thread */
+	int			generation;		/* incremented for each processing cycle */
+	int			next_job;		/* next job to be taken */
+	int			done_jobs;		/* number of jobs completed */
+	int			exit;			/* tell worker threads to exit */
+	int			num_threads;		/* number of worker threads */
+	pthread_t		tid[MAX_SENDER];
+	int			num_jobs;		/* number of audio masters */
+	dsp_job_t		job[MAX_SENDER];
+	int			buffer_size;
+} dsp_pool_t;
+
+int dsp_pool_init(dsp_pool_t *pool, int num_threads, int buffer_size, double interval);
+void dsp_pool_exit(dsp_pool_t *pool);
+void dsp_pool_process(dsp_pool_t *pool, int *quit);
+
@@ -36,17 +36,21 @@
 #include "call.h"
 #include "console.h"
 #include "get_time.h"
+#include "dsp_pool.h"
+#include "audio_clock.h"
 #ifdef HAVE_SDR
 #include "../libsdr/sdr.h"
 #include "../libsdr/sdr_config.h"
 #endif
 #include "../liboptions/options.h"
 #include "../libfm/fm.h"
+#include "../libfilter/iir_filter.h"
 #include "../libaaimage/aaimage.h"
 
 #define DEFAULT_LO_OFFSET -1000000.0
 
 static int got_init = 0;
+static dsp_pool_t dsp_pool;
 
 /* common mobile settings */
 int num_kanal = 0;
@@ -78,6 +82,8 @@ int send_patterns = 1;
 static int release_on_disconnect = 1;
 int loopback = 0;
 int rt_prio = 0;
+int dsp_threads = 0;
+int audio_clock_event = 0;
 int fast_math = 0;
 const char *write_tx_wave = NULL;
 const char *write_rx_wave = NULL;
@@ -170,6 +176,9 @@ void main_mobile_init(const char *digits, const struct number_lengths lengths[],
 {
 	logging_init();
 
+	/* select filter kernels once, before any thread uses them */
+	iir_kernel_select(IIR_KERNEL_AUTO);
+
 	cc_argv[cc_argc++] = options_strdup("remote auto");
 
 	number_digits = digits;
@@ -304,6 +313,13 @@ void main_mobile_print_help(const char *arg0, const char *ext_usage)
 	printf("        Loopback test: 1 = internal | 2 = external | 3 = echo\n");
 	printf(" -r --realtime <prio>\n");
 	printf("        Set prio: 0 to disable, 99 for maximum (default = %d)\n", rt_prio);
+	printf("    --audio-clock sleep | event\n");
+	printf("        Sleep for the rest of the processing interval, or wait until audio\n");
+	printf("        samples are received. Waiting reduces latency and wakeups when idle.\n");
+	printf("        (default = '%s')\n", (audio_clock_event) ? "event" : "sleep");
+	printf("    --dsp-threads <num>\n");
+	printf("        Process audio devices in parallel by given number of worker threads.\n");
+	printf("        Only useful with multiple audio devices. (default = %d = disabled)\n", dsp_threads);
 	printf("    --fast-math\n");
 	printf("        Use fast math approximation for slow CPU / ARM based systems.\n");
 	printf("    --write-rx-wave <file>\n");
@@ -380,6 +396,8 @@ void main_mobile_print_hotkeys(void)
 #define	OPT_CALL_BUFFER		1009
 #define	OPT_FAST_MATH		1010
 #define	OPT_NO_L16		1011
+#define	OPT_DSP_THREADS		1012
+#define	OPT_AUDIO_CLOCK		1013
 #define	OPT_LIMESDR		1100
 #define	OPT_LIMESDR_MINI	1101
 
@@ -408,6 +426,8 @@ void main_mobile_add_options(void)
 	option_add('t', "tones", 1);
 	option_add('l', "loopback", 1);
 	option_add('r', "realtime", 1);
+	option_add(OPT_AUDIO_CLOCK, "audio-clock", 1);
+	option_add(OPT_DSP_THREADS, "dsp-threads", 1);
 	option_add(OPT_FAST_MATH, "fast-math", 0);
 	option_add(OPT_WRITE_RX_WAVE, "write-rx-wave", 1);
 	option_add(OPT_WRITE_TX_WAVE, "write-tx-wave", 1);
@@ -520,6 +540,23 @@ int main_mobile_handle_options(int short_option, int argi, char **argv)
 	case 'r':
 		rt_prio = atoi(argv[argi]);
 		break;
+	case OPT_AUDIO_CLOCK:
+		if (!strcmp(argv[argi], "sleep"))
+			audio_clock_event = 0;
+		else if (!strcmp(argv[argi], "event"))
+			audio_clock_event = 1;
+		else {
+			fprintf(stderr, "Given audio clock '%s' is invalid, use 'sleep' or 'event'.\n", argv[argi]);
+			return -EINVAL;
+		}
+		break;
+	case OPT_DSP_THREADS:
+		dsp_threads = atoi(argv[argi]);
+		if (dsp_threads < 0)
+			dsp_threads = 0;
+		if (dsp_threads > MAX_SENDER)
+			dsp_threads = MAX_SENDER;
+		break;
 	case OPT_FAST_MATH:
 		fast_math = 1;
 		break;
@@ -618,7 +655,7 @@ void main_mobile_loop(const char *name, int *quit, void (*myhandler)(void), cons
 {
 	int buffer_size;
 	sender_t *sender;
-	double last_time_call = 0, begin_time, now, sleep;
+	double last_time_call = 0, now;
 	struct termios term, term_orig;
 	int num_chan, i;
 	int c;
@@ -689,6 +726,11 @@ void main_mobile_loop(const char *name, int *quit, void (*myhandler)(void), cons
 	rc = sdr_configure(dsp_samplerate);
 	if (rc < 0)
 		return;
+	/* when running faster than real time, wait for IQ samples instead of sleeping */
+	if (use_sdr && sdr_config->iq_free_running && !audio_clock_event) {
+		LOGP(DSENDER, LOGL_NOTICE, "IQ file is free running, using event driven audio clock.\n");
+		audio_clock_event = 1;
+	}
 #endif
 
 	/* open audio */
@@ -720,6 +762,15 @@ void main_mobile_loop(const char *name, int *quit, void (*myhandler)(void), cons
 		}
 	}
 
+	/* worker threads inherit real time priority */
+	if (dsp_threads > 0) {
+		rc = dsp_pool_init(&dsp_pool, dsp_threads, buffer_size, dsp_interval);
+		if (rc < 0) {
+			fprintf(stderr, "Failed to create worker threads. Quitting!\n");
+			return;
+		}
+	}
+
 	if (!loopback)
 		print_aaimage();
 
@@ -743,16 +794,23 @@ void main_mobile_loop(const char *name, int *quit, void (*myhandler)(void), cons
 	if (console_start_audio())
 		*quit = 1;
 
+	if (audio_clock_init(audio_clock_event, dsp_interval, dsp_buffer))
+		*quit = 1;
+
 	while(!(*quit)) {
 		int work;
-		begin_time = get_time();
+		audio_clock_tick();
 
 		/* process sound of all transceivers */
-		for (sender = sender_head; sender; sender = sender->next) {
-			/* do not process audio for an audio slave, since it is done by audio master */
-			if (sender->master) /* if master is set, we are an audio slave */
-				continue;
-			process_sender_audio(sender, quit, samples, powers, buffer_size);
+		if (dsp_threads > 0) {
+			dsp_pool_process(&dsp_pool, quit);
+		} else {
+			for (sender = sender_head; sender; sender = sender->next) {
+				/* do not process audio for an audio slave, since it is done by audio master */
+				if (sender->master) /* if master is set, we are an audio slave */
+					continue;
+				process_sender_audio(sender, quit, samples, powers, buffer_size);
+			}
 		}
 
 		/* process audio for call instances */
@@ -851,17 +909,12 @@ next_char:
 
 		display_measurements(dsp_interval / 1000.0);
 
-		now = get_time();
-
-		/* sleep interval */
-		sleep = (dsp_interval / 1000.0) - (now - begin_time);
-		if (sleep > 0)
-			usleep(sleep * 1000000.0);
-
-//		now = get_time();
-//		printf("duration =%.6f\n", now - begin_time);
+		/* sleep interval or wait for audio */
+		audio_clock_wait(quit);
 	}
 
+	audio_clock_exit();
+
 	/* reset signals */
 	signal(SIGINT, SIG_DFL);
 	signal(SIGHUP, SIG_DFL);
@@ -873,6 +926,9 @@ next_char:
 		free(powers[i]);
 	}
 
+	if (dsp_threads > 0)
+		dsp_pool_exit(&dsp_pool);
+
 	/* reset terminal */
 	tcsetattr(0, TCSANOW, &term_orig);
 	
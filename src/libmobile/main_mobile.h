@@ -17,6 +17,8 @@ extern double tx_gain;
 extern int send_patterns;
 extern int loopback;
 extern int rt_prio;
+extern int dsp_threads;
+extern int audio_clock_event;
 extern int fast_math;
 extern const char *write_rx_wave;
 extern const char *write_tx_wave;
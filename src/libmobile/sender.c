@@ -78,7 +78,7 @@ int sender_create(sender_t *sender, const char *kanal, double sendefrequenz, dou
 
 	/* if we find a channel that uses the same device as we do,
 	 * we will link us as slave to this master channel. then we 
-	 * receive and send audio via second channel of the device
+	 * receive and send audio via next channel of the device
 	 * of the master channel.
 	 */
 	for (master = sender_head; master; master = master->next) {
@@ -125,6 +125,8 @@ int sender_create(sender_t *sender, const char *kanal, double sendefrequenz, dou
 			sender->audio_read = sdr_read;
 			sender->audio_write = sdr_write;
 			sender->audio_get_tosend = sdr_get_tosend;
+			sender->audio_poll_fds = sdr_poll_fds;
+			sender->audio_poll_revents = sdr_poll_revents;
 		} else
 #endif
 		{
@@ -135,6 +137,8 @@ int sender_create(sender_t *sender, const char *kanal, double sendefrequenz, dou
 			sender->audio_read = sound_read;
 			sender->audio_write = sound_write;
 			sender->audio_get_tosend = sound_get_tosend;
+			sender->audio_poll_fds = sound_poll_fds;
+			sender->audio_poll_revents = sound_poll_revents;
 #else
 			LOGP(DSENDER, LOGL_ERROR, "No sound card support compiled in!\n");
 			rc = -ENOTSUP;
@@ -295,6 +299,8 @@ void sender_destroy(sender_t *sender)
 
 	jitter_destroy(&sender->dejitter);
 	jitter_destroy(&sender->loop_dejitter);
+
+	exit_samplerate(&sender->srstate);
 }
 
 /* set frequency modulation and parameters */
@@ -330,42 +336,27 @@ static void gain_samples(sample_t *samples, int length, double gain)
 		*samples++ *= gain;
 }
 
-/* Handle audio streaming of one transceiver. */
-void process_sender_audio(sender_t *sender, int *quit, sample_t **samples, uint8_t **power, int buffer_size)
+/* Stage 1 of audio streaming: Get TX samples from all instances of an audio master.
+ * This calls the protocol, so it must be done by the main thread.
+ * Returns the number of samples to send, or < 0 if nothing is to be done. */
+int sender_audio_tx(sender_t *sender, int *quit, sample_t **samples, uint8_t **power, int buffer_size)
 {
 	sender_t *inst;
-	int rc, count;
-	int num_chan, i;
-#ifdef DEBUG_TIME_CONSUMPTION
-	static double t1, t2, t3, t4, t5, d1 = 0, d2 = 0, d3 = 0, d4 = 0, s = 0;
-#endif
-
-	/* count instances for audio channel */
-	for (num_chan = 0, inst = sender; inst; num_chan++, inst = inst->slave);
-	enum paging_signal paging_signal[num_chan];
-	int on[num_chan];
-	double rf_level_db[num_chan];
+	int count, i;
 
-#ifdef DEBUG_TIME_CONSUMPTION
-	t1 = get_time();
-#endif
 	count = sender->audio_get_tosend(sender->audio, buffer_size);
 	if (count < 0) {
 		LOGP_CHAN(DSENDER, LOGL_ERROR, "Failed to get number of samples in buffer (rc = %d)!\n", count);
 		if (count == -EPIPE) {
 			if (cant_recover) {
-cant_recover:
 				LOGP(DSENDER, LOGL_ERROR, "Cannot recover due to measurements, quitting!\n");
 				*quit = 1;
-				return;
+				return count;
 			}
 			LOGP(DSENDER, LOGL_ERROR, "Trying to recover!\n");
 		}
-		return;
+		return count;
 	}
-#ifdef DEBUG_TIME_CONSUMPTION
-	t2 = get_time();
-#endif
 	if (count > 0) {
 		/* limit to our buffer */
 		if (count > buffer_size)
@@ -382,6 +373,28 @@ cant_recover:
 				display_wave(&inst->dispwav, samples[i], count, inst->max_display);
 				sender_receive(inst, samples[i], count, 0.0);
 			}
+		}
+	}
+
+	return count;
+}
+
+/* Stage 2 of audio streaming: Write TX samples to and read RX samples from the audio device.
+ * This does not call the protocol, so it can be done by a worker thread for each audio master.
+ * Returns the number of samples received, or < 0 if nothing was received. */
+int sender_audio_device(sender_t *sender, int *quit, sample_t **samples, uint8_t **power, int count, int buffer_size, double *rf_level_db)
+{
+	sender_t *inst;
+	int rc, num_chan, i;
+
+	/* count instances for audio channel */
+	for (num_chan = 0, inst = sender; inst; num_chan++, inst = inst->slave);
+	enum paging_signal paging_signal[num_chan];
+	int on[num_chan];
+
+	if (count > 0) {
+		/* loop through all channels */
+		for (i = 0, inst = sender; inst; i++, inst = inst->slave) {
 			/* do pre emphasis towards radio */
 			if (inst->pre_emphasis)
 				pre_emphasis(&inst->estate, samples[i], count);
@@ -395,9 +408,6 @@ cant_recover:
 			on[i] = inst->paging_on;
 		}
 
-#ifdef DEBUG_TIME_CONSUMPTION
-		t2 = get_time();
-#endif
 		if (sender->wave_tx_rec.fp)
 			wave_write(&sender->wave_tx_rec, samples, count);
 		if (sender->wave_tx_play.fp)
@@ -407,23 +417,24 @@ cant_recover:
 		if (rc < 0) {
 			LOGP(DSENDER, LOGL_ERROR, "Failed to write TX data to audio device (rc = %d)\n", rc);
 			if (rc == -EPIPE) {
-				if (cant_recover)
-					goto cant_recover;
+				if (cant_recover) {
+cant_recover:
+					LOGP(DSENDER, LOGL_ERROR, "Cannot recover due to measurements, quitting!\n");
+					*quit = 1;
+					return -EPIPE;
+				}
 				LOGP(DSENDER, LOGL_ERROR, "Trying to recover!\n");
 			}
-			return;
+			return rc;
 		}
 	}
-#ifdef DEBUG_TIME_CONSUMPTION
-	t3 = get_time();
-#endif
 
 	count = sender->audio_read(sender->audio, samples, buffer_size, num_chan, rf_level_db);
 	if (count < 0) {
 		/* special case when audio_read wants us to quit */
 		if (count == -EPERM) {
 			*quit = 1;
-			return;
+			return count;
 		}
 		LOGP(DSENDER, LOGL_ERROR, "Failed to read from audio device (rc = %d)!\n", count);
 		if (count == -EPIPE) {
@@ -431,11 +442,8 @@ cant_recover:
 				goto cant_recover;
 			LOGP(DSENDER, LOGL_ERROR, "Trying to recover!\n");
 		}
-		return;
+		return count;
 	}
-#ifdef DEBUG_TIME_CONSUMPTION
-	t4 = get_time();
-#endif
 	if (count) {
 		if (sender->wave_rx_rec.fp)
 			wave_write(&sender->wave_rx_rec, samples, count);
@@ -449,35 +457,80 @@ cant_recover:
 			/* rx gain */
 			if (inst->rx_gain != 1.0)
 				gain_samples(samples[i], count, inst->rx_gain);
-			/* do filter and de-emphasis from radio receive audio, process echo test */
+			/* do filter and de-emphasis from radio receive audio */
 			if (inst->de_emphasis) {
 				dc_filter(&inst->estate, samples[i], count);
 				de_emphasis(&inst->estate, samples[i], count);
 			}
-			if (inst->loopback != 1) {
-				display_wave(&inst->dispwav, samples[i], count, inst->max_display);
-				sender_receive(inst, samples[i], count, rf_level_db[i]);
-			}
-			if (inst->loopback == 3) {
-				jitter_frame_t *jf;
-				jf = jitter_frame_alloc(NULL, NULL, (uint8_t *)samples[i], count * sizeof(*(samples[i])), 0, inst->loop_sequence, inst->loop_timestamp, 123);
-				if (jf)
-					jitter_save(&inst->loop_dejitter, jf);
-				inst->loop_sequence += 1;
-				inst->loop_timestamp += count;
-			}
 		}
 	}
+
+	return count;
+}
+
+/* Stage 3 of audio streaming: Forward RX samples to all instances of an audio master, process echo test.
+ * This calls the protocol, so it must be done by the main thread. */
+void sender_audio_rx(sender_t *sender, sample_t **samples, int count, double *rf_level_db)
+{
+	sender_t *inst;
+	int i;
+
+	/* loop through all channels */
+	for (i = 0, inst = sender; inst; i++, inst = inst->slave) {
+		if (inst->loopback != 1) {
+			display_wave(&inst->dispwav, samples[i], count, inst->max_display);
+			sender_receive(inst, samples[i], count, rf_level_db[i]);
+		}
+		if (inst->loopback == 3) {
+			jitter_frame_t *jf;
+			jf = jitter_frame_alloc(&inst->loop_dejitter, NULL, NULL, (uint8_t *)samples[i], count * sizeof(*(samples[i])), 0, inst->loop_sequence, inst->loop_timestamp, 123);
+			if (jf)
+				jitter_save(&inst->loop_dejitter, jf);
+			inst->loop_sequence += 1;
+			inst->loop_timestamp += count;
+		}
+	}
+}
+
+/* Handle audio streaming of one transceiver. */
+void process_sender_audio(sender_t *sender, int *quit, sample_t **samples, uint8_t **power, int buffer_size)
+{
+	sender_t *inst;
+	int count;
+	int num_chan;
+#ifdef DEBUG_TIME_CONSUMPTION
+	static double t1, t2, t3, t4, d1 = 0, d2 = 0, d3 = 0, s = 0;
+#endif
+
+	/* count instances for audio channel */
+	for (num_chan = 0, inst = sender; inst; num_chan++, inst = inst->slave);
+	double rf_level_db[num_chan];
+
+#ifdef DEBUG_TIME_CONSUMPTION
+	t1 = get_time();
+#endif
+	count = sender_audio_tx(sender, quit, samples, power, buffer_size);
+	if (count < 0)
+		return;
+#ifdef DEBUG_TIME_CONSUMPTION
+	t2 = get_time();
+#endif
+	count = sender_audio_device(sender, quit, samples, power, count, buffer_size, rf_level_db);
+	if (count <= 0)
+		return;
 #ifdef DEBUG_TIME_CONSUMPTION
-	t5 = get_time();
+	t3 = get_time();
+#endif
+	sender_audio_rx(sender, samples, count, rf_level_db);
+#ifdef DEBUG_TIME_CONSUMPTION
+	t4 = get_time();
 	d1 += (t2 - t1);
 	d2 += (t3 - t2);
 	d3 += (t4 - t3);
-	d4 += (t5 - t4);
 	if (get_time() - s >= 1.0) {
-		printf("duration: %.3f (process TX), %.3f (send TX), %.3f (receive RX), %.3f (process RX)\n", d1, d2, d3, d4);
+		printf("duration: %.3f (process TX), %.3f (audio device), %.3f (process RX)\n", d1, d2, d3);
 		s = get_time();
-		d1 = d2 = d3 = d4 = 0;
+		d1 = d2 = d3 = 0;
 	}
 #endif
 }
@@ -48,6 +48,8 @@ typedef struct sender {
 	int			(*audio_write)(void *, sample_t **, uint8_t **, int, enum paging_signal *, int *, int);
 	int			(*audio_read)(void *, sample_t **, int, int, double *);
 	int			(*audio_get_tosend)(void *, int);
+	int			(*audio_poll_fds)(void *, struct pollfd *, int);
+	int			(*audio_poll_revents)(void *, struct pollfd *, int);
 	int			samplerate;
 	samplerate_t		srstate;		/* sample rate conversion state */
 	double			rx_gain;		/* factor of level to apply on RX samples */
@@ -100,6 +102,9 @@ void sender_set_fm(sender_t *sender, double max_deviation, double max_modulation
 void sender_set_am(sender_t *sender, double max_modulation, double speech_deviation, double max_display, double modulation_index);
 int sender_open_audio(int buffer_size, double interval);
 int sender_start_audio(void);
+int sender_audio_tx(sender_t *sender, int *quit, sample_t **samples, uint8_t **power, int buffer_size);
+int sender_audio_device(sender_t *sender, int *quit, sample_t **samples, uint8_t **power, int count, int buffer_size, double *rf_level_db);
+void sender_audio_rx(sender_t *sender, sample_t **samples, int count, double *rf_level_db);
 void process_sender_audio(sender_t *sender, int *quit, sample_t **samples, uint8_t **power, int buffer_size);
 void sender_send(sender_t *sender, sample_t *samples, uint8_t *power, int count);
 void sender_receive(sender_t *sender, sample_t *samples, int count, double rf_level_db);
@@ -1,5 +1,4 @@
-#include <stdint.h>
-#include "testton.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t pattern[] = {
 	0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0001, 0x0001, 0x0000,
@@ -30064,14 +30063,3 @@ static uint16_t pattern[] = {
 	0x0000, 0x0000, 0x0000, 0x0000, 0x0001, 0x0000, 0x0000, 0x0001,
 	0x0000, 0xffff, 0x0000, 0x0000, 0x0000, 0x0001, 0x0001, 0x0000,
 };
-extern int16_t *test_spl;
-extern int test_size;
-extern int test_max;
-
-void init_testton(void)
-{
-	test_spl = (int16_t *)pattern;
-	test_size = sizeof(pattern) / sizeof(pattern[0]);
-	test_max = test_size;
-}
-
@@ -1,3 +0,0 @@
-
-void init_testton(void);
-
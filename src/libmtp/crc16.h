@@ -1,3 +1,14 @@
 
+#define CRC16_INIT	0xffff	/* initial value of CRC register */
+#define CRC16_GOOD	0xf0b8	/* CRC register after data and its correct CRC have been processed */
+
+extern const uint16_t crc16_table[256];
+
+/* process one byte, the LSB is the first bit on the line */
+static inline uint16_t crc16_update(uint16_t crc, uint8_t data)
+{
+	return (crc >> 8) ^ crc16_table[(crc ^ data) & 0xff];
+}
+
 uint16_t calc_crc16(uint8_t *data_p, int length);
 
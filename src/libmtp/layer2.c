@@ -34,6 +34,7 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <math.h>
+#include <pthread.h>
 #include <osmocom/core/timer.h>
 #include <osmocom/core/utils.h>
 #include "../liblogging/logging.h"
@@ -1076,7 +1077,6 @@ void (*func_mtp_receive_msu)(mtp_t *mtp, uint8_t bsn, uint8_t bib, uint8_t fsn,
 static int mtp_receive_frame(mtp_t *mtp, uint8_t *data, int len)
 {
 	uint8_t bsn, bib, fsn, fib, li;
-	uint16_t crc;
 
 	if (len < 5) {
 		/* frame too short */
@@ -1097,8 +1097,8 @@ static int mtp_receive_frame(mtp_t *mtp, uint8_t *data, int len)
 		return -EINVAL;
 	}
 
-	crc = calc_crc16(data, len + 3);
-	if (data[3 + len] != (crc & 0xff) || data[4 + len] != (crc >> 8)) {
+	/* CRC has been calculated while receiving, including the received CRC */
+	if (mtp->rx_crc != CRC16_GOOD) {
 		/* crc error */
 		LOGP_CHAN(DMTP2, LOGL_DEBUG, "Receiving frame has wrong CRC\n");
 		return -EINVAL;
@@ -1127,30 +1127,30 @@ static int mtp_receive_frame(mtp_t *mtp, uint8_t *data, int len)
 	return 0;
 }
 
-/*
- * send bit towards layer 1.
- * bit is transmitted from flag (between frames) and from data.
- * also perform bit stuffing for data to be transmitted
- */
-uint8_t mtp_send_bit(mtp_t *mtp)
+/* flag has been sent completely, start frame after flag */
+static void mtp_flag_sent(mtp_t *mtp)
+{
+	/* continuously send flag when power off */
+	if (mtp->l2_state == MTP_L2STATE_POWER_OFF)
+		return;
+	mtp->tx_byte_count = 0;
+	mtp->tx_frame_len = mtp_send_frame(mtp, mtp->tx_frame, sizeof(mtp->tx_frame));
+	/* if no frame, continue with flag (not transmitting) */
+	if (mtp->tx_frame_len)
+		mtp->tx_transmitting = 1;
+	mtp->tx_stream = 0x00;
+}
+
+static uint8_t send_bit(mtp_t *mtp)
 {
 	uint8_t bit;
 
 	/* send flag, before frame (not transmitting) */
 	if (!mtp->tx_transmitting) {
 		bit = (0x7e >> mtp->tx_bit_count) & 1;
-		/* start frame after flag */
 		if (++mtp->tx_bit_count == 8) {
 			mtp->tx_bit_count = 0;
-			/* continuously send flag when power off */
-			if (mtp->l2_state == MTP_L2STATE_POWER_OFF)
-				return bit;
-			mtp->tx_byte_count = 0;
-			mtp->tx_frame_len = mtp_send_frame(mtp, mtp->tx_frame, sizeof(mtp->tx_frame));
-			/* if no frame, continue with flag (not transmitting) */
-			if (mtp->tx_frame_len)
-				mtp->tx_transmitting = 1;
-			mtp->tx_stream = 0x00;
+			mtp_flag_sent(mtp);
 		}
 		return bit;
 	}
@@ -1180,6 +1180,26 @@ uint8_t mtp_send_bit(mtp_t *mtp)
 	return bit;
 }
 
+/*
+ * send bit towards layer 1.
+ * bit is transmitted from flag (between frames) and from data.
+ * also perform bit stuffing for data to be transmitted
+ */
+uint8_t mtp_send_bit(mtp_t *mtp)
+{
+	uint8_t bit;
+
+	/* first send bits that have been encoded ahead by mtp_send_block() */
+	if (mtp->tx_out_num) {
+		bit = mtp->tx_out & 1;
+		mtp->tx_out >>= 1;
+		mtp->tx_out_num--;
+		return bit;
+	}
+
+	return send_bit(mtp);
+}
+
 #define MONITOR_GOOD		0
 #define MONITOR_BAD		-1
 #define MONITOR_OCTET_COUNTING	-2
@@ -1282,6 +1302,7 @@ void mtp_receive_bit(mtp_t *mtp, uint8_t bit)
 		}
 		mtp->rx_byte_count = 0;
 		mtp->rx_bit_count = 0;
+		mtp->rx_crc = CRC16_INIT;
 		mtp->rx_receiving = 1;
 		return;
 	}
@@ -1317,36 +1338,191 @@ void mtp_receive_bit(mtp_t *mtp, uint8_t bit)
 		}
 		/* store byte */
 		mtp->rx_frame[mtp->rx_byte_count++] = mtp->rx_byte;
+		mtp->rx_crc = crc16_update(mtp->rx_crc, mtp->rx_byte);
 	}
 }
 
+/*
+ * byte-wise HDLC processing
+ *
+ * Instead of processing each bit, a whole byte is processed with one table
+ * lookup. The result of 8 bits depends only on the number of consecutive '1'
+ * bits that have been sent or received before.
+ *
+ * When receiving, the table gives the de-stuffed data bits and tells if a
+ * flag or an abort sequence is found inside the byte. In this case (and when
+ * octet counting hits), the byte is processed bit by bit, so the result is
+ * exactly the same.
+ *
+ * When transmitting, the table gives the bits with stuffing bits inserted.
+ * Bits that do not fit into the output byte are kept for the next block, so
+ * the frame is requested a few bits earlier than with mtp_send_bit().
+ */
+
+#define HDLC_EVENT_FLAG		0x01	/* flag found inside byte */
+#define HDLC_EVENT_ABORT	0x02	/* 7 consecutive '1' found inside byte */
+
+static struct hdlc_rx {
+	uint8_t data;			/* de-stuffed data bits, first bit is LSB */
+	uint8_t num;			/* number of de-stuffed data bits */
+	uint8_t stream;			/* rx_stream after this byte */
+	uint8_t event;			/* flag or abort inside byte */
+} hdlc_rx_table[8][256];		/* index: number of '1' bits received before, received byte */
+
+static struct hdlc_tx {
+	uint16_t bits;			/* bits to send, first bit is LSB */
+	uint8_t num;			/* number of bits to send (8..10) */
+	uint8_t stream;			/* tx_stream after this byte */
+} hdlc_tx_table[6][256];		/* index: number of '1' bits sent before, byte to send */
+
+static pthread_once_t hdlc_tables_once = PTHREAD_ONCE_INIT;
+
+static void hdlc_init_tables(void)
+{
+	struct hdlc_rx *rx;
+	struct hdlc_tx *tx;
+	int ones, run, byte, i, bit;
+	uint8_t stream;
+
+	for (ones = 0; ones < 8; ones++) {
+		for (byte = 0; byte < 256; byte++) {
+			rx = &hdlc_rx_table[ones][byte];
+			run = ones;
+			for (i = 0; i < 8; i++) {
+				bit = (byte >> i) & 1;
+				if (bit) {
+					if (run < 7)
+						run++;
+					/* 7 bits of '1' */
+					if (run == 7) {
+						rx->event |= HDLC_EVENT_ABORT;
+						continue;
+					}
+				} else {
+					if (run == 6) {
+						/* flag */
+						rx->event |= HDLC_EVENT_FLAG;
+						run = 0;
+						continue;
+					}
+					if (run >= 5) {
+						/* stuffing bit */
+						run = 0;
+						continue;
+					}
+					run = 0;
+				}
+				rx->data |= bit << rx->num;
+				rx->num++;
+			}
+			/* the stream contains all received bits, last bit is LSB */
+			for (i = 0, stream = 0; i < 8; i++)
+				stream = (stream << 1) | ((byte >> i) & 1);
+			rx->stream = stream;
+		}
+	}
+
+	for (ones = 0; ones < 6; ones++) {
+		for (byte = 0; byte < 256; byte++) {
+			tx = &hdlc_tx_table[ones][byte];
+			run = ones;
+			stream = 0;
+			for (i = 0; i < 8; i++) {
+				/* if 5 bits are '1', add '0' */
+				if (run == 5) {
+					tx->num++;
+					stream <<= 1;
+					run = 0;
+				}
+				bit = (byte >> i) & 1;
+				tx->bits |= bit << tx->num;
+				tx->num++;
+				stream = (stream << 1) | bit;
+				run = (bit) ? run + 1 : 0;
+			}
+			tx->stream = stream;
+		}
+	}
+}
+
+/* build tables once, before the first MTP instance processes any block */
+void mtp_init_hdlc(void)
+{
+	pthread_once(&hdlc_tables_once, hdlc_init_tables);
+}
+
 /* layer 1 wants to transmit block of data: the LSB will be sent first */
 void mtp_send_block(mtp_t *mtp, uint8_t *data, int len)
 {
-	int i, j;
-	uint8_t out = 0;
+	const struct hdlc_tx *tx;
+	int i, ones;
 
 	for (i = 0; i < len; i++) {
-		for (j = 0; j < 8; j++) {
-			out >>= 1;
-			out |= mtp_send_bit(mtp) << 7;
+		while (mtp->tx_out_num < 8) {
+			if (!mtp->tx_transmitting && mtp->tx_bit_count == 0) {
+				/* send complete flag */
+				mtp->tx_out |= 0x7e << mtp->tx_out_num;
+				mtp->tx_out_num += 8;
+				mtp_flag_sent(mtp);
+			} else if (mtp->tx_transmitting && mtp->tx_bit_count == 0) {
+				/* send complete byte */
+				ones = __builtin_ctz(~mtp->tx_stream | 0x20);
+				mtp->tx_byte = mtp->tx_frame[mtp->tx_byte_count];
+				tx = &hdlc_tx_table[ones][mtp->tx_byte];
+				mtp->tx_out |= tx->bits << mtp->tx_out_num;
+				mtp->tx_out_num += tx->num;
+				mtp->tx_stream = tx->stream;
+				if (++mtp->tx_byte_count == mtp->tx_frame_len)
+					mtp->tx_transmitting = 0;
+			} else {
+				/* continue a flag or byte that mtp_send_bit() has started */
+				mtp->tx_out |= send_bit(mtp) << mtp->tx_out_num;
+				mtp->tx_out_num++;
+			}
 		}
-		data[i] = out;
+		data[i] = mtp->tx_out;
+		mtp->tx_out >>= 8;
+		mtp->tx_out_num -= 8;
 	}
 }
 
 /* layer 1 received block of data: the LSB was received first */
 void mtp_receive_block(mtp_t *mtp, uint8_t *data, int len)
 {
-	int i, j;
+	const struct hdlc_rx *rx;
+	uint16_t bits;
+	int i, j, ones;
 	uint8_t in;
 
 	for (i = 0; i < len; i++) {
 		in = data[i];
-		for (j = 0; j < 8; j++) {
-			mtp_receive_bit(mtp, in & 1);
-			in >>= 1;
+		ones = __builtin_ctz(~mtp->rx_stream | 0x80);
+		rx = &hdlc_rx_table[ones][in];
+		/* process bit by bit, if something happens inside this byte */
+		if ((rx->event & HDLC_EVENT_FLAG)
+		 || ((rx->event & HDLC_EVENT_ABORT) && (mtp->rx_receiving || !mtp->rx_octet_counting))
+		 || (mtp->rx_octet_counting && mtp->rx_octet_count + 8 >= 8 * N)
+		 || (mtp->rx_receiving && mtp->rx_bit_count + rx->num >= 8 && mtp->rx_byte_count == (int)sizeof(mtp->rx_frame))) {
+			for (j = 0; j < 8; j++) {
+				mtp_receive_bit(mtp, in & 1);
+				in >>= 1;
+			}
+			continue;
 		}
+		if (mtp->rx_octet_counting)
+			mtp->rx_octet_count += 8;
+		mtp->rx_stream = rx->stream;
+		if (!mtp->rx_receiving)
+			continue;
+		/* shift data bits into current byte, store byte when complete */
+		bits = mtp->rx_byte | (rx->data << 8);
+		if (mtp->rx_bit_count + rx->num >= 8) {
+			mtp->rx_frame[mtp->rx_byte_count] = bits >> (8 - mtp->rx_bit_count);
+			mtp->rx_crc = crc16_update(mtp->rx_crc, mtp->rx_frame[mtp->rx_byte_count++]);
+			mtp->rx_bit_count += rx->num - 8;
+		} else
+			mtp->rx_bit_count += rx->num;
+		mtp->rx_byte = bits >> rx->num;
 	}
 }
 
@@ -77,6 +77,7 @@ int mtp_init(mtp_t *mtp, const char *name, void *inst, void (*mtp_receive)(void
 	osmo_timer_setup(&mtp->t2, mtp_t2, mtp);
 	osmo_timer_setup(&mtp->t3, mtp_t3, mtp);
 	osmo_timer_setup(&mtp->t4, mtp_t4, mtp);
+	mtp_init_hdlc();
 
 	return 0;
 }
@@ -85,6 +85,8 @@ typedef struct mtp {
 	int		tx_transmitting;/* transmit frame, if 0: transmit flag */
 	uint8_t		tx_byte;	/* current byte transmitting */
 	uint8_t		tx_stream;	/* output stream to track bit stuffing */
+	uint32_t	tx_out;		/* bits that have been encoded ahead by mtp_send_block() */
+	int		tx_out_num;	/* number of bits encoded ahead */
 
 	/* frame reception */
 	uint8_t		rx_frame[272];	/* frame memory */
@@ -93,6 +95,7 @@ typedef struct mtp {
 	int		rx_receiving;	/* receive frame, if 0: no flag yet */
 	uint8_t		rx_byte;	/* current byte receiving */
 	uint8_t		rx_stream;	/* input stream to track bit stuffing/flag/abort */
+	uint16_t	rx_crc;		/* CRC of bytes received so far */
 	int		rx_flag_count;	/* counter to detect exessively received flags */
 	int		rx_octet_counting; /* we are in octet counting mode */
 	int		rx_octet_count;	/* counter when performing octet counting */
@@ -132,6 +135,7 @@ void mtp_l2l3(mtp_t *mtp, enum mtp_prim prim, uint8_t sio, uint8_t *data, int le
 uint8_t mtp_send_bit(mtp_t *mtp);
 void mtp_receive_bit(mtp_t *mtp, uint8_t bit);
 
+void mtp_init_hdlc(void);
 void mtp_send_block(mtp_t *mtp, uint8_t *data, int len);
 void mtp_receive_block(mtp_t *mtp, uint8_t *data, int len);
 
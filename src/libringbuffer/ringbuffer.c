@@ -0,0 +1,343 @@
+/* single producer / single consumer ring buffer
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * One thread writes elements (producer), another thread reads them
+ * (consumer). No locking is required, because the write position (head) is
+ * only changed by the producer and the read position (tail) is only changed
+ * by the consumer.
+ *
+ * Both positions are free running counters. The number of elements in the
+ * buffer is head - tail, also when the counters wrap. The size of the buffer
+ * is a power of two, so the index into the buffer is the position masked by
+ * size - 1. All elements of the buffer can be used.
+ *
+ * The producer writes elements first, then it stores the new head with
+ * release ordering. The consumer loads the head with acquire ordering, so
+ * the elements are visible before the consumer reads them. The same is done
+ * the other way round with the tail, so the producer does not overwrite
+ * elements before the consumer has read them.
+ *
+ * Elements are accessed in spans. A span is the contiguous part of the
+ * buffer up to the end of the buffer, so it can be copied with memcpy or
+ * processed directly. Two spans are required when the buffer wraps.
+ *
+ * If RINGBUFFER_WAKEUP is given, an eventfd is used for each direction. A
+ * thread that waits for elements (or space) sets a flag and polls the
+ * eventfd. The other thread only writes to the eventfd, if that flag is set,
+ * so no system call is done while both threads are busy. A full memory
+ * barrier between storing the position and checking the flag (and between
+ * setting the flag and checking the position) makes sure that a wakeup is
+ * never lost. The eventfd of the consumer can also be used in a select loop,
+ * see ringbuffer_arm_read() and ringbuffer_disarm_read().
+ *
+ * Without RINGBUFFER_WAKEUP, waiting sleeps for the given timeout.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include "ringbuffer.h"
+
+int ringbuffer_init(ringbuffer_t *rb, size_t elements, size_t elem_size, int flags)
+{
+	memset(rb, 0, sizeof(*rb));
+	rb->data_fd = -1;
+	rb->space_fd = -1;
+
+	/* round up to power of two */
+	rb->size = 1;
+	while (rb->size < elements)
+		rb->size <<= 1;
+	rb->mask = rb->size - 1;
+	rb->elem_size = elem_size;
+	atomic_init(&rb->head, 0);
+	atomic_init(&rb->tail, 0);
+	atomic_init(&rb->read_waiting, 0);
+	atomic_init(&rb->write_waiting, 0);
+
+	rb->buffer = calloc(rb->size, elem_size);
+	if (!rb->buffer) {
+		fprintf(stderr, "No mem!\n");
+		return -ENOMEM;
+	}
+
+	if ((flags & RINGBUFFER_WAKEUP)) {
+		rb->data_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		rb->space_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (rb->data_fd < 0 || rb->space_fd < 0) {
+			int rc = -errno;
+			fprintf(stderr, "Failed to create eventfd for ring buffer! (errno %d)\n", errno);
+			ringbuffer_exit(rb);
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+void ringbuffer_exit(ringbuffer_t *rb)
+{
+	/* not initialized */
+	if (!rb->buffer)
+		return;
+	free(rb->buffer);
+	rb->buffer = NULL;
+	if (rb->data_fd >= 0)
+		close(rb->data_fd);
+	rb->data_fd = -1;
+	if (rb->space_fd >= 0)
+		close(rb->space_fd);
+	rb->space_fd = -1;
+}
+
+/* flush buffer, must not be called while another thread uses it */
+void ringbuffer_reset(ringbuffer_t *rb)
+{
+	atomic_store(&rb->head, 0);
+	atomic_store(&rb->tail, 0);
+}
+
+/* number of elements that can be read */
+size_t ringbuffer_fill(ringbuffer_t *rb)
+{
+	size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+	size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+
+	return head - tail;
+}
+
+/* number of elements that can be written */
+size_t ringbuffer_space(ringbuffer_t *rb)
+{
+	return rb->size - ringbuffer_fill(rb);
+}
+
+static void wakeup(int fd, atomic_int *waiting)
+{
+	uint64_t one = 1;
+	ssize_t __attribute__((__unused__)) rc;
+
+	if (fd < 0)
+		return;
+	/* order the store of the position before checking the flag */
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load_explicit(waiting, memory_order_relaxed))
+		rc = write(fd, &one, sizeof(one));
+}
+
+/* get contiguous span to write to, return number of elements */
+size_t ringbuffer_write_span(ringbuffer_t *rb, void **data)
+{
+	size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+	size_t space = rb->size - (head - tail);
+	size_t to_end = rb->size - (head & rb->mask);
+
+	*data = rb->buffer + (head & rb->mask) * rb->elem_size;
+	return (space < to_end) ? space : to_end;
+}
+
+/* make written elements available to consumer */
+void ringbuffer_write_commit(ringbuffer_t *rb, size_t num)
+{
+	size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+
+	atomic_store_explicit(&rb->head, head + num, memory_order_release);
+	wakeup(rb->data_fd, &rb->read_waiting);
+}
+
+/* get contiguous span to read from, return number of elements */
+size_t ringbuffer_read_span(ringbuffer_t *rb, void **data)
+{
+	size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+	size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+	size_t fill = head - tail;
+	size_t to_end = rb->size - (tail & rb->mask);
+
+	*data = rb->buffer + (tail & rb->mask) * rb->elem_size;
+	return (fill < to_end) ? fill : to_end;
+}
+
+/* release read elements to producer */
+void ringbuffer_read_commit(ringbuffer_t *rb, size_t num)
+{
+	size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+
+	atomic_store_explicit(&rb->tail, tail + num, memory_order_release);
+	wakeup(rb->space_fd, &rb->write_waiting);
+}
+
+/* write up to num elements, return number of elements written */
+size_t ringbuffer_write(ringbuffer_t *rb, const void *data, size_t num)
+{
+	const unsigned char *src = data;
+	size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+	size_t space = rb->size - (head - tail);
+	size_t pos = head & rb->mask, span;
+
+	if (num > space)
+		num = space;
+	if (!num)
+		return 0;
+
+	/* copy up to the end of buffer, then from the start of buffer */
+	span = rb->size - pos;
+	if (span > num)
+		span = num;
+	memcpy(rb->buffer + pos * rb->elem_size, src, span * rb->elem_size);
+	if (span < num)
+		memcpy(rb->buffer, src + span * rb->elem_size, (num - span) * rb->elem_size);
+	ringbuffer_write_commit(rb, num);
+
+	return num;
+}
+
+/* read up to num elements, return number of elements read */
+size_t ringbuffer_read(ringbuffer_t *rb, void *data, size_t num)
+{
+	unsigned char *dst = data;
+	size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+	size_t head = atomic_load_explicit(&rb->head, memory_order_acquire);
+	size_t fill = head - tail;
+	size_t pos = tail & rb->mask, span;
+
+	if (num > fill)
+		num = fill;
+	if (!num)
+		return 0;
+
+	/* copy up to the end of buffer, then from the start of buffer */
+	span = rb->size - pos;
+	if (span > num)
+		span = num;
+	memcpy(dst, rb->buffer + pos * rb->elem_size, span * rb->elem_size);
+	if (span < num)
+		memcpy(dst + span * rb->elem_size, rb->buffer, (num - span) * rb->elem_size);
+	ringbuffer_read_commit(rb, num);
+
+	return num;
+}
+
+static int64_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int wait_for(ringbuffer_t *rb, int fd, atomic_int *waiting, size_t num, int timeout_ms, int for_space)
+{
+	struct pollfd pfd;
+	uint64_t value;
+	int64_t end = now_ms() + timeout_ms;
+	ssize_t __attribute__((__unused__)) rc;
+	int remain;
+
+	if (num > rb->size)
+		num = rb->size;
+
+#define AVAILABLE() ((for_space) ? ringbuffer_space(rb) : ringbuffer_fill(rb))
+
+	if (AVAILABLE() >= num)
+		return 1;
+
+	if (fd < 0) {
+		if (timeout_ms > 0)
+			usleep(timeout_ms * 1000);
+		return AVAILABLE() >= num;
+	}
+
+	while (1) {
+		atomic_store_explicit(waiting, 1, memory_order_relaxed);
+		/* order the store of the flag before checking the position */
+		atomic_thread_fence(memory_order_seq_cst);
+		if (AVAILABLE() >= num)
+			break;
+		remain = end - now_ms();
+		if (remain <= 0)
+			break;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, remain) > 0)
+			rc = read(fd, &value, sizeof(value));
+	}
+	atomic_store_explicit(waiting, 0, memory_order_relaxed);
+
+	return AVAILABLE() >= num;
+
+#undef AVAILABLE
+}
+
+/* wait until num elements can be read or timeout, return 1 if available */
+int ringbuffer_wait_read(ringbuffer_t *rb, size_t num, int timeout_ms)
+{
+	return wait_for(rb, rb->data_fd, &rb->read_waiting, num, timeout_ms, 0);
+}
+
+/* wait until num elements can be written or timeout, return 1 if available */
+int ringbuffer_wait_write(ringbuffer_t *rb, size_t num, int timeout_ms)
+{
+	return wait_for(rb, rb->space_fd, &rb->write_waiting, num, timeout_ms, 1);
+}
+
+/* prepare waiting for elements by a select loop, return 1 if num elements are available already
+ * the eventfd becomes readable when the producer writes elements, until ringbuffer_disarm_read() is called */
+int ringbuffer_arm_read(ringbuffer_t *rb, size_t num)
+{
+	if (num > rb->size)
+		num = rb->size;
+
+	atomic_store_explicit(&rb->read_waiting, 1, memory_order_relaxed);
+	/* order the store of the flag before checking the position */
+	atomic_thread_fence(memory_order_seq_cst);
+	if (ringbuffer_fill(rb) >= num) {
+		atomic_store_explicit(&rb->read_waiting, 0, memory_order_relaxed);
+		return 1;
+	}
+
+	return 0;
+}
+
+/* stop waiting for elements by a select loop and consume pending wakeup */
+void ringbuffer_disarm_read(ringbuffer_t *rb)
+{
+	uint64_t value;
+	ssize_t __attribute__((__unused__)) rc;
+
+	atomic_store_explicit(&rb->read_waiting, 0, memory_order_relaxed);
+	if (rb->data_fd >= 0)
+		rc = read(rb->data_fd, &value, sizeof(value));
+}
+
+/* eventfd that becomes readable when the producer has written elements, or -1 */
+int ringbuffer_data_fd(ringbuffer_t *rb)
+{
+	return rb->data_fd;
+}
@@ -0,0 +1,44 @@
+#ifndef _LIB_RINGBUFFER_H
+#define _LIB_RINGBUFFER_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+/* flags for ringbuffer_init() */
+#define RINGBUFFER_WAKEUP	(1 << 0)	/* use eventfd to wake up waiting thread */
+
+typedef struct ringbuffer {
+	unsigned char	*buffer;	/* elements */
+	size_t		elem_size;	/* size of one element in bytes */
+	size_t		size;		/* number of elements (power of two) */
+	size_t		mask;		/* size - 1 */
+	int		data_fd;	/* eventfd to wake up consumer (or -1) */
+	int		space_fd;	/* eventfd to wake up producer (or -1) */
+	/* padding, so producer and consumer position are on different cache lines */
+	char		pad1[64];
+	atomic_size_t	head;		/* free running write position, written by producer */
+	atomic_int	read_waiting;	/* consumer waits for elements */
+	char		pad2[64];
+	atomic_size_t	tail;		/* free running read position, written by consumer */
+	atomic_int	write_waiting;	/* producer waits for space */
+	char		pad3[64];
+} ringbuffer_t;
+
+int ringbuffer_init(ringbuffer_t *rb, size_t elements, size_t elem_size, int flags);
+void ringbuffer_exit(ringbuffer_t *rb);
+void ringbuffer_reset(ringbuffer_t *rb);
+size_t ringbuffer_fill(ringbuffer_t *rb);
+size_t ringbuffer_space(ringbuffer_t *rb);
+size_t ringbuffer_write_span(ringbuffer_t *rb, void **data);
+void ringbuffer_write_commit(ringbuffer_t *rb, size_t num);
+size_t ringbuffer_read_span(ringbuffer_t *rb, void **data);
+void ringbuffer_read_commit(ringbuffer_t *rb, size_t num);
+size_t ringbuffer_write(ringbuffer_t *rb, const void *data, size_t num);
+size_t ringbuffer_read(ringbuffer_t *rb, void *data, size_t num);
+int ringbuffer_wait_read(ringbuffer_t *rb, size_t num, int timeout_ms);
+int ringbuffer_wait_write(ringbuffer_t *rb, size_t num, int timeout_ms);
+int ringbuffer_arm_read(ringbuffer_t *rb, size_t num);
+void ringbuffer_disarm_read(ringbuffer_t *rb);
+int ringbuffer_data_fd(ringbuffer_t *rb);
+
+#endif /* _LIB_RINGBUFFER_H */
@@ -1,5 +1,10 @@
 
+/* configure --enable-float-samples builds the DSP chain with 32 bit float samples */
+#ifdef SAMPLE_FLOAT
+typedef float sample_t;
+#else
 typedef double sample_t;
+#endif
 
 #define	SPEECH_LEVEL	0.1585
 
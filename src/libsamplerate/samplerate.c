@@ -17,227 +17,413 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* How it works:
+ *
+ * A low pass FIR filter is designed for a sample rate that is 'phases' times
+ * the input sample rate (windowed sinc, Kaiser window). The filter is split
+ * into a bank of 'phases' sub filters. Each output sample is calculated from
+ * the last 'taps' input samples and the sub filter that matches the fraction
+ * of the output sample's position between two input samples.
+ *
+ * If both sample rates are integer and their ratio can be expressed by L/M
+ * with L not above SAMPLERATE_MAX_PHASES, the bank has L phases and the
+ * position is exact. Otherwise the position is a 32 bit fraction, the upper
+ * bits select the phase and the lower bits interpolate linearly between two
+ * adjacent phases. The low quality preset takes the nearest phase of a larger
+ * bank instead, so only one sub filter is calculated for each output sample.
+ *
+ * If both sample rates are equal, the samples are passed unchanged.
+ *
+ * The pass band ends at the given cut-off frequency, the stop band begins at
+ * the low sample rate minus the cut-off frequency. Everything that is mirrored
+ * into the pass band is attenuated by the alias rejection of the quality
+ * preset.
+ *
+ * The input samples are copied behind the history inside a buffer of the
+ * state, so input and output may be the same and no stack buffer is required.
+ * The buffer only grows, if a larger chunk than before is given.
+ */
+
 #include <stdio.h>
 #include <stdint.h>
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 #include "../libsample/sample.h"
+#include "../liblogging/logging.h"
 #include "samplerate.h"
 
-int init_samplerate(samplerate_t *state, double low_samplerate, double high_samplerate, double filter_cutoff)
+#define SAMPLERATE_MAX_PHASES	1024	/* use exact phases up to this number */
+#define SAMPLERATE_MAX_TAPS	2048	/* limit filter length of each phase */
+
+static const struct samplerate_preset {
+	double rejection;	/* alias rejection in dB */
+	int phase_bits;		/* phases for arbitrary ratio */
+	int interpolate;	/* interpolate between phases, else take nearest phase */
+} samplerate_preset[] = {
+	{ 40.0, 8, 0 },
+	{ 70.0, 7, 1 },
+	{ 100.0, 9, 1 },
+};
+
+/* modified bessel function of first kind and order 0 */
+static double bessel_i0(double x)
 {
+	double sum = 1.0, term = 1.0;
+	int k;
+
+	for (k = 1; k < 100 && term > sum * 1e-16; k++) {
+		term *= (x / 2.0 / k) * (x / 2.0 / k);
+		sum += term;
+	}
+
+	return sum;
+}
+
+/* get greatest common divisor */
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+	uint64_t t;
+
+	while (b) {
+		t = a % b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+/* design coefficient bank for given input rate and ratio of output rate */
+static int init_filter(samplerate_filter_t *filter, double in_rate, double out_rate, double low_samplerate, double filter_cutoff, const struct samplerate_preset *preset)
+{
+	double pass, stop, cutoff, beta, center, x, w, sum;
+	double *h;
+	int taps, phases, length, p, k, j;
+	uint64_t step, l, m, g;
+
+	memset(filter, 0, sizeof(*filter));
+
+	/* position of output samples: exact phases for rational ratio, else 32 bit fraction */
+	l = (uint64_t)out_rate;
+	m = (uint64_t)in_rate;
+	if ((double)l == out_rate && (double)m == in_rate && l && m) {
+		g = gcd(l, m);
+		l /= g;
+		m /= g;
+	} else
+		l = 0;
+	if (l && l <= SAMPLERATE_MAX_PHASES) {
+		phases = l;
+		filter->one = l;
+		step = m;
+	} else {
+		phases = 1 << preset->phase_bits;
+		filter->interpolate = preset->interpolate;
+		filter->phase_shift = 32 - preset->phase_bits;
+		/* the extra phase is used, if the position is rounded up to the next sample */
+		if (!filter->interpolate)
+			filter->phase_round = 1ULL << (filter->phase_shift - 1);
+		filter->one = 1ULL << 32;
+		step = (uint64_t)(in_rate / out_rate * 4294967296.0 + 0.5);
+	}
+	filter->phases = phases;
+	filter->step_index = step / filter->one;
+	filter->step_frac = step % filter->one;
+
+	/* pass band ends at cut-off, stop band starts where the alias of the cut-off frequency is */
+	pass = filter_cutoff;
+	if (pass <= 0.0 || pass > low_samplerate * 0.45)
+		pass = low_samplerate * 0.45;
+	stop = low_samplerate - pass;
+	cutoff = (pass + stop) / 2.0;
+
+	/* kaiser window design, filter length at input sample rate */
+	if (preset->rejection > 50.0)
+		beta = 0.1102 * (preset->rejection - 8.7);
+	else
+		beta = 0.5842 * pow(preset->rejection - 21.0, 0.4) + 0.07886 * (preset->rejection - 21.0);
+	taps = (int)ceil((preset->rejection - 7.95) / (2.285 * 2.0 * M_PI * (stop - pass) / in_rate)) + 1;
+	if (taps > SAMPLERATE_MAX_TAPS)
+		taps = SAMPLERATE_MAX_TAPS;
+	filter->taps = taps;
+
+	/* prototype filter at 'phases' times the input rate, gain of each phase is 1 */
+	length = taps * phases;
+	h = calloc(length, sizeof(*h));
+	filter->coeff = calloc((phases + 1) * taps, sizeof(*filter->coeff));
+	filter->buf_size = taps;
+	filter->buf = calloc(filter->buf_size, sizeof(*filter->buf));
+	if (!h || !filter->coeff || !filter->buf) {
+		LOGP(DDSP, LOGL_ERROR, "No memory!\n");
+		free(h);
+		return -ENOMEM;
+	}
+	center = (double)(length - 1) / 2.0;
+	sum = 0.0;
+	for (j = 0; j < length; j++) {
+		x = ((double)j - center) / (double)phases;
+		w = 1.0 - (2.0 * (double)j / (double)(length - 1) - 1.0) * (2.0 * (double)j / (double)(length - 1) - 1.0);
+		h[j] = bessel_i0(beta * sqrt((w > 0.0) ? w : 0.0)) / bessel_i0(beta);
+		if (x != 0.0)
+			h[j] *= sin(2.0 * M_PI * cutoff / in_rate * x) / (M_PI * x);
+		else
+			h[j] *= 2.0 * cutoff / in_rate;
+		sum += h[j];
+	}
+
+	/* sort into bank, the extra phase is used to interpolate the last phase */
+	for (p = 0; p <= phases; p++) {
+		for (k = 0; k < taps; k++) {
+			j = p + k * phases;
+			if (j < length)
+				filter->coeff[p * taps + taps - 1 - k] = h[j] / sum * (double)phases;
+		}
+	}
+	free(h);
+
+	return 0;
+}
+
+static void exit_filter(samplerate_filter_t *filter)
+{
+	free(filter->coeff);
+	filter->coeff = NULL;
+	free(filter->buf);
+	filter->buf = NULL;
+}
+
+int init_samplerate_quality(samplerate_t *state, double low_samplerate, double high_samplerate, double filter_cutoff, enum samplerate_quality quality)
+{
+	int rc;
+
 	memset(state, 0, sizeof(*state));
 	state->factor = high_samplerate / low_samplerate;
 	if (state->factor < 1.0) {
 		fprintf(stderr, "Software error: Low sample rate must be lower than high sample rate, aborting!\n");
 		abort();
 	}
+	if (quality < SAMPLERATE_QUALITY_LOW || quality > SAMPLERATE_QUALITY_HIGH) {
+		fprintf(stderr, "Software error: Invalid quality preset, aborting!\n");
+		abort();
+	}
+	if (high_samplerate == low_samplerate) {
+		state->bypass = 1;
+		return 0;
+	}
+
+	rc = init_filter(&state->down, high_samplerate, low_samplerate, low_samplerate, filter_cutoff, &samplerate_preset[quality]);
+	if (rc < 0)
+		goto error;
+	rc = init_filter(&state->up, low_samplerate, high_samplerate, low_samplerate, filter_cutoff, &samplerate_preset[quality]);
+	if (rc < 0)
+		goto error;
+
+	return 0;
+
+error:
+	exit_samplerate(state);
+	return rc;
+}
+
+int init_samplerate(samplerate_t *state, double low_samplerate, double high_samplerate, double filter_cutoff)
+{
+	return init_samplerate_quality(state, low_samplerate, high_samplerate, filter_cutoff, SAMPLERATE_QUALITY_DEFAULT);
+}
 
-	state->filter_cutoff = filter_cutoff;
-	if (state->filter_cutoff) {
-		iir_lowpass_init(&state->up.lp, filter_cutoff, high_samplerate, 2);
-		iir_lowpass_init(&state->down.lp, filter_cutoff, high_samplerate, 2);
+void exit_samplerate(samplerate_t *state)
+{
+	exit_filter(&state->down);
+	exit_filter(&state->up);
+}
+
+/* append input samples to history */
+static int filter_input(samplerate_filter_t *filter, sample_t *input, int input_num)
+{
+	sample_t *buf;
+
+	if (filter->taps + input_num > filter->buf_size) {
+		buf = realloc(filter->buf, (filter->taps + input_num) * sizeof(*buf));
+		if (!buf) {
+			LOGP(DDSP, LOGL_ERROR, "No memory!\n");
+			return -ENOMEM;
+		}
+		filter->buf = buf;
+		filter->buf_size = filter->taps + input_num;
 	}
+	memcpy(filter->buf + filter->taps, input, input_num * sizeof(*input));
 
 	return 0;
 }
 
-int samplerate_downsample_input_num(samplerate_t *state, int output_num)
+/* keep last samples as history */
+static void filter_history(samplerate_filter_t *filter, int input_num)
 {
-	double factor = state->factor, in_index;
-	int idx;
+	memmove(filter->buf, filter->buf + input_num, filter->taps * sizeof(*filter->buf));
+}
+
+static inline sample_t dot_product(const sample_t *x, const sample_t *c, int taps)
+{
+	sample_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	int k;
+
+	for (k = 0; k + 4 <= taps; k += 4) {
+		s0 += x[k] * c[k];
+		s1 += x[k + 1] * c[k + 1];
+		s2 += x[k + 2] * c[k + 2];
+		s3 += x[k + 3] * c[k + 3];
+	}
+	for (; k < taps; k++)
+		s0 += x[k] * c[k];
 
-	/* resample filtered result */
-	in_index = state->down.in_index;
+	return (s0 + s1) + (s2 + s3);
+}
 
-	while (output_num--) {
-		/* increment input index */
-		in_index += factor;
+/* calculate output sample from given samples ('taps' samples up to current sample) */
+static inline sample_t filter_output(samplerate_filter_t *filter, const sample_t *x)
+{
+	const sample_t *c;
+	sample_t y0, y1;
+	int taps = filter->taps;
+
+	c = filter->coeff + ((filter->frac + filter->phase_round) >> filter->phase_shift) * taps;
+	y0 = dot_product(x, c, taps);
+	if (!filter->interpolate)
+		return y0;
+	y1 = dot_product(x, c + taps, taps);
+	return y0 + (y1 - y0) * (sample_t)((double)(filter->frac & ((1ULL << filter->phase_shift) - 1)) / (double)(1ULL << filter->phase_shift));
+}
+
+/* advance position to next output sample, return number of input samples passed */
+static inline int filter_step(samplerate_filter_t *filter)
+{
+	int passed = filter->step_index;
+
+	filter->frac += filter->step_frac;
+	if (filter->frac >= filter->one) {
+		filter->frac -= filter->one;
+		passed++;
 	}
 
-	/* convert index to int */
-	idx = (int)in_index;
+	return passed;
+}
+
+int samplerate_downsample_input_num(samplerate_t *state, int output_num)
+{
+	samplerate_filter_t *filter = &state->down;
+	uint64_t pos, step;
+
+	if (state->bypass)
+		return output_num;
 
-	return idx;
+	pos = (uint64_t)filter->index * filter->one + filter->frac;
+	step = (uint64_t)filter->step_index * filter->one + filter->step_frac;
+
+	return (pos + (uint64_t)output_num * step) / filter->one;
 }
 
 int samplerate_downsample_output_num(samplerate_t *state, int input_num)
 {
-	double factor = state->factor, in_index;
-	int output_num = 0, idx;
+	samplerate_filter_t *filter = &state->down;
+	uint64_t pos, step, end;
 
-	/* count output */
-	in_index = state->down.in_index;
+	if (state->bypass)
+		return input_num;
 
-	while (42) {
-		/* convert index to int */
-		idx = (int)in_index;
-		/* if index is outside input sample range, we are done */
-		if (idx >= input_num)
-			break;
-		/* count output number */
-		output_num++;
-		/* increment input index */
-		in_index += factor;
-	}
+	pos = (uint64_t)filter->index * filter->one + filter->frac;
+	step = (uint64_t)filter->step_index * filter->one + filter->step_frac;
+	end = (uint64_t)input_num * filter->one;
 
-	return output_num;
+	if (pos >= end)
+		return 0;
+	return (end - pos - 1) / step + 1;
 }
 
 /* convert high sample rate to low sample rate */
 int samplerate_downsample(samplerate_t *state, sample_t *samples, int input_num)
 {
-	int output_num = 0, i, idx;
-	double factor = state->factor, in_index, diff;
-	sample_t output[(int)((double)input_num / factor + 0.5) + 10]; /* add some safety */
-	sample_t last_sample;
-
-	/* filter down */
-	if (state->filter_cutoff)
-		iir_process(&state->down.lp, samples, input_num);
-
-	/* get last sample for interpolation */
-	last_sample = state->down.last_sample;
-
-	/* resample filtered result */
-	in_index = state->down.in_index;
-
-	for (i = 0; ; i++) {
-		/* convert index to int */
-		idx = (int)in_index;
-		/* if index is outside input sample range, we are done */
-		if (idx >= input_num)
-			break;
-		/* linear interpolation */
-		diff = in_index - (double)idx;
-		if (idx)
-			output[i] = samples[idx - 1] * (1.0 - diff) + samples[idx] * diff;
-		else
-			output[i] = last_sample * (1.0 - diff) + samples[idx] * diff;
-		/* count output number */
-		output_num++;
-		/* increment input index */
-		in_index += factor;
-	}
+	samplerate_filter_t *filter = &state->down;
+	int output_num = 0;
 
-	/* store last sample for interpolation */
-	if (input_num)
-		state->down.last_sample = samples[input_num - 1];
+	if (state->bypass)
+		return input_num;
 
-	/* remove number of input samples from index */
-	in_index -= (double)input_num;
-	/* in_index cannot be negative, except due to rounding error, so... */
-	if ((int)in_index < 0)
-		in_index = 0.0;
+	if (filter_input(filter, samples, input_num) < 0)
+		return 0;
 
-	state->down.in_index = in_index;
+	/* the output sample at index uses input samples up to index */
+	while (filter->index < input_num) {
+		samples[output_num++] = filter_output(filter, filter->buf + filter->index + 1);
+		filter->index += filter_step(filter);
+	}
 
-	/* copy samples */
-	for (i = 0; i < output_num; i++)
-		*samples++ = output[i];
+	/* remove number of input samples from index */
+	filter->index -= input_num;
+	filter_history(filter, input_num);
 
 	return output_num;
 }
 
 int samplerate_upsample_input_num(samplerate_t *state, int output_num)
 {
-	double factor = 1.0 / state->factor, in_index;
-	int idx = 0;
-
-	/* count output */
-	in_index = state->up.in_index;
+	samplerate_filter_t *filter = &state->up;
+	uint64_t step;
 
-	while (output_num--) {
-		/* increment input index */
-		in_index += factor;
-		/* count index on overflow */
-		if (in_index >= 1.0) {
-			idx++;
-			in_index -= 1.0;
-		}
-	}
+	if (state->bypass)
+		return output_num;
+	step = (uint64_t)filter->step_index * filter->one + filter->step_frac;
 
-	return idx;
+	return (filter->frac + (uint64_t)output_num * step) / filter->one;
 }
 
 int samplerate_upsample_output_num(samplerate_t *state, int input_num)
 {
-	double factor = 1.0 / state->factor, in_index;
-	int output_num = 0, idx = 0;
-
-	/* count output */
-	in_index = state->up.in_index;
-
-	while (idx < input_num) {
-		/* count output number */
-		output_num++;
-		/* increment input index */
-		in_index += factor;
-		/* count index on overflow */
-		if (in_index >= 1.0) {
-			idx++;
-			in_index -= 1.0;
-		}
-	}
+	samplerate_filter_t *filter = &state->up;
+	uint64_t step;
 
-	return output_num;
+	if (input_num <= 0)
+		return 0;
+	if (state->bypass)
+		return input_num;
+	step = (uint64_t)filter->step_index * filter->one + filter->step_frac;
+
+	return ((uint64_t)input_num * filter->one - filter->frac + step - 1) / step;
 }
 
-/* convert low sample rate to high sample rate */
-void samplerate_upsample(samplerate_t *state, sample_t *input, int input_num, sample_t *output, int output_num)
+/* convert low sample rate to high sample rate
+ *
+ * input_num must be given by samplerate_upsample_input_num() for output_num,
+ * otherwise the output is silence and an error is returned */
+int samplerate_upsample(samplerate_t *state, sample_t *input, int input_num, sample_t *output, int output_num)
 {
-	int i, idx;
-	double factor = 1.0 / state->factor, in_index;
-	sample_t buff[output_num];
-	sample_t *samples, current_sample, last_sample;
+	samplerate_filter_t *filter = &state->up;
+	int i, idx = 0;
 
-	/* get last sample for interpolation */
-	current_sample = state->up.current_sample;
-	last_sample = state->up.last_sample;
+	if (samplerate_upsample_input_num(state, output_num) != input_num) {
+		LOGP(DDSP, LOGL_ERROR, "Given %d input samples, but %d are required for %d output samples.\n", input_num, samplerate_upsample_input_num(state, output_num), output_num);
+		memset(output, 0, output_num * sizeof(*output));
+		return -EINVAL;
+	}
 
-	if (input == output)
-		samples = buff;
-	else
-		samples = output;
+	if (state->bypass) {
+		if (output != input)
+			memcpy(output, input, output_num * sizeof(*output));
+		return 0;
+	}
 
-	/* resample input */
-	in_index = state->up.in_index;
-	idx = 0;
+	if (filter_input(filter, input, input_num) < 0) {
+		memset(output, 0, output_num * sizeof(*output));
+		return -ENOMEM;
+	}
 
+	/* the output sample uses all input samples that have been consumed so far */
 	for (i = 0; i < output_num; i++) {
-		/* linear interpolation */
-		samples[i] = last_sample * (1.0 - in_index) + current_sample * in_index;
-		/* increment input index */
-		in_index += factor;
-		/* get next sample on overflow */
-		if (in_index >= 1.0) {
-			if (idx == input_num) {
-				fprintf(stderr, "Given input_num is too small, please fix!\n");
-			}
-			last_sample = current_sample;
-			current_sample = input[idx++];
-			in_index -= 1.0;
-		}
+		output[i] = filter_output(filter, filter->buf + idx);
+		idx += filter_step(filter);
 	}
-	if (idx < input_num) {
-		fprintf(stderr, "Given input_num is too large, please fix!\n");
-		abort();
-	}
-
-	/* store last sample for interpolation */
-	state->up.last_sample = last_sample;
-	state->up.current_sample = current_sample;
-	state->up.in_index = in_index;
 
-	/* filter up */
-	if (state->filter_cutoff)
-		iir_process(&state->up.lp, samples, output_num);
+	filter_history(filter, input_num);
 
-	if (input == output) {
-		/* copy samples */
-		for (i = 0; i < output_num; i++)
-			*output++ = samples[i];
-	}
+	return 0;
 }
-
@@ -1,25 +1,43 @@
-#include "../libfilter/iir_filter.h"
+
+enum samplerate_quality {
+	SAMPLERATE_QUALITY_LOW = 0,	/* 40 dB alias rejection, 256 phases, nearest phase */
+	SAMPLERATE_QUALITY_MEDIUM,	/* 70 dB alias rejection, 128 phases, interpolated */
+	SAMPLERATE_QUALITY_HIGH,	/* 100 dB alias rejection, 512 phases, interpolated */
+};
+
+/* not slower than the linear interpolation that was used before */
+#define SAMPLERATE_QUALITY_DEFAULT	SAMPLERATE_QUALITY_LOW
+
+/* polyphase filter of one direction */
+typedef struct samplerate_filter {
+	int taps;		/* number of coefficients of each phase */
+	int phases;		/* number of phases in coefficient bank */
+	int interpolate;	/* interpolate between two phases (arbitrary ratio) */
+	int phase_shift;	/* shift position fraction to get phase */
+	uint64_t phase_round;	/* add to position fraction to get nearest phase */
+	uint64_t one;		/* one input sample in units of position fraction */
+	int step_index;		/* distance between output samples (integer part) */
+	uint64_t step_frac;	/* distance between output samples (fraction part) */
+	int index;		/* position of next output sample (integer part) */
+	uint64_t frac;		/* position of next output sample (fraction part) */
+	sample_t *coeff;	/* coefficient bank: (phases + 1) * taps, reversed order */
+	sample_t *buf;		/* history of 'taps' samples, followed by input samples */
+	int buf_size;		/* size of buffer in samples */
+} samplerate_filter_t;
 
 typedef struct samplerate {
 	double factor;
-	double filter_cutoff;
-	struct {
-		iir_filter_t lp;
-		sample_t last_sample;
-		double in_index;
-	} down;
-	struct {
-		iir_filter_t lp;
-		sample_t current_sample;
-		sample_t last_sample;
-		double in_index;
-	} up;
+	int bypass;		/* both rates are equal, samples are not changed */
+	samplerate_filter_t down;
+	samplerate_filter_t up;
 } samplerate_t;
 
 int init_samplerate(samplerate_t *state, double low_samplerate, double high_samplerate, double filter_cutoff);
+int init_samplerate_quality(samplerate_t *state, double low_samplerate, double high_samplerate, double filter_cutoff, enum samplerate_quality quality);
+void exit_samplerate(samplerate_t *state);
 int samplerate_downsample_input_num(samplerate_t *state, int output_num);
 int samplerate_downsample_output_num(samplerate_t *state, int input_num);
 int samplerate_downsample(samplerate_t *state, sample_t *samples, int input_num);
 int samplerate_upsample_input_num(samplerate_t *state, int output_num);
 int samplerate_upsample_output_num(samplerate_t *state, int input_num);
-void samplerate_upsample(samplerate_t *state, sample_t *input, int input_num, sample_t *output, int output_num);
+int samplerate_upsample(samplerate_t *state, sample_t *input, int input_num, sample_t *output, int output_num);
@@ -0,0 +1,174 @@
+/* sample store, shared by all processes
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * Announcements and other recorded samples are not compiled into the
+ * programs. They are generated from the sources by samplestore_gen when
+ * building and installed as one file. See samplestore.h for the layout.
+ *
+ * When samples are requested the first time, the file is mapped read-only.
+ * All processes that map this file share the same pages, and only the pages
+ * of samples that are actually read are loaded from disk. Samples are not
+ * copied, the caller gets a pointer into the mapped file. On big endian
+ * hosts the file is mapped privately and the samples are swapped once.
+ *
+ * The file is searched at the path given by the environment variable
+ * SAMPLESTORE, then at the install path. To run programs without installing
+ * them, set SAMPLESTORE to src/libsamplestore/samples.store of the build.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../liblogging/logging.h"
+#include "samplestore.h"
+
+static int tried = 0;
+static const uint8_t *store = NULL;
+static uint32_t store_entries;
+
+static uint32_t get_u32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* map file and check that all entries are inside the file */
+static int map_store(const char *path)
+{
+	struct stat st;
+	const uint8_t *map, *entry;
+	uint32_t i, entries, offset, count;
+	size_t size;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) < 0 || st.st_size < SAMPLESTORE_HEADER) {
+		close(fd);
+		return -1;
+	}
+	size = st.st_size;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+#else
+	map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+#endif
+	close(fd);
+	if (map == MAP_FAILED)
+		return -1;
+
+	if (memcmp(map, SAMPLESTORE_MAGIC, 8))
+		goto invalid;
+	entries = get_u32(map + 8);
+	if (entries > (size - SAMPLESTORE_HEADER) / SAMPLESTORE_ENTRY)
+		goto invalid;
+	for (i = 0; i < entries; i++) {
+		entry = map + SAMPLESTORE_HEADER + i * SAMPLESTORE_ENTRY;
+		offset = get_u32(entry + SAMPLESTORE_NAME_LEN);
+		count = get_u32(entry + SAMPLESTORE_NAME_LEN + 4);
+		if (entry[SAMPLESTORE_NAME_LEN - 1] || (offset & 1) || offset > size || count > (size - offset) / 2)
+			goto invalid;
+	}
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	/* samples are little endian, swap them, so pointers to them can be given */
+	for (i = 0; i < entries; i++) {
+		uint8_t *data, swap;
+
+		entry = map + SAMPLESTORE_HEADER + i * SAMPLESTORE_ENTRY;
+		data = (uint8_t *)map + get_u32(entry + SAMPLESTORE_NAME_LEN);
+		for (count = get_u32(entry + SAMPLESTORE_NAME_LEN + 4); count; count--, data += 2) {
+			swap = data[0];
+			data[0] = data[1];
+			data[1] = swap;
+		}
+	}
+	mprotect((void *)map, size, PROT_READ);
+#endif
+
+	store = map;
+	store_entries = entries;
+	LOGP(DCALL, LOGL_DEBUG, "Using sample store '%s' with %u entries.\n", path, entries);
+
+	return 0;
+
+invalid:
+	LOGP(DCALL, LOGL_ERROR, "Sample store '%s' is corrupt!\n", path);
+	munmap((void *)map, size);
+	return -1;
+}
+
+static const uint8_t *find_entry(const char *name)
+{
+	const char *path;
+	const uint8_t *entry;
+	uint32_t i;
+
+	if (!tried) {
+		tried = 1;
+		path = getenv("SAMPLESTORE");
+		if (path && map_store(path) < 0)
+			LOGP(DCALL, LOGL_NOTICE, "Sample store '%s' given by SAMPLESTORE cannot be opened, trying default path.\n", path);
+		if (!store && map_store(SAMPLESTORE_PATH) < 0)
+			LOGP(DCALL, LOGL_NOTICE, "Sample store '%s' not found, announcements are replaced by tones and voice samples are not available.\n", SAMPLESTORE_PATH);
+	}
+	if (!store)
+		return NULL;
+
+	for (i = 0; i < store_entries; i++) {
+		entry = store + SAMPLESTORE_HEADER + i * SAMPLESTORE_ENTRY;
+		if (!strcmp((const char *)entry, name))
+			return entry;
+	}
+
+	return NULL;
+}
+
+/* return number of samples stored with the given name, or -1 if not found */
+int samplestore_size(const char *name)
+{
+	const uint8_t *entry;
+
+	entry = find_entry(name);
+	if (!entry)
+		return -1;
+
+	return get_u32(entry + SAMPLESTORE_NAME_LEN + 4);
+}
+
+/* return samples stored with the given name and their number, or NULL if not found
+ * the samples are not copied, they stay valid until the program exits */
+const int16_t *samplestore_get(const char *name, int *count)
+{
+	const uint8_t *entry;
+
+	entry = find_entry(name);
+	if (!entry)
+		return NULL;
+	*count = get_u32(entry + SAMPLESTORE_NAME_LEN + 4);
+
+	return (const int16_t *)(store + get_u32(entry + SAMPLESTORE_NAME_LEN));
+}
@@ -0,0 +1,18 @@
+/* Layout of the sample store file, all values are little endian:
+ *
+ * magic		8 bytes, see SAMPLESTORE_MAGIC
+ * number of entries	uint32
+ * reserved		uint32
+ * entries		name (SAMPLESTORE_NAME_LEN bytes, zero terminated),
+ *			offset of samples from start of file (uint32),
+ *			number of samples (uint32)
+ * samples		int16
+ */
+#define SAMPLESTORE_MAGIC	"OSMOSPL1"
+#define SAMPLESTORE_NAME_LEN	32
+#define SAMPLESTORE_HEADER	16
+#define SAMPLESTORE_ENTRY	(SAMPLESTORE_NAME_LEN + 8)
+
+int samplestore_size(const char *name);
+const int16_t *samplestore_get(const char *name, int *count);
+
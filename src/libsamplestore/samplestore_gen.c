@@ -0,0 +1,188 @@
+/* generate sample store from sample tables in C sources
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * Each argument after the output file gives the name of an entry, the source
+ * file and the array inside the source file: <name>=<file>:<array>
+ *
+ * The array is searched in the source file and all numbers between the
+ * braces of the initializer are read as 16 bit samples. The numbers may be
+ * hexadecimal or decimal and may be given as unsigned 16 bit values.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "samplestore.h"
+
+struct entry {
+	char name[SAMPLESTORE_NAME_LEN];
+	int16_t *spl;
+	uint32_t count;
+};
+
+static char *read_file(const char *filename)
+{
+	FILE *fp;
+	char *text;
+	long size;
+
+	fp = fopen(filename, "r");
+	if (!fp) {
+		fprintf(stderr, "Failed to open '%s'\n", filename);
+		return NULL;
+	}
+	fseek(fp, 0, SEEK_END);
+	size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	text = malloc(size + 1);
+	if (!text || fread(text, 1, size, fp) != (size_t)size) {
+		fprintf(stderr, "Failed to read '%s'\n", filename);
+		fclose(fp);
+		free(text);
+		return NULL;
+	}
+	text[size] = '\0';
+	fclose(fp);
+
+	return text;
+}
+
+/* find "<array>[" followed by an initializer and read all numbers */
+static int parse_array(struct entry *e, const char *text, const char *array)
+{
+	const char *p = text, *end;
+	size_t len = strlen(array);
+	uint32_t size = 0;
+	long value;
+
+	while ((p = strstr(p, array))) {
+		if ((p == text || !(isalnum((unsigned char)p[-1]) || p[-1] == '_')) && p[len] == '[')
+			break;
+		p += len;
+	}
+	if (!p)
+		return -1;
+	p = strchr(p, '{');
+	if (!p)
+		return -1;
+	p++;
+
+	while (1) {
+		while (isspace((unsigned char)*p) || *p == ',')
+			p++;
+		if (*p == '}')
+			break;
+		value = strtol(p, (char **)&end, 0);
+		if (end == p || value < -32768 || value > 65535)
+			return -1;
+		p = end;
+		if (e->count == size) {
+			size = (size) ? size * 2 : 65536;
+			e->spl = realloc(e->spl, size * sizeof(*e->spl));
+			if (!e->spl)
+				return -1;
+		}
+		e->spl[e->count++] = (int16_t)(uint16_t)value;
+	}
+
+	return 0;
+}
+
+static void put_u32(FILE *fp, uint32_t value)
+{
+	fputc(value, fp);
+	fputc(value >> 8, fp);
+	fputc(value >> 16, fp);
+	fputc(value >> 24, fp);
+}
+
+int main(int argc, char *argv[])
+{
+	struct entry *entries;
+	char *name, *file, *array, *text;
+	uint32_t offset, s;
+	FILE *fp;
+	int num, i;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <output> <name>=<file>:<array> ...\n", argv[0]);
+		return 1;
+	}
+
+	num = argc - 2;
+	entries = calloc(num, sizeof(*entries));
+	if (!entries)
+		return 1;
+	for (i = 0; i < num; i++) {
+		name = strdup(argv[i + 2]);
+		file = strchr(name, '=');
+		array = (file) ? strrchr(file, ':') : NULL;
+		if (!array || strlen(name) - strlen(file) >= SAMPLESTORE_NAME_LEN) {
+			fprintf(stderr, "Invalid entry '%s'\n", argv[i + 2]);
+			return 1;
+		}
+		*file++ = '\0';
+		*array++ = '\0';
+		strcpy(entries[i].name, name);
+		text = read_file(file);
+		if (!text)
+			return 1;
+		if (parse_array(&entries[i], text, array) < 0) {
+			fprintf(stderr, "Failed to parse array '%s' in '%s'\n", array, file);
+			return 1;
+		}
+		free(text);
+		free(name);
+	}
+
+	fp = fopen(argv[1], "w");
+	if (!fp) {
+		fprintf(stderr, "Failed to create '%s'\n", argv[1]);
+		return 1;
+	}
+	fwrite(SAMPLESTORE_MAGIC, 8, 1, fp);
+	put_u32(fp, num);
+	put_u32(fp, 0);
+	offset = SAMPLESTORE_HEADER + num * SAMPLESTORE_ENTRY;
+	for (i = 0; i < num; i++) {
+		fwrite(entries[i].name, SAMPLESTORE_NAME_LEN, 1, fp);
+		put_u32(fp, offset);
+		put_u32(fp, entries[i].count);
+		offset += entries[i].count * 2;
+	}
+	for (i = 0; i < num; i++) {
+		for (s = 0; s < entries[i].count; s++) {
+			fputc(entries[i].spl[s], fp);
+			fputc((uint16_t)entries[i].spl[s] >> 8, fp);
+		}
+		free(entries[i].spl);
+	}
+	free(entries);
+	if (fclose(fp)) {
+		fprintf(stderr, "Failed to write '%s'\n", argv[1]);
+		remove(argv[1]);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,162 @@
+/* vectorized operations on interleaved IQ samples
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * IQ samples are stored as pairs of floats (I, Q, I, Q, ...). One vector of
+ * four float lanes holds two IQ samples. The compiler translates this to SSE2
+ * on x86_64 and to NEON on ARM64. Because I and Q alternate, each constant
+ * (like the DC bias) is stored as { I, Q, I, Q } in a vector.
+ *
+ * Vectors are loaded and stored with memcpy(), so the buffers do not need to
+ * be aligned. An odd number of IQ samples leaves one sample, which is
+ * processed without vector.
+ *
+ * Sums are done with float vectors over a block of samples, then added to
+ * double, so that the precision does not degrade when many samples are
+ * summed up.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "iq_vector.h"
+
+typedef int32_t v4si __attribute__ ((vector_size (16)));
+typedef float v4sf __attribute__ ((vector_size (16)));
+
+#define SUM_BLOCK	256	/* IQ samples to sum with float precision */
+
+/* add all I and all Q values */
+void iq_sum(const float *iq, int num, double *sum_i, double *sum_q)
+{
+	v4sf sum, v;
+	int n, s;
+
+	while (num > 1) {
+		n = (num > SUM_BLOCK) ? SUM_BLOCK : num;
+		n &= ~1;
+		sum = (v4sf){ 0.0f, 0.0f, 0.0f, 0.0f };
+		for (s = 0; s < n; s += 2) {
+			memcpy(&v, iq + s * 2, sizeof(v));
+			sum += v;
+		}
+		*sum_i += sum[0] + sum[2];
+		*sum_q += sum[1] + sum[3];
+		iq += n * 2;
+		num -= n;
+	}
+	if (num) {
+		*sum_i += iq[0];
+		*sum_q += iq[1];
+	}
+}
+
+/* subtract DC bias */
+void iq_remove_dc(float *iq, int num, float dc_i, float dc_q)
+{
+	v4sf dc = { dc_i, dc_q, dc_i, dc_q }, v;
+	int s;
+
+	for (s = 0; s + 1 < num; s += 2) {
+		memcpy(&v, iq + s * 2, sizeof(v));
+		v -= dc;
+		memcpy(iq + s * 2, &v, sizeof(v));
+	}
+	if (s < num) {
+		iq[s * 2] -= dc_i;
+		iq[s * 2 + 1] -= dc_q;
+	}
+}
+
+/* multiply by gain and repeat each sample 'factor' times (sample and hold) */
+void iq_interpolate(const float *in, int num, int factor, float gain, float *out)
+{
+	v4sf v, w;
+	int s, o;
+
+	switch (factor) {
+	case 1:
+		for (s = 0; s + 1 < num; s += 2) {
+			memcpy(&v, in + s * 2, sizeof(v));
+			v *= gain;
+			memcpy(out + s * 2, &v, sizeof(v));
+		}
+		if (s < num) {
+			out[s * 2] = in[s * 2] * gain;
+			out[s * 2 + 1] = in[s * 2 + 1] * gain;
+		}
+		break;
+	case 2:
+		for (s = 0; s + 1 < num; s += 2) {
+			memcpy(&v, in + s * 2, sizeof(v));
+			v *= gain;
+			w = __builtin_shuffle(v, (v4si){ 0, 1, 0, 1 });
+			memcpy(out + s * 4, &w, sizeof(w));
+			w = __builtin_shuffle(v, (v4si){ 2, 3, 2, 3 });
+			memcpy(out + s * 4 + 4, &w, sizeof(w));
+		}
+		if (s < num) {
+			out[s * 4] = out[s * 4 + 2] = in[s * 2] * gain;
+			out[s * 4 + 1] = out[s * 4 + 3] = in[s * 2 + 1] * gain;
+		}
+		break;
+	default:
+		/* store the sample twice with each vector */
+		for (s = 0; s < num; s++) {
+			v = (v4sf){ in[0], in[1], in[0], in[1] } * gain;
+			for (o = 0; o + 1 < factor; o += 2) {
+				memcpy(out, &v, sizeof(v));
+				out += 4;
+			}
+			if (o < factor) {
+				memcpy(out, &v, sizeof(*out) * 2);
+				out += 2;
+			}
+			in += 2;
+		}
+	}
+}
+
+/* take every 'factor'th sample, starting with sample '*offset'
+ * '*offset' is set to the sample to start with at next input
+ * returns the number of output samples */
+int iq_decimate(const float *in, int num, int factor, int *offset, float *out)
+{
+	v4sf a, b;
+	int s, count = 0;
+
+	s = *offset;
+	if (factor == 2) {
+		for (; s + 3 < num; s += 4) {
+			memcpy(&a, in + s * 2, sizeof(a));
+			memcpy(&b, in + s * 2 + 4, sizeof(b));
+			a = __builtin_shuffle(a, b, (v4si){ 0, 1, 4, 5 });
+			memcpy(out + count * 2, &a, sizeof(a));
+			count += 2;
+		}
+	}
+	/* one IQ sample is copied as a whole (64 bits) */
+	for (; s < num; s += factor) {
+		memcpy(out + count * 2, in + s * 2, sizeof(*out) * 2);
+		count++;
+	}
+	*offset = s - num;
+
+	return count;
+}
@@ -0,0 +1,6 @@
+
+void iq_sum(const float *iq, int num, double *sum_i, double *sum_q);
+void iq_remove_dc(float *iq, int num, float dc_i, float dc_q);
+void iq_interpolate(const float *in, int num, int factor, float gain, float *out);
+int iq_decimate(const float *in, int num, int factor, int *offset, float *out);
+
@@ -0,0 +1,386 @@
+/* IQ file, pipe and socket access instead of SDR device
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * Raw IQ samples are read from a file, a FIFO, stdin ('-') or a Unix socket
+ * ('unix:<path>'). Transmitted IQ samples are written the same way, or they
+ * are discarded, if no TX file is given.
+ *
+ * Supported formats are interleaved I and Q as 32 bit float (cf32), signed
+ * 16 bit (cs16) or unsigned 8 bit (cu8, like rtl_sdr). Samples are in host
+ * byte order.
+ *
+ * In real time mode, the number of samples that can be received is given by
+ * the time since start, so it behaves like an SDR. In free running mode, the
+ * samples are received as fast as they can be read. The processing loop waits
+ * for received samples, so everything runs as fast as the CPU allows.
+ *
+ * Instead of time stamps, the number of received and transmitted samples is
+ * counted. tosend() returns the number of samples that are needed, to make TX
+ * count advance RX count by the given buffer size. So TX is paced by RX in
+ * both modes.
+ *
+ * When the end of the RX file is reached, receive() returns -EPERM, which
+ * makes the process quit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "iqfile.h"
+#include "../liblogging/logging.h"
+
+enum iq_format {
+	IQ_FORMAT_CF32,
+	IQ_FORMAT_CS16,
+	IQ_FORMAT_CU8,
+};
+
+static struct iqfile {
+	int			rx_fd, tx_fd;
+	enum iq_format		format;
+	int			sample_bytes;		/* bytes of one IQ sample */
+	double			samplerate;
+	int			free_running;
+	double			start_time;		/* time of start (real time mode) */
+	pthread_mutex_t		count_mutex;
+	int64_t			rx_count;		/* samples received */
+	int64_t			tx_count;		/* samples transmitted or discarded */
+	int			tx_valid;		/* TX count is set in advance of RX count */
+	uint8_t			*rx_buffer;		/* raw samples */
+	int			rx_fill;		/* bytes of incomplete sample in buffer */
+	int			rx_size;
+	uint8_t			*tx_buffer;
+	int			tx_size;
+	int			eof;			/* end of RX file */
+} iq = {
+	.rx_fd = -1,
+	.tx_fd = -1,
+};
+
+static double get_time_monotonic(void)
+{
+	struct timespec tv;
+
+	clock_gettime(CLOCK_MONOTONIC, &tv);
+
+	return (double)tv.tv_sec + (double)tv.tv_nsec / 1000000000.0;
+}
+
+static int open_path(const char *path, int tx)
+{
+	struct sockaddr_un sa;
+	int fd;
+
+	if (!strcmp(path, "-"))
+		return dup((tx) ? STDOUT_FILENO : STDIN_FILENO);
+
+	if (!strncmp(path, "unix:", 5)) {
+		path += 5;
+		if (strlen(path) >= sizeof(sa.sun_path)) {
+			LOGP(DSDR, LOGL_ERROR, "Socket path '%s' is too long.\n", path);
+			return -EINVAL;
+		}
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+			return -errno;
+		memset(&sa, 0, sizeof(sa));
+		sa.sun_family = AF_UNIX;
+		strcpy(sa.sun_path, path);
+		if (connect(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+			close(fd);
+			return -errno;
+		}
+		return fd;
+	}
+
+	/* opening a FIFO blocks until the other side opens it */
+	if (tx)
+		fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	else
+		fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -errno;
+	return fd;
+}
+
+int iqfile_open(const char *rx_path, const char *tx_path, const char *format, double rate, int free_running, int buffer_size)
+{
+	if (!strcmp(format, "cf32")) {
+		iq.format = IQ_FORMAT_CF32;
+		iq.sample_bytes = 2 * sizeof(float);
+	} else if (!strcmp(format, "cs16")) {
+		iq.format = IQ_FORMAT_CS16;
+		iq.sample_bytes = 2 * sizeof(int16_t);
+	} else if (!strcmp(format, "cu8")) {
+		iq.format = IQ_FORMAT_CU8;
+		iq.sample_bytes = 2 * sizeof(uint8_t);
+	} else {
+		LOGP(DSDR, LOGL_ERROR, "Unknown IQ format '%s', use 'cf32', 'cs16' or 'cu8'.\n", format);
+		return -EINVAL;
+	}
+	iq.samplerate = rate;
+	iq.free_running = free_running;
+	pthread_mutex_init(&iq.count_mutex, NULL);
+
+	iq.rx_size = buffer_size * iq.sample_bytes;
+	iq.rx_buffer = calloc(iq.rx_size, 1);
+	iq.tx_size = buffer_size * iq.sample_bytes;
+	iq.tx_buffer = calloc(iq.tx_size, 1);
+	if (!iq.rx_buffer || !iq.tx_buffer) {
+		LOGP(DSDR, LOGL_ERROR, "No mem!\n");
+		iqfile_close();
+		return -ENOMEM;
+	}
+
+	LOGP(DSDR, LOGL_INFO, "Reading %s IQ samples from '%s' at %.0f samples/s (%s).\n", format, rx_path, rate, (free_running) ? "free running" : "real time");
+	iq.rx_fd = open_path(rx_path, 0);
+	if (iq.rx_fd < 0) {
+		LOGP(DSDR, LOGL_ERROR, "Failed to open '%s' for reading IQ samples (errno %d).\n", rx_path, -iq.rx_fd);
+		iqfile_close();
+		return -EIO;
+	}
+
+	if (tx_path && tx_path[0]) {
+		LOGP(DSDR, LOGL_INFO, "Writing %s IQ samples to '%s'.\n", format, tx_path);
+		/* a socket is used for both directions */
+		if (!strncmp(tx_path, "unix:", 5) && !strcmp(tx_path, rx_path))
+			iq.tx_fd = dup(iq.rx_fd);
+		else
+			iq.tx_fd = open_path(tx_path, 1);
+		if (iq.tx_fd < 0) {
+			LOGP(DSDR, LOGL_ERROR, "Failed to open '%s' for writing IQ samples (errno %d).\n", tx_path, -iq.tx_fd);
+			iqfile_close();
+			return -EIO;
+		}
+	} else
+		LOGP(DSDR, LOGL_INFO, "No TX file given, transmitted IQ samples are discarded.\n");
+
+	return 0;
+}
+
+int iqfile_start(void)
+{
+	iq.start_time = get_time_monotonic();
+
+	return 0;
+}
+
+void iqfile_close(void)
+{
+	LOGP(DSDR, LOGL_DEBUG, "Clean up IQ file\n");
+	if (iq.rx_fd >= 0) {
+		close(iq.rx_fd);
+		iq.rx_fd = -1;
+	}
+	if (iq.tx_fd >= 0) {
+		close(iq.tx_fd);
+		iq.tx_fd = -1;
+	}
+	free(iq.rx_buffer);
+	iq.rx_buffer = NULL;
+	free(iq.tx_buffer);
+	iq.tx_buffer = NULL;
+	if (iq.sample_bytes) {
+		pthread_mutex_destroy(&iq.count_mutex);
+		iq.sample_bytes = 0;
+	}
+}
+
+static void iq_to_float(float *buff, const uint8_t *raw, int num)
+{
+	int i;
+
+	switch (iq.format) {
+	case IQ_FORMAT_CF32:
+		memcpy(buff, raw, num * 2 * sizeof(float));
+		break;
+	case IQ_FORMAT_CS16:
+		for (i = 0; i < num * 2; i++)
+			buff[i] = (float)((const int16_t *)raw)[i] / 32768.0f;
+		break;
+	case IQ_FORMAT_CU8:
+		for (i = 0; i < num * 2; i++)
+			buff[i] = ((float)raw[i] - 127.5f) / 127.5f;
+		break;
+	}
+}
+
+static void float_to_iq(uint8_t *raw, const float *buff, int num)
+{
+	float value;
+	int i;
+
+	switch (iq.format) {
+	case IQ_FORMAT_CF32:
+		memcpy(raw, buff, num * 2 * sizeof(float));
+		break;
+	case IQ_FORMAT_CS16:
+		for (i = 0; i < num * 2; i++) {
+			value = buff[i] * 32767.0f;
+			if (value > 32767.0f)
+				value = 32767.0f;
+			if (value < -32767.0f)
+				value = -32767.0f;
+			((int16_t *)raw)[i] = (int16_t)value;
+		}
+		break;
+	case IQ_FORMAT_CU8:
+		for (i = 0; i < num * 2; i++) {
+			value = buff[i] * 127.5f + 127.5f;
+			if (value > 255.0f)
+				value = 255.0f;
+			if (value < 0.0f)
+				value = 0.0f;
+			raw[i] = (uint8_t)(value + 0.5f);
+		}
+		break;
+	}
+}
+
+int iqfile_send(float *buff, int num)
+{
+	int chunk, len, sent = 0;
+	uint8_t *p;
+
+	while (sent < num) {
+		chunk = num - sent;
+		if (chunk > iq.tx_size / iq.sample_bytes)
+			chunk = iq.tx_size / iq.sample_bytes;
+		if (iq.tx_fd >= 0) {
+			float_to_iq(iq.tx_buffer, buff + sent * 2, chunk);
+			p = iq.tx_buffer;
+			len = chunk * iq.sample_bytes;
+			while (len) {
+				int rc = write(iq.tx_fd, p, len);
+				if (rc < 0) {
+					if (errno == EINTR)
+						continue;
+					LOGP(DSDR, LOGL_ERROR, "Failed to write IQ samples (errno %d), discarding from now on.\n", errno);
+					close(iq.tx_fd);
+					iq.tx_fd = -1;
+					break;
+				}
+				p += rc;
+				len -= rc;
+			}
+		}
+		sent += chunk;
+	}
+
+	pthread_mutex_lock(&iq.count_mutex);
+	iq.tx_count += sent;
+	pthread_mutex_unlock(&iq.count_mutex);
+
+	return sent;
+}
+
+/* read what we got, return 0, if nothing is available now, -EPERM at the end of file */
+int iqfile_receive(float *buff, int max)
+{
+	int64_t available;
+	int len, count;
+
+	if (iq.eof)
+		return -EPERM;
+
+	if (max > iq.rx_size / iq.sample_bytes)
+		max = iq.rx_size / iq.sample_bytes;
+
+	/* behave like an SDR: receive what has been sampled since start */
+	if (!iq.free_running) {
+		available = (int64_t)((get_time_monotonic() - iq.start_time) * iq.samplerate) - iq.rx_count;
+		if (available <= 0)
+			return 0;
+		if (max > available)
+			max = available;
+	}
+
+	/* read blocks, if not all samples are available yet */
+	len = read(iq.rx_fd, iq.rx_buffer + iq.rx_fill, max * iq.sample_bytes - iq.rx_fill);
+	if (len < 0) {
+		if (errno == EINTR || errno == EAGAIN)
+			return 0;
+		LOGP(DSDR, LOGL_ERROR, "Failed to read IQ samples (errno %d).\n", errno);
+		iq.eof = 1;
+		return -EPERM;
+	}
+	if (len == 0) {
+		LOGP(DSDR, LOGL_NOTICE, "End of IQ file reached after %.3f seconds of samples.\n", (double)iq.rx_count / iq.samplerate);
+		iq.eof = 1;
+		return -EPERM;
+	}
+	iq.rx_fill += len;
+
+	/* keep bytes of an incomplete sample for next read */
+	count = iq.rx_fill / iq.sample_bytes;
+	iq_to_float(buff, iq.rx_buffer, count);
+	iq.rx_fill -= count * iq.sample_bytes;
+	memmove(iq.rx_buffer, iq.rx_buffer + count * iq.sample_bytes, iq.rx_fill);
+
+	pthread_mutex_lock(&iq.count_mutex);
+	iq.rx_count += count;
+	pthread_mutex_unlock(&iq.count_mutex);
+
+	return count;
+}
+
+/* estimate number of samples that can be sent */
+int iqfile_get_tosend(int buffer_size)
+{
+	int tosend;
+
+	/* we must wait until we received something */
+	if (!iq.rx_count)
+		return 0;
+
+	/* start transmitting at the current RX count, so TX will be in advance by buffer_size */
+	if (!iq.tx_valid) {
+		pthread_mutex_lock(&iq.count_mutex);
+		iq.tx_count = iq.rx_count;
+		pthread_mutex_unlock(&iq.count_mutex);
+		iq.tx_valid = 1;
+	}
+
+	pthread_mutex_lock(&iq.count_mutex);
+	tosend = buffer_size - (iq.tx_count - iq.rx_count);
+	pthread_mutex_unlock(&iq.count_mutex);
+
+	if (tosend > buffer_size)
+		tosend = buffer_size;
+	if (tosend < 0)
+		tosend = 0;
+
+	return tosend;
+}
+
+/* end of file, all samples have been received */
+int iqfile_eof(void)
+{
+	return iq.eof;
+}
@@ -0,0 +1,9 @@
+
+int iqfile_open(const char *rx_path, const char *tx_path, const char *format, double rate, int free_running, int buffer_size);
+int iqfile_start(void);
+void iqfile_close(void);
+int iqfile_send(float *buff, int num);
+int iqfile_receive(float *buff, int max);
+int iqfile_get_tosend(int buffer_size);
+int iqfile_eof(void);
+
@@ -25,12 +25,16 @@ enum paging_signal;
 #include <string.h>
 #include <errno.h>
 #include <math.h>
+#include <stdatomic.h>
 #define __USE_GNU
 #include <pthread.h>
 #include <unistd.h>
+#include <poll.h>
 #include "../libsample/sample.h"
 #include "../libfm/fm.h"
 #include "../libam/am.h"
+#include "../libchannelizer/channelizer.h"
+#include "../libringbuffer/ringbuffer.h"
 #include <osmocom/core/timer.h>
 #include "../libmobile/sender.h"
 #include "sdr_config.h"
@@ -41,6 +45,10 @@ enum paging_signal;
 #ifdef HAVE_SOAPY
 #include "soapy.h"
 #endif
+#ifdef HAVE_IQFILE
+#include "iqfile.h"
+#endif
+#include "iq_vector.h"
 #include "../liblogging/logging.h"
 
 /* enable to debug buffer handling */
@@ -55,18 +63,23 @@ enum paging_signal;
 /* limit the IQ level to prevent IIR filter from exceeding range of -1 .. 1 */
 #define LIMIT_IQ_LEVEL		0.95
 
+/* below this number of channels, mixing and demodulating each channel at sample rate is faster */
+#define CHANNELIZER_MIN_CHANNELS	8
+
+/* below this number of channels, modulating and mixing each channel at sample rate is faster */
+#define COMBINER_MIN_CHANNELS		64
+
 int sdr_rx_overflow = 0;
 
 typedef struct sdr_thread {
 	int use;
 	volatile int running, exit;	/* flags to control exit of threads */
-	int buffer_size;
-	volatile float *buffer;
+	ringbuffer_t ring;		/* IQ samples between thread and SDR functions */
 	float *buffer2;
-	volatile int in, out;		/* in and out pointers (atomic, so no locking required) */
 	int max_fill;			/* measure maximum buffer fill */
 	double max_fill_timer;		/* timer to display/reset maximum fill */
 	iir_filter_t lp[2];		/* filter for upsample/downsample IQ data */
+	atomic_int eof;			/* end of received IQ file, set after the last samples are written */
 } sdr_thread_t;
 
 typedef struct sdr_chan {
@@ -77,6 +90,14 @@ typedef struct sdr_chan {
 	fm_demod_t	fm_demod;	/* demodulator instance */
 	am_mod_t	am_mod;		/* modulator instance */
 	am_demod_t	am_demod;	/* demodulator instance */
+	int		tx_bin;		/* combiner bin of this channel */
+	float		*tx_narrowband;	/* IQ samples of channel towards combiner */
+	samplerate_t	tx_decimator;	/* low-pass filter and decimation of samples to combiner rate */
+	decimator_t	decimator;	/* decimator instance */
+	float		*narrowband;	/* IQ samples of channel after channelizer or decimator */
+	sample_t	*fifo;		/* demodulated samples, interpolated to sample rate */
+	int		fifo_fill;	/* number of samples in fifo */
+	samplerate_t	interpolator;	/* polyphase interpolation of demodulated samples to sample rate */
 	dispmeasparam_t	*dmp_rf_level;
 	dispmeasparam_t	*dmp_freq_offset;
 	dispmeasparam_t	*dmp_deviation;
@@ -88,6 +109,20 @@ typedef struct sdr {
 	sdr_thread_t	thread_read,
 			thread_write;
 	sdr_chan_t	*chan;		/* settings for all channels */
+	int		use_channelizer;/* split RX channels by channelizer */
+	channelizer_t	channelizer;	/* channelizer instance */
+	int		*chan_bin;	/* list of channelizer bins of all channels */
+	float		**chan_narrowband; /* list of IQ buffers of all channels */
+	int		use_decimator;	/* decimate each RX channel */
+	int		decimate_sdr_rate; /* decimator takes IQ samples at SDR rate and outputs them at sample rate */
+	float		*wideband;	/* IQ samples at SDR rate for decimator */
+	sample_t	*narrow_samples;/* demodulated samples at channelizer or decimator rate */
+	int		use_combiner;	/* combine TX channels by combiner */
+	combiner_t	combiner;	/* combiner instance */
+	int		*comb_bin;	/* list of combiner bins of all channels */
+	float		**comb_narrowband; /* list of IQ buffers of all channels */
+	uint8_t		*comb_power;	/* decimated power states */
+	int		comb_phase;	/* sample position to decimate */
 	int		paging_channel;	/* if set, points to paging channel */
 	sdr_chan_t	paging_chan;	/* settings for extra paging channel */
 	int		channels;	/* number of frequencies */
@@ -141,6 +176,7 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 {
 	sdr_t *sdr;
 	int threads = 1, oversample = 1; /* always use threads */
+	int rx_samplerate; /* sample rate of received IQ samples before demodulation */
 	double bandwidth;
 	double tx_center_frequency = 0.0, rx_center_frequency = 0.0;
 	int rc;
@@ -162,6 +198,12 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 		oversample = sdr_config->samplerate / samplerate;
 		threads = 1;
 	}
+	/* decimator cannot resample by other factors than 2^n, interpolating would add images to the audio */
+	if (sdr_config->decimator && channels && rx_frequency && (oversample & (oversample - 1))) {
+		LOGP(DSDR, LOGL_ERROR, "SDR sample rate must be audio sample rate * 2^n to use decimator!\n");
+		LOGP(DSDR, LOGL_ERROR, "You selected an SDR rate of %d and an audio rate of %d.\n", sdr_config->samplerate, samplerate);
+		return NULL;
+	}
 
 	bandwidth = 2.0 * (max_deviation + max_modulation);
 	if (bandwidth)
@@ -180,37 +222,39 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 	sdr->threads = threads; /* always required, because write may block */
 	sdr->oversample = oversample;
 
+	/* Decimate from SDR rate to sample rate, so no interpolation is required afterwards.
+	 * Then the filter of the read thread and the decimation of the IQ samples are not used. */
+	if (sdr_config->decimator && channels && rx_frequency && oversample > 1)
+		sdr->decimate_sdr_rate = 1;
+	rx_samplerate = (sdr->decimate_sdr_rate) ? sdr_config->samplerate : samplerate;
+
 	if (threads) {
 		memset(&sdr->thread_read, 0, sizeof(sdr->thread_read));
-		sdr->thread_read.buffer_size = sdr->buffer_size * 2 * sdr->oversample + 2;
-		sdr->thread_read.buffer = calloc(sdr->thread_read.buffer_size, sizeof(*sdr->thread_read.buffer));
-		if (!sdr->thread_read.buffer) {
+		atomic_init(&sdr->thread_read.eof, 0);
+		/* ring buffer of IQ samples (two floats each) */
+		if (ringbuffer_init(&sdr->thread_read.ring, sdr->buffer_size * sdr->oversample + 1, sizeof(float) * 2, RINGBUFFER_WAKEUP) < 0) {
 			LOGP(DSDR, LOGL_ERROR, "No mem!\n");
 			goto error;
 		}
-		sdr->thread_read.buffer2 = calloc(sdr->thread_read.buffer_size, sizeof(*sdr->thread_read.buffer2));
+		sdr->thread_read.buffer2 = calloc(sdr->thread_read.ring.size * 2, sizeof(*sdr->thread_read.buffer2));
 		if (!sdr->thread_read.buffer2) {
 			LOGP(DSDR, LOGL_ERROR, "No mem!\n");
 			goto error;
 		}
-		sdr->thread_read.in = sdr->thread_read.out = 0;
 		if (oversample > 1) {
 			iir_lowpass_init(&sdr->thread_read.lp[0], samplerate / 2.0, sdr_config->samplerate, 2);
 			iir_lowpass_init(&sdr->thread_read.lp[1], samplerate / 2.0, sdr_config->samplerate, 2);
 		}
 		memset(&sdr->thread_write, 0, sizeof(sdr->thread_write));
-		sdr->thread_write.buffer_size = sdr->buffer_size * 2 + 2;
-		sdr->thread_write.buffer = calloc(sdr->thread_write.buffer_size, sizeof(*sdr->thread_write.buffer));
-		if (!sdr->thread_write.buffer) {
+		if (ringbuffer_init(&sdr->thread_write.ring, sdr->buffer_size + 1, sizeof(float) * 2, RINGBUFFER_WAKEUP) < 0) {
 			LOGP(DSDR, LOGL_ERROR, "No mem!\n");
 			goto error;
 		}
-		sdr->thread_write.buffer2 = calloc(sdr->thread_write.buffer_size * sdr->oversample, sizeof(*sdr->thread_write.buffer2));
+		sdr->thread_write.buffer2 = calloc(sdr->thread_write.ring.size * 2 * sdr->oversample, sizeof(*sdr->thread_write.buffer2));
 		if (!sdr->thread_write.buffer2) {
 			LOGP(DSDR, LOGL_ERROR, "No mem!\n");
 			goto error;
 		}
-		sdr->thread_write.in = sdr->thread_write.out = 0;
 		if (oversample > 1) {
 			iir_lowpass_init(&sdr->thread_write.lp[0], samplerate / 2.0, sdr_config->samplerate, 2);
 			iir_lowpass_init(&sdr->thread_write.lp[1], samplerate / 2.0, sdr_config->samplerate, 2);
@@ -238,12 +282,13 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 		LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
 		goto error;
 	}
-	sdr->wavespl0 = calloc(sdr->buffer_size, sizeof(*sdr->wavespl0));
+	/* received IQ samples are recorded at SDR rate, if they are decimated from SDR rate */
+	sdr->wavespl0 = calloc(sdr->buffer_size * ((sdr->decimate_sdr_rate) ? sdr->oversample : 1), sizeof(*sdr->wavespl0));
 	if (!sdr->wavespl0) {
 		LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
 		goto error;
 	}
-	sdr->wavespl1 = calloc(sdr->buffer_size, sizeof(*sdr->wavespl1));
+	sdr->wavespl1 = calloc(sdr->buffer_size * ((sdr->decimate_sdr_rate) ? sdr->oversample : 1), sizeof(*sdr->wavespl1));
 	if (!sdr->wavespl1) {
 		LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
 		goto error;
@@ -279,6 +324,7 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 		/* calculate required bandwidth (IQ rate) */
 
 		double tx_low_frequency = 0.0, tx_high_frequency = 0.0;
+		double mod_samplerate;
 		for (c = 0; c < channels; c++) {
 			sdr->chan[c].tx_frequency = tx_frequency[c];
 			if (c == 0 || sdr->chan[c].tx_frequency < tx_low_frequency)
@@ -349,6 +395,26 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 		/* show spectrum */
 		show_spectrum("TX", (double)samplerate / 2.0, tx_center_frequency, tx_frequency, paging_frequency, channels);
 
+		/* use combiner to combine channels into spectrum */
+		if (sdr_config->combiner && channels < COMBINER_MIN_CHANNELS)
+			LOGP(DSDR, LOGL_NOTICE, "Combiner is slower than mixing below %d channels, so it is not used.\n", COMBINER_MIN_CHANNELS);
+		else if (sdr_config->combiner) {
+			rc = combiner_init(&sdr->combiner, samplerate, bandwidth, sdr->buffer_size);
+			if (rc < 0) {
+				LOGP(DSDR, LOGL_ERROR, "Failed to init combiner!\n");
+				goto error;
+			}
+			sdr->use_combiner = 1;
+			LOGP(DSDR, LOGL_INFO, "Using combiner with %d bins, sample rate of each channel is %.0f Hz.\n", sdr->combiner.bins, combiner_samplerate(&sdr->combiner));
+			sdr->comb_bin = calloc(channels, sizeof(*sdr->comb_bin));
+			sdr->comb_narrowband = calloc(channels, sizeof(*sdr->comb_narrowband));
+			sdr->comb_power = calloc(sdr->buffer_size / sdr->combiner.interpolation + 1, sizeof(*sdr->comb_power));
+			if (!sdr->comb_bin || !sdr->comb_narrowband || !sdr->comb_power) {
+				LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
+				goto error;
+			}
+		}
+
 		/* range of TX */
 		double low_side, high_side, range;
 		low_side = (tx_center_frequency - tx_low_frequency) + bandwidth / 2.0;
@@ -369,13 +435,31 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 			tx_offset = sdr->chan[c].tx_frequency - tx_center_frequency;
 			LOGP(DSDR, LOGL_DEBUG, "Frequency #%d: TX offset: %.6f MHz\n", c, tx_offset / 1e6);
 			sdr->chan[c].am = am[c];
+			mod_samplerate = samplerate;
+			if (sdr->use_combiner) {
+				/* modulator only needs to shift the remaining offset to the center of the bin */
+				sdr->chan[c].tx_bin = combiner_bin(&sdr->combiner, tx_offset, &tx_offset);
+				mod_samplerate = combiner_samplerate(&sdr->combiner);
+				LOGP(DSDR, LOGL_DEBUG, "Frequency #%d: combiner bin %d, remaining TX offset: %.3f KHz\n", c, sdr->chan[c].tx_bin, tx_offset / 1e3);
+				sdr->chan[c].tx_narrowband = calloc((sdr->buffer_size / sdr->combiner.interpolation + 1) * 2, sizeof(*sdr->chan[c].tx_narrowband));
+				if (!sdr->chan[c].tx_narrowband) {
+					LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
+					goto error;
+				}
+				sdr->comb_narrowband[c] = sdr->chan[c].tx_narrowband;
+				rc = init_samplerate(&sdr->chan[c].tx_decimator, mod_samplerate, samplerate, max_modulation);
+				if (rc < 0) {
+					LOGP(DSDR, LOGL_ERROR, "Failed to init decimator!\n");
+					goto error;
+				}
+			}
 			if (am[c]) {
 				double gain, bias;
 				gain = modulation_index / 2.0;
 				bias = 1.0 - gain;
-				rc = am_mod_init(&sdr->chan[c].am_mod, samplerate, tx_offset, sdr->amplitude * gain, sdr->amplitude * bias);
+				rc = am_mod_init(&sdr->chan[c].am_mod, mod_samplerate, tx_offset, sdr->amplitude * gain, sdr->amplitude * bias);
 			} else
-				rc = fm_mod_init(&sdr->chan[c].fm_mod, samplerate, tx_offset, sdr->amplitude);
+				rc = fm_mod_init(&sdr->chan[c].fm_mod, mod_samplerate, tx_offset, sdr->amplitude);
 			if (rc < 0)
 				goto error;
 		}
@@ -383,7 +467,12 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 			double tx_offset;
 			tx_offset = sdr->chan[sdr->paging_channel].tx_frequency - tx_center_frequency;
 			LOGP(DSDR, LOGL_DEBUG, "Paging Frequency: TX offset: %.6f MHz\n", tx_offset / 1e6);
-			rc = fm_mod_init(&sdr->chan[sdr->paging_channel].fm_mod, samplerate, tx_offset, sdr->amplitude);
+			mod_samplerate = samplerate;
+			if (sdr->use_combiner) {
+				sdr->chan[sdr->paging_channel].tx_bin = combiner_bin(&sdr->combiner, tx_offset, &tx_offset);
+				mod_samplerate = combiner_samplerate(&sdr->combiner);
+			}
+			rc = fm_mod_init(&sdr->chan[sdr->paging_channel].fm_mod, mod_samplerate, tx_offset, sdr->amplitude);
 			if (rc < 0)
 				goto error;
 		}
@@ -412,6 +501,7 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 	if (rx_frequency && channels) {
 		/* calculate required bandwidth (IQ rate) */
 		double rx_low_frequency = 0.0, rx_high_frequency = 0.0;
+		double demod_samplerate;
 		for (c = 0; c < channels; c++) {
 			sdr->chan[c].rx_frequency = rx_frequency[c];
 			if (c == 0 || sdr->chan[c].rx_frequency < rx_low_frequency)
@@ -459,7 +549,45 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 		}
 
 		/* show spectrum */
-		show_spectrum("RX", (double)samplerate / 2.0, rx_center_frequency, rx_frequency, 0.0, channels);
+		show_spectrum("RX", (double)rx_samplerate / 2.0, rx_center_frequency, rx_frequency, 0.0, channels);
+
+		/* use channelizer to split spectrum into channels */
+		if (sdr_config->channelizer && channels < CHANNELIZER_MIN_CHANNELS)
+			LOGP(DSDR, LOGL_NOTICE, "Channelizer is slower than mixing below %d channels, so it is not used.\n", CHANNELIZER_MIN_CHANNELS);
+		else if (sdr_config->channelizer) {
+			rc = channelizer_init(&sdr->channelizer, samplerate, bandwidth);
+			if (rc < 0) {
+				LOGP(DSDR, LOGL_ERROR, "Failed to init channelizer!\n");
+				goto error;
+			}
+			sdr->use_channelizer = 1;
+			LOGP(DSDR, LOGL_INFO, "Using channelizer with %d bins, sample rate of each channel is %.0f Hz.\n", sdr->channelizer.bins, channelizer_samplerate(&sdr->channelizer));
+			sdr->chan_bin = calloc(channels, sizeof(*sdr->chan_bin));
+			sdr->chan_narrowband = calloc(channels, sizeof(*sdr->chan_narrowband));
+			sdr->narrow_samples = calloc(sdr->buffer_size / sdr->channelizer.decimation + 1, sizeof(*sdr->narrow_samples));
+			if (!sdr->chan_bin || !sdr->chan_narrowband || !sdr->narrow_samples) {
+				LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
+				goto error;
+			}
+		}
+
+		/* use decimator to reduce the sample rate of each channel */
+		if (sdr_config->decimator) {
+			sdr->use_decimator = 1;
+			/* decimation is at least 2 */
+			sdr->narrow_samples = calloc(sdr->buffer_size / 2 + 1, sizeof(*sdr->narrow_samples));
+			if (!sdr->narrow_samples) {
+				LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
+				goto error;
+			}
+			if (sdr->decimate_sdr_rate) {
+				sdr->wideband = calloc(sdr->buffer_size * sdr->oversample * 2, sizeof(*sdr->wideband));
+				if (!sdr->wideband) {
+					LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
+					goto error;
+				}
+			}
+		}
 
 		/* range of RX */
 		double low_side, high_side, range;
@@ -467,7 +595,7 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 		high_side = (rx_high_frequency - rx_center_frequency) + bandwidth / 2.0;
 		range = ((low_side > high_side) ? low_side : high_side) * 2.0;
 		LOGP(DSDR, LOGL_INFO, "Total bandwidth (two sidebands) for all RX Frequencies: %.0f Hz\n", range);
-		if (range > samplerate * USABLE_BANDWIDTH) {
+		if (range > rx_samplerate * USABLE_BANDWIDTH) {
 			LOGP(DSDR, LOGL_NOTICE, "*******************************************************************************\n");
 			LOGP(DSDR, LOGL_NOTICE, "The required bandwidth of %.0f Hz exceeds %.0f%% of the sample rate.\n", range, USABLE_BANDWIDTH * 100.0);
 			LOGP(DSDR, LOGL_NOTICE, "Please increase samplerate!\n");
@@ -481,10 +609,76 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 			rx_offset = sdr->chan[c].rx_frequency - rx_center_frequency;
 			LOGP(DSDR, LOGL_DEBUG, "Frequency #%d: RX offset: %.6f MHz\n", c, rx_offset / 1e6);
 			sdr->chan[c].am = am[c];
+			demod_samplerate = samplerate;
+			if (sdr->use_channelizer) {
+				/* demodulator only needs to shift the remaining offset to the center of the bin */
+				sdr->chan_bin[c] = channelizer_bin(&sdr->channelizer, rx_offset, &rx_offset);
+				demod_samplerate = channelizer_samplerate(&sdr->channelizer);
+				LOGP(DSDR, LOGL_DEBUG, "Frequency #%d: channelizer bin %d, remaining RX offset: %.3f KHz\n", c, sdr->chan_bin[c], rx_offset / 1e3);
+				sdr->chan[c].narrowband = calloc((sdr->buffer_size / sdr->channelizer.decimation + 1) * 2, sizeof(*sdr->chan[c].narrowband));
+				/* fifo is pre-filled with one output of channelizer (delay), so it never runs empty */
+				sdr->chan[c].fifo = calloc(sdr->buffer_size + sdr->channelizer.decimation * 2, sizeof(*sdr->chan[c].fifo));
+				if (!sdr->chan[c].narrowband || !sdr->chan[c].fifo) {
+					LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
+					goto error;
+				}
+				sdr->chan[c].fifo_fill = sdr->channelizer.decimation;
+				sdr->chan_narrowband[c] = sdr->chan[c].narrowband;
+				rc = init_samplerate(&sdr->chan[c].interpolator, demod_samplerate, samplerate, max_modulation);
+				if (rc < 0) {
+					LOGP(DSDR, LOGL_ERROR, "Failed to init interpolator!\n");
+					goto error;
+				}
+			}
+			if (sdr->decimate_sdr_rate) {
+				decimator_t *dec = &sdr->chan[c].decimator;
+				int stages = 0;
+				while ((1 << stages) < sdr->oversample)
+					stages++;
+				rc = decimator_init(dec, sdr_config->samplerate, rx_offset, bandwidth, sdr->buffer_size * sdr->oversample, stages);
+				if (rc < 0) {
+					LOGP(DSDR, LOGL_ERROR, "Failed to init decimator!\n");
+					goto error;
+				}
+				/* decimator shifts the channel to 0 Hz, so the demodulator does not need to */
+				rx_offset = 0.0;
+				demod_samplerate = decimator_samplerate(dec);
+				LOGP(DSDR, LOGL_INFO, "Frequency #%d: Using decimator with %d half-band stages from SDR rate, sample rate of channel is %.0f Hz.\n", c, dec->stages, demod_samplerate);
+				/* output of decimator has the same number of samples as the sample rate */
+				sdr->chan[c].narrowband = calloc((sdr->buffer_size + 1) * 2, sizeof(*sdr->chan[c].narrowband));
+				if (!sdr->chan[c].narrowband) {
+					LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
+					goto error;
+				}
+			} else if (sdr->use_decimator) {
+				decimator_t *dec = &sdr->chan[c].decimator;
+				rc = decimator_init(dec, samplerate, rx_offset, bandwidth, sdr->buffer_size, 0);
+				if (rc < 0) {
+					LOGP(DSDR, LOGL_ERROR, "Failed to init decimator!\n");
+					goto error;
+				}
+				/* decimator shifts the channel to 0 Hz, so the demodulator does not need to */
+				rx_offset = 0.0;
+				demod_samplerate = decimator_samplerate(dec);
+				LOGP(DSDR, LOGL_INFO, "Frequency #%d: Using decimator with %d half-band stages, sample rate of channel is %.0f Hz.\n", c, dec->stages, demod_samplerate);
+				sdr->chan[c].narrowband = calloc((sdr->buffer_size / dec->decimation + 1) * 2, sizeof(*sdr->chan[c].narrowband));
+				/* fifo is pre-filled with one output of decimator (delay), so it never runs empty */
+				sdr->chan[c].fifo = calloc(sdr->buffer_size + dec->decimation * 2, sizeof(*sdr->chan[c].fifo));
+				if (!sdr->chan[c].narrowband || !sdr->chan[c].fifo) {
+					LOGP(DSDR, LOGL_ERROR, "NO MEM!\n");
+					goto error;
+				}
+				sdr->chan[c].fifo_fill = dec->decimation;
+				rc = init_samplerate(&sdr->chan[c].interpolator, demod_samplerate, samplerate, max_modulation);
+				if (rc < 0) {
+					LOGP(DSDR, LOGL_ERROR, "Failed to init interpolator!\n");
+					goto error;
+				}
+			}
 			if (am[c])
-				rc = am_demod_init(&sdr->chan[c].am_demod, samplerate, rx_offset, bandwidth / 2.0, 1.0 / modulation_index); /* bandwidth is only one side band */
+				rc = am_demod_init(&sdr->chan[c].am_demod, demod_samplerate, rx_offset, bandwidth / 2.0, 1.0 / modulation_index); /* bandwidth is only one side band */
 			else
-				rc = fm_demod_init(&sdr->chan[c].fm_demod, samplerate, rx_offset, bandwidth); /* bandwidth are deviation and both sidebands */
+				rc = fm_demod_init(&sdr->chan[c].fm_demod, demod_samplerate, rx_offset, bandwidth); /* bandwidth are deviation and both sidebands */
 			if (rc < 0)
 				goto error;
 		}
@@ -492,7 +686,7 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 		LOGP(DSDR, LOGL_INFO, "Using gain: RX %.1f dB\n", sdr_config->rx_gain);
 		/* open wave */
 		if (sdr_config->write_iq_rx_wave) {
-			rc = wave_create_record(&sdr->wave_rx_rec, sdr_config->write_iq_rx_wave, samplerate, 2, 1.0);
+			rc = wave_create_record(&sdr->wave_rx_rec, sdr_config->write_iq_rx_wave, rx_samplerate, 2, 1.0);
 			if (rc < 0) {
 				LOGP(DSDR, LOGL_ERROR, "Failed to create WAVE recoding instance!\n");
 				goto error;
@@ -500,7 +694,7 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 		}
 		if (sdr_config->read_iq_rx_wave) {
 			int two = 2;
-			rc = wave_create_playback(&sdr->wave_rx_play, sdr_config->read_iq_rx_wave, &samplerate, &two, 1.0);
+			rc = wave_create_playback(&sdr->wave_rx_play, sdr_config->read_iq_rx_wave, &rx_samplerate, &two, 1.0);
 			if (rc < 0) {
 				LOGP(DSDR, LOGL_ERROR, "Failed to create WAVE playback instance!\n");
 				goto error;
@@ -519,8 +713,8 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 		}
 	}
 
-	display_iq_init(samplerate);
-	display_spectrum_init(samplerate, rx_center_frequency);
+	display_iq_init(rx_samplerate);
+	display_spectrum_init(rx_samplerate, rx_center_frequency);
 
 	LOGP(DSDR, LOGL_INFO, "Using local oscillator offset: %.0f Hz\n", sdr_config->lo_offset);
 
@@ -540,6 +734,14 @@ void *sdr_open(int __attribute__((__unused__)) direction, const char __attribute
 	}
 #endif
 
+#ifdef HAVE_IQFILE
+	if (sdr_config->iqfile) {
+		rc = iqfile_open(sdr_config->iq_rx_file, sdr_config->iq_tx_file, sdr_config->iq_format, sdr_config->samplerate, sdr_config->iq_free_running, sdr->buffer_size * sdr->oversample);
+		if (rc)
+			goto error;
+	}
+#endif
+
 	return sdr;
 
 error:
@@ -559,56 +761,45 @@ void calibrate_bias(void)
 
 static void sdr_bias(float *buffer, int count)
 {
-	int i;
-
+	if (count <= 0)
+		return;
 	if (bias_count < sdr_config->samplerate) {
-		for (i = 0; i < count; i++) {
-			bias_I += *buffer++;
-			bias_Q += *buffer++;
-		}
+		iq_sum(buffer, count, &bias_I, &bias_Q);
 		bias_count += count;
 		if (bias_count >= sdr_config->samplerate) {
 			bias_I /= bias_count;
 			bias_Q /= bias_count;
 			LOGP(DSDR, LOGL_INFO, "DC bias calibration finished.\n");
 		}
-	} else {
-		for (i = 0; i < count; i++) {
-			*buffer++ -= bias_I;
-			*buffer++ -= bias_Q;
-		}
-	}
+	} else
+		iq_remove_dc(buffer, count, bias_I, bias_Q);
 }
 
 static void *sdr_write_child(void *arg)
 {
 	sdr_t *sdr = (sdr_t *)arg;
-	int num;
-	int fill, out;
-	int s, ss, o;
+	int num, span;
+	float *buffer;
 
 	while (sdr->thread_write.running) {
 		/* write to SDR */
-		fill = (sdr->thread_write.in - sdr->thread_write.out + sdr->thread_write.buffer_size) % sdr->thread_write.buffer_size;
-		num = fill / 2;
+		num = 0;
+		/* up to two spans, if ring buffer wraps */
+		while (num < (int)sdr->thread_write.ring.size && (span = ringbuffer_read_span(&sdr->thread_write.ring, (void **)&buffer))) {
+			if (span > (int)sdr->thread_write.ring.size - num)
+				span = sdr->thread_write.ring.size - num;
+			iq_interpolate(buffer, span, sdr->oversample, LIMIT_IQ_LEVEL, sdr->thread_write.buffer2 + num * sdr->oversample * 2);
+			ringbuffer_read_commit(&sdr->thread_write.ring, span);
+			num += span;
+		}
 		if (num) {
 #ifdef DEBUG_BUFFER
 			printf("Thread found %d samples in write buffer and forwards them to SDR.\n", num);
 #endif
-			out = sdr->thread_write.out;
-			for (s = 0, ss = 0; s < num; s++) {
-				for (o = 0; o < sdr->oversample; o++) {
-					sdr->thread_write.buffer2[ss++] = sdr->thread_write.buffer[out] * LIMIT_IQ_LEVEL;
-					sdr->thread_write.buffer2[ss++] = sdr->thread_write.buffer[out + 1] * LIMIT_IQ_LEVEL;
-				}
-				out = (out + 2) % sdr->thread_write.buffer_size;
-			}
-			sdr->thread_write.out = out;
 #ifndef DISABLE_FILTER
 			/* filter spectrum */
 			if (sdr->oversample > 1) {
-				iir_process_baseband(&sdr->thread_write.lp[0], sdr->thread_write.buffer2, num * sdr->oversample);
-				iir_process_baseband(&sdr->thread_write.lp[1], sdr->thread_write.buffer2 + 1, num * sdr->oversample);
+				iir_process_iq(&sdr->thread_write.lp[0], &sdr->thread_write.lp[1], sdr->thread_write.buffer2, num * sdr->oversample);
 			}
 #endif
 #ifdef HAVE_UHD
@@ -618,11 +809,15 @@ static void *sdr_write_child(void *arg)
 #ifdef HAVE_SOAPY
 			if (sdr_config->soapy)
 				soapy_send(sdr->thread_write.buffer2, num * sdr->oversample);
+#endif
+#ifdef HAVE_IQFILE
+			if (sdr_config->iqfile)
+				iqfile_send(sdr->thread_write.buffer2, num * sdr->oversample);
 #endif
 		}
 
-		/* delay some time */
-		usleep(sdr->interval * 1000.0);
+		/* wait for more samples, but not longer than the interval */
+		ringbuffer_wait_read(&sdr->thread_write.ring, 1, ceil(sdr->interval));
 	}
 
 	LOGP(DSDR, LOGL_DEBUG, "Thread received exit!\n");
@@ -634,47 +829,54 @@ static void *sdr_read_child(void *arg)
 {
 	sdr_t *sdr = (sdr_t *)arg;
 	int num, count = 0;
-	int space, in;
-	int s, ss;
+	float *buffer;
 
 	while (sdr->thread_read.running) {
 		/* read from SDR */
-		space = (sdr->thread_read.out - sdr->thread_read.in + sdr->thread_read.buffer_size - 2 + sdr->thread_read.buffer_size) % sdr->thread_read.buffer_size;
-		num = space / 2;
+		num = ringbuffer_space(&sdr->thread_read.ring);
 		if (num) {
+			/* receive into ring buffer, if the space does not wrap, so there is no need to copy */
+			if ((int)ringbuffer_write_span(&sdr->thread_read.ring, (void **)&buffer) < num)
+				buffer = sdr->thread_read.buffer2;
 #ifdef HAVE_UHD
 			if (sdr_config->uhd)
-				count = uhd_receive(sdr->thread_read.buffer2, num);
+				count = uhd_receive(buffer, num);
 #endif
 #ifdef HAVE_SOAPY
 			if (sdr_config->soapy)
-				count = soapy_receive(sdr->thread_read.buffer2, num);
+				count = soapy_receive(buffer, num);
+#endif
+#ifdef HAVE_IQFILE
+			if (sdr_config->iqfile) {
+				count = iqfile_receive(buffer, num);
+				if (iqfile_eof())
+					atomic_store_explicit(&sdr->thread_read.eof, 1, memory_order_release);
+			}
 #endif
 			if (bias_count >= 0)
-				sdr_bias(sdr->thread_read.buffer2, count);
+				sdr_bias(buffer, count);
 			if (count > 0) {
 #ifdef DEBUG_BUFFER
 				printf("Thread read %d samples from SDR and writes them to read buffer.\n", count);
 #endif
 #ifndef DISABLE_FILTER
 				/* filter spectrum */
-				if (sdr->oversample > 1) {
-					iir_process_baseband(&sdr->thread_read.lp[0], sdr->thread_read.buffer2, count);
-					iir_process_baseband(&sdr->thread_read.lp[1], sdr->thread_read.buffer2 + 1, count);
+				if (sdr->oversample > 1 && !sdr->decimate_sdr_rate) {
+					iir_process_iq(&sdr->thread_read.lp[0], &sdr->thread_read.lp[1], buffer, count);
 				}
 #endif
-				in = sdr->thread_read.in;
-				for (s = 0, ss = 0; s < count; s++) {
-					sdr->thread_read.buffer[in++] = sdr->thread_read.buffer2[ss++];
-					sdr->thread_read.buffer[in++] = sdr->thread_read.buffer2[ss++];
-					in %= sdr->thread_read.buffer_size;
-				}
-				sdr->thread_read.in = in;
+				if (buffer == sdr->thread_read.buffer2)
+					ringbuffer_write(&sdr->thread_read.ring, buffer, count);
+				else
+					ringbuffer_write_commit(&sdr->thread_read.ring, count);
 			}
 		}
 
+		/* If buffer is full, wait until samples have been read. */
+		if (!num)
+			ringbuffer_wait_write(&sdr->thread_read.ring, 1, ceil(sdr->interval));
 		/* If receive functions block, we always receive something, so don't sleep. */
-		if (!num || count <= 0)
+		else if (count <= 0)
 			usleep(sdr->interval * 1000.0);
 	}
 
@@ -696,6 +898,10 @@ int sdr_start(void *inst)
 #ifdef HAVE_SOAPY
 	if (sdr_config->soapy)
 		rc = soapy_start();
+#endif
+#ifdef HAVE_IQFILE
+	if (sdr_config->iqfile)
+		rc = iqfile_start();
 #endif
 	if (rc < 0)
 		return rc;
@@ -756,12 +962,10 @@ void sdr_close(void *inst)
 		}
 	}
 
-	if (sdr->thread_read.buffer)
-		free((void *)sdr->thread_read.buffer);
+	ringbuffer_exit(&sdr->thread_read.ring);
 	if (sdr->thread_read.buffer2)
 		free((void *)sdr->thread_read.buffer2);
-	if (sdr->thread_write.buffer)
-		free((void *)sdr->thread_write.buffer);
+	ringbuffer_exit(&sdr->thread_write.ring);
 	if (sdr->thread_write.buffer2)
 		free((void *)sdr->thread_write.buffer2);
 
@@ -775,6 +979,11 @@ void sdr_close(void *inst)
 		soapy_close();
 #endif
 
+#ifdef HAVE_IQFILE
+	if (sdr_config->iqfile)
+		iqfile_close();
+#endif
+
 	if (sdr) {
 		free(sdr->modbuff);
 		free(sdr->modbuff_I);
@@ -782,6 +991,7 @@ void sdr_close(void *inst)
 		free(sdr->modbuff_carrier);
 		free(sdr->wavespl0);
 		free(sdr->wavespl1);
+		free(sdr->wideband);
 		wave_destroy_record(&sdr->wave_rx_rec);
 		wave_destroy_record(&sdr->wave_tx_rec);
 		wave_destroy_playback(&sdr->wave_rx_play);
@@ -794,11 +1004,27 @@ void sdr_close(void *inst)
 				fm_demod_exit(&sdr->chan[c].fm_demod);
 				am_mod_exit(&sdr->chan[c].am_mod);
 				am_demod_exit(&sdr->chan[c].am_demod);
+				decimator_exit(&sdr->chan[c].decimator);
+				exit_samplerate(&sdr->chan[c].interpolator);
+				exit_samplerate(&sdr->chan[c].tx_decimator);
+				free(sdr->chan[c].tx_narrowband);
+				free(sdr->chan[c].narrowband);
+				free(sdr->chan[c].fifo);
 			}
 			if (sdr->paging_channel)
 				fm_mod_exit(&sdr->chan[sdr->paging_channel].fm_mod);
 			free(sdr->chan);
 		}
+		if (sdr->use_channelizer)
+			channelizer_exit(&sdr->channelizer);
+		free(sdr->chan_bin);
+		free(sdr->chan_narrowband);
+		free(sdr->narrow_samples);
+		if (sdr->use_combiner)
+			combiner_exit(&sdr->combiner);
+		free(sdr->comb_bin);
+		free(sdr->comb_narrowband);
+		free(sdr->comb_power);
 		free(sdr);
 		sdr = NULL;
 	}
@@ -815,12 +1041,35 @@ static double get_time(void)
 	return (double)tv.tv_sec + (double)tv.tv_nsec / 1000000000.0;
 }
 
+/* decimate samples and power states to combiner rate
+ *
+ * The samples are filtered by the polyphase low-pass filter of the decimator,
+ * so that no audio above the modulation bandwidth is mirrored into the
+ * channel. The samples are not used after writing them, so they are
+ * decimated in place. The decimated sample is taken at every first sample of
+ * each block, so we get the number of samples that the combiner requires to
+ * generate the given number of samples. */
+static int comb_decimate(sdr_chan_t *chan, int decimation, int phase, sample_t *samples, uint8_t *power, int num, uint8_t *narrow_power)
+{
+	int s;
+
+	for (s = 0; s < num; s++) {
+		if (phase == 0)
+			*narrow_power++ = power[s];
+		if (++phase == decimation)
+			phase = 0;
+	}
+
+	return samplerate_downsample(&chan->tx_decimator, samples, num);
+}
+
 int sdr_write(void *inst, sample_t **samples, uint8_t **power, int num, enum paging_signal __attribute__((unused)) *paging_signal, int *on, int channels)
 {
 	sdr_t *sdr = (sdr_t *)inst;
 	float *buff = NULL;
 	int c, s, ss;
 	int sent = 0;
+	int narrow_num;
 
 	if (num > sdr->buffer_size) {
 		fprintf(stderr, "exceeding maximum size given by sdr->buffer_size, please fix!\n");
@@ -831,8 +1080,32 @@ int sdr_write(void *inst, sample_t **samples, uint8_t **power, int num, enum pag
 		abort();
 	}
 
-	/* process all channels */
-	if (channels) {
+	/* process all channels at combiner rate and combine them */
+	if (channels && sdr->use_combiner) {
+		buff = sdr->modbuff;
+		narrow_num = combiner_input_num(&sdr->combiner, num);
+		for (c = 0; c < channels; c++) {
+			if (comb_decimate(&sdr->chan[c], sdr->combiner.interpolation, sdr->comb_phase, samples[c], power[c], num, sdr->comb_power) != narrow_num) {
+				fprintf(stderr, "decimator output does not match the number of samples for combiner, please fix!\n");
+				abort();
+			}
+			memset(sdr->chan[c].tx_narrowband, 0, sizeof(*sdr->chan[c].tx_narrowband) * narrow_num * 2);
+			/* switch to paging channel, if requested */
+			if (on[c] && sdr->paging_channel) {
+				sdr->comb_bin[c] = sdr->chan[sdr->paging_channel].tx_bin;
+				fm_modulate_complex(&sdr->chan[sdr->paging_channel].fm_mod, samples[c], sdr->comb_power, narrow_num, sdr->chan[c].tx_narrowband);
+			} else {
+				sdr->comb_bin[c] = sdr->chan[c].tx_bin;
+				if (sdr->chan[c].am)
+					am_modulate_complex(&sdr->chan[c].am_mod, samples[c], sdr->comb_power, narrow_num, sdr->chan[c].tx_narrowband);
+				else
+					fm_modulate_complex(&sdr->chan[c].fm_mod, samples[c], sdr->comb_power, narrow_num, sdr->chan[c].tx_narrowband);
+			}
+		}
+		sdr->comb_phase = (sdr->comb_phase + num) % sdr->combiner.interpolation;
+		combiner_process(&sdr->combiner, sdr->comb_narrowband, sdr->comb_bin, channels, narrow_num, buff, num);
+	} else if (channels) {
+		/* process all channels at sample rate */
 		buff = sdr->modbuff;
 		memset(buff, 0, sizeof(*buff) * num * 2);
 		for (c = 0; c < channels; c++) {
@@ -867,10 +1140,10 @@ int sdr_write(void *inst, sample_t **samples, uint8_t **power, int num, enum pag
 
 	if (sdr->threads) {
 		/* store data towards SDR in ring buffer */
-		int fill, space, in;
+		int fill, space;
 
-		fill = (sdr->thread_write.in - sdr->thread_write.out + sdr->thread_write.buffer_size) % sdr->thread_write.buffer_size;
-		space = (sdr->thread_write.out - sdr->thread_write.in + sdr->thread_write.buffer_size - 2 + sdr->thread_write.buffer_size) % sdr->thread_write.buffer_size;
+		fill = ringbuffer_fill(&sdr->thread_write.ring);
+		space = ringbuffer_space(&sdr->thread_write.ring);
 
 		/* debug fill level */
 		if (fill > sdr->thread_write.max_fill)
@@ -879,26 +1152,20 @@ int sdr_write(void *inst, sample_t **samples, uint8_t **power, int num, enum pag
 			sdr->thread_write.max_fill_timer = get_time();
 		if (get_time() - sdr->thread_write.max_fill_timer > 1.0) {
 			double delay;
-			delay = (double)sdr->thread_write.max_fill / 2.0 / (double)sdr->samplerate;
+			delay = (double)sdr->thread_write.max_fill / (double)sdr->samplerate;
 			sdr->thread_write.max_fill = 0;
 			sdr->thread_write.max_fill_timer += 1.0;
 			LOGP(DSDR, LOGL_DEBUG, "write delay = %.3f ms\n", delay * 1000.0);
 		}
 
-		if (space < num * 2) {
+		if (space < num) {
 			LOGP(DSDR, LOGL_ERROR, "Write SDR buffer overflow!\n");
-			num = space / 2;
+			num = space;
 		}
 #ifdef DEBUG_BUFFER
 		printf("Writing %d samples to write buffer.\n", num);
 #endif
-		in = sdr->thread_write.in;
-		for (s = 0, ss = 0; s < num; s++) {
-			sdr->thread_write.buffer[in++] = buff[ss++];
-			sdr->thread_write.buffer[in++] = buff[ss++];
-			in %= sdr->thread_write.buffer_size;
-		}
-		sdr->thread_write.in = in;
+		ringbuffer_write(&sdr->thread_write.ring, buff, num);
 		sent = num;
 	} else {
 #ifdef HAVE_UHD
@@ -908,6 +1175,10 @@ int sdr_write(void *inst, sample_t **samples, uint8_t **power, int num, enum pag
 #ifdef HAVE_SOAPY
 		if (sdr_config->soapy)
 			sent = soapy_send(buff, num);
+#endif
+#ifdef HAVE_IQFILE
+		if (sdr_config->iqfile)
+			sent = iqfile_send(buff, num);
 #endif
 		if (sent < 0)
 			return sent;
@@ -916,11 +1187,30 @@ int sdr_write(void *inst, sample_t **samples, uint8_t **power, int num, enum pag
 	return sent;
 }
 
+/* interpolate demodulated samples from channelizer or decimator rate to sample rate
+ *
+ * The polyphase filter of the interpolator removes the images of the audio
+ * spectrum, that repeat at multiples of the channelizer or decimator rate.
+ * The fifo has one output sample of channelizer or decimator (decimation factor) more than
+ * required, so we can always take the number of samples we have received. */
+static void chan_interpolate(sdr_chan_t *chan, sample_t *narrow, int narrow_count, sample_t *samples, int count)
+{
+	int num;
+
+	num = samplerate_upsample_output_num(&chan->interpolator, narrow_count);
+	samplerate_upsample(&chan->interpolator, narrow, narrow_count, chan->fifo + chan->fifo_fill, num);
+	chan->fifo_fill += num;
+
+	memcpy(samples, chan->fifo, count * sizeof(*samples));
+	chan->fifo_fill -= count;
+	memmove(chan->fifo, chan->fifo + count, chan->fifo_fill * sizeof(*chan->fifo));
+}
+
 int sdr_read(void *inst, sample_t **samples, int num, int channels, double *rf_level_db)
 {
 	sdr_t *sdr = (sdr_t *)inst;
-	float *buff = NULL;
-	int count = 0;
+	float *buff = NULL, *iq;
+	int count = 0, iq_count, iq_num;
 	int c, s, ss;
 
 	if (num > sdr->buffer_size) {
@@ -936,9 +1226,12 @@ int sdr_read(void *inst, sample_t **samples, int num, int channels, double *rf_l
 
 	if (sdr->threads) {
 		/* load data from SDR out of ring buffer */
-		int fill, out;
+		int fill, span, skip, eof;
+		float *buffer;
 
-		fill = (sdr->thread_read.in - sdr->thread_read.out + sdr->thread_read.buffer_size) % sdr->thread_read.buffer_size;
+		/* get end of IQ file first, so that all samples written before are included in fill */
+		eof = atomic_load_explicit(&sdr->thread_read.eof, memory_order_acquire);
+		fill = ringbuffer_fill(&sdr->thread_read.ring);
 
 		/* debug fill level */
 		if (fill > sdr->thread_read.max_fill)
@@ -947,24 +1240,34 @@ int sdr_read(void *inst, sample_t **samples, int num, int channels, double *rf_l
 			sdr->thread_read.max_fill_timer = get_time();
 		if (get_time() - sdr->thread_read.max_fill_timer > 1.0) {
 			double delay;
-			delay = (double)sdr->thread_read.max_fill / 2.0 / (double)sdr_config->samplerate;
+			delay = (double)sdr->thread_read.max_fill / (double)sdr_config->samplerate;
 			sdr->thread_read.max_fill = 0;
 			sdr->thread_read.max_fill_timer += 1.0;
 			LOGP(DSDR, LOGL_DEBUG, "read delay = %.3f ms\n", delay * 1000.0);
 		}
 
-		if (fill / 2 / sdr->oversample < num)
-			num = fill / 2 / sdr->oversample;
+		if (fill / sdr->oversample < num)
+			num = fill / sdr->oversample;
+		/* end of IQ file and all samples have been read, so we quit */
+		if (!num && eof)
+			return -EPERM;
 #ifdef DEBUG_BUFFER
 		printf("Reading %d samples from read buffer.\n", num);
 #endif
-		out = sdr->thread_read.out;
-		for (s = 0, ss = 0; s < num; s++) {
-			buff[ss++] = sdr->thread_read.buffer[out];
-			buff[ss++] = sdr->thread_read.buffer[out + 1];
-			out = (out + 2 * sdr->oversample) % sdr->thread_read.buffer_size;
+		if (sdr->decimate_sdr_rate)
+			ringbuffer_read(&sdr->thread_read.ring, sdr->wideband, num * sdr->oversample);
+		else if (sdr->oversample == 1)
+			ringbuffer_read(&sdr->thread_read.ring, buff, num);
+		else {
+			/* take every 'oversample'th sample, up to two spans, if ring buffer wraps */
+			for (s = 0, skip = 0; s < num; ) {
+				span = ringbuffer_read_span(&sdr->thread_read.ring, (void **)&buffer);
+				if (span > skip + (num - s) * sdr->oversample)
+					span = skip + (num - s) * sdr->oversample;
+				s += iq_decimate(buffer, span, sdr->oversample, &skip, buff + s * 2);
+				ringbuffer_read_commit(&sdr->thread_read.ring, span);
+			}
 		}
-		sdr->thread_read.out = out;
 		count = num;
 	} else {
 #ifdef HAVE_UHD
@@ -974,6 +1277,10 @@ int sdr_read(void *inst, sample_t **samples, int num, int channels, double *rf_l
 #ifdef HAVE_SOAPY
 		if (sdr_config->soapy)
 			count = soapy_receive(buff, num);
+#endif
+#ifdef HAVE_IQFILE
+		if (sdr_config->iqfile)
+			count = iqfile_receive(buff, num);
 #endif
 		if (bias_count >= 0)
 			sdr_bias(buff, count);
@@ -986,62 +1293,92 @@ int sdr_read(void *inst, sample_t **samples, int num, int channels, double *rf_l
 		sdr_rx_overflow = 0;
 	}
 
+	/* IQ samples before demodulation, these are at SDR rate, if the decimator takes them */
+	if (sdr->decimate_sdr_rate) {
+		iq = sdr->wideband;
+		iq_num = count * sdr->oversample;
+	} else {
+		iq = buff;
+		iq_num = count;
+	}
+
 	if (sdr->wave_rx_rec.fp) {
 		sample_t *spl_list[2] = { sdr->wavespl0, sdr->wavespl1 };
-		for (s = 0, ss = 0; s < count; s++) {
-			spl_list[0][s] = buff[ss++];
-			spl_list[1][s] = buff[ss++];
+		for (s = 0, ss = 0; s < iq_num; s++) {
+			spl_list[0][s] = iq[ss++];
+			spl_list[1][s] = iq[ss++];
 		}
-		wave_write(&sdr->wave_rx_rec, spl_list, count);
+		wave_write(&sdr->wave_rx_rec, spl_list, iq_num);
 	}
 	if (sdr->wave_rx_play.fp) {
 		sample_t *spl_list[2] = { sdr->wavespl0, sdr->wavespl1 };
-		wave_read(&sdr->wave_rx_play, spl_list, count);
-		for (s = 0, ss = 0; s < count; s++) {
-			buff[ss++] = spl_list[0][s];
-			buff[ss++] = spl_list[1][s];
+		wave_read(&sdr->wave_rx_play, spl_list, iq_num);
+		for (s = 0, ss = 0; s < iq_num; s++) {
+			iq[ss++] = spl_list[0][s];
+			iq[ss++] = spl_list[1][s];
 		}
 	}
-	display_iq(buff, count);
-	display_spectrum(buff, count);
+	display_iq(iq, iq_num);
+	display_spectrum(iq, iq_num);
 
 	if (channels) {
+		iq_count = count;
+		if (sdr->use_channelizer)
+			iq_count = channelizer_process(&sdr->channelizer, buff, count, sdr->chan_bin, sdr->chan_narrowband, channels);
 		for (c = 0; c < channels; c++) {
+			fm_demod_stats_t stats;
+
 			if (rf_level_db)
 				rf_level_db[c] = NAN;
-			if (sdr->chan[c].am)
-				am_demodulate_complex(&sdr->chan[c].am_demod, samples[c], count, buff, sdr->modbuff_I, sdr->modbuff_Q, sdr->modbuff_carrier);
-			else
-				fm_demodulate_complex(&sdr->chan[c].fm_demod, samples[c], count, buff, sdr->modbuff_I, sdr->modbuff_Q);
+			if (sdr->decimate_sdr_rate) {
+				/* decimator outputs the channel at sample rate, so it is demodulated without interpolation */
+				iq_count = decimator_process(&sdr->chan[c].decimator, iq, iq_num, sdr->chan[c].narrowband);
+				if (iq_count != count) {
+					fprintf(stderr, "decimator output does not match the number of samples, please fix!\n");
+					abort();
+				}
+				if (sdr->chan[c].am)
+					am_demodulate_complex(&sdr->chan[c].am_demod, samples[c], count, sdr->chan[c].narrowband, sdr->modbuff_I, sdr->modbuff_Q, sdr->modbuff_carrier);
+				else
+					fm_demodulate_complex_fused(&sdr->chan[c].fm_demod, samples[c], count, sdr->chan[c].narrowband, &stats);
+			} else if (sdr->use_channelizer || sdr->use_decimator) {
+				if (sdr->use_decimator)
+					iq_count = decimator_process(&sdr->chan[c].decimator, buff, count, sdr->chan[c].narrowband);
+				/* demodulate at channelizer or decimator rate and interpolate to sample rate */
+				if (sdr->chan[c].am)
+					am_demodulate_complex(&sdr->chan[c].am_demod, sdr->narrow_samples, iq_count, sdr->chan[c].narrowband, sdr->modbuff_I, sdr->modbuff_Q, sdr->modbuff_carrier);
+				else
+					fm_demodulate_complex_fused(&sdr->chan[c].fm_demod, sdr->narrow_samples, iq_count, sdr->chan[c].narrowband, &stats);
+				chan_interpolate(&sdr->chan[c], sdr->narrow_samples, iq_count, samples[c], count);
+			} else {
+				if (sdr->chan[c].am)
+					am_demodulate_complex(&sdr->chan[c].am_demod, samples[c], count, buff, sdr->modbuff_I, sdr->modbuff_Q, sdr->modbuff_carrier);
+				else
+					fm_demodulate_complex_fused(&sdr->chan[c].fm_demod, samples[c], count, buff, &stats);
+			}
 			sender_t *sender = get_sender_by_empfangsfrequenz(sdr->chan[c].rx_frequency);
-			if (!sender || !count)
+			if (!sender || !count || !iq_count)
 				continue;
-			double min, max, avg;
-			avg = 0.0;
-			for (s = 0; s < count; s++) {
-				/* average the square length of vector */
-				avg += sdr->modbuff_I[s] * sdr->modbuff_I[s] + sdr->modbuff_Q[s] * sdr->modbuff_Q[s];
+			double avg;
+			if (!sdr->chan[c].am) {
+				/* statistics are calculated by the demodulator */
+				avg = sqrt(stats.power); /* RMS */
+			} else {
+				avg = 0.0;
+				for (s = 0; s < iq_count; s++) {
+					/* average the square length of vector */
+					avg += sdr->modbuff_I[s] * sdr->modbuff_I[s] + sdr->modbuff_Q[s] * sdr->modbuff_Q[s];
+				}
+				avg = sqrt(avg /(double)iq_count); /* RMS */
 			}
-			avg = sqrt(avg /(double)count); /* RMS */
 			avg = log10(avg) * 20;
 			display_measurements_update(sdr->chan[c].dmp_rf_level, avg, 0.0);
 			if (rf_level_db)
 				rf_level_db[c] = avg;
 			if (!sdr->chan[c].am) {
-				min = 0.0;
-				max = 0.0;
-				avg = 0.0;
-				for (s = 0; s < count; s++) {
-					avg += samples[c][s];
-					if (s == 0 || samples[c][s] > max)
-						max = samples[c][s];
-					if (s == 0 || samples[c][s] < min)
-						min = samples[c][s];
-				}
-				avg /= (double)count;
-				display_measurements_update(sdr->chan[c].dmp_freq_offset, avg / 1000.0, 0.0);
+				display_measurements_update(sdr->chan[c].dmp_freq_offset, stats.offset / 1000.0, 0.0);
 				/* use half min and max, because we want the deviation above/below (+-) center frequency. */
-				display_measurements_update(sdr->chan[c].dmp_deviation, min / 2.0 / 1000.0, max / 2.0 / 1000.0);
+				display_measurements_update(sdr->chan[c].dmp_deviation, stats.min / 2.0 / 1000.0, stats.max / 2.0 / 1000.0);
 			}
 		}
 	}
@@ -1062,6 +1399,10 @@ int sdr_get_tosend(void *inst, int buffer_size)
 #ifdef HAVE_SOAPY
 	if (sdr_config->soapy)
 		count = soapy_get_tosend(buffer_size * sdr->oversample);
+#endif
+#ifdef HAVE_IQFILE
+	if (sdr_config->iqfile)
+		count = iqfile_get_tosend(buffer_size * sdr->oversample);
 #endif
 	if (count < 0)
 		return count;
@@ -1072,8 +1413,8 @@ int sdr_get_tosend(void *inst, int buffer_size)
 		/* subtract what we have in write buffer, because this is not jet sent to the SDR */
 		int fill;
 
-		fill = (sdr->thread_write.in - sdr->thread_write.out + sdr->thread_write.buffer_size) % sdr->thread_write.buffer_size;
-		count -= fill / 2;
+		fill = ringbuffer_fill(&sdr->thread_write.ring);
+		count -= fill;
 		if (count < 0)
 			count = 0;
 	}
@@ -1082,3 +1423,47 @@ int sdr_get_tosend(void *inst, int buffer_size)
 }
 
 
+
+/*
+ * get file descriptor to wait for received samples
+ *
+ * return 0 if samples can be read now, number of file descriptors otherwise */
+int sdr_poll_fds(void *inst, struct pollfd *pfd, int max)
+{
+	sdr_t *sdr = (sdr_t *)inst;
+	int num;
+
+	if (!sdr->threads || ringbuffer_data_fd(&sdr->thread_read.ring) < 0 || max < 1)
+		return -ENOTSUP;
+
+	/* samples of one interval */
+	num = ceil((double)sdr->samplerate * sdr->interval / 1000.0);
+	if (num > sdr->buffer_size)
+		num = sdr->buffer_size;
+
+	/* consume last wakeup, then wait for the next one */
+	ringbuffer_disarm_read(&sdr->thread_read.ring);
+	if (ringbuffer_arm_read(&sdr->thread_read.ring, num * sdr->oversample))
+		return 0;
+	/* end of IQ file, nothing will arrive anymore */
+	if (atomic_load_explicit(&sdr->thread_read.eof, memory_order_acquire))
+		return 0;
+
+	pfd[0].fd = ringbuffer_data_fd(&sdr->thread_read.ring);
+	pfd[0].events = POLLIN;
+	pfd[0].revents = 0;
+	return 1;
+}
+
+/*
+ * translate the events of the file descriptor given by sdr_poll_fds()
+ *
+ * return 1 if samples can be read now, 0 otherwise */
+int sdr_poll_revents(void __attribute__((unused)) *inst, struct pollfd *pfd, int num)
+{
+	/* the ring buffer is readable when the eventfd is written */
+	if (num < 1)
+		return 0;
+
+	return (pfd[0].revents & (POLLIN | POLLERR)) ? 1 : 0;
+}
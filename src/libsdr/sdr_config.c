@@ -42,6 +42,7 @@ void sdr_config_init(double lo_offset)
 	sdr_config->tune_args = "";
 	sdr_config->lo_offset = lo_offset;
 	sdr_config->timestamps = 1;
+	sdr_config->iq_format = "cf32";
 
 	got_init = 1;
 }
@@ -57,6 +58,21 @@ void sdr_config_print_help(void)
 #ifdef HAVE_SOAPY
 	printf("    --sdr-soapy\n");
 	printf("        Force SoapySDR driver\n");
+#endif
+#ifdef HAVE_IQFILE
+	printf("    --sdr-iq-rx <file> | - | unix:<socket>\n");
+	printf("        Read raw IQ samples from file, FIFO, stdin or Unix socket, instead of\n");
+	printf("        using an SDR device. The sample rate is given by --sdr-samplerate.\n");
+	printf("    --sdr-iq-tx <file> | - | unix:<socket>\n");
+	printf("        Write raw IQ samples to file, FIFO, stdout or Unix socket. If not\n");
+	printf("        given, transmitted IQ samples are discarded.\n");
+	printf("    --sdr-iq-format cf32 | cs16 | cu8\n");
+	printf("        Format of IQ samples: 32 bit float, signed 16 bit or unsigned 8 bit.\n");
+	printf("        (default = '%s')\n", sdr_config->iq_format);
+	printf("    --sdr-iq-free-running\n");
+	printf("        Do not receive IQ samples in real time, but as fast as possible. The\n");
+	printf("        program quits at the end of the IQ file. Use this to decode recorded\n");
+	printf("        IQ samples faster than real time.\n");
 #endif
 	printf("    --sdr-channel <channel #>\n");
 	printf("        Give channel number for multi channel SDR device (default = %d)\n", sdr_config->channel);
@@ -95,6 +111,20 @@ void sdr_config_print_help(void)
 	printf("        Swap RX and TX frequencies for loopback tests over the air.\n");
 	printf("    --sdr-timestamps 1 | 0\n");
 	printf("        Use TX timestamps on UHD device. (default = %d)\n", sdr_config->timestamps);
+	printf("    --sdr-channelizer\n");
+	printf("        Use polyphase filter bank to split received spectrum into channels.\n");
+	printf("        This reduces CPU load when receiving many channels. It is only used with\n");
+	printf("        8 channels or more, because mixing each channel is faster below.\n");
+	printf("    --sdr-decimator\n");
+	printf("        Shift each received channel to 0 Hz and decimate it by half-band filters,\n");
+	printf("        so that it is demodulated at low sample rate.\n");
+	printf("        This reduces CPU load when receiving few channels at high sample rate.\n");
+	printf("        The SDR sample rate must be the sample rate (-s) * 2^n. If it is higher,\n");
+	printf("        the channels are decimated directly from the SDR sample rate.\n");
+	printf("    --sdr-combiner\n");
+	printf("        Use polyphase filter bank to combine transmitted channels into spectrum.\n");
+	printf("        This reduces CPU load when transmitting many channels. It is only used\n");
+	printf("        with 64 channels or more, because mixing each channel is faster below.\n");
 }
 
 void sdr_config_print_hotkeys(void)
@@ -124,6 +154,13 @@ void sdr_config_print_hotkeys(void)
 #define	OPT_READ_IQ_TX_WAVE	1517
 #define	OPT_SDR_SWAP_LINKS	1518
 #define	OPT_SDR_TIMESTAMPS	1519
+#define	OPT_SDR_CHANNELIZER	1520
+#define	OPT_SDR_COMBINER	1521
+#define	OPT_SDR_IQ_RX		1522
+#define	OPT_SDR_IQ_TX		1523
+#define	OPT_SDR_IQ_FORMAT	1524
+#define	OPT_SDR_IQ_FREE_RUNNING	1525
+#define	OPT_SDR_DECIMATOR	1526
 
 void sdr_config_add_options(void)
 {
@@ -147,6 +184,13 @@ void sdr_config_add_options(void)
 	option_add(OPT_READ_IQ_TX_WAVE, "read-iq-tx-wave", 1);
 	option_add(OPT_SDR_SWAP_LINKS, "sdr-swap-links", 0);
 	option_add(OPT_SDR_TIMESTAMPS, "sdr-timestamps", 1);
+	option_add(OPT_SDR_CHANNELIZER, "sdr-channelizer", 0);
+	option_add(OPT_SDR_DECIMATOR, "sdr-decimator", 0);
+	option_add(OPT_SDR_COMBINER, "sdr-combiner", 0);
+	option_add(OPT_SDR_IQ_RX, "sdr-iq-rx", 1);
+	option_add(OPT_SDR_IQ_TX, "sdr-iq-tx", 1);
+	option_add(OPT_SDR_IQ_FORMAT, "sdr-iq-format", 1);
+	option_add(OPT_SDR_IQ_FREE_RUNNING, "sdr-iq-free-running", 0);
 }
 
 int sdr_config_handle_options(int short_option, int argi, char **argv)
@@ -224,6 +268,38 @@ int sdr_config_handle_options(int short_option, int argi, char **argv)
 	case OPT_SDR_TIMESTAMPS:
 		sdr_config->timestamps = atoi(argv[argi]);
 		break;
+	case OPT_SDR_CHANNELIZER:
+		sdr_config->channelizer = 1;
+		break;
+	case OPT_SDR_DECIMATOR:
+		sdr_config->decimator = 1;
+		break;
+	case OPT_SDR_COMBINER:
+		sdr_config->combiner = 1;
+		break;
+	case OPT_SDR_IQ_RX:
+#ifdef HAVE_IQFILE
+		sdr_config->iqfile = 1;
+		sdr_config->iq_rx_file = options_strdup(argv[argi]);
+		use_sdr = 1;
+#else
+		fprintf(stderr, "IQ file support not compiled in!\n");
+		return -EINVAL;
+#endif
+		break;
+	case OPT_SDR_IQ_TX:
+		sdr_config->iq_tx_file = options_strdup(argv[argi]);
+		break;
+	case OPT_SDR_IQ_FORMAT:
+		if (strcmp(argv[argi], "cf32") && strcmp(argv[argi], "cs16") && strcmp(argv[argi], "cu8")) {
+			fprintf(stderr, "Given IQ format '%s' is invalid, use 'cf32', 'cs16' or 'cu8'.\n", argv[argi]);
+			return -EINVAL;
+		}
+		sdr_config->iq_format = options_strdup(argv[argi]);
+		break;
+	case OPT_SDR_IQ_FREE_RUNNING:
+		sdr_config->iq_free_running = 1;
+		break;
 	default:
 		return -EINVAL;
 	}
@@ -239,11 +315,21 @@ int sdr_configure(int samplerate)
 	}
 
 	/* no sdr selected -> return 0 */
-	if (!sdr_config->uhd && !sdr_config->soapy)
+	if (!sdr_config->uhd && !sdr_config->soapy && !sdr_config->iqfile)
 		return 0;
 
-	if ((sdr_config->uhd == 1 && sdr_config->soapy == 1)) {
-		fprintf(stderr, "You must choose which one you want: --sdr-uhd or --sdr-soapy\n");
+	if (sdr_config->uhd + sdr_config->soapy + sdr_config->iqfile > 1) {
+		fprintf(stderr, "You must choose which one you want: --sdr-uhd or --sdr-soapy or --sdr-iq-rx\n");
+		exit(0);
+	}
+
+	if (sdr_config->iq_free_running && !sdr_config->iqfile) {
+		fprintf(stderr, "Free running mode requires an IQ file, use --sdr-iq-rx\n");
+		exit(0);
+	}
+
+	if (sdr_config->channelizer && sdr_config->decimator) {
+		fprintf(stderr, "You must choose which one you want: --sdr-channelizer or --sdr-decimator\n");
 		exit(0);
 	}
 
@@ -1,7 +1,8 @@
 
 typedef struct sdr_config {
 	int		uhd,			/* select UHD API */
-			soapy;			/* select Soapy SDR API */
+			soapy,			/* select Soapy SDR API */
+			iqfile;			/* select IQ file instead of SDR device */
 	int		channel;		/* channel number */
 	const char	*device_args,		/* arguments */
 			*stream_args,
@@ -20,6 +21,13 @@ typedef struct sdr_config {
 	const char	*read_iq_rx_wave;
 	int		swap_links;		/* swap DL and UL frequency */
 	int		timestamps;		/* use time stamps when transmitting */
+	int		channelizer;		/* use polyphase channelizer to split RX channels */
+	int		decimator;		/* use half-band decimator for each RX channel */
+	int		combiner;		/* use polyphase combiner to combine TX channels */
+	const char	*iq_rx_file;		/* IQ file, pipe or socket */
+	const char	*iq_tx_file;
+	const char	*iq_format;		/* cf32, cs16 or cu8 */
+	int		iq_free_running;	/* process IQ file as fast as possible */
 } sdr_config_t;
 
 extern sdr_config_t *sdr_config;
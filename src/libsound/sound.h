@@ -1,5 +1,6 @@
 
 enum paging_signal;
+struct pollfd;
 
 enum sound_direction {
 	SOUND_DIR_PLAY,
@@ -13,6 +14,8 @@ void sound_close(void *inst);
 int sound_write(void *inst, sample_t **samples, uint8_t **power, int num, enum paging_signal *paging_signal, int *on, int channels);
 int sound_read(void *inst, sample_t **samples, int num, int channels, double *rf_level_db);
 int sound_get_tosend(void *inst, int buffer_size);
+int sound_poll_fds(void *inst, struct pollfd *pfd, int max);
+int sound_poll_revents(void *inst, struct pollfd *pfd, int num);
 int sound_is_stereo_capture(void *inst);
 int sound_is_stereo_playback(void *inst);
 
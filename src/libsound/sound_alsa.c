@@ -17,12 +17,35 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* How it works:
+ *
+ * The sound card is accessed via mmap, if supported by the device. Then the
+ * samples are converted directly between the DMA buffer of the sound card and
+ * the sample_t arrays of each channel. snd_pcm_mmap_begin() provides an area
+ * for each channel of the device, that describes where the first sample is
+ * located and how many bits there are from one sample to the next sample.
+ * This way interleaved and non-interleaved buffers are handled the same way.
+ *
+ * If the device does not support mmap, the samples are read/written with
+ * snd_pcm_readi()/snd_pcm_writei() via a buffer. The same conversion is used,
+ * by creating areas that describe that buffer.
+ *
+ * The sample format is S16, S32 or FLOAT, whatever the device supports. One
+ * sample step of S16 equals 'spl_deviation', the other formats are scaled to
+ * the same level. The conversion is done by sound_format.c.
+ *
+ * Any number of channels can be used, so that a multichannel sound card can
+ * serve many transceivers. If the device has more channels than required, the
+ * unused channels are ignored when reading and get silence when writing.
+ */
+
 #include <stdlib.h>
 #include <stdint.h>
 #include <math.h>
 #include <alsa/asoundlib.h>
 #include "../libsample/sample.h"
 #include "../liblogging/logging.h"
+#include "sound_format.h"
 #ifdef HAVE_MOBILE
 #include "../libmobile/sender.h"
 #else
@@ -35,23 +58,34 @@ typedef struct sound {
 	enum sound_direction direction;
 	snd_pcm_t *phandle, *chandle;
 	int pchannels, cchannels;
+	snd_pcm_format_t pformat, cformat;	/* sample format of device */
+	int pmmap, cmmap;		/* device is accessed via mmap */
 	int channels;			/* required number of channels */
 	int samplerate;			/* required sample rate */
+	int avail_min;			/* frames to wait for when polling capture */
 	char *caudiodev, *paudiodev;	/* required device */
 	double spl_deviation;		/* how much deviation is one sample step */
+	void *buffer;			/* buffer for devices without mmap support */
+	int buffer_frames;		/* number of frames that fit into buffer */
+	snd_pcm_channel_area_t *buffer_areas; /* areas that describe the buffer */
 #ifdef HAVE_MOBILE
 	double paging_phaseshift;	/* phase to shift every sample */
 	double paging_phase;	 	/* current phase */
-	double rx_frequency[2];		/* rx frequency of radio connected to channel */
-	dispmeasparam_t *dmp[2];
+	sample_t *paging;		/* buffer for paging signal */
+	int paging_size;		/* number of samples that fit into paging buffer */
+	double *rx_frequency;		/* rx frequency of radio connected to channel */
+	dispmeasparam_t **dmp;
 #endif
 } sound_t;
 
-static int set_hw_params(snd_pcm_t *handle, int samplerate, int *channels)
+static int set_hw_params(snd_pcm_t *handle, int samplerate, int *channels, snd_pcm_format_t *format, int *mmap)
 {
+	static const snd_pcm_format_t formats[] = { SND_PCM_FORMAT_S16, SND_PCM_FORMAT_S32, SND_PCM_FORMAT_FLOAT };
 	snd_pcm_hw_params_t *hw_params = NULL;
+	snd_pcm_access_mask_t *access_mask = NULL;
 	int rc;
-	unsigned int rrate;
+	unsigned int rrate, rchannels;
+	int i;
 
 	rc = snd_pcm_hw_params_malloc(&hw_params);
 	if (rc < 0) {
@@ -71,17 +105,35 @@ static int set_hw_params(snd_pcm_t *handle, int samplerate, int *channels)
 		goto error;
 	}
 
-	rc = snd_pcm_hw_params_set_access (handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+	rc = snd_pcm_access_mask_malloc(&access_mask);
 	if (rc < 0) {
-		LOGP(DSOUND, LOGL_ERROR, "cannot set access to interleaved (%s)\n", snd_strerror(rc));
+		LOGP(DSOUND, LOGL_ERROR, "Failed to allocate access mask! (%s)\n", snd_strerror(rc));
 		goto error;
 	}
+	snd_pcm_access_mask_none(access_mask);
+	snd_pcm_access_mask_set(access_mask, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+	snd_pcm_access_mask_set(access_mask, SND_PCM_ACCESS_MMAP_NONINTERLEAVED);
+	rc = snd_pcm_hw_params_set_access_mask(handle, hw_params, access_mask);
+	if (rc < 0) {
+		*mmap = 0;
+		rc = snd_pcm_hw_params_set_access(handle, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED);
+		if (rc < 0) {
+			LOGP(DSOUND, LOGL_ERROR, "cannot set access to mmap nor interleaved (%s)\n", snd_strerror(rc));
+			goto error;
+		}
+	} else
+		*mmap = 1;
 
-	rc = snd_pcm_hw_params_set_format(handle, hw_params, SND_PCM_FORMAT_S16);
+	for (i = 0; i < (int)(sizeof(formats) / sizeof(formats[0])); i++) {
+		rc = snd_pcm_hw_params_set_format(handle, hw_params, formats[i]);
+		if (rc == 0)
+			break;
+	}
 	if (rc < 0) {
-		LOGP(DSOUND, LOGL_ERROR, "cannot set sample format (%s)\n", snd_strerror(rc));
+		LOGP(DSOUND, LOGL_ERROR, "cannot set sample format to S16, S32 nor FLOAT (%s)\n", snd_strerror(rc));
 		goto error;
 	}
+	*format = formats[i];
 
 	rrate = samplerate;
 	rc = snd_pcm_hw_params_set_rate_near(handle, hw_params, &rrate, 0);
@@ -95,16 +147,19 @@ static int set_hw_params(snd_pcm_t *handle, int samplerate, int *channels)
 		goto error;
 	}
 
-	*channels = 1;
-	rc = snd_pcm_hw_params_set_channels(handle, hw_params, *channels);
+	/* use the required number of channels or the lowest number above */
+	rchannels = *channels;
+	rc = snd_pcm_hw_params_set_channels_min(handle, hw_params, &rchannels);
 	if (rc < 0) {
-		*channels = 2;
-		rc = snd_pcm_hw_params_set_channels(handle, hw_params, *channels);
-		if (rc < 0) {
-			LOGP(DSOUND, LOGL_ERROR, "cannot set channel count to 1 nor 2 (%s)\n", snd_strerror(rc));
-			goto error;
-		}
+		LOGP(DSOUND, LOGL_ERROR, "cannot set channel count to %d or more (%s)\n", *channels, snd_strerror(rc));
+		goto error;
 	}
+	rc = snd_pcm_hw_params_set_channels_first(handle, hw_params, &rchannels);
+	if (rc < 0) {
+		LOGP(DSOUND, LOGL_ERROR, "cannot set channel count (%s)\n", snd_strerror(rc));
+		goto error;
+	}
+	*channels = rchannels;
 
 	rc = snd_pcm_hw_params(handle, hw_params);
 	if (rc < 0) {
@@ -112,11 +167,15 @@ static int set_hw_params(snd_pcm_t *handle, int samplerate, int *channels)
 		goto error;
 	}
 
+	snd_pcm_access_mask_free(access_mask);
 	snd_pcm_hw_params_free(hw_params);
 
 	return 0;
 
 error:
+	if (access_mask) {
+		snd_pcm_access_mask_free(access_mask);
+	}
 	if (hw_params) {
 		snd_pcm_hw_params_free(hw_params);
 	}
@@ -124,6 +183,47 @@ error:
 	return rc;
 }
 
+static int set_sw_params(snd_pcm_t *handle, int avail_min)
+{
+	snd_pcm_sw_params_t *sw_params = NULL;
+	int rc;
+
+	rc = snd_pcm_sw_params_malloc(&sw_params);
+	if (rc < 0) {
+		LOGP(DSOUND, LOGL_ERROR, "Failed to allocate sw_params! (%s)\n", snd_strerror(rc));
+		goto error;
+	}
+
+	rc = snd_pcm_sw_params_current(handle, sw_params);
+	if (rc < 0) {
+		LOGP(DSOUND, LOGL_ERROR, "cannot get software parameters (%s)\n", snd_strerror(rc));
+		goto error;
+	}
+
+	rc = snd_pcm_sw_params_set_avail_min(handle, sw_params, avail_min);
+	if (rc < 0) {
+		LOGP(DSOUND, LOGL_ERROR, "cannot set minimum available frames (%s)\n", snd_strerror(rc));
+		goto error;
+	}
+
+	rc = snd_pcm_sw_params(handle, sw_params);
+	if (rc < 0) {
+		LOGP(DSOUND, LOGL_ERROR, "cannot set software parameters (%s)\n", snd_strerror(rc));
+		goto error;
+	}
+
+	snd_pcm_sw_params_free(sw_params);
+
+	return 0;
+
+error:
+	if (sw_params) {
+		snd_pcm_sw_params_free(sw_params);
+	}
+
+	return rc;
+}
+
 static int dev_open(sound_t *sound)
 {
 	int rc, rc_rec = 0, rc_play = 0;
@@ -142,16 +242,17 @@ static int dev_open(sound_t *sound)
 		return (rc_play < 0) ? rc_play : rc_rec;
 
 	if (sound->direction == SOUND_DIR_PLAY || sound->direction == SOUND_DIR_DUPLEX) {
-		rc = set_hw_params(sound->phandle, sound->samplerate, &sound->pchannels);
+		sound->pchannels = sound->channels;
+		rc = set_hw_params(sound->phandle, sound->samplerate, &sound->pchannels, &sound->pformat, &sound->pmmap);
 		if (rc < 0) {
 			LOGP(DSOUND, LOGL_ERROR, "Failed to set playback hw params\n");
 			return rc;
 		}
 		if (sound->pchannels < sound->channels) {
 			LOGP(DSOUND, LOGL_ERROR, "Sound card only supports %d channel for playback.\n", sound->pchannels);
-			return rc;
+			return -EIO;
 		}
-		LOGP(DSOUND, LOGL_DEBUG, "Playback with %d channels.\n", sound->pchannels);
+		LOGP(DSOUND, LOGL_DEBUG, "Playback with %d channels, format %s, %s access.\n", sound->pchannels, snd_pcm_format_name(sound->pformat), (sound->pmmap) ? "mmap" : "read/write");
 
 		rc = snd_pcm_prepare(sound->phandle);
 		if (rc < 0) {
@@ -161,7 +262,8 @@ static int dev_open(sound_t *sound)
 	}
 
 	if (sound->direction == SOUND_DIR_REC || sound->direction == SOUND_DIR_DUPLEX) {
-		rc = set_hw_params(sound->chandle, sound->samplerate, &sound->cchannels);
+		sound->cchannels = sound->channels;
+		rc = set_hw_params(sound->chandle, sound->samplerate, &sound->cchannels, &sound->cformat, &sound->cmmap);
 		if (rc < 0) {
 			LOGP(DSOUND, LOGL_ERROR, "Failed to set capture hw params\n");
 			return rc;
@@ -170,7 +272,13 @@ static int dev_open(sound_t *sound)
 			LOGP(DSOUND, LOGL_ERROR, "Sound card only supports %d channel for capture.\n", sound->cchannels);
 			return -EIO;
 		}
-		LOGP(DSOUND, LOGL_DEBUG, "Capture with %d channels.\n", sound->cchannels);
+		LOGP(DSOUND, LOGL_DEBUG, "Capture with %d channels, format %s, %s access.\n", sound->cchannels, snd_pcm_format_name(sound->cformat), (sound->cmmap) ? "mmap" : "read/write");
+
+		rc = set_sw_params(sound->chandle, sound->avail_min);
+		if (rc < 0) {
+			LOGP(DSOUND, LOGL_ERROR, "Failed to set capture sw params\n");
+			return rc;
+		}
 
 		rc = snd_pcm_prepare(sound->chandle);
 		if (rc < 0) {
@@ -190,15 +298,191 @@ static void dev_close(sound_t *sound)
 		snd_pcm_close(sound->chandle);
 }
 
-void *sound_open(int direction, const char *audiodev, double __attribute__((unused)) *tx_frequency, double __attribute__((unused)) *rx_frequency, int __attribute__((unused)) *am, int channels, double __attribute__((unused)) paging_frequency, int samplerate, int __attribute((unused)) buffer_size, double __attribute__((unused)) interval, double max_deviation, double __attribute__((unused)) max_modulation, double __attribute__((unused)) modulation_index)
+/* allocate buffer for devices that do not support mmap */
+static int alloc_buffer(sound_t *sound, int frames)
+{
+	int channels = (sound->pchannels > sound->cchannels) ? sound->pchannels : sound->cchannels;
+
+	if (frames <= sound->buffer_frames)
+		return 0;
+
+	free(sound->buffer);
+	free(sound->buffer_areas);
+	sound->buffer_frames = 0;
+	/* 4 bytes are the largest sample size of all formats used */
+	sound->buffer = malloc(frames * channels * 4);
+	sound->buffer_areas = calloc(channels, sizeof(*sound->buffer_areas));
+	if (!sound->buffer || !sound->buffer_areas) {
+		LOGP(DSOUND, LOGL_ERROR, "Failed to alloc memory!\n");
+		return -ENOMEM;
+	}
+	sound->buffer_frames = frames;
+
+	return 0;
+}
+
+/* describe interleaved frames in buffer as areas */
+static const snd_pcm_channel_area_t *get_buffer_areas(sound_t *sound, int channels, snd_pcm_format_t format)
+{
+	int bits = snd_pcm_format_physical_width(format);
+	int c;
+
+	for (c = 0; c < channels; c++) {
+		sound->buffer_areas[c].addr = sound->buffer;
+		sound->buffer_areas[c].first = c * bits;
+		sound->buffer_areas[c].step = channels * bits;
+	}
+
+	return sound->buffer_areas;
+}
+
+/* sample format of the device, as used by the conversion */
+static enum sound_format get_format(snd_pcm_format_t format)
+{
+	switch (format) {
+	case SND_PCM_FORMAT_S16:
+		return SOUND_FORMAT_S16;
+	case SND_PCM_FORMAT_S32:
+		return SOUND_FORMAT_S32;
+	case SND_PCM_FORMAT_FLOAT:
+		return SOUND_FORMAT_FLOAT;
+	default:
+		fprintf(stderr, "Sample format %d not handled, please fix!\n", format);
+		abort();
+	}
+}
+
+/* multiply samples by scale, convert them to the format of the device and store them in the area of a channel
+ * if samples is NULL, silence is stored */
+static void store_area(const snd_pcm_channel_area_t *area, snd_pcm_uframes_t offset, snd_pcm_format_t format, const sample_t *samples, double scale, int num)
+{
+	uint8_t *p = (uint8_t *)area->addr + (area->first + offset * area->step) / 8;
+
+	sound_format_store(get_format(format), p, area->step / 8, samples, scale, num);
+}
+
+/* load samples from the area of a channel, convert them from the format of the device and multiply by scale
+ * if add is set, the samples are added to the given samples */
+static void load_area(const snd_pcm_channel_area_t *area, snd_pcm_uframes_t offset, snd_pcm_format_t format, sample_t *samples, double scale, int add, int num)
+{
+	const uint8_t *p = (const uint8_t *)area->addr + (area->first + offset * area->step) / 8;
+
+	sound_format_load(get_format(format), p, area->step / 8, samples, scale, add, num);
+}
+
+/* write samples of all channels of the device, NULL pointer writes silence
+ * returns the number of frames written */
+static int pcm_write(sound_t *sound, sample_t **src, double *scale, int num)
+{
+	const snd_pcm_channel_area_t *areas;
+	snd_pcm_uframes_t offset, frames;
+	snd_pcm_sframes_t avail, commit;
+	int written = 0;
+	int rc, c;
+
+	if (!sound->pmmap) {
+		rc = alloc_buffer(sound, num);
+		if (rc < 0)
+			return rc;
+		areas = get_buffer_areas(sound, sound->pchannels, sound->pformat);
+		for (c = 0; c < sound->pchannels; c++)
+			store_area(&areas[c], 0, sound->pformat, src[c], scale[c], num);
+		return snd_pcm_writei(sound->phandle, sound->buffer, num);
+	}
+
+	avail = snd_pcm_avail_update(sound->phandle);
+	if (avail < 0)
+		return avail;
+	if (num > avail)
+		num = avail;
+
+	/* the buffer may wrap, so it can take more than one turn */
+	while (written < num) {
+		frames = num - written;
+		rc = snd_pcm_mmap_begin(sound->phandle, &areas, &offset, &frames);
+		if (rc < 0)
+			return rc;
+		if (frames == 0)
+			break;
+		for (c = 0; c < sound->pchannels; c++)
+			store_area(&areas[c], offset, sound->pformat, (src[c]) ? src[c] + written : NULL, scale[c], frames);
+		commit = snd_pcm_mmap_commit(sound->phandle, offset, frames);
+		if (commit < 0)
+			return commit;
+		if ((snd_pcm_uframes_t)commit != frames)
+			return -EPIPE;
+		written += frames;
+	}
+
+	/* writing to mmap does not start playback, so we do it */
+	if (written && snd_pcm_state(sound->phandle) == SND_PCM_STATE_PREPARED) {
+		rc = snd_pcm_start(sound->phandle);
+		if (rc < 0)
+			return rc;
+	}
+
+	return written;
+}
+
+/* read samples of all channels of the device, NULL pointer ignores the channel
+ * returns the number of frames read */
+static int pcm_read(sound_t *sound, sample_t **dst, int *add, int num)
+{
+	const snd_pcm_channel_area_t *areas;
+	snd_pcm_uframes_t offset, frames;
+	snd_pcm_sframes_t commit;
+	int got = 0;
+	int rc, c;
+
+	if (!sound->cmmap) {
+		rc = alloc_buffer(sound, num);
+		if (rc < 0)
+			return rc;
+		/* make valgrind happy, because snd_pcm_readi() does not seem to initially fill buffer with values */
+		memset(sound->buffer, 0, snd_pcm_frames_to_bytes(sound->chandle, num));
+		rc = snd_pcm_readi(sound->chandle, sound->buffer, num);
+		if (rc <= 0)
+			return rc;
+		areas = get_buffer_areas(sound, sound->cchannels, sound->cformat);
+		for (c = 0; c < sound->cchannels; c++) {
+			if (dst[c])
+				load_area(&areas[c], 0, sound->cformat, dst[c], sound->spl_deviation, add[c], rc);
+		}
+		return rc;
+	}
+
+	/* the buffer may wrap, so it can take more than one turn */
+	while (got < num) {
+		frames = num - got;
+		rc = snd_pcm_mmap_begin(sound->chandle, &areas, &offset, &frames);
+		if (rc < 0)
+			return rc;
+		if (frames == 0)
+			break;
+		for (c = 0; c < sound->cchannels; c++) {
+			if (dst[c])
+				load_area(&areas[c], offset, sound->cformat, dst[c] + got, sound->spl_deviation, add[c], frames);
+		}
+		commit = snd_pcm_mmap_commit(sound->chandle, offset, frames);
+		if (commit < 0)
+			return commit;
+		if ((snd_pcm_uframes_t)commit != frames)
+			return -EPIPE;
+		got += frames;
+	}
+
+	return got;
+}
+
+void *sound_open(int direction, const char *audiodev, double __attribute__((unused)) *tx_frequency, double __attribute__((unused)) *rx_frequency, int __attribute__((unused)) *am, int channels, double __attribute__((unused)) paging_frequency, int samplerate, int __attribute((unused)) buffer_size, double interval, double max_deviation, double __attribute__((unused)) max_modulation, double __attribute__((unused)) modulation_index)
 {
 	sound_t *sound;
 	const char *env;
 	char *p;
 	int rc;
 
-	if (channels < 1 || channels > 2) {
-		LOGP(DSOUND, LOGL_ERROR, "Cannot use more than two channels with the same sound card!\n");
+	if (channels < 1) {
+		LOGP(DSOUND, LOGL_ERROR, "Cannot use sound card without channels!\n");
 		return NULL;
 	}
 
@@ -221,8 +505,22 @@ void *sound_open(int direction, const char *audiodev, double __attribute__((unus
 	sound->spl_deviation = max_deviation / 32767.0;
 #ifdef HAVE_MOBILE
 	sound->paging_phaseshift = 1.0 / ((double)samplerate / 1000.0);
+	sound->rx_frequency = calloc(channels, sizeof(*sound->rx_frequency));
+	sound->dmp = calloc(channels, sizeof(*sound->dmp));
+	if (!sound->rx_frequency || !sound->dmp) {
+		LOGP(DSOUND, LOGL_ERROR, "Failed to alloc memory!\n");
+		goto error;
+	}
 #endif
 
+	if ((env = getenv("KEEP_FRAMES"))) {
+		KEEP_FRAMES = atoi(env);
+		LOGP(DSOUND, LOGL_NOTICE, "KEEP %d samples in RX buffer, to prevent corrupt read.\n", KEEP_FRAMES);
+	}
+
+	/* wake up poll, if one interval can be read */
+	sound->avail_min = (int)ceil((double)samplerate * interval / 1000.0) + KEEP_FRAMES;
+
 	rc = dev_open(sound);
 	if (rc < 0)
 		goto error;
@@ -241,11 +539,6 @@ void *sound_open(int direction, const char *audiodev, double __attribute__((unus
 	}
 #endif
 
-	if ((env = getenv("KEEP_FRAMES"))) {
-		KEEP_FRAMES = atoi(env);
-		LOGP(DSOUND, LOGL_NOTICE, "KEEP %d samples in RX buffer, to prevent corrupt read.\n", KEEP_FRAMES);
-	}
-
 	return sound;
 
 error:
@@ -257,13 +550,15 @@ error:
 int sound_start(void *inst)
 {
 	sound_t *sound = (sound_t *)inst;
-	int16_t buff[2];
 
 	if (sound->direction != SOUND_DIR_REC && sound->direction != SOUND_DIR_DUPLEX)
 		return -EINVAL;
 
 	/* trigger capturing */
-	snd_pcm_readi(sound->chandle, buff, 1);
+	if (sound->cmmap)
+		snd_pcm_start(sound->chandle);
+	else if (alloc_buffer(sound, 1) == 0)
+		snd_pcm_readi(sound->chandle, sound->buffer, 1);
 
 	return 0;
 }
@@ -274,11 +569,19 @@ void sound_close(void *inst)
 
 	dev_close(sound);
 	free(sound->paudiodev);
+	free(sound->buffer);
+	free(sound->buffer_areas);
+#ifdef HAVE_MOBILE
+	free(sound->paging);
+	free(sound->rx_frequency);
+	free(sound->dmp);
+#endif
 	free(sound);
 }
 
 #ifdef HAVE_MOBILE
-static void gen_paging_tone(sound_t *sound, int16_t *samples, int length, enum paging_signal paging_signal, int on)
+/* generate paging signal with the level of S16 samples */
+static void gen_paging_tone(sound_t *sound, sample_t *samples, int length, enum paging_signal paging_signal, int on)
 {
 	double phaseshift, phase;
 	int i;
@@ -295,16 +598,18 @@ static void gen_paging_tone(sound_t *sound, int16_t *samples, int length, enum p
 			phase = sound->paging_phase;
 			for (i = 0; i < length; i++) {
 				if (phase < 0.5)
-					*samples++ = 30000;
+					*samples++ = 30000.0;
 				else
-					*samples++ = -30000;
+					*samples++ = -30000.0;
 				phase += phaseshift;
 				if (phase >= 1.0)
 					phase -= 1.0;
 			}
 			sound->paging_phase = phase;
-		} else
-			memset(samples, 0, length << 1);
+		} else {
+			for (i = 0; i < length; i++)
+				*samples++ = 0.0;
+		}
 		break;
 	case PAGING_SIGNAL_NEGATIVE:
 		/* negative signal if paging signal is on */
@@ -312,10 +617,13 @@ static void gen_paging_tone(sound_t *sound, int16_t *samples, int length, enum p
 		/* FALLTHRU */
 	case PAGING_SIGNAL_POSITIVE:
 		/* positive signal if paging signal is on */
-		if (on)
-			memset(samples, 127, length << 1);
-		else
-			memset(samples, 128, length << 1);
+		if (on) {
+			for (i = 0; i < length; i++)
+				*samples++ = 32639.0;
+		} else {
+			for (i = 0; i < length; i++)
+				*samples++ = -32640.0;
+		}
 		break;
 	case PAGING_SIGNAL_NONE:
 		break;
@@ -326,70 +634,44 @@ static void gen_paging_tone(sound_t *sound, int16_t *samples, int length, enum p
 int sound_write(void *inst, sample_t **samples, uint8_t __attribute__((unused)) **power, int num, enum paging_signal __attribute__((unused)) *paging_signal, int __attribute__((unused)) *on, int channels)
 {
 	sound_t *sound = (sound_t *)inst;
-	double spl_deviation = sound->spl_deviation;
-	int32_t value;
-	int16_t buff[num << 1];
+	sample_t *src[sound->pchannels];
+	double scale[sound->pchannels];
 	int rc;
-	int i, ii;
+	int c;
 
 	if (sound->direction != SOUND_DIR_PLAY && sound->direction != SOUND_DIR_DUPLEX)
 		return -EINVAL;
 
-	if (sound->pchannels == 2) {
-		/* two channels */
+	/* channels of the device that are not used get silence */
+	for (c = 0; c < sound->pchannels; c++) {
+		src[c] = (c < channels) ? samples[c] : NULL;
+		scale[c] = 1.0 / sound->spl_deviation;
+	}
+
+	if (sound->pchannels >= 2) {
+		/* second channel */
 #ifdef HAVE_MOBILE
 		if (paging_signal && on && paging_signal[0] != PAGING_SIGNAL_NONE) {
-			int16_t paging[num << 1];
-			gen_paging_tone(sound, paging, num, paging_signal[0], on[0]);
-			for (i = 0, ii = 0; i < num; i++) {
-				value = samples[0][i] / spl_deviation;
-				if (value > 32767)
-					value = 32767;
-				else if (value < -32767)
-					value = -32767;
-				buff[ii++] = value;
-				buff[ii++] = paging[i];
+			if (num > sound->paging_size) {
+				free(sound->paging);
+				sound->paging_size = 0;
+				sound->paging = malloc(num * sizeof(*sound->paging));
+				if (!sound->paging) {
+					LOGP(DSOUND, LOGL_ERROR, "Failed to alloc memory!\n");
+					return -ENOMEM;
+				}
+				sound->paging_size = num;
 			}
+			gen_paging_tone(sound, sound->paging, num, paging_signal[0], on[0]);
+			src[1] = sound->paging;
+			scale[1] = 1.0;
 		} else
 #endif
-		if (channels == 2) {
-			for (i = 0, ii = 0; i < num; i++) {
-				value = samples[0][i] / spl_deviation;
-				if (value > 32767)
-					value = 32767;
-				else if (value < -32767)
-					value = -32767;
-				buff[ii++] = value;
-				value = samples[1][i] / spl_deviation;
-				if (value > 32767)
-					value = 32767;
-				else if (value < -32767)
-					value = -32767;
-				buff[ii++] = value;
-			}
-		} else {
-			for (i = 0, ii = 0; i < num; i++) {
-				value = samples[0][i] / spl_deviation;
-				if (value > 32767)
-					value = 32767;
-				else if (value < -32767)
-					value = -32767;
-				buff[ii++] = value;
-				buff[ii++] = value;
-			}
-		}
-	} else {
-		/* one channel */
-		for (i = 0, ii = 0; i < num; i++) {
-			value = samples[0][i] / spl_deviation;
-			if (value > 32767)
-				value = 32767;
-			else if (value < -32767)
-				value = -32767;
-			buff[ii++] = value;
-		}
+		if (channels == 1)
+			src[1] = samples[0];
 	}
-	rc = snd_pcm_writei(sound->phandle, buff, num);
+
+	rc = pcm_write(sound, src, scale, num);
 
 	if (rc < 0) {
 		LOGP(DSOUND, LOGL_ERROR, "failed to write audio to interface (%s)\n", snd_strerror(rc));
@@ -413,12 +695,10 @@ int sound_write(void *inst, sample_t **samples, uint8_t __attribute__((unused))
 int sound_read(void *inst, sample_t **samples, int num, int channels, double *rf_level_db)
 {
 	sound_t *sound = (sound_t *)inst;
-	double spl_deviation = sound->spl_deviation;
-	int16_t buff[num << 1];
-	int32_t spl;
-	int32_t max[2], a;
+	sample_t *dst[sound->cchannels];
+	int add[sound->cchannels];
 	int in, rc;
-	int i, ii;
+	int c;
 
 	if (sound->direction != SOUND_DIR_REC && sound->direction != SOUND_DIR_DUPLEX)
 		return -EINVAL;
@@ -434,12 +714,20 @@ int sound_read(void *inst, sample_t **samples, int num, int channels, double *rf
 	if (in > num)
 		in = num;
 
-	/* make valgrind happy, because snd_pcm_readi() does not seem to initially fill buffer with values */
-	memset(buff, 0, sizeof(*buff) * sound->cchannels * in);
+	/* channels of the device that are not used are ignored */
+	for (c = 0; c < sound->cchannels; c++) {
+		dst[c] = (c < channels) ? samples[c] : NULL;
+		add[c] = 0;
+	}
+	/* mix both channels of a stereo device, if only one channel is used */
+	if (sound->cchannels == 2 && channels < 2) {
+		dst[1] = samples[0];
+		add[1] = 1;
+	}
 
-	rc = snd_pcm_readi(sound->chandle, buff, in);
+	rc = pcm_read(sound, dst, add, in);
 	if (rc < 0) {
-		if (errno == EAGAIN)
+		if (rc == -EAGAIN)
 			return 0;
 		LOGP(DSOUND, LOGL_ERROR, "failed to read audio from interface (%s)\n", snd_strerror(rc));
 		/* recover read */
@@ -455,54 +743,28 @@ int sound_read(void *inst, sample_t **samples, int num, int channels, double *rf
 	}
 	if (rc == 0)
 		return rc;
-	if (sound->cchannels == 2) {
-		if (channels < 2) {
-			for (i = 0, ii = 0; i < rc; i++) {
-				spl = buff[ii++];
-				spl += buff[ii++];
-				a = (spl >= 0) ? spl : -spl;
-				if (i == 0 || a > max[0])
-					max[0] = a;
-				samples[0][i] = (double)spl * spl_deviation;
-			}
-		} else {
-			for (i = 0, ii = 0; i < rc; i++) {
-				spl = buff[ii++];
-				a = (spl >= 0) ? spl : -spl;
-				if (i == 0 || a > max[0])
-					max[0] = a;
-				samples[0][i] = (double)spl * spl_deviation;
-				spl = buff[ii++];
-				a = (spl >= 0) ? spl : -spl;
-				if (i == 0 || a > max[1])
-					max[1] = a;
-				samples[1][i] = (double)spl * spl_deviation;
-			}
-		}
-	} else {
-		for (i = 0, ii = 0; i < rc; i++) {
-			spl = buff[ii++];
-			a = (spl >= 0) ? spl : -spl;
-			if (i == 0 || a > max[0])
-				max[0] = a;
-			samples[0][i] = (double)spl * spl_deviation;
-		}
-	}
 
 #ifdef HAVE_MOBILE
 	sender_t *sender;
-	for (i = 0; i < channels; i++) {
+	double max, a;
+	int i;
+	for (c = 0; c < channels; c++) {
 		if (rf_level_db)
-			rf_level_db[i] = NAN;
-		sender = get_sender_by_empfangsfrequenz(sound->rx_frequency[i]);
+			rf_level_db[c] = NAN;
+		sender = get_sender_by_empfangsfrequenz(sound->rx_frequency[c]);
 		if (!sender)
 			continue;
-		display_measurements_update(sound->dmp[i], log10((double)max[i] / 32768.0) * 20, 0.0);
+		for (i = 0, max = 0.0; i < rc; i++) {
+			a = fabs(samples[c][i]);
+			if (a > max)
+				max = a;
+		}
+		display_measurements_update(sound->dmp[c], log10(max / sound->spl_deviation / 32768.0) * 20, 0.0);
 	}
 #else
-	for (i = 0; i < channels; i++) {
+	for (c = 0; c < channels; c++) {
 		if (rf_level_db)
-			rf_level_db[i] = NAN;
+			rf_level_db[c] = NAN;
 	}
 #endif
 
@@ -546,6 +808,45 @@ int sound_get_tosend(void *inst, int buffer_size)
 	return tosend;
 }
 
+/*
+ * get file descriptors to wait for captured samples
+ *
+ * return 0 if samples can be read now, number of file descriptors otherwise */
+int sound_poll_fds(void *inst, struct pollfd *pfd, int max)
+{
+	sound_t *sound = (sound_t *)inst;
+	snd_pcm_sframes_t avail;
+
+	if (sound->direction != SOUND_DIR_REC && sound->direction != SOUND_DIR_DUPLEX)
+		return -EINVAL;
+
+	/* read now, also if there is an error, so it can be handled by sound_read() */
+	avail = snd_pcm_avail(sound->chandle);
+	if (avail < 0 || avail >= sound->avail_min)
+		return 0;
+
+	return snd_pcm_poll_descriptors(sound->chandle, pfd, max);
+}
+
+/*
+ * translate the events of the file descriptors given by sound_poll_fds()
+ *
+ * return 1 if samples can be read now, 0 otherwise */
+int sound_poll_revents(void *inst, struct pollfd *pfd, int num)
+{
+	sound_t *sound = (sound_t *)inst;
+	unsigned short revents;
+	int rc;
+
+	/* some plugins use other events on their descriptors than they report */
+	rc = snd_pcm_poll_descriptors_revents(sound->chandle, pfd, num, &revents);
+	/* read now, so the error can be handled by sound_read() */
+	if (rc < 0)
+		return 1;
+
+	return (revents & (POLLIN | POLLERR)) ? 1 : 0;
+}
+
 int sound_is_stereo_capture(void *inst)
 {
 	sound_t *sound = (sound_t *)inst;
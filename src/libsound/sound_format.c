@@ -0,0 +1,112 @@
+/* Conversion of samples from and to the sample format of sound devices
+ *
+ * (C) 2026 by Andreas Eversberg <jolly@eversberg.eu>
+ * All Rights Reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* How it works:
+ *
+ * The samples of one channel are stored in a buffer with a given step in
+ * bytes from one sample to the next sample. This way a channel of interleaved
+ * and non-interleaved buffers is converted the same way.
+ *
+ * The level of the samples is the level of S16. Stored samples are clipped to
+ * the range of S16. S32 has the same level, shifted by 16 bits. FLOAT has the
+ * level of S16, divided by 32768.
+ *
+ * This does not depend on ALSA, so it can be tested without sound card.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../libsample/sample.h"
+#include "sound_format.h"
+
+static inline double clip_s16(double value)
+{
+	if (value > 32767.0)
+		return 32767.0;
+	if (value < -32767.0)
+		return -32767.0;
+	return value;
+}
+
+/* multiply samples by scale, convert them to the given format and store them with given step (bytes) between samples
+ * if samples is NULL, silence is stored */
+void sound_format_store(enum sound_format format, void *dst, int step, const sample_t *samples, double scale, int num)
+{
+	uint8_t *p = dst;
+	double value;
+	int i;
+
+	switch (format) {
+	case SOUND_FORMAT_S16:
+		for (i = 0; i < num; i++, p += step) {
+			value = (samples) ? clip_s16(samples[i] * scale) : 0.0;
+			*(int16_t *)p = (int16_t)value;
+		}
+		break;
+	case SOUND_FORMAT_S32:
+		for (i = 0; i < num; i++, p += step) {
+			value = (samples) ? clip_s16(samples[i] * scale) : 0.0;
+			*(int32_t *)p = (int32_t)(value * 65536.0);
+		}
+		break;
+	case SOUND_FORMAT_FLOAT:
+		for (i = 0; i < num; i++, p += step) {
+			value = (samples) ? clip_s16(samples[i] * scale) : 0.0;
+			*(float *)p = (float)(value / 32768.0);
+		}
+		break;
+	default:
+		fprintf(stderr, "Sample format %d not handled, please fix!\n", format);
+		abort();
+	}
+}
+
+/* load samples with given step (bytes) between samples, convert them from the given format and multiply by scale
+ * if add is set, the samples are added to the given samples */
+void sound_format_load(enum sound_format format, const void *src, int step, sample_t *samples, double scale, int add, int num)
+{
+	const uint8_t *p = src;
+	double value;
+	int i;
+
+	switch (format) {
+	case SOUND_FORMAT_S16:
+		for (i = 0; i < num; i++, p += step) {
+			value = *(const int16_t *)p;
+			samples[i] = ((add) ? samples[i] : 0.0) + value * scale;
+		}
+		break;
+	case SOUND_FORMAT_S32:
+		for (i = 0; i < num; i++, p += step) {
+			value = *(const int32_t *)p / 65536.0;
+			samples[i] = ((add) ? samples[i] : 0.0) + value * scale;
+		}
+		break;
+	case SOUND_FORMAT_FLOAT:
+		for (i = 0; i < num; i++, p += step) {
+			value = *(const float *)p * 32768.0;
+			samples[i] = ((add) ? samples[i] : 0.0) + value * scale;
+		}
+		break;
+	default:
+		fprintf(stderr, "Sample format %d not handled, please fix!\n", format);
+		abort();
+	}
+}
@@ -0,0 +1,9 @@
+
+enum sound_format {
+	SOUND_FORMAT_S16,
+	SOUND_FORMAT_S32,
+	SOUND_FORMAT_FLOAT,
+};
+
+void sound_format_store(enum sound_format format, void *dst, int step, const sample_t *samples, double scale, int num);
+void sound_format_load(enum sound_format format, const void *src, int step, sample_t *samples, double scale, int add, int num);
@@ -1,7 +1,4 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include "tones.h"
-#include "american_congestion.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t slin16_congestion[] = {
 	0xfffd, 0x0004, 0xfffb, 0x0004, 0xfffe, 0x0001, 0x0001, 0xfffe,
@@ -6633,9 +6630,3 @@ static uint16_t slin16_congestion[] = {
 	0xfeae, 0xfdc4, 0x007f, 0x01bd, 0xffee, 0xfef0, 0xffa5, 0xfff2,
 	0xfee3, 0xff0f, 0x0007, 0xff7b, 0xfee5, 0xfefe, 0xff93, 0x0033,
 };
-
-tones_seq_t seq_american_congestion[] = {
-        { TONES_TDATA_SLIN16HOST, TONES_DURATION_AUTO, slin16_congestion, sizeof(slin16_congestion), -6.0 },
-        { TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
-};
-
@@ -1,7 +1,4 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include "tones.h"
-#include "american_invalidnumber.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t slin16_invalidnumber[] = {
 	0xfffe, 0x0001, 0xffff, 0x0001, 0xffff, 0x0002, 0xfffe, 0x0002,
@@ -7210,9 +7207,3 @@ static uint16_t slin16_invalidnumber[] = {
 	0xff5f, 0xff95, 0x00fb, 0xff59, 0xff9b, 0xff95, 0xff54, 0x0018,
 	0xfffc, 0x00c0, 0x005c, 0xff41, 0xff90, 0x0021, 0xff10, 0xff27,
 };
-
-tones_seq_t seq_american_invalidnumber[] = {
-        { TONES_TDATA_SLIN16HOST, TONES_DURATION_AUTO, slin16_invalidnumber, sizeof(slin16_invalidnumber), -6.0 },
-        { TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
-};
-
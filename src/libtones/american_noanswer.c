@@ -1,7 +1,4 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include "tones.h"
-#include "american_congestion.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t slin16_noanswer[] = {
 	0xfe24, 0xfd20, 0xfd2c, 0xfdb5, 0xfeba, 0xfe20, 0xfd41, 0xfe32,
@@ -5093,9 +5090,3 @@ static uint16_t slin16_noanswer[] = {
 	0xfe7e, 0xfe79, 0xfd4d, 0xfddc, 0xfeb9, 0xfe03, 0xfdfb, 0xfeb9,
 	0xfe6a, 0xfe18, 0xff14, 0xff4e, 0xfe2d, 0xfdd9, 0xfde3, 0xfdd8,
 };
-
-tones_seq_t seq_american_noanswer[] = {
-        { TONES_TDATA_SLIN16HOST, TONES_DURATION_AUTO, slin16_noanswer, sizeof(slin16_noanswer), -6.0 },
-        { TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
-};
-
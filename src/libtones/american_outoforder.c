@@ -1,7 +1,4 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include "tones.h"
-#include "american_outoforder.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t slin16_outoforder[] = {
 	0xfeae, 0xfde4, 0xfe26, 0xfea7, 0xfe94, 0xfe8a, 0xfeb4, 0xfe3b,
@@ -8170,9 +8167,3 @@ static uint16_t slin16_outoforder[] = {
 	0xfffa, 0xfffc, 0xfffc, 0xfffc, 0xfffc, 0xfffe, 0xfffc, 0xffff,
 	0xfffe, 0xfffe, 0xffff, 0xfffe, 0x0001, 0xfffe, 0x0003, 0xfffe,
 };
-
-tones_seq_t seq_american_outoforder[] = {
-        { TONES_TDATA_SLIN16HOST, TONES_DURATION_AUTO, slin16_outoforder, sizeof(slin16_outoforder), -6.0 },
-        { TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
-};
-
@@ -1,7 +1,4 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include "tones.h"
-#include "denmark_outoforder.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t slin16_outoforder[] = {
 	0x0007, 0x0008, 0x0008, 0x0009, 0x0006, 0x000b, 0x0004, 0x000a,
@@ -7148,9 +7145,3 @@ static uint16_t slin16_outoforder[] = {
 	0xff89, 0xff94, 0xff8e, 0xff8d, 0xff8c, 0xff93, 0xff8a, 0xff91,
 	0xff85, 0xff83, 0xff8e, 0xff82, 0xff82, 0xff8a, 0xff87, 0xff93,
 };
-
-tones_seq_t seq_denmark_outoforder[] = {
-        { TONES_TDATA_SLIN16HOST, TONES_DURATION_AUTO, slin16_outoforder, sizeof(slin16_outoforder), -6.0 },
-        { TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
-};
-
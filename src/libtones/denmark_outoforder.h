@@ -1,3 +0,0 @@
-
-extern tones_seq_t seq_denmark_outoforder[];
-
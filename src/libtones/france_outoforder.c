@@ -1,7 +1,4 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include "tones.h"
-#include "france_outoforder.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t slin16_outoforder[] = {
 	0x0000, 0x0000, 0x0003, 0xfff8, 0xfff6, 0xfff2, 0xfffd, 0xfffc,
@@ -6802,9 +6799,3 @@ static uint16_t slin16_outoforder[] = {
 	0x0002, 0xffff, 0xffff, 0x0003, 0xfffc, 0x0004, 0xfff9, 0xfff2,
 	0xfff8, 0xfff1, 0xfff8, 0xfff3, 0xfff5, 0xfff5, 0xfff5, 0xfff4,
 };
-
-tones_seq_t seq_france_outoforder[] = {
-        { TONES_TDATA_SLIN16HOST, TONES_DURATION_AUTO, slin16_outoforder, sizeof(slin16_outoforder), -6.0 },
-        { TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
-};
-
@@ -1,7 +1,4 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include "tones.h"
-#include "german_outoforder.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t slin16_outoforder[] = {
 	0x0012, 0x0019, 0x0016, 0x0019, 0x0015, 0x0008, 0xfffd, 0x0005,
@@ -5417,9 +5414,3 @@ static uint16_t slin16_outoforder[] = {
 	0xfff6, 0xfff7, 0x0007, 0x000e, 0x0015, 0x0005, 0x0002, 0xfff5,
 	0xfff8, 0x0003, 0x0002, 0x001c, 0x000d, 0x0004, 0xfff0, 0xfff6,
 };
-
-tones_seq_t seq_german_outoforder[] = {
-        { TONES_TDATA_SLIN16HOST, TONES_DURATION_AUTO, slin16_outoforder, sizeof(slin16_outoforder), -6.0 },
-        { TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
-};
-
@@ -1,7 +1,4 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include "tones.h"
-#include "oldgerman_outoforder.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t slin16_outoforder[] = {
 	0xffd1, 0x0011, 0x0031, 0x002d, 0x0016, 0x000d, 0x002f, 0xffea,
@@ -4992,9 +4989,3 @@ static uint16_t slin16_outoforder[] = {
 	0x0008, 0x0002, 0xfff8, 0xfffc, 0xfff4, 0xfffb, 0xfffe, 0xfff3,
 	0x0006, 0x000e, 0xfffd, 0x000b, 0xfffc, 0x000b, 0x000e, 0xfffb,
 };
-
-tones_seq_t seq_oldgerman_outoforder[] = {
-        { TONES_TDATA_SLIN16HOST, TONES_DURATION_AUTO, slin16_outoforder, sizeof(slin16_outoforder), -6.0 },
-        { TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
-};
-
@@ -3,15 +3,47 @@
 #include <stdlib.h>
 #include "tones.h"
 #include "patterns.h"
-#include "german_outoforder.h"
-#include "oldgerman_outoforder.h"
-#include "american_outoforder.h"
-#include "american_invalidnumber.h"
-#include "american_noanswer.h"
-#include "american_congestion.h"
-#include "denmark_outoforder.h"
-#include "uk_outoforder.h"
-#include "france_outoforder.h"
+
+/* announcements are loaded from the sample store when they are used */
+static tones_seq_t seq_german_outoforder[] = {
+	{ TONES_TDATA_SLIN16STORE, TONES_DURATION_AUTO, "german_outoforder", 0, -6.0 },
+	{ TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
+};
+
+static tones_seq_t seq_oldgerman_outoforder[] = {
+	{ TONES_TDATA_SLIN16STORE, TONES_DURATION_AUTO, "oldgerman_outoforder", 0, -6.0 },
+	{ TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
+};
+
+static tones_seq_t seq_american_outoforder[] = {
+	{ TONES_TDATA_SLIN16STORE, TONES_DURATION_AUTO, "american_outoforder", 0, -6.0 },
+	{ TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
+};
+
+static tones_seq_t seq_american_invalidnumber[] = {
+	{ TONES_TDATA_SLIN16STORE, TONES_DURATION_AUTO, "american_invalidnumber", 0, -6.0 },
+	{ TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
+};
+
+static tones_seq_t seq_american_noanswer[] = {
+	{ TONES_TDATA_SLIN16STORE, TONES_DURATION_AUTO, "american_noanswer", 0, -6.0 },
+	{ TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
+};
+
+static tones_seq_t seq_american_congestion[] = {
+	{ TONES_TDATA_SLIN16STORE, TONES_DURATION_AUTO, "american_congestion", 0, -6.0 },
+	{ TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
+};
+
+static tones_seq_t seq_denmark_outoforder[] = {
+	{ TONES_TDATA_SLIN16STORE, TONES_DURATION_AUTO, "denmark_outoforder", 0, -6.0 },
+	{ TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
+};
+
+static tones_seq_t seq_uk_outoforder[] = {
+	{ TONES_TDATA_SLIN16STORE, TONES_DURATION_AUTO, "uk_outoforder", 0, -6.0 },
+	{ TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
+};
 
 /* all tones are alaw flipped encoded */
 /* the last sample+1 is in phase with the first sample. */
@@ -8,6 +8,8 @@
 #include <math.h>
 #include "tones.h"
 #include "patterns.h"
+#include "../libsamplestore/samplestore.h"
+#include "../liblogging/logging.h"
 #include <osmocom/cc/g711.h>
 
 struct tones_sets_t {
@@ -58,6 +60,7 @@ static size_t sizeof_coding(enum tones_tdata coding)
 {
 	switch (coding) {
 	case TONES_TDATA_SLIN16HOST:
+	case TONES_TDATA_SLIN16STORE:
 		return 2;
 	case TONES_TDATA_ALAW:
 	case TONES_TDATA_ULAW:
@@ -84,6 +87,8 @@ static int render_chunk(void *out_spl, enum tones_tdata out_coding, void *in_spl
 	if (in_coding == TONES_TDATA_SLIN16HOST && db) {
 		level = pow(10.0, db / 20.0);
 		new_in_spl = malloc(duration * 2);
+		if (!new_in_spl)
+			return -ENOMEM;
 		for (s = 0; s < duration; s++) {
 			value = (double)(((int16_t *)in_spl)[s]) * level;
 			if (value > 32767)
@@ -117,6 +122,7 @@ static int render_chunk(void *out_spl, enum tones_tdata out_coding, void *in_spl
 			g711_decode_ulaw_flipped(in_spl, duration, &temp, &temp_size, NULL);
 			memcpy(out_spl, temp, duration * 2);
 			break;
+		case TONES_TDATA_SLIN16STORE:
 		case TONES_TDATA_EOL:
 			return -EINVAL;
 		}
@@ -142,6 +148,7 @@ static int render_chunk(void *out_spl, enum tones_tdata out_coding, void *in_spl
 			g711_transcode_ulaw_flipped_to_alaw(in_spl, duration, &temp, &temp_size, NULL);
 			memcpy(out_spl, temp, duration);
 			break;
+		case TONES_TDATA_SLIN16STORE:
 		case TONES_TDATA_EOL:
 			return -EINVAL;
 		}
@@ -167,6 +174,7 @@ static int render_chunk(void *out_spl, enum tones_tdata out_coding, void *in_spl
 			g711_transcode_flipped(in_spl, duration, &temp, &temp_size, NULL);
 			memcpy(out_spl, temp, duration);
 			break;
+		case TONES_TDATA_SLIN16STORE:
 		case TONES_TDATA_EOL:
 			return -EINVAL;
 		}
@@ -193,6 +201,7 @@ static int render_chunk(void *out_spl, enum tones_tdata out_coding, void *in_spl
 			g711_transcode_flipped(temp, temp_size, &temp2, &temp_size2, NULL);
 			memcpy(out_spl, temp2, duration);
 			break;
+		case TONES_TDATA_SLIN16STORE:
 		case TONES_TDATA_EOL:
 			return -EINVAL;
 		}
@@ -219,10 +228,12 @@ static int render_chunk(void *out_spl, enum tones_tdata out_coding, void *in_spl
 		case TONES_TDATA_ULAWFLIPPED:
 			memcpy(out_spl, in_spl, duration);
 			break;
+		case TONES_TDATA_SLIN16STORE:
 		case TONES_TDATA_EOL:
 			return -EINVAL;
 		}
 		break;
+	case TONES_TDATA_SLIN16STORE:
 	case TONES_TDATA_EOL:
 		return -EINVAL;
 	}
@@ -234,10 +245,49 @@ static int render_chunk(void *out_spl, enum tones_tdata out_coding, void *in_spl
 	return 0;
 }
 
-static void render_tone(tones_data_t *data, uint8_t tone, tones_seq_t *seq, enum tones_tdata coding)
+/* Get sample data of a sequence, samples from the sample store are not
+ * copied, they are only read when rendering. */
+static void *get_spl_data(tones_seq_t *seq, size_t *size, enum tones_tdata *coding)
+{
+	const int16_t *spl;
+	int count;
+
+	if (seq->tdata != TONES_TDATA_SLIN16STORE) {
+		*size = seq->spl_data_size;
+		*coding = seq->tdata;
+		return seq->spl_data;
+	}
+
+	spl = samplestore_get(seq->spl_data, &count);
+	if (!spl || count <= 0)
+		return NULL;
+	*size = count * sizeof(*spl);
+	*coding = TONES_TDATA_SLIN16HOST;
+
+	return (void *)spl;
+}
+
+/* Return false, if samples of a sequence are missing in the sample store. */
+static bool seq_available(tones_seq_t *seq)
+{
+	int i;
+
+	for (i = 0; seq[i].tdata; i++) {
+		if (seq[i].tdata == TONES_TDATA_SLIN16STORE && samplestore_size(seq[i].spl_data) <= 0) {
+			LOGP(DCALL, LOGL_NOTICE, "Announcement '%s' not in sample store, using substitute tone.\n", (const char *)seq[i].spl_data);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int render_tone(tones_data_t *data, uint8_t tone, tones_seq_t *seq, enum tones_tdata coding)
 {
 	int duration, i, s, torender;
-	size_t in_spl_size, out_spl_size;
+	size_t in_spl_size, out_spl_size, in_data_size;
+	enum tones_tdata in_coding;
+	void *in_data;
 	int rc;
 
 	out_spl_size = sizeof_coding(coding);
@@ -246,30 +296,40 @@ static void render_tone(tones_data_t *data, uint8_t tone, tones_seq_t *seq, enum
 	duration = 0;
 	for (i = 0; seq[i].tdata; i++) {
 		in_spl_size = sizeof_coding(seq[i].tdata);
-		if (seq[i].duration == TONES_DURATION_AUTO)
-			duration += seq[i].spl_data_size / in_spl_size;
-		else
+		if (seq[i].duration == TONES_DURATION_AUTO) {
+			if (seq[i].tdata == TONES_TDATA_SLIN16STORE)
+				duration += samplestore_size(seq[i].spl_data);
+			else
+				duration += seq[i].spl_data_size / in_spl_size;
+		} else
 			duration += seq[i].duration;
 	}
 	data->spl_data[tone] = malloc(duration * data->spl_size);
+	if (!data->spl_data[tone])
+		return -ENOMEM;
 
 	/* Render each tone chunk. */
 	duration = 0;
 	for (i = 0; seq[i].tdata; i++) {
 		in_spl_size = sizeof_coding(seq[i].tdata);
+		in_data = get_spl_data(&seq[i], &in_data_size, &in_coding);
+		if (!in_data) {
+			rc = -ENOENT;
+			goto error;
+		}
 		if (seq[i].duration == TONES_DURATION_AUTO) {
-			torender = seq[i].spl_data_size / in_spl_size;
-			rc = render_chunk(data->spl_data[tone] + duration * out_spl_size, coding, seq[i].spl_data, seq[i].tdata, torender, seq[i].db);
+			torender = in_data_size / in_spl_size;
+			rc = render_chunk(data->spl_data[tone] + duration * out_spl_size, coding, in_data, in_coding, torender, seq[i].db);
 			if (rc)
-				abort();
+				goto error;
 			duration += torender;
 		} else for (s = 0; s < seq[i].duration; s += torender) {
-			torender = seq[i].spl_data_size / in_spl_size;
+			torender = in_data_size / in_spl_size;
 			if (seq[i].duration - s < torender)
 				torender = seq[i].duration - s;
-			rc = render_chunk(data->spl_data[tone] + duration * out_spl_size, coding, seq[i].spl_data, seq[i].tdata, torender, seq[i].db);
+			rc = render_chunk(data->spl_data[tone] + duration * out_spl_size, coding, in_data, in_coding, torender, seq[i].db);
 			if (rc)
-				abort();
+				goto error;
 			duration += torender;
 		}
 	}
@@ -278,6 +338,13 @@ static void render_tone(tones_data_t *data, uint8_t tone, tones_seq_t *seq, enum
 	/* Store silence interval until repeat. Use duration of TONES_TDATA_EOL. */
 	duration += seq[i].duration;
 	data->spl_repeat[tone] = duration;
+
+	return 0;
+
+error:
+	free(data->spl_data[tone]);
+	data->spl_data[tone] = NULL;
+	return rc;
 }
 
 int tones_init(tones_data_t *data, const char *toneset, enum tones_tdata coding)
@@ -298,27 +365,32 @@ int tones_init(tones_data_t *data, const char *toneset, enum tones_tdata coding)
 		return -EINVAL;
 	set = tones_sets[i].set;
 
+	data->coding = coding;
 	data->spl_size = sizeof_coding(coding);
 
+	/* Tones are rendered when they are used the first time. Tones with
+	 * samples that are not in the sample store are substituted. */
 	for (i = 0; set[i].tone; i++) {
-		render_tone(data, set[i].tone, set[i].seq, coding);
-		int peak = 0;
-		for (int s = 0; s < data->spl_duration[set[i].tone]; s++) {
-			if (((int16_t *)data->spl_data[set[i].tone])[s] > peak)
-				peak = ((int16_t *)data->spl_data[set[i].tone])[s];
-		}
+		if (seq_available(set[i].seq))
+			data->seq[set[i].tone] = set[i].seq;
 	}
-	render_tone(data, TONES_TONE_SILENCE, seq_silence, coding);
+	data->seq[TONES_TONE_SILENCE] = seq_silence;
 
 	return 0;
 }
 
 void tones_exit(tones_data_t *data)
 {
+	tones_encoded_t *enc;
 	int i;
 
 	for (i = 0; i < 256; i++)
 		free(data->spl_data[i]);
+	while ((enc = data->encoded)) {
+		data->encoded = enc->next;
+		free(enc->payload);
+		free(enc);
+	}
 	memset(data, 0, sizeof(*data));
 }
 
@@ -330,65 +402,65 @@ static enum tones_tone substitute_tone(tones_data_t *data, enum tones_tone tone)
 		return tone;
 
 	/* If no 'recall', use 'ringback'. If none of them, turn off tone. */
-	if (tone == TONES_TONE_RECALL && !data->spl_data[tone])
+	if (tone == TONES_TONE_RECALL && !data->seq[tone])
 		tone = TONES_TONE_RINGBACK;
-	if (tone == TONES_TONE_RINGBACK && !data->spl_data[tone])
+	if (tone == TONES_TONE_RINGBACK && !data->seq[tone])
 		tone = TONES_TONE_RECALL;
-	if (tone == TONES_TONE_RECALL && !data->spl_data[tone]) {
+	if (tone == TONES_TONE_RECALL && !data->seq[tone]) {
 		tone = TONES_TONE_SILENCE;
 		return tone;
 	}
 
 	/* Turn 'dialtonespecial' into 'dialtone'. If no dialtone exists, turn off tone. */
-	if (tone == TONES_TONE_DIALTONE_SPECIAL && !data->spl_data[tone])
+	if (tone == TONES_TONE_DIALTONE_SPECIAL && !data->seq[tone])
 		tone = TONES_TONE_DIALTONE;
-	if (tone == TONES_TONE_DIALTONE && !data->spl_data[tone]) {
+	if (tone == TONES_TONE_DIALTONE && !data->seq[tone]) {
 		tone = TONES_TONE_SILENCE;
 		return tone;
 	}
 
 	/* If no CW exists, turn off tone. */
-	if (tone == TONES_TONE_CW && !data->spl_data[tone]) {
+	if (tone == TONES_TONE_CW && !data->seq[tone]) {
 		tone = TONES_TONE_OFF;
 		return tone;
 	}
 
 	/* If no interception exists, turn off tone. */
-	if (tone == TONES_TONE_AUFSCHALTTON && !data->spl_data[tone]) {
+	if (tone == TONES_TONE_AUFSCHALTTON && !data->seq[tone]) {
 		tone = TONES_TONE_OFF;
 		return tone;
 	}
 
 	/* Turn 'congestion' into 'busy'. */
-	if (tone == TONES_TONE_CONGESTION && !data->spl_data[tone])
+	if (tone == TONES_TONE_CONGESTION && !data->seq[tone])
 		tone = TONES_TONE_BUSY;
 
 	/* Turn 'noanswer' into 'busy'. */
-	if (tone == TONES_TONE_NOANSWER && !data->spl_data[tone])
+	if (tone == TONES_TONE_NOANSWER && !data->seq[tone])
 		tone = TONES_TONE_BUSY;
 
 	/* Turn 'hangup' into 'busy' and vice versa. If none of them, use 'SIT'. */
-	if (tone == TONES_TONE_HANGUP && !data->spl_data[tone])
+	if (tone == TONES_TONE_HANGUP && !data->seq[tone])
 		tone = TONES_TONE_BUSY;
-	if (tone == TONES_TONE_BUSY && !data->spl_data[tone])
+	if (tone == TONES_TONE_BUSY && !data->seq[tone])
 		tone = TONES_TONE_HANGUP;
-	if (tone == TONES_TONE_HANGUP && !data->spl_data[tone])
+	if (tone == TONES_TONE_HANGUP && !data->seq[tone])
 		tone = TONES_TONE_SIT;
 
 	/* Turn any other non-existing tone into 'SIT' */
-	if (!data->spl_data[tone])
+	if (!data->seq[tone])
 		tone = TONES_TONE_SIT;
 
 	/* If no 'SIT', try to use congestion, busy or hangup. */
-	if (tone == TONES_TONE_SIT && !data->spl_data[tone])
+	if (tone == TONES_TONE_SIT && !data->seq[tone])
 		tone = TONES_TONE_CONGESTION;
-	if (tone == TONES_TONE_CONGESTION && !data->spl_data[tone])
+	if (tone == TONES_TONE_CONGESTION && !data->seq[tone])
 		tone = TONES_TONE_BUSY;
-	if (tone == TONES_TONE_BUSY && !data->spl_data[tone])
+	if (tone == TONES_TONE_BUSY && !data->seq[tone])
 		tone = TONES_TONE_HANGUP;
 
 	/* If no tone at all, turn off tone.*/
-	if (!data->spl_data[tone])
+	if (!data->seq[tone])
 		tone = TONES_TONE_SILENCE;
 
 	return tone;
@@ -396,9 +468,22 @@ static enum tones_tone substitute_tone(tones_data_t *data, enum tones_tone tone)
 
 void tones_set_tone(tones_data_t *data, tones_t *t, enum tones_tone tone)
 {
+	int rc;
+
 	t->data = data;
 	t->tone = substitute_tone(data, tone);
 	t->spl_pos = 0;
+
+	/* Render tone when it is used the first time. If it cannot be
+	 * rendered, it is removed from the set and substituted. */
+	while (data->seq[t->tone] && !data->spl_data[t->tone]) {
+		rc = render_tone(data, t->tone, data->seq[t->tone], data->coding);
+		if (rc == 0)
+			break;
+		LOGP(DCALL, LOGL_ERROR, "Failed to render tone %d (rc = %d), using substitute tone.\n", t->tone, rc);
+		data->seq[t->tone] = NULL;
+		t->tone = substitute_tone(data, tone);
+	}
 }
 
 void tones_read_tone(tones_t *t, void *out_data, int out_duration)
@@ -447,3 +532,82 @@ void tones_read_tone(tones_t *t, void *out_data, int out_duration)
 	t->spl_pos = in_pos;
 }
 
+
+/* Encode one repetition of the tone, so that a frame can be taken from any
+ * position. The first frame is appended, so that frames that wrap around can
+ * be taken also. The silence between repetitions is encoded as silence. */
+static tones_encoded_t *encode_tone(tones_data_t *data, enum tones_tone tone, const void *codec, tones_encode_t encode, void *priv, int spl_count)
+{
+	tones_encoded_t *enc;
+	int16_t *spl, *in_data = data->spl_data[tone];
+	int in_duration = data->spl_duration[tone];
+	int in_repeat = data->spl_repeat[tone];
+	int i, pos, len;
+
+	enc = calloc(1, sizeof(*enc));
+	spl = malloc((in_repeat + spl_count) * sizeof(*spl));
+	if (enc)
+		enc->payload = malloc((in_repeat + spl_count) * 2);
+	if (!enc || !spl || !enc->payload)
+		goto error;
+	for (i = 0, pos = 0; i < in_repeat + spl_count; i++) {
+		spl[i] = (pos < in_duration) ? in_data[pos] : 0;
+		if (++pos == in_repeat)
+			pos = 0;
+	}
+	len = encode(priv, spl, in_repeat + spl_count, enc->payload);
+	/* Only codecs with a fixed size for each sample can be used. */
+	if (len <= 0 || len % (in_repeat + spl_count))
+		goto error;
+	enc->tone = tone;
+	enc->codec = codec;
+	enc->spl_count = spl_count;
+	enc->spl_size = len / (in_repeat + spl_count);
+	enc->next = data->encoded;
+	data->encoded = enc;
+	free(spl);
+
+	return enc;
+
+error:
+	free(spl);
+	if (enc)
+		free(enc->payload);
+	free(enc);
+	return NULL;
+}
+
+/* Return a frame of the current tone, encoded with the given codec.
+ * The tone is encoded once for each codec and shared by all tones_t.
+ * NULL is returned, if there is nothing to play or if the tone cannot be
+ * encoded. */
+uint8_t *tones_read_encoded(tones_t *t, const void *codec, tones_encode_t encode, void *priv, int spl_count, int *payload_len)
+{
+	tones_data_t *data = t->data;
+	tones_encoded_t *enc;
+	int in_repeat, in_pos;
+
+	/* No tone was set or it cannot be encoded. */
+	if (!data || !data->spl_data[t->tone] || !data->spl_duration[t->tone] || data->coding != TONES_TDATA_SLIN16HOST)
+		return NULL;
+	in_repeat = data->spl_repeat[t->tone];
+
+	for (enc = data->encoded; enc; enc = enc->next) {
+		if (enc->tone == t->tone && enc->codec == codec && enc->spl_count >= spl_count)
+			break;
+	}
+	if (!enc) {
+		enc = encode_tone(data, t->tone, codec, encode, priv, spl_count);
+		if (!enc)
+			return NULL;
+	}
+
+	/* Wrap around if repeat count is reached. */
+	in_pos = t->spl_pos;
+	if (in_pos >= in_repeat)
+		in_pos %= in_repeat;
+	t->spl_pos = (in_pos + spl_count) % in_repeat;
+
+	*payload_len = spl_count * enc->spl_size;
+	return enc->payload + in_pos * enc->spl_size;
+}
@@ -27,6 +27,7 @@ enum tones_tdata {
 	TONES_TDATA_ULAW,		/* tone is mu-law coded */
 	TONES_TDATA_ALAWFLIPPED,	/* tone is a-law coded */
 	TONES_TDATA_ULAWFLIPPED,	/* tone is mu-law coded */
+	TONES_TDATA_SLIN16STORE,	/* tone is linear audio, spl_data is the name in sample store */
 };
 
 #define TONES_DURATION_AUTO 0
@@ -46,12 +47,28 @@ typedef struct tones_set {
 	tones_seq_t *seq;
 } tones_set_t;
 
+/* Encode linear samples to payload, return length of payload */
+typedef int (*tones_encode_t)(void *priv, int16_t *spl, int spl_count, uint8_t *payload);
+
+/* Encoded tone, shared by all tones_t that play this tone with the same codec */
+typedef struct tones_encoded {
+	struct tones_encoded *next;
+	enum tones_tone tone;		/* encoded tone */
+	const void *codec;		/* codec that was used to encode */
+	int spl_count;			/* number of samples in one frame */
+	size_t spl_size;		/* size of one encoded sample */
+	uint8_t *payload;		/* one repetition of the tone, followed by one frame */
+} tones_encoded_t;
+
 /* Rendered tones from tone set after init */
 typedef struct tones_data {
-	void *spl_data[256];		/* sample data of all tones */
+	tones_seq_t *seq[256];		/* sequence of all tones in tone set */
+	enum tones_tdata coding;	/* coding of rendered tones */
+	void *spl_data[256];		/* sample data of all tones, rendered when used */
 	int spl_duration[256];		/* duration in sample */
 	int spl_repeat[256];		/* length of sample data in memory */
 	size_t spl_size;		/* size of one encoded sample */
+	tones_encoded_t *encoded;	/* list of encoded tones */
 } tones_data_t;
 
 /* Rendered tones from tone set after init */
@@ -66,4 +83,5 @@ int tones_init(tones_data_t *data, const char *toneset, enum tones_tdata coding)
 void tones_exit(tones_data_t *data);
 void tones_set_tone(tones_data_t *data, tones_t *t, enum tones_tone tone);
 void tones_read_tone(tones_t *t, void *spl, int spl_count);
+uint8_t *tones_read_encoded(tones_t *t, const void *codec, tones_encode_t encode, void *priv, int spl_count, int *payload_len);
 
@@ -1,7 +1,4 @@
-#include <stdint.h>
-#include <stdlib.h>
-#include "tones.h"
-#include "uk_outoforder.h"
+/* sample data, not compiled, samplestore_gen converts it to the sample store */
 
 static uint16_t slin16_outoforder[] = {
 	0x0000, 0x0000, 0xffff, 0x0002, 0xfffe, 0x0003, 0xfffd, 0x0001,
@@ -8188,9 +8185,3 @@ static uint16_t slin16_outoforder[] = {
 	0x00d7, 0x009c, 0x0064, 0xffc9, 0xff64, 0xffc8, 0x0008, 0xff90,
 	0xff69, 0xff9f, 0xffbe, 0xffb2, 0xffe9, 0x0003, 0x0062, 0x0111,
 };
-
-tones_seq_t seq_uk_outoforder[] = {
-        { TONES_TDATA_SLIN16HOST, TONES_DURATION_AUTO, slin16_outoforder, sizeof(slin16_outoforder), -6.0 },
-        { TONES_TDATA_EOL, 0, NULL, 0, 0.0 }
-};
-
@@ -232,9 +232,43 @@ void psk_mod(psk_mod_t *psk, sample_t *sample, int length)
 #endif
 }
 
+/* The demodulator mixes the signal with a carrier from a table (NCO). The
+ * phase of the carrier is a 32 bit integer, so it wraps without branches.
+ *
+ * I and Q are filtered with the same receive low pass, which removes the
+ * mixing product at twice the carrier frequency. The polyphase decimator
+ * calculates only the output samples that are required for the reduced
+ * sample rate of at least DEMOD_RATE. (10 samples per symbol at 48000 Hz.)
+ * All further processing is done at this rate.
+ *
+ * To remove the modulation from the phase error, the phase is multiplied by
+ * 8. This is done by squaring the normalized IQ vector three times, multiple
+ * samples at once using GCC vector extensions. The change of the phase error
+ * is tracked by counting quarter turns of the filtered phase error vector.
+ * The angles of phase error and symbol are calculated at sample points only.
+ * The sector of a symbol is given by the upper three bits of the angle (16
+ * bits per turn) after adding half of a sector.
+ */
+
+#define NCO_TAB_BITS	10
+#define NCO_TAB_SIZE	(1 << NCO_TAB_BITS)
+#define NCO_TAB_SHIFT	(32 - NCO_TAB_BITS)
+#define NCO_TAB_HALF	(1 << (NCO_TAB_SHIFT - 1))
+#define NCO_ANGLE	(2.0 * M_PI / 4294967296.0)
+#define DEMOD_RATE	16000	/* minimum sample rate after decimation */
+#define DEMOD_CHUNK	256	/* number of samples that are processed at once */
+
+typedef sample_t vsample_t __attribute__ ((vector_size (16)));
+#define LANES		((int)(sizeof(vsample_t) / sizeof(sample_t)))
+
+static int nco_init = 0;
+static sample_t nco_cos_tab[NCO_TAB_SIZE], nco_sin_tab[NCO_TAB_SIZE];
+
 int psk_demod_init(psk_demod_t *psk, void *inst, void (*receive_bit)(void *inst, int bit), int samplerate, double symbolrate)
 {
+	fir_filter_t *fir;
 	double cutoff, transitionband;
+	int rate, i;
 
 	if (samplerate < 48000) {
 		LOGP(DDSP, LOGL_NOTICE, "Sampling rate for PSK decoder must be 48000 Hz minimum!\n");
@@ -246,20 +280,40 @@ int psk_demod_init(psk_demod_t *psk, void *inst, void (*receive_bit)(void *inst,
 	psk->receive_bit = receive_bit;
 	psk->inst = inst;
 
+	if (!nco_init) {
+		for (i = 0; i < NCO_TAB_SIZE; i++) {
+			nco_cos_tab[i] = cos(2.0 * M_PI * (double)i / (double)NCO_TAB_SIZE);
+			nco_sin_tab[i] = sin(2.0 * M_PI * (double)i / (double)NCO_TAB_SIZE);
+		}
+		nco_init = 1;
+	}
+
+	psk->factor = samplerate / DEMOD_RATE;
+	rate = samplerate / psk->factor;
+
 	/* fixme: make correct filter */
 //	cutoff = symbolrate / 2.0 * 1.5;
 	cutoff = RX_CARRIER - 100;
 	transitionband = 200;
-	psk->lp[0] = fir_lowpass_init((double)samplerate, cutoff, transitionband);
-	psk->lp[1] = fir_lowpass_init((double)samplerate, cutoff, transitionband);
-	iir_lowpass_init(&psk->lp_error[0], 50.0, samplerate, 2);
-	iir_lowpass_init(&psk->lp_error[1], 50.0, samplerate, 2);
-	iir_bandpass_init(&psk->lp_clock, symbolrate, samplerate, 40);
-	psk->sample_delay = (int)floor((double)samplerate / symbolrate * 0.25); /* percent of sine duration behind zero crossing */
+	fir = fir_lowpass_init((double)samplerate, cutoff, transitionband);
+	if (!fir)
+		return -ENOMEM;
+	psk->lp[0] = fir_decimator_init(fir, psk->factor);
+	psk->lp[1] = fir_decimator_init(fir, psk->factor);
+	fir_exit(fir);
+	if (!psk->lp[0] || !psk->lp[1]) {
+		psk_demod_exit(psk);
+		return -ENOMEM;
+	}
+	iir_lowpass_init(&psk->lp_error[0], 50.0, rate, 2);
+	iir_lowpass_init(&psk->lp_error[1], 50.0, rate, 2);
+	iir_bandpass_init(&psk->lp_clock, symbolrate, rate, 40);
+	psk->sample_delay = (int)floor((double)rate / symbolrate * 0.25); /* percent of sine duration behind zero crossing */
 	LOGP(DDSP, LOGL_DEBUG, "Cut off frequency is at %.1f Hz and %.1f Hz.\n", RX_CARRIER + cutoff, RX_CARRIER - cutoff);
+	LOGP(DDSP, LOGL_DEBUG, "Decimate by %d to %d Hz.\n", psk->factor, rate);
 
-	psk->carrier_phaseshift = 2.0 * M_PI * -RX_CARRIER / (double)samplerate;
-	LOGP(DDSP, LOGL_DEBUG, "Carrier phase shift of %.4f per sample @ %d.\n", psk->carrier_phaseshift, samplerate);
+	psk->carrier_phaseshift = (uint32_t)(int64_t)floor(-RX_CARRIER / (double)samplerate * 4294967296.0 + 0.5);
+	LOGP(DDSP, LOGL_DEBUG, "Carrier phase shift of %.4f per sample @ %d.\n", (double)(int32_t)psk->carrier_phaseshift * NCO_ANGLE, samplerate);
 
 	return 0;
 }
@@ -267,11 +321,11 @@ int psk_demod_init(psk_demod_t *psk, void *inst, void (*receive_bit)(void *inst,
 void psk_demod_exit(psk_demod_t *psk)
 {
 	if (psk->lp[0]) {
-		fir_exit(psk->lp[0]);
+		fir_poly_exit(psk->lp[0]);
 		psk->lp[0] = NULL;
 	}
 	if (psk->lp[1]) {
-		fir_exit(psk->lp[1]);
+		fir_poly_exit(psk->lp[1]);
 		psk->lp[1] = NULL;
 	}
 }
@@ -341,119 +395,179 @@ static void debug_phase(double phase, double amplitude, double error, double amp
 }
 #endif
 
-void psk_demod(psk_demod_t *psk, sample_t *sample, int length)
+/* mix with carrier: the table entry next to the phase is corrected by the
+ * remaining angle, using second order taylor series */
+static uint32_t psk_mix(uint32_t phase, uint32_t phaseshift, const sample_t *sample, int length, sample_t *I, sample_t *Q)
 {
-	sample_t I[length], Q[length], i;
-	sample_t Ip[length], Qp[length];
-	double phases[length];
-	sample_t amplitudes[length], amplitudes2[length];
-	double phaseshift, phase, phase_error, angle_error;
-	uint16_t phase_error_int, offset;
-	int s, ss;
-	uint8_t sector, rotation, bits;
-
-	/* demodulate phase from carrier */
-	phaseshift = psk->carrier_phaseshift;
-	phase = psk->carrier_phase;
-	for (s = 0, ss = 0; s < length; s++) {
+	uint32_t idx;
+	sample_t d, d2, c, s;
+	int i;
+
+	for (i = 0; i < length; i++) {
 		phase += phaseshift;
-		i = sample[ss++];
-		if (phase < 0)
-			phase += 2.0 * M_PI;
-		else if (phase >= 2.0 * M_PI)
-			phase -= 2.0 * M_PI;
-		I[s] = i * cos(phase);
-		Q[s] = i * sin(phase);
+		idx = ((phase + NCO_TAB_HALF) >> NCO_TAB_SHIFT) & (NCO_TAB_SIZE - 1);
+		d = (sample_t)(int32_t)(phase - (idx << NCO_TAB_SHIFT)) * NCO_ANGLE;
+		d2 = 1.0 - d * d * 0.5;
+		c = nco_cos_tab[idx];
+		s = nco_sin_tab[idx];
+		I[i] = sample[i] * (c * d2 - s * d);
+		Q[i] = sample[i] * (s * d2 + c * d);
 	}
-	psk->carrier_phase = phase;
-	fir_process(psk->lp[0], I, length);
-	fir_process(psk->lp[1], Q, length);
 
-	/* get phase error */
-	for (s = 0, ss = 0; s < length; s++) {
-		phases[s] = atan2(Q[s], I[s]);
-		amplitudes[s] = sqrt(Q[s] * Q[s] + I[s] * I[s]) * 2.0;
-		amplitudes2[s] = amplitudes[s];
-		Ip[s] = amplitudes[s] * cos(phases[s] * 8.0) * 2.0;
-		Qp[s] = amplitudes[s] * sin(phases[s] * 8.0) * 2.0;
+	return phase;
+}
+
+/* get amplitude (for symbol clock) and the vector with 8 times the phase (for phase error) */
+static void psk_power8(const sample_t *I, const sample_t *Q, int length, sample_t *amplitude, sample_t *Ip, sample_t *Qp)
+{
+	const sample_t one = 1.0, two = 2.0, tiny = 1e-30;
+	vsample_t i, q, a, r, re, im, t;
+	sample_t root[LANES];
+	int s, l;
+
+	for (s = 0; s + LANES <= length; s += LANES) {
+		memcpy(&i, I + s, sizeof(i));
+		memcpy(&q, Q + s, sizeof(q));
+		r = i * i + q * q;
+		/* there is no vector square root, so it is calculated for each lane and loaded as a vector */
+		for (l = 0; l < LANES; l++)
+			root[l] = sqrt(r[l]);
+		memcpy(&a, root, sizeof(a));
+		/* normalize, so that the power does not overflow, a tiny offset avoids division by zero */
+		r = one / (a + tiny);
+		re = i * r;
+		im = q * r;
+		/* square three times */
+		t = re * re - im * im;
+		im = two * re * im;
+		re = t;
+		t = re * re - im * im;
+		im = two * re * im;
+		re = t;
+		t = re * re - im * im;
+		im = two * re * im;
+		re = t;
+		a *= two;
+		memcpy(amplitude + s, &a, sizeof(a));
+		re *= a * two;
+		im *= a * two;
+		memcpy(Ip + s, &re, sizeof(re));
+		memcpy(Qp + s, &im, sizeof(im));
 	}
-	iir_process(&psk->lp_error[0], Ip, length);
-	iir_process(&psk->lp_error[1], Qp, length);
+	for (; s < length; s++) {
+		sample_t _a, _re, _im, _t;
+
+		_a = sqrt(I[s] * I[s] + Q[s] * Q[s]);
+		_re = I[s] / (_a + 1e-30);
+		_im = Q[s] / (_a + 1e-30);
+		for (l = 0; l < 3; l++) {
+			_t = _re * _re - _im * _im;
+			_im = 2.0 * _re * _im;
+			_re = _t;
+		}
+		amplitude[s] = _a * 2.0;
+		Ip[s] = _re * _a * 4.0;
+		Qp[s] = _im * _a * 4.0;
+	}
+}
+
+/* get quadrant of vector, as the upper two bits of the angle */
+static inline uint8_t psk_quadrant(sample_t i, sample_t q)
+{
+	if (q < 0.0)
+		return (i >= 0.0) ? 3 : 2;
+	return (i > 0.0) ? 0 : 1;
+}
 
-	/* filter amplitude to get symbol clock */
-	/* NOTE: the filter biases the amplitude, so that we have positive and negative peaks.
-	   positive peak is the sample point */
-	iir_process(&psk->lp_clock, amplitudes2, length);
+/* get angle of vector, 65536 is one turn */
+static inline uint16_t psk_angle(sample_t i, sample_t q)
+{
+	return (uint16_t)(int32_t)floor(atan2(q, i) / (2.0 * M_PI) * 65536.0);
+}
 
-	for (s = 0; s < length; s++) {
-		/* calculate change of phase error angle within one sample */
-		phase_error_int = (int)floor(atan2(Qp[s], Ip[s]) / (2.0 * M_PI) * 65536.0);
-		offset = phase_error_int - psk->last_phase_error;
-		psk->last_phase_error = phase_error_int;
-
-		/* apply change to current phase error value */
-		psk->phase_error += (int16_t)offset;
-		if (psk->phase_error >= 65536 * 8)
-			psk->phase_error -= 65536 * 8;
-		if (psk->phase_error < 0)
-			psk->phase_error += 65536 * 8;
-
-		phase_error = (double)psk->phase_error / 65536.0 * (2.0 * M_PI) / 8.0;
-
-		/* if we have reached a zero crossing of the amplitude signal, wait for sample point */
-		if (psk->sample_timer && --psk->sample_timer == 0) {
-			/* sample point reached */
-			phase = fmod(phases[s] - phase_error + 4.0 * M_PI, 2.0 * M_PI);
-			if (phase < 2.0 * M_PI / 16.0 * 1.0)
-				sector = 0;
-			else if (phase < 2.0 * M_PI / 16.0 * 3.0)
-				sector = 1;
-			else if (phase < 2.0 * M_PI / 16.0 * 5.0)
-				sector = 2;
-			else if (phase < 2.0 * M_PI / 16.0 * 7.0)
-				sector = 3;
-			else if (phase < 2.0 * M_PI / 16.0 * 9.0)
-				sector = 4;
-			else if (phase < 2.0 * M_PI / 16.0 * 11.0)
-				sector = 5;
-			else if (phase < 2.0 * M_PI / 16.0 * 13.0)
-				sector = 6;
-			else if (phase < 2.0 * M_PI / 16.0 * 15.0)
-				sector = 7;
-			else
-				sector = 0;
-			angle_error = fmod(phase / 2.0 / M_PI * 8.0, 1.0);
-			if (angle_error > 0.5)
-				angle_error -= 1.0;
-
-			rotation = (sector - psk->last_sector) & 7; // might be negative, so we use AND!
-			bits = phase2bits[rotation];
+void psk_demod(psk_demod_t *psk, sample_t *sample, int length)
+{
+	sample_t I[DEMOD_CHUNK], Q[DEMOD_CHUNK];
+	sample_t Ip[DEMOD_CHUNK], Qp[DEMOD_CHUNK];
+	sample_t amplitudes[DEMOD_CHUNK];
+	uint32_t phase_error;
+	uint16_t angle;
+	int s, num, count;
+	uint8_t quadrant, sector, rotation, bits;
+
+	while (length) {
+		num = (length > DEMOD_CHUNK) ? DEMOD_CHUNK : length;
+
+		/* demodulate phase from carrier and decimate */
+		psk->carrier_phase = psk_mix(psk->carrier_phase, psk->carrier_phaseshift, sample, num, I, Q);
+		count = fir_decimate_dual(psk->lp[0], psk->lp[1], I, Q, num);
+		sample += num;
+		length -= num;
+
+		/* get phase error */
+		psk_power8(I, Q, count, amplitudes, Ip, Qp);
+		iir_process_dual(&psk->lp_error[0], &psk->lp_error[1], Ip, Qp, count);
+
+		/* filter amplitude to get symbol clock */
+		/* NOTE: the filter biases the amplitude, so that we have positive and negative peaks.
+		   positive peak is the sample point */
+		iir_process(&psk->lp_clock, amplitudes, count);
+
+		for (s = 0; s < count; s++) {
+			/* count quarter turns of phase error vector, the vector turns slowly, because it is filtered */
+			quadrant = psk_quadrant(Ip[s], Qp[s]);
+			switch ((quadrant - psk->error_quadrant) & 3) {
+			case 1:
+				psk->error_quarters++;
+				break;
+			case 2:
+				psk->error_quarters += 2;
+				break;
+			case 3:
+				psk->error_quarters--;
+				break;
+			}
+			psk->error_quarters &= 31;
+			psk->error_quadrant = quadrant;
+
+			/* if we have reached a zero crossing of the amplitude signal, wait for sample point */
+			if (psk->sample_timer && --psk->sample_timer == 0) {
+				/* sample point reached: get phase error (8 turns of error vector = one turn of carrier) */
+				angle = psk_angle(Ip[s], Qp[s]);
+				phase_error = psk->error_quarters << 14;
+				phase_error = (phase_error + (int16_t)(angle - (uint16_t)phase_error)) & (65536 * 8 - 1);
+				/* rotate symbol by phase error and get sector, half a sector is added to round */
+				angle = psk_angle(I[s], Q[s]) - (uint16_t)(phase_error >> 3);
+				sector = (uint16_t)(angle + 4096) >> 13;
+
+				rotation = (sector - psk->last_sector) & 7; // might be negative, so we use AND!
+				bits = phase2bits[rotation];
 #ifdef DEBUG_DECODER
-			printf("sector=%d last_sector=%d rotation=%d bits=%d angle_error=%.2f\n", sector, psk->last_sector, rotation, bits, angle_error);
+				printf("sector=%d last_sector=%d rotation=%d bits=%d angle_error=%.2f\n", sector, psk->last_sector, rotation, bits, (double)(int16_t)((angle + 4096) << 3) / 65536.0 - 0.5);
 #endif
-			psk->last_sector = sector;
-			/* report bits */
+				psk->last_sector = sector;
+				/* report bits */
 #ifndef DEBUG_DECODER
-			psk->receive_bit(psk->inst, bits >> 2);
-			psk->receive_bit(psk->inst, (bits >> 1) & 1);
-			psk->receive_bit(psk->inst, bits & 1);
+				psk->receive_bit(psk->inst, bits >> 2);
+				psk->receive_bit(psk->inst, (bits >> 1) & 1);
+				psk->receive_bit(psk->inst, bits & 1);
 #endif
-		}
-		if (psk->last_amplitude <= 0.0 && amplitudes2[s] > 0.0)
-			psk->sample_timer = psk->sample_delay;
-		psk->last_amplitude = amplitudes2[s];
+			}
+			if (psk->last_amplitude <= 0.0 && amplitudes[s] > 0.0)
+				psk->sample_timer = psk->sample_delay;
+			psk->last_amplitude = amplitudes[s];
 
 #ifdef DEBUG_DECODER
-		static int when = 0;
-		if (++when > 10000) {
-			printf("\0337\033[H");
-			/* display amplitude between 0.0 and 1.0, aplitude2 between -0.5 and 0.5 */
-			debug_phase(phases[s], amplitudes[s], phase_error, amplitudes2[s]);
-			printf("phase2 = %.4f offset = %d, error = %d (error & 0xffff = %d)\n", phase_error, offset, psk->phase_error, psk->phase_error & 0xffff);
-			printf("\033[0;39m\0338"); fflush(stdout);
-			usleep(50000);
-		}
+			static int when = 0;
+			if (++when > 10000) {
+				printf("\0337\033[H");
+				/* display amplitude between 0.0 and 1.0, aplitude2 between -0.5 and 0.5 */
+				debug_phase(atan2(Q[s], I[s]), sqrt(I[s] * I[s] + Q[s] * Q[s]) * 2.0, (double)psk->error_quarters * M_PI / 16.0, amplitudes[s]);
+				printf("error quarters = %d\n", psk->error_quarters);
+				printf("\033[0;39m\0338"); fflush(stdout);
+				usleep(50000);
+			}
 #endif
+		}
 	}
 }
-
@@ -22,15 +22,16 @@ typedef struct psk_demod {
 	void		(*receive_bit)(void *inst, int bit);
 	void		*inst;
 
-	double		carrier_phase;		/* current carrier phase */
-	double		carrier_phaseshift;	/* shift of phase per sample */
+	uint32_t	carrier_phase;		/* current carrier phase, 2^32 is one turn */
+	uint32_t	carrier_phaseshift;	/* shift of phase per sample */
 
-	fir_filter_t	*lp[2];			/* filter for limiting spectrum */
+	fir_poly_t	*lp[2];			/* filter for limiting spectrum and decimation */
+	int		factor;			/* decimation factor */
 	iir_filter_t	lp_error[2];		/* filter for phase correction */
 	iir_filter_t	lp_clock;		/* filter for symbol clock */
 
-	uint16_t	last_phase_error;	/* error phase of last sample */
-	int32_t		phase_error;		/* current phase error */
+	uint8_t		error_quadrant;		/* quadrant of phase error vector of last sample */
+	int32_t		error_quarters;		/* quarter turns of phase error vector, modulo 8 turns */
 
 	sample_t	last_amplitude;		/* clock amplitude of last sample */
 	int		sample_delay;		/* delay of quarter symbol length in samples */
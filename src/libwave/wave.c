@@ -28,27 +28,25 @@
 #include "../liblogging/logging.h"
 #include "wave.h"
 
-/* NOTE: No locking required for writing and reading buffer pointers, since 'int' is atomic on >=32 bit machines */
+/* samples are converted in chunks of this size, before they are written to or read from the ring buffer */
+#define CHUNK_BYTES	1024
 
 static void *record_child(void *arg)
 {
 	wave_rec_t *rec = (wave_rec_t *)arg;
-	int to_write, to_end, len;
+	int to_write, len;
+	void *data;
 
-	while (!rec->finish || rec->buffer_writep != rec->buffer_readp) {
-		/* how much data is in buffer */
-		to_write = (rec->buffer_size + rec->buffer_writep - rec->buffer_readp) % rec->buffer_size;
+	while (!rec->finish || ringbuffer_fill(&rec->ring)) {
+		/* how much data is in buffer, only up to the end of buffer */
+		to_write = ringbuffer_read_span(&rec->ring, &data);
 		if (to_write == 0) {
-			usleep(10000);
+			ringbuffer_wait_read(&rec->ring, 1, 10);
 			continue;
 		}
-		/* only write up to the end of buffer */
-		to_end = rec->buffer_size - rec->buffer_readp;
-		if (to_end < to_write)
-			to_write = to_end;
 		/* write */
 		errno = 0;
-		len = fwrite(rec->buffer + rec->buffer_readp, 1, to_write, rec->fp);
+		len = fwrite(data, 1, to_write, rec->fp);
 		/* quit on error */
 		if (len < 0) {
 error:
@@ -57,9 +55,7 @@ error:
 			return NULL;
 		}
 		/* increment read pointer */
-		rec->buffer_readp += len;
-		if (rec->buffer_readp == rec->buffer_size)
-			rec->buffer_readp = 0;
+		ringbuffer_read_commit(&rec->ring, len);
 		/* quit on end of file */
 		if (len != to_write)
 			goto error;
@@ -71,21 +67,18 @@ error:
 static void *playback_child(void *arg)
 {
 	wave_play_t *play = (wave_play_t *)arg;
-	int to_read, to_end, len;
+	int to_read, len;
+	void *data;
 
 	while(!play->finish) {
-		/* how much space is in buffer */
-		to_read = (play->buffer_size + play->buffer_readp - play->buffer_writep - 1) % play->buffer_size;
+		/* how much space is in buffer, only up to the end of buffer */
+		to_read = ringbuffer_write_span(&play->ring, &data);
 		if (to_read == 0) {
-			usleep(10000);
+			ringbuffer_wait_write(&play->ring, 1, 10);
 			continue;
 		}
-		/* only read up to the end of buffer */
-		to_end = play->buffer_size - play->buffer_writep;
-		if (to_end < to_read)
-			to_read = to_end;
 		/* read */
-		len = fread(play->buffer + play->buffer_writep, 1, to_read, play->fp);
+		len = fread(data, 1, to_read, play->fp);
 		/* quit on error */
 		if (len < 0) {
 			LOGP(DWAVE, LOGL_ERROR, "Failed to read from playback WAVE file! (errno %d)\n", errno);
@@ -93,9 +86,7 @@ static void *playback_child(void *arg)
 			return NULL;
 		}
 		/* increment write pointer */
-		play->buffer_writep += len;
-		if (play->buffer_writep == play->buffer_size)
-			play->buffer_writep = 0;
+		ringbuffer_write_commit(&play->ring, len);
 		/* quit on end of file */
 		if (len != to_read) {
 			play->finish = 1;
@@ -136,11 +127,9 @@ int wave_create_record(wave_rec_t *rec, const char *filename, int samplerate, in
 	memset(&dummyheader, 0, sizeof(dummyheader));
 	len = fwrite(dummyheader, 1, sizeof(dummyheader), rec->fp);
 
-	rec->buffer_size = samplerate * 2 * channels;
-	rec->buffer = calloc(rec->buffer_size, 1);
-	if (!rec->buffer) {
+	rc = ringbuffer_init(&rec->ring, samplerate * 2 * channels, 1, RINGBUFFER_WAKEUP);
+	if (rc < 0) {
 		LOGP(DWAVE, LOGL_NOTICE, "No mem!\n");
-		rc = ENOMEM;
 		goto error;
 	}
 
@@ -155,10 +144,7 @@ int wave_create_record(wave_rec_t *rec, const char *filename, int samplerate, in
 	return 0;
 
 error:
-	if (rec->buffer) {
-		free(rec->buffer);
-		rec->buffer = NULL;
-	}
+	ringbuffer_exit(&rec->ring);
 	if (rec->fp) {
 		fclose(rec->fp);
 		rec->fp = NULL;
@@ -298,11 +284,9 @@ int wave_create_playback(wave_play_t *play, const char *filename, int *samplerat
 	play->channels = *channels_p;
 	play->left = chunk / 2 / *channels_p;
 
-	play->buffer_size = *samplerate_p * 2 * *channels_p;
-	play->buffer = calloc(play->buffer_size, 1);
-	if (!play->buffer) {
+	rc = ringbuffer_init(&play->ring, *samplerate_p * 2 * *channels_p, 1, RINGBUFFER_WAKEUP);
+	if (rc < 0) {
 		LOGP(DWAVE, LOGL_ERROR, "No mem!\n");
-		rc = -ENOMEM;
 		goto error;
 	}
 
@@ -317,10 +301,7 @@ int wave_create_playback(wave_play_t *play, const char *filename, int *samplerat
 	return 0;
 
 error:
-	if (play->buffer) {
-		free(play->buffer);
-		play->buffer = NULL;
-	}
+	ringbuffer_exit(&play->ring);
 	if (play->fp) {
 		fclose(play->fp);
 		play->fp = NULL;
@@ -332,8 +313,9 @@ int wave_write(wave_rec_t *rec, sample_t **samples, int length)
 {
 	double max_deviation = rec->max_deviation;
 	int32_t value;
+	uint8_t chunk[CHUNK_BYTES];
 	int __attribute__((__unused__)) len;
-	int i, c;
+	int i, c, b;
 	int to_write;
 
 	/* on error, don't write more */
@@ -341,7 +323,7 @@ int wave_write(wave_rec_t *rec, sample_t **samples, int length)
 		return 0;
 
 	/* how much space is in buffer */
-	to_write = (rec->buffer_size + rec->buffer_readp - rec->buffer_writep - 1) % rec->buffer_size;
+	to_write = ringbuffer_space(&rec->ring);
 	to_write /= 2 * rec->channels;
 	if (to_write < length)
 		LOGP(DWAVE, LOGL_NOTICE, "Record WAVE buffer overflow.\n");
@@ -350,19 +332,23 @@ int wave_write(wave_rec_t *rec, sample_t **samples, int length)
 	if (to_write == 0)
 		return 0;
 
-	for (i = 0; i < to_write; i++) {
+	for (i = 0, b = 0; i < to_write; i++) {
 		for (c = 0; c < rec->channels; c++) {
 			value = samples[c][i] / max_deviation * 32767.0;
 			if (value > 32767)
 				value = 32767;
 			else if (value < -32767)
 				value = -32767;
-			rec->buffer[rec->buffer_writep] = value;
-			rec->buffer_writep = (rec->buffer_writep + 1) % rec->buffer_size;
-			rec->buffer[rec->buffer_writep] = value >> 8;
-			rec->buffer_writep = (rec->buffer_writep + 1) % rec->buffer_size;
+			chunk[b++] = value;
+			chunk[b++] = value >> 8;
+		}
+		if (b > CHUNK_BYTES - 2 * rec->channels) {
+			ringbuffer_write(&rec->ring, chunk, b);
+			b = 0;
 		}
 	}
+	if (b)
+		ringbuffer_write(&rec->ring, chunk, b);
 	rec->written += to_write;
 
 	return to_write;
@@ -372,8 +358,9 @@ int wave_read(wave_play_t *play, sample_t **samples, int length)
 {
 	double max_deviation = play->max_deviation;
 	int16_t value; /* must be int16, so assembling bytes work */
+	uint8_t chunk[CHUNK_BYTES];
 	int __attribute__((__unused__)) len;
-	int i, c;
+	int i, c, b = 0, frames;
 	int to_read;
 	int got = 0;
 
@@ -389,7 +376,7 @@ read_empty:
 	}
 
 	/* how much do we read from buffer */
-	to_read = (play->buffer_size + play->buffer_writep - play->buffer_readp) % play->buffer_size;
+	to_read = ringbuffer_fill(&play->ring);
 	to_read /= 2 * play->channels;
 	if (to_read > (int)play->left)
 		to_read = play->left;
@@ -405,12 +392,15 @@ read_empty:
 	}
 
 	/* read from buffer */
+	frames = CHUNK_BYTES / (2 * play->channels);
 	for (i = 0; i < to_read; i++) {
+		if (i % frames == 0) {
+			ringbuffer_read(&play->ring, chunk, ((to_read - i < frames) ? to_read - i : frames) * 2 * play->channels);
+			b = 0;
+		}
 		for (c = 0; c < play->channels; c++) {
-			value = play->buffer[play->buffer_readp];
-			play->buffer_readp = (play->buffer_readp + 1) % play->buffer_size;
-			value |= play->buffer[play->buffer_readp] << 8;
-			play->buffer_readp = (play->buffer_readp + 1) % play->buffer_size;
+			value = chunk[b++];
+			value |= chunk[b++] << 8;
 			samples[c][i] = (double)value / 32767.0 * max_deviation;
 		}
 	}
@@ -494,8 +484,7 @@ void wave_destroy_record(wave_rec_t *rec)
 	/* data */
 	fprintf(rec->fp, "data%c%c%c%c", size & 0xff, (size >> 8) & 0xff, (size >> 16) & 0xff, size >> 24);
 
-	free(rec->buffer);
-	rec->buffer = NULL;
+	ringbuffer_exit(&rec->ring);
 	fclose(rec->fp);
 	rec->fp = NULL;
 
@@ -511,8 +500,7 @@ void wave_destroy_playback(wave_play_t *play)
 	play->finish = 1;
 	pthread_join(play->tid, NULL);
 
-	free(play->buffer);
-	play->buffer = NULL;
+	ringbuffer_exit(&play->ring);
 	fclose(play->fp);
 	play->fp = NULL;
 }
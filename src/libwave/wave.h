@@ -1,3 +1,4 @@
+#include "../libringbuffer/ringbuffer.h"
 
 typedef struct wave_rec {
 	FILE		*fp;
@@ -8,10 +9,7 @@ typedef struct wave_rec {
 	/* thread stuff */
 	pthread_t	tid;		/* file io thread id */
 	int		finish;		/* indicates end of thread */
-	uint8_t		*buffer;	/* buffer to store sample data */
-	int		buffer_size;	/* size of buffer in bytes */
-	int		buffer_readp;	/* read pointer to next byte in buffer */
-	int		buffer_writep;	/* write pointer to next byte in buffer */
+	ringbuffer_t	ring;		/* buffer to store sample data (bytes) */
 } wave_rec_t;
 
 typedef struct wave_play {
@@ -22,10 +20,7 @@ typedef struct wave_play {
 	/* thread stuff */
 	pthread_t	tid;		/* file io thread id */
 	int		finish;		/* indicates end of thread */
-	uint8_t		*buffer;	/* buffer to store sample data */
-	int		buffer_size;	/* size of buffer in bytes */
-	int		buffer_readp;	/* read pointer to next byte in buffer */
-	int		buffer_writep;	/* write pointer to next byte in buffer */
+	ringbuffer_t	ring;		/* buffer to store sample data (bytes) */
 } wave_play_t;
 
 int wave_create_record(wave_rec_t *rec, const char *filename, int samplerate, int channels, double max_deviation);
@@ -236,7 +236,7 @@ void sender_receive(sender_t *sender, sample_t *samples, int length, double __at
 		/* if repeater mode, store sample in jitter buffer */
 		if (mpt1327->repeater)  {
 			jitter_frame_t *jf;
-			jf = jitter_frame_alloc(NULL, NULL, (uint8_t *)samples, length * sizeof(*samples), 0, mpt1327->repeater_sequence, mpt1327->repeater_timestamp, 123);
+			jf = jitter_frame_alloc(&mpt1327->repeater_dejitter, NULL, NULL, (uint8_t *)samples, length * sizeof(*samples), 0, mpt1327->repeater_sequence, mpt1327->repeater_timestamp, 123);
 			if (jf)
 				jitter_save(&mpt1327->repeater_dejitter, jf);
 			mpt1327->repeater_sequence += 1;
@@ -374,7 +374,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 
 	if (unit->tc->state == STATE_BUSY && unit->tc->dsp_mode == DSP_MODE_TRAFFIC) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&unit->tc->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&unit->tc->sender.dejitter, jf);
 	}
@@ -24,6 +24,7 @@
 #include <errno.h>
 #include <inttypes.h>
 #include "../liblogging/logging.h"
+#include "../libbitbuf/bitbuf.h"
 #include "message.h"
 
 static struct mpt1327_parameter_names {
@@ -245,7 +246,11 @@ static struct mpt1327_defintion {
 	const char *short_name;
 	const char *long_name;
 	uint64_t bits, mask;
-	enum mpt1327_parameters params[64];
+	struct mpt1327_field {
+		enum mpt1327_parameters param;
+		int pos, num;
+	} fields[64];			/* runs of bits that belong to the same parameter */
+	int num_fields;
 } mpt1327_definitions[_NUM_MPT_DEFINITIONS];
 
 static void _CHECK_MAX_BITS(int bits, const char *name)
@@ -261,6 +266,7 @@ void init_codeword(void)
 	uint64_t bits, mask;
 	int num_bits;
 	enum mpt1327_parameters params[64];
+	struct mpt1327_field *field = NULL;
 	char *param_text, *next_param, *param, *param_bits, *param_const;
 	int i, j, p, b;
 
@@ -363,7 +369,16 @@ void init_codeword(void)
 		mpt1327_definitions[i].long_name = definitions[i].long_name;
 		mpt1327_definitions[i].bits = bits;
 		mpt1327_definitions[i].mask = mask;
-		memcpy(mpt1327_definitions[i].params, params, sizeof(params));
+		mpt1327_definitions[i].num_fields = 0;
+		for (b = 0; b < 64; b++) {
+			if (b == 0 || params[b] != params[b - 1]) {
+				field = &mpt1327_definitions[i].fields[mpt1327_definitions[i].num_fields++];
+				field->param = params[b];
+				field->pos = b;
+				field->num = 0;
+			}
+			field->num++;
+		}
 		/* check for duplicate message types */
 		for (j = 0; j < i; j++)
 			if (mpt1327_definitions[j].type == definitions[i].type)
@@ -406,10 +421,11 @@ uint16_t mpt1327_checkbits(uint64_t bits, uint16_t *parityp)
 
 static void debug_codeword(const char *prefix, int i, uint64_t bits, int enc)
 {
-	uint64_t value;
+	const struct mpt1327_field *field;
+	bitbuf_t buf;
 	char text[1024];
 	int column;
-	int b;
+	int f;
 
 	if (loglevel > LOGL_INFO)
 		return;
@@ -438,26 +454,23 @@ static void debug_codeword(const char *prefix, int i, uint64_t bits, int enc)
 	}
 
 	LOGP(DFRAME, LOGL_INFO, "%s Codeword %s: %s\n", prefix, mpt1327_definitions[i].short_name, mpt1327_definitions[i].long_name);
+	bitbuf_clear(&buf);
+	bitbuf_append(&buf, bits, 64);
 	column = 0;
-	for (b = 0; b < 64; b++) {
-		/* if we have first parameter or we swith to next parameter */
-		if (b == 0 || mpt1327_definitions[i].params[b] != mpt1327_definitions[i].params[b - 1]) {
-			value = 0;
-			if (b != 0)
-				text[column++] = ' ';
-			if (mpt1327_definitions[i].params[b]) {
-				strcpy(text + column, mpt1327_parameter_names[mpt1327_definitions[i].params[b]].name);
-				column += strlen(mpt1327_parameter_names[mpt1327_definitions[i].params[b]].name);
-				text[column++] = '=';
-			}
+	for (f = 0; f < mpt1327_definitions[i].num_fields; f++) {
+		field = &mpt1327_definitions[i].fields[f];
+		if (f != 0)
+			text[column++] = ' ';
+		if (field->param) {
+			strcpy(text + column, mpt1327_parameter_names[field->param].name);
+			column += strlen(mpt1327_parameter_names[field->param].name);
+			text[column++] = '=';
 		}
-		value = (value << 1) | ((bits >> (63 - b)) & 1);
-		text[column++] = ((bits >> (63 - b)) & 1) + '0';
+		bitbuf_string(&buf, field->pos, field->num, text + column);
+		column += field->num;
 #if 0
-		if (b == 63 || mpt1327_definitions[i].params[b] != mpt1327_definitions[i].params[b + 1]) {
-			sprintf(text + column, "(%" PRIu64 ")", value);
-			column += strlen(text + column);
-		}
+		sprintf(text + column, "(%" PRIu64 ")", bitbuf_extract(&buf, field->pos, field->num));
+		column += strlen(text + column);
 #endif
 	}
 	text[column] = '\0';
@@ -466,9 +479,11 @@ static void debug_codeword(const char *prefix, int i, uint64_t bits, int enc)
 
 uint64_t mpt1327_encode_codeword(mpt1327_codeword_t *codeword)
 {
+	const struct mpt1327_field *field;
 	uint64_t params[_NUM_MPT_PARAMETERS];
+	bitbuf_t buf;
 	uint64_t bits;
-	int i, b;
+	int i, f;
 
 	/* check all codeword definitions */
 	for (i = 0; i < _NUM_MPT_DEFINITIONS; i++) {
@@ -480,14 +495,15 @@ uint64_t mpt1327_encode_codeword(mpt1327_codeword_t *codeword)
 		abort();
 	}
 
-	/* fill parameters */
+	/* fill parameters, the last field carries the lowest bits of a parameter */
 	memcpy(params, codeword->params, sizeof(params));
-	bits = 0;
-	for (b = 63; b >= 0; b--) {
-		if ((params[mpt1327_definitions[i].params[b]] & 1))
-			bits |= (0x8000000000000000 >> b);
-		params[mpt1327_definitions[i].params[b]] >>= 1;
+	bitbuf_clear(&buf);
+	for (f = mpt1327_definitions[i].num_fields - 1; f >= 0; f--) {
+		field = &mpt1327_definitions[i].fields[f];
+		bitbuf_set(&buf, field->pos, params[field->param], field->num);
+		params[field->param] = (field->num < 64) ? params[field->param] >> field->num : 0;
 	}
+	bits = bitbuf_extract(&buf, 0, 64);
 
 	/* set constants */
 	bits = (bits & ~mpt1327_definitions[i].mask) | mpt1327_definitions[i].bits;
@@ -516,7 +532,10 @@ assumption_wrong:
 
 int mpt1327_decode_codeword(mpt1327_codeword_t *codeword, int specific, enum mpt1327_codeword_dir dir, uint64_t bits)
 {
-	int i, b;
+	const struct mpt1327_field *field;
+	bitbuf_t buf;
+	uint64_t *param;
+	int i, f;
 
 	memset(codeword, 0, sizeof(*codeword));
 	codeword->dir = dir;
@@ -539,24 +558,23 @@ int mpt1327_decode_codeword(mpt1327_codeword_t *codeword, int specific, enum mpt
 				break;
 		}
 	}
+	bitbuf_clear(&buf);
+	bitbuf_append(&buf, bits, 64);
 	if (i == _NUM_MPT_DEFINITIONS) {
-		char debug[256];
+		char debug[65];
 		LOGP(DFRAME, LOGL_NOTICE, "Received unknown codeword or loopback from transmitter side.\n");
-		for (b = 0; b < 64; b++)
-			debug[b] = ((bits >> (63 - b)) & 1) + '0';
-		debug[b] = '\0';
-		LOGP(DFRAME, LOGL_DEBUG, "%s\n", debug);
+		LOGP(DFRAME, LOGL_DEBUG, "%s\n", bitbuf_string(&buf, 0, 64, debug));
 		return -EINVAL;
 	}
 	codeword->type = mpt1327_definitions[i].type;
 	codeword->short_name = mpt1327_definitions[i].short_name;
 	codeword->long_name = mpt1327_definitions[i].long_name;
 
-	/* fill parameters */
-	for (b = 0; b < 64; b++) {
-		codeword->params[mpt1327_definitions[i].params[b]] <<= 1;
-		if ((bits & (0x8000000000000000 >> b)))
-			codeword->params[mpt1327_definitions[i].params[b]] |= 1;
+	/* fill parameters, a parameter may be spread over several fields */
+	for (f = 0; f < mpt1327_definitions[i].num_fields; f++) {
+		field = &mpt1327_definitions[i].fields[f];
+		param = &codeword->params[field->param];
+		*param = ((field->num < 64) ? *param << field->num : 0) | bitbuf_extract(&buf, field->pos, field->num);
 	}
 
 	debug_codeword("Receiving", i, bits, 0);
@@ -144,11 +144,11 @@ int dsp_init_sender(nmt_t *nmt, double deviation_factor)
 	nmt->super_filter_spl = spl;
 
 	/* count supervidory tones */
-	for (i = 0; i < 5; i++) {
-		audio_goertzel_init(&nmt->super_goertzel[i], super_freq[i], nmt->sender.samplerate);
-		if (i < 4)
-			nmt->super_phaseshift65536[i] = 65536.0 / ((double)nmt->sender.samplerate / super_freq[i]);
-	}
+	for (i = 0; i < 4; i++)
+		nmt->super_phaseshift65536[i] = 65536.0 / ((double)nmt->sender.samplerate / super_freq[i]);
+	/* all tones are filtered in one pass */
+	if (goertzel_bank_init(&nmt->super_bank, super_freq, 5, nmt->sender.samplerate, nmt->super_samples) < 0)
+		return -EINVAL;
 	super_reset(nmt);
 
 	/* dial tone */
@@ -179,6 +179,7 @@ void dsp_cleanup_sender(nmt_t *nmt)
 		free(nmt->super_filter_spl);
 		nmt->super_filter_spl = NULL;
 	}
+	goertzel_bank_exit(&nmt->super_bank);
 }
 
 /* Check for SYNC bits, then collect data bits */
@@ -230,6 +231,7 @@ static void fsk_receive_bit(void *inst, int bit, double quality, double level)
 		nmt->rx_sync = 0;
 		nmt->rx_in_sync = 1;
 		nmt->rx_count = 0;
+		bitbuf_clear(&nmt->rx_frame);
 
 		/* set muting of receive path */
 		nmt->rx_mute = (int)((double)nmt->sender.samplerate * MUTE_DURATION);
@@ -237,14 +239,13 @@ static void fsk_receive_bit(void *inst, int bit, double quality, double level)
 	}
 
 	/* read bits */
-	nmt->rx_frame[nmt->rx_count] = bit + '0';
+	bitbuf_append(&nmt->rx_frame, bit, 1);
 	nmt->rx_level[nmt->rx_count] = level;
 	nmt->rx_quality[nmt->rx_count] = quality;
 	if (++nmt->rx_count != 140)
 		return;
 
 	/* end of frame */
-	nmt->rx_frame[140] = '\0';
 	nmt->rx_in_sync = 0;
 
 	/* average level and quality */
@@ -262,16 +263,17 @@ static void fsk_receive_bit(void *inst, int bit, double quality, double level)
 	/* send telegramm */
 	frames_elapsed = (nmt->rx_bits_count_current - nmt->rx_bits_count_last + 83) / 166; /* round to nearest frame */
 	/* convert level so that received level at TX_PEAK_FSK results in 1.0 (100%) */
-	nmt_receive_frame(nmt, nmt->rx_frame, quality, level, frames_elapsed);
+	nmt_receive_frame(nmt, &nmt->rx_frame, quality, level, frames_elapsed);
 }
 
 /* compare supervisory signal against noise floor around 3895 Hz */
-static void super_decode(nmt_t *nmt, sample_t *samples, int length)
+static void super_decode(nmt_t *nmt, sample_t *samples, int __attribute__((unused)) length)
 {
-	double result[2], level, quality;
+	double bank_result[5], result[2], level, quality;
 
-	audio_goertzel(&nmt->super_goertzel[nmt->supervisory - 1], samples, length, 0, &result[0], 1);
-	audio_goertzel(&nmt->super_goertzel[4], samples, length, 0, &result[1], 1); /* noise floor detection */
+	goertzel_bank(&nmt->super_bank, samples, 0, bank_result);
+	result[0] = bank_result[nmt->supervisory - 1];
+	result[1] = bank_result[4]; /* noise floor detection */
 
 	/* normalize supervisory level */
 	level = result[0] / TX_PEAK_SUPER;
@@ -386,24 +388,21 @@ void sender_receive(sender_t *sender, sample_t *samples, int length, double __at
 static int fsk_send_bit(void *inst)
 {
 	nmt_t *nmt = (nmt_t *)inst;
-	const char *frame;
 
 	/* send frame bit (prio) */
 	if (nmt->dsp_mode == DSP_MODE_FRAME) {
-		if (!nmt->tx_frame_length || nmt->tx_frame_pos == nmt->tx_frame_length) {
+		if (nmt->tx_frame_pos == nmt->tx_frame.length) {
 			/* request frame */
-			frame = nmt_get_frame(nmt);
-			if (!frame) {
-				nmt->tx_frame_length = 0;
+			if (nmt_get_frame(nmt, &nmt->tx_frame) < 0) {
+				nmt->tx_frame.length = 0;
+				nmt->tx_frame_pos = 0;
 				LOGP_CHAN(DDSP, LOGL_DEBUG, "Stop sending frames.\n");
 				return -1;
 			}
-			memcpy(nmt->tx_frame, frame, 166);
-			nmt->tx_frame_length = 166;
 			nmt->tx_frame_pos = 0;
 		}
 
-		return nmt->tx_frame[nmt->tx_frame_pos++];
+		return bitbuf_bit(&nmt->tx_frame, nmt->tx_frame_pos++);
 	}
 
 	/* send dms bit */
@@ -524,7 +523,8 @@ void nmt_set_dsp_mode(nmt_t *nmt, enum dsp_mode mode)
 	/* reset frame */
 	if (mode == DSP_MODE_FRAME && nmt->dsp_mode != mode) {
 		fsk_mod_reset(&nmt->fsk_mod);
-		nmt->tx_frame_length = 0;
+		nmt->tx_frame.length = 0;
+		nmt->tx_frame_pos = 0;
 	}
 
 	LOGP_CHAN(DDSP, LOGL_DEBUG, "DSP mode %s -> %s\n", nmt_dsp_mode_name(nmt->dsp_mode), nmt_dsp_mode_name(mode));
@@ -549,7 +549,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 
 	if (nmt->dsp_mode == DSP_MODE_AUDIO || nmt->dsp_mode == DSP_MODE_DTMF) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&nmt->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&nmt->sender.dejitter, jf);
 	}
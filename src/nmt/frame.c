@@ -28,6 +28,8 @@
 #include "nmt.h"
 #include "frame.h"
 
+#define FRAME_SYNC	0x2aaaf12	/* 10101010101010111100010010 (26 bits) */
+
 uint64_t nmt_encode_channel(int nmt_system, int channel, int power)
 {
 	uint64_t value = 0;
@@ -1164,10 +1166,9 @@ static void assemble_frame(int nmt_system, frame_t *frame, uint8_t *digits, int
 /* encode frame to bits
  * debug can be turned on or off
  */
-const char *encode_frame(int nmt_system, frame_t *frame, int debug)
+void encode_frame(int nmt_system, frame_t *frame, bitbuf_t *bits, int debug)
 {
 	uint8_t digits[16], message[9], code[18];
-	static char bits[166];
 	int i;
 
 	assemble_frame(nmt_system, frame, digits, debug);
@@ -1177,23 +1178,20 @@ const char *encode_frame(int nmt_system, frame_t *frame, int debug)
 	for (i = 0; i < 8; i++)
 		message[i] = (digits[i * 2] << 4) | digits[i * 2 + 1];
 	hagelbarger_encode(message, code, 70);
-	memcpy(bits, "10101010101010111100010010", 26);
-	for (i = 0; i < 140; i++)
-		bits[i + 26] = ((code[i / 8] >> (7 - (i & 7))) & 1) + '0';
-
-	return bits;
+	bitbuf_clear(bits);
+	bitbuf_append(bits, FRAME_SYNC, 26);
+	bitbuf_append_bytes(bits, code, 140);
 }
 
 /* decode bits to frame */
-int decode_frame(int nmt_system, frame_t *frame, const char *bits, enum nmt_direction direction, int callack)
+int decode_frame(int nmt_system, frame_t *frame, const bitbuf_t *bits, enum nmt_direction direction, int callack)
 {
 	uint8_t digits[16], message[8], code[19];
 	int i;
 
 	/* hagelbarger code */
 	memset(code, 0x00, sizeof(code));
-	for (i = 0; i < 140; i++)
-		code[i / 8] |= (bits[i] & 1) << (7 - (i & 7));
+	bitbuf_extract_bytes(bits, 0, 140, code);
 	hagelbarger_decode(code, message, 64);
 	for (i = 0; i < 8; i++) {
 		digits[i * 2] = message[i] >> 4;
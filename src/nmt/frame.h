@@ -98,6 +98,6 @@ int nmt_encode_a_number(frame_t *frame, int index, enum number_type type, const
 
 const char *nmt_frame_name(enum nmt_mt mt);
 
-const char *encode_frame(int nmt_system, frame_t *frame, int debug);
-int decode_frame(int nmt_system, frame_t *frame, const char *bits, enum nmt_direction direction, int callack);
+void encode_frame(int nmt_system, frame_t *frame, bitbuf_t *bits, int debug);
+int decode_frame(int nmt_system, frame_t *frame, const bitbuf_t *bits, enum nmt_direction direction, int callack);
 
@@ -1587,7 +1587,7 @@ static void tx_active(nmt_t *nmt, frame_t *frame)
  * general handlers to call sub handling
  */
 
-void nmt_receive_frame(nmt_t *nmt, const char *bits, double quality, double level, int frames_elapsed)
+void nmt_receive_frame(nmt_t *nmt, const bitbuf_t *bits, double quality, double level, int frames_elapsed)
 {
 	frame_t frame;
 	int rc;
@@ -1704,10 +1704,9 @@ static void nmt_timeout(void *data)
 
 /* FSK processing requests next frame after transmission of previous
    frame has been finished. */
-const char *nmt_get_frame(nmt_t *nmt)
+int nmt_get_frame(nmt_t *nmt, bitbuf_t *bits)
 {
 	frame_t frame;
-	const char *bits;
 	int last_frame_idle, debug = 1;
 
 	memset(&frame, 0, sizeof(frame));
@@ -1783,15 +1782,15 @@ const char *nmt_get_frame(nmt_t *nmt)
 
 	/* frame sending aborted (e.g. due to audio) */
 	if (nmt->dsp_mode != DSP_MODE_FRAME)
-		return NULL;
+		return -ENOENT;
 
-	bits = encode_frame(nmt->sysinfo.system, &frame, debug);
+	encode_frame(nmt->sysinfo.system, &frame, bits, debug);
 
 	if (debug)
 		LOGP_CHAN(DNMT, LOGL_DEBUG, "Sending frame %s.\n", nmt_frame_name(frame.mt));
 	if (debug && nmt->tx_last_frame_idle)
 		LOGP_CHAN(DNMT, LOGL_DEBUG, "Subsequent IDLE frames are not shown, to prevent flooding the output.\n");
-	return bits;
+	return 0;
 }
 
 /*
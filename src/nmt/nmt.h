@@ -5,6 +5,7 @@
 #include "../libmobile/call.h"
 #include "../libfsk/fsk.h"
 #include "../libgoertzel/goertzel.h"
+#include "../libbitbuf/bitbuf.h"
 typedef struct nmt nmt_t;
 #include "dms.h"
 #include "sms.h"
@@ -109,7 +110,7 @@ struct nmt {
 	fsk_mod_t		fsk_mod;		/* fsk processing */
 	fsk_demod_t		fsk_demod;
 	int			super_samples;		/* number of samples in buffer for supervisory detection */
-	goertzel_t		super_goertzel[5];	/* filter for supervisory decoding */
+	goertzel_bank_t		super_bank;		/* filter for supervisory decoding */
 	sample_t		*super_filter_spl;	/* array with sample buffer for supervisory detection */
 	int			super_filter_pos;	/* current sample position in filter_spl */
 	double			super_phaseshift65536[4];/* how much the phase of sine wave changes per sample */
@@ -120,7 +121,7 @@ struct nmt {
 	uint16_t		rx_sync;		/* shift register to detect sync */
 	int			rx_in_sync;		/* if we are in sync and receive bits */
 	int			rx_mute;		/* mute count down after sync */
-	char			rx_frame[141];		/* receive frame (one extra byte to terminate string) */
+	bitbuf_t		rx_frame;		/* receive frame */
 	int			rx_count;		/* next bit to receive */
 	double			rx_level[256];		/* level infos */
 	double			rx_quality[256];	/* quality infos */
@@ -129,8 +130,7 @@ struct nmt {
 	uint64_t		rx_bits_count_last;	/* sample counter of last frame */
 	int			super_detected;		/* current detection state flag */
 	int			super_detect_count;	/* current number of consecutive detections/losses */
-	char			tx_frame[166];		/* carries bits of one frame to transmit */
-	int			tx_frame_length;
+	bitbuf_t		tx_frame;		/* carries bits of one frame to transmit */
 	int			tx_frame_pos;
 	int			tx_last_frame_idle;	/* indicator to prevent debugging all idle frames */
 
@@ -149,8 +149,8 @@ int nmt_create(int nmt_system, const char *country, const char *kanal, enum nmt_
 void nmt_check_channels(int nmt_system);
 void nmt_destroy(sender_t *sender);
 void nmt_go_idle(nmt_t *nmt);
-void nmt_receive_frame(nmt_t *nmt, const char *bits, double quality, double level, int frames_elapsed);
-const char *nmt_get_frame(nmt_t *nmt);
+void nmt_receive_frame(nmt_t *nmt, const bitbuf_t *bits, double quality, double level, int frames_elapsed);
+int nmt_get_frame(nmt_t *nmt, bitbuf_t *bits);
 void nmt_rx_super(nmt_t *nmt, int tone, double quality);
 void timeout_mt_paging(struct transaction *trans);
 void deliver_sms(const char *sms);
@@ -24,6 +24,7 @@
 #include <errno.h>
 #include "../libsample/sample.h"
 #include "../liblogging/logging.h"
+#include "../libbitbuf/bitbuf.h"
 #include "pocsag.h"
 #include "frame.h"
 
@@ -248,14 +249,10 @@ static uint32_t encode_numeric(pocsag_msg_t *msg)
 			break;
 	}
 
-	/* compose message */
+	/* compose message, digits are sent LSB first */
 	word = 0x1;
-	for (i = 0; i < 5; i++) {
-		word = (word << 1) | (digit[i] & 0x1);
-		word = (word << 1) | ((digit[i] >> 1) & 0x1);
-		word = (word << 1) | ((digit[i] >> 2) & 0x1);
-		word = (word << 1) | ((digit[i] >> 3) & 0x1);
-	}
+	for (i = 0; i < 5; i++)
+		word = (word << 4) | bitbuf_reverse(digit[i], 4);
 
 	word = (word << 10) | pocsag_crc(word);
 	word = (word << 1) | pocsag_parity(word);
@@ -271,17 +268,15 @@ static void decode_numeric(pocsag_t *pocsag, uint32_t word)
 	for (i = 0; i < 5; i++) {
 		if (pocsag->rx_msg_data_length == sizeof(pocsag->rx_msg_data))
 			return;
-		digit = (word >> (27 - i * 4)) & 0x1;
-		digit = (digit << 1) | ((word >> (28 - i * 4)) & 0x1);
-		digit = (digit << 1) | ((word >> (29 - i * 4)) & 0x1);
-		digit = (digit << 1) | ((word >> (30 - i * 4)) & 0x1);
+		/* digits are sent LSB first */
+		digit = bitbuf_reverse(word >> (27 - i * 4), 4);
 		pocsag->rx_msg_data[pocsag->rx_msg_data_length++] = numeric[digit];
 	}
 }
 
 static uint32_t encode_alpha(pocsag_msg_t *msg)
 {
-	int bits;
+	int bits, num;
 	uint32_t word;
 
 	/* compose message */
@@ -294,16 +289,16 @@ static uint32_t encode_alpha(pocsag_msg_t *msg)
 			msg->data_index++;
 			continue;
 		}
-		while (42) {
-			word = (word << 1) | ((msg->data[msg->data_index] >> msg->bit_index) & 1);
-			bits++;
-			if (++msg->bit_index == 7) {
-				msg->bit_index = 0;
-				msg->data_index++;
-				break;
-			}
-			if (bits == 20)
-				break;
+		/* characters are sent LSB first, take as many bits as fit into the word */
+		num = 7 - msg->bit_index;
+		if (num > 20 - bits)
+			num = 20 - bits;
+		word = (word << num) | bitbuf_reverse(msg->data[msg->data_index] >> msg->bit_index, num);
+		bits += num;
+		msg->bit_index += num;
+		if (msg->bit_index == 7) {
+			msg->bit_index = 0;
+			msg->data_index++;
 		}
 		if (bits == 20)
 			break;
@@ -327,16 +322,23 @@ static uint32_t encode_alpha(pocsag_msg_t *msg)
 
 static void decode_alpha(pocsag_t *pocsag, uint32_t word)
 {
-	int i;
+	uint8_t bits;
+	int i, num;
 
-	for (i = 0; i < 20; i++) {
+	for (i = 0; i < 20; i += num) {
 		if (pocsag->rx_msg_data_length == sizeof(pocsag->rx_msg_data))
 			return;
+		/* characters are sent LSB first, take as many bits as are left in the word */
+		num = 7 - pocsag->rx_msg_bit_index;
+		if (num > 20 - i)
+			num = 20 - i;
+		bits = bitbuf_reverse(word >> (31 - i - num), num);
 		if (!pocsag->rx_msg_bit_index)
 			pocsag->rx_msg_data[pocsag->rx_msg_data_length] = 0x00;
-		pocsag->rx_msg_data[pocsag->rx_msg_data_length] >>= 1;
-		pocsag->rx_msg_data[pocsag->rx_msg_data_length] |= ((word >> (30 - i)) & 0x1) << 6;
-		if (++pocsag->rx_msg_bit_index == 7) {
+		pocsag->rx_msg_data[pocsag->rx_msg_data_length] >>= num;
+		pocsag->rx_msg_data[pocsag->rx_msg_data_length] |= bits << (7 - num);
+		pocsag->rx_msg_bit_index += num;
+		if (pocsag->rx_msg_bit_index == 7) {
 			pocsag->rx_msg_bit_index = 0;
 			pocsag->rx_msg_data_length++;
 		}
@@ -351,10 +353,8 @@ static void decode_hex(pocsag_t *pocsag, uint32_t word)
 	for (i = 0; i < 5; i++) {
 		if (pocsag->rx_msg_data_length == sizeof(pocsag->rx_msg_data))
 			return;
-		digit = (word >> (27 - i * 4)) & 0x1;
-		digit = (digit << 1) | ((word >> (28 - i * 4)) & 0x1);
-		digit = (digit << 1) | ((word >> (29 - i * 4)) & 0x1);
-		digit = (digit << 1) | ((word >> (30 - i * 4)) & 0x1);
+		/* digits are sent LSB first */
+		digit = bitbuf_reverse(word >> (27 - i * 4), 4);
 		pocsag->rx_msg_data[pocsag->rx_msg_data_length++] = hex[digit];
 	}
 }
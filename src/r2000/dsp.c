@@ -183,19 +183,19 @@ static void fsk_receive_bit(void *inst, int bit, double quality, double level)
 		r2000->rx_sync = 0;
 		r2000->rx_in_sync = 1;
 		r2000->rx_count = 0;
+		bitbuf_clear(&r2000->rx_frame);
 
 		return;
 	}
 
 	/* read bits */
-	r2000->rx_frame[r2000->rx_count] = bit + '0';
+	bitbuf_append(&r2000->rx_frame, bit, 1);
 	r2000->rx_level[r2000->rx_count] = level;
 	r2000->rx_quality[r2000->rx_count] = quality;
 	if (++r2000->rx_count != r2000->rx_max)
 		return;
 
 	/* end of frame */
-	r2000->rx_frame[r2000->rx_max] = '\0';
 	r2000->rx_in_sync = 0;
 
 	/* average level and quality */
@@ -211,7 +211,7 @@ static void fsk_receive_bit(void *inst, int bit, double quality, double level)
 	display_measurements_update(r2000->dmp_frame_quality, quality * 100.0, 0.0);
 
 	/* send frame to upper layer */
-	r2000_receive_frame(r2000, r2000->rx_frame, quality, level);
+	r2000_receive_frame(r2000, &r2000->rx_frame, quality, level);
 }
 
 static void super_receive_bit(void *inst, int bit, double quality, double level)
@@ -303,21 +303,18 @@ void sender_receive(sender_t *sender, sample_t *samples, int length, double __at
 static int fsk_send_bit(void *inst)
 {
 	r2000_t *r2000 = (r2000_t *)inst;
-	const char *frame;
 
-	if (!r2000->tx_frame_length || r2000->tx_frame_pos == r2000->tx_frame_length) {
-		frame = r2000_get_frame(r2000);
-		if (!frame) {
-			r2000->tx_frame_length = 0;
+	if (r2000->tx_frame_pos == r2000->tx_frame.length) {
+		if (r2000_get_frame(r2000, &r2000->tx_frame) < 0) {
+			r2000->tx_frame.length = 0;
+			r2000->tx_frame_pos = 0;
 			LOGP_CHAN(DDSP, LOGL_DEBUG, "Stop sending frames.\n");
 			return -1;
 		}
-		memcpy(r2000->tx_frame, frame, 208);
-		r2000->tx_frame_length = 208;
 		r2000->tx_frame_pos = 0;
 	}
 
-	return r2000->tx_frame[r2000->tx_frame_pos++];
+	return bitbuf_bit(&r2000->tx_frame, r2000->tx_frame_pos++);
 }
 
 static int super_send_bit(void *inst)
@@ -408,7 +405,8 @@ void r2000_set_dsp_mode(r2000_t *r2000, enum dsp_mode mode, int super)
 {
 	/* reset telegramm */
 	if (mode == DSP_MODE_FRAME && r2000->dsp_mode != mode) {
-		r2000->tx_frame_length = 0;
+		r2000->tx_frame.length = 0;
+		r2000->tx_frame_pos = 0;
 		fsk_mod_reset(&r2000->fsk_mod);
 	}
 	if ((mode == DSP_MODE_AUDIO_TX || mode == DSP_MODE_AUDIO_TX_RX)
@@ -447,7 +445,7 @@ void call_down_audio(void *decoder, void *decoder_priv, int callref, uint16_t se
 	if (r2000->dsp_mode == DSP_MODE_AUDIO_TX
 	 || r2000->dsp_mode == DSP_MODE_AUDIO_TX_RX) {
 		jitter_frame_t *jf;
-		jf = jitter_frame_alloc(decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
+		jf = jitter_frame_alloc(&r2000->sender.dejitter, decoder, decoder_priv, payload, payload_len, marker, sequence, timestamp, ssrc);
 		if (jf)
 			jitter_save(&r2000->sender.dejitter, jf);
 	}
@@ -25,8 +25,11 @@
 #include <inttypes.h>
 #include "../liblogging/logging.h"
 #include "../libhagelbarger/hagelbarger.h"
+#include "../libbitbuf/bitbuf.h"
 #include "frame.h"
 
+#define FRAME_SYNC	0xaaaaaf12	/* 10101010101010101010111100010010 (32 bits) */
+
 static const char *param_hex(uint64_t value)
 {
 	static char result[32];
@@ -517,39 +520,35 @@ static int assemble_frame(frame_t *frame, uint8_t *message, int num, int debug)
 
 /* encode frame to bits
  */
-const char *encode_frame(frame_t *frame, int debug)
+void encode_frame(frame_t *frame, bitbuf_t *bits, int debug)
 {
 	uint8_t message[11], code[23];
-	static char bits[32 + 176 + 1];
-	int i;
 
 	assemble_frame(frame, message, 80, debug);
 
 	/* hagelbarger code */
 	hagelbarger_encode(message, code, 88);
-	memcpy(bits, "10101010101010101010111100010010", 32);
-	for (i = 0; i < 176; i++)
-		bits[i + 32] = ((code[i / 8] >> (7 - (i & 7))) & 1) + '0';
-	bits[208] = '\0';
-
-	return bits;
+	bitbuf_clear(bits);
+	bitbuf_append(bits, FRAME_SYNC, 32);
+	bitbuf_append_bytes(bits, code, 176);
 }
 
 //#define GEGENPROBE
 
 /* decode bits to frame */
-int decode_frame(frame_t *frame, const char *bits)
+int decode_frame(frame_t *frame, const bitbuf_t *bits)
 {
 	uint8_t message[11], code[23];
-	int i, num = strlen(bits);
-
+	int num = bits->length;
 #ifdef GEGENPROBE
-	printf("bits as received=%s\n", bits);
+	char string[num + 1];
+	int i;
+
+	printf("bits as received=%s\n", bitbuf_string(bits, 0, num, string));
 #endif
 	/* hagelbarger code */
 	memset(code, 0x00, sizeof(code));
-	for (i = 0; i < num; i++)
-		code[i / 8] |= (bits[i] & 1) << (7 - (i & 7));
+	bitbuf_extract_bytes(bits, 0, num, code);
 	hagelbarger_decode(code, message, num / 2 - 6);
 
 #if 0
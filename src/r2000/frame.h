@@ -28,6 +28,6 @@ const char *param_agi(uint64_t value);
 const char *param_aga(uint64_t value);
 const char *param_crins(uint64_t value);
 const char *r2000_frame_name(int message, int dir);
-int decode_frame(frame_t *frame, const char *bits);
-const char *encode_frame(frame_t *frame, int debug);
+int decode_frame(frame_t *frame, const bitbuf_t *bits);
+void encode_frame(frame_t *frame, bitbuf_t *bits, int debug);
 
@@ -1151,10 +1151,9 @@ static void timeout_release_tc(r2000_t *r2000)
 
 /* FSK processing requests next frame after transmission of previous
    frame has been finished. */
-const char *r2000_get_frame(r2000_t *r2000)
+int r2000_get_frame(r2000_t *r2000, bitbuf_t *bits)
 {
 	frame_t frame;
-	const char *bits;
 	int last_frame_idle, debug = 1;
 
 	r2000->tx_frame_count++;
@@ -1220,18 +1219,18 @@ const char *r2000_get_frame(r2000_t *r2000)
 
 	/* frame sending aborted (e.g. due to audio) */
 	if (r2000->dsp_mode != DSP_MODE_FRAME)
-		return NULL;
+		return -ENOENT;
 
-	bits = encode_frame(&frame, debug);
+	encode_frame(&frame, bits, debug);
 
 	if (debug)
 		LOGP_CHAN(DR2000, LOGL_DEBUG, "Sending frame %s.\n", r2000_frame_name(frame.message, REL_TO_SM));
 	if (debug && r2000->tx_last_frame_idle)
 		LOGP_CHAN(DR2000, LOGL_DEBUG, "Subsequent IDLE frames are not shown, to prevent flooding the output.\n");
-	return bits;
+	return 0;
 }
 
-void r2000_receive_frame(r2000_t *r2000, const char *bits, double quality, double level)
+void r2000_receive_frame(r2000_t *r2000, const bitbuf_t *bits, double quality, double level)
 {
 	frame_t frame;
 	int rc;
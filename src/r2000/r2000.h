@@ -3,6 +3,7 @@
 #include "../libmobile/sender.h"
 #include "../libmobile/call.h"
 #include "../libfsk/fsk.h"
+#include "../libbitbuf/bitbuf.h"
 
 enum dsp_mode {
 	DSP_MODE_OFF,		/* no transmission */
@@ -87,15 +88,14 @@ typedef struct r2000 {
 	enum dsp_mode		dsp_mode;		/* current mode: audio, durable tone 0 or 1, paging */
 	fsk_mod_t		fsk_mod;		/* fsk processing */
 	fsk_demod_t		fsk_demod;
-	char			tx_frame[208];		/* carries bits of one frame to transmit */
-	int			tx_frame_length;
+	bitbuf_t		tx_frame;		/* carries bits of one frame to transmit */
 	int			tx_frame_pos;
 	int			tx_last_frame_idle;	/* indicator to prevent debugging all idle frames */
 	uint16_t		rx_sync;		/* shift register to detect sync */
 	int			rx_in_sync;		/* if we are in sync and receive bits */
 	int			rx_mute;		/* mute count down after sync */
 	int			rx_max;			/* maximum bits to receive (including 32 bits sync sequence) */
-	char			rx_frame[177];		/* receive frame (one extra byte to terminate string) */
+	bitbuf_t		rx_frame;		/* receive frame */
 	int			rx_count;		/* next bit to receive */
 	double			rx_level[256];		/* level infos */
 	double			rx_quality[256];	/* quality infos */
@@ -131,7 +131,7 @@ void r2000_go_idle(r2000_t *r2000);
 void r2000_band_list(void);
 double r2000_channel2freq(int band, int channel, int uplink);
 const char *r2000_number_valid(const char *number);
-const char *r2000_get_frame(r2000_t *r2000);
-void r2000_receive_frame(r2000_t *r2000, const char *bits, double quality, double level);
+int r2000_get_frame(r2000_t *r2000, bitbuf_t *bits);
+void r2000_receive_frame(r2000_t *r2000, const bitbuf_t *bits, double quality, double level);
 void r2000_receive_super(r2000_t *r2000, uint8_t super, double quality, double level);
 
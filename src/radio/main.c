@@ -35,6 +35,7 @@ enum paging_signal;
 #include "../libsdr/sdr_config.h"
 #include "../libsdr/sdr.h"
 #include "../liboptions/options.h"
+#include "../libfilter/iir_filter.h"
 #include <osmocom/cc/misc.h>
 #include "radio.h"
 
@@ -323,6 +324,8 @@ int main(int argc, char *argv[])
 	/* global inits */
 	fm_init(fast_math);
 	am_init(fast_math);
+	/* select filter kernels once, before any thread uses them */
+	iir_kernel_select(IIR_KERNEL_AUTO);
 
 	rc = sdr_configure(dsp_samplerate);
 	if (rc < 0)
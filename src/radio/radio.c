@@ -377,6 +377,10 @@ void radio_exit(radio_t *radio)
 		free(radio->carrier_buffer);
 		radio->carrier_buffer = NULL;
 	}
+	exit_samplerate(&radio->tx_resampler[0]);
+	exit_samplerate(&radio->tx_resampler[1]);
+	exit_samplerate(&radio->rx_resampler[0]);
+	exit_samplerate(&radio->rx_resampler[1]);
 	if (radio->tx_audio_mode == AUDIO_MODE_WAVEFILE) {
 		wave_destroy_playback(&radio->wave_tx_play);
 		radio->tx_audio_mode = AUDIO_MODE_NONE;
@@ -504,14 +508,14 @@ int radio_tx(radio_t *radio, float *baseband, int signal_num)
 			else
 				return 0;
 		}
-		jf = jitter_frame_alloc(NULL, NULL, (uint8_t *)audio_samples[0], rc * sizeof(*(audio_samples[0])), 0, radio->tx_sequence[0], radio->tx_timestamp[0], 123);
+		jf = jitter_frame_alloc(&radio->tx_dejitter[0], NULL, NULL, (uint8_t *)audio_samples[0], rc * sizeof(*(audio_samples[0])), 0, radio->tx_sequence[0], radio->tx_timestamp[0], 123);
 		if (jf)
 			jitter_save(&radio->tx_dejitter[0], jf);
 		radio->tx_sequence[0] += 1;
 		radio->tx_timestamp[0] += rc;
 		jitter_load_samples(&radio->tx_dejitter[0], (uint8_t *)audio_samples[0], audio_num, sizeof(*(audio_samples[0])), NULL, NULL);
 		if (radio->tx_audio_channels == 2) {
-			jf = jitter_frame_alloc(NULL, NULL, (uint8_t *)audio_samples[1], rc * sizeof(*(audio_samples[1])), 0, radio->tx_sequence[1], radio->tx_timestamp[1], 123);
+			jf = jitter_frame_alloc(&radio->tx_dejitter[1], NULL, NULL, (uint8_t *)audio_samples[1], rc * sizeof(*(audio_samples[1])), 0, radio->tx_sequence[1], radio->tx_timestamp[1], 123);
 			if (jf)
 				jitter_save(&radio->tx_dejitter[1], jf);
 			radio->tx_sequence[1] += 1;
@@ -653,7 +657,7 @@ int radio_rx(radio_t *radio, float *baseband, int signal_num)
 
 	switch (radio->modulation) {
 	case MODULATION_FM:
-		fm_demodulate_complex(&radio->fm_demod, samples[0], signal_num, baseband, radio->I_buffer, radio->Q_buffer);
+		fm_demodulate_complex_fused(&radio->fm_demod, samples[0], signal_num, baseband, NULL);
 		for (i = 0; i < signal_num; i++)
 			samples[0][i] /= radio->fm_deviation;
 		if (radio->stereo) {
@@ -749,13 +753,13 @@ int radio_rx(radio_t *radio, float *baseband, int signal_num)
 		wave_write(&radio->wave_rx_rec, samples, audio_num);
 #ifdef HAVE_ALSA
 	if ((radio->rx_audio_mode & AUDIO_MODE_AUDIODEV)) {
-		jf = jitter_frame_alloc(NULL, NULL, (uint8_t *)samples[0], audio_num * sizeof(*(samples[0])), 0, radio->rx_sequence[0], radio->rx_timestamp[0], 123);
+		jf = jitter_frame_alloc(&radio->rx_dejitter[0], NULL, NULL, (uint8_t *)samples[0], audio_num * sizeof(*(samples[0])), 0, radio->rx_sequence[0], radio->rx_timestamp[0], 123);
 		if (jf)
 			jitter_save(&radio->rx_dejitter[0], jf);
 		radio->rx_sequence[0] += 1;
 		radio->rx_timestamp[0] += audio_num;
 		if (radio->rx_audio_channels == 2) {
-			jf = jitter_frame_alloc(NULL, NULL, (uint8_t *)samples[1], audio_num * sizeof(*(samples[1])), 0, radio->rx_sequence[1], radio->rx_timestamp[1], 123);
+			jf = jitter_frame_alloc(&radio->rx_dejitter[1], NULL, NULL, (uint8_t *)samples[1], audio_num * sizeof(*(samples[1])), 0, radio->rx_sequence[1], radio->rx_timestamp[1], 123);
 			if (jf)
 				jitter_save(&radio->rx_dejitter[1], jf);
 			radio->rx_sequence[1] += 1;
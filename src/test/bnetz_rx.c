@@ -0,0 +1,50 @@
+/* decode B-Netz telegramms from FM demodulated samples, used by the decoding tests */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "../libsample/sample.h"
+#include "../libfsk/fsk.h"
+#include "bnetz_rx.h"
+
+static void bnetz_receive_bit(void *inst, int bit, double __attribute__((unused)) quality, double level)
+{
+	bnetz_rx_t *rx = (bnetz_rx_t *)inst;
+	int i;
+
+	rx->telegramm = (rx->telegramm << 1) | bit;
+	memmove(rx->level, rx->level + 1, sizeof(rx->level) - sizeof(*rx->level));
+	rx->level[15] = level;
+	rx->bits++;
+
+	/* check if pattern 01110xxxxxxxxxxx matches */
+	if (rx->bits < 16 || (rx->telegramm & 0xf800) != 0x7000)
+		return;
+	for (i = 0; i < 16; i++) {
+		if (rx->level[i] < BNETZ_LEVEL_TH)
+			return;
+	}
+
+	printf("%8.3f s: B-Netz telegramm 0x%04x\n", (double)rx->sample_count / rx->samplerate, rx->telegramm);
+	rx->frames++;
+}
+
+int bnetz_rx_init(bnetz_rx_t *rx, int samplerate)
+{
+	memset(rx, 0, sizeof(*rx));
+	rx->samplerate = samplerate;
+
+	return fsk_demod_init(&rx->fsk, rx, bnetz_receive_bit, samplerate, BNETZ_BIT_RATE, BNETZ_F0, BNETZ_F1, BNETZ_BIT_ADJUST);
+}
+
+void bnetz_rx_exit(bnetz_rx_t *rx)
+{
+	fsk_demod_cleanup(&rx->fsk);
+}
+
+/* telegramms are reported with the time of the first sample of the chunk */
+void bnetz_rx_receive(bnetz_rx_t *rx, sample_t *samples, int length)
+{
+	fsk_demod_receive(&rx->fsk, samples, length);
+	rx->sample_count += length;
+}
@@ -0,0 +1,20 @@
+/* B-Netz telegramms, see bnetz/dsp.c */
+#define BNETZ_BIT_RATE		100.0
+#define BNETZ_BIT_ADJUST	0.5
+#define BNETZ_F0		2070.0
+#define BNETZ_F1		1950.0
+#define BNETZ_LEVEL_TH		0.10
+
+typedef struct bnetz_rx {
+	fsk_demod_t	fsk;
+	int		samplerate;
+	uint32_t	sample_count;
+	uint16_t	telegramm;
+	double		level[16];
+	int		bits;
+	int		frames;
+} bnetz_rx_t;
+
+int bnetz_rx_init(bnetz_rx_t *rx, int samplerate);
+void bnetz_rx_exit(bnetz_rx_t *rx);
+void bnetz_rx_receive(bnetz_rx_t *rx, sample_t *samples, int length);
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../amps/bch.h"
+
+#define WORDS		100000
+#define BENCH_WORDS	1000000
+
+/* bit by bit encoder as it was used before */
+static uint16_t encode_bch_bits(uint64_t data, int length)
+{
+	uint16_t redun = 0;
+	int i, feedback;
+
+	for (i = length - 1; i >= 0; i--) {
+		feedback = ((data >> i) & 1) ^ (redun >> 11);
+		redun = (redun << 1) & 0xfff;
+		if (feedback)
+			redun ^= 0x539;
+	}
+
+	return redun;
+}
+
+static uint64_t random_data(int length)
+{
+	uint64_t data = ((uint64_t)random() << 31) ^ random();
+
+	return data & ((1ULL << length) - 1);
+}
+
+static double get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* measure words per second of bit by bit encoder, table encoder and decoder */
+static void bench_bch(int length)
+{
+	static uint64_t data[BENCH_WORDS], words[BENCH_WORDS];
+	uint64_t word;
+	uint16_t sum = 0;
+	double start, t_bits, t_table, t_decode;
+	int i, errors = 0;
+
+	for (i = 0; i < BENCH_WORDS; i++) {
+		data[i] = random_data(length);
+		if (encode_bch_bits(data[i], length) != bch_encode(data[i], length))
+			errors++;
+		words[i] = (data[i] << BCH_REDUN) | bch_encode(data[i], length);
+	}
+
+	start = get_time();
+	for (i = 0; i < BENCH_WORDS; i++)
+		sum += encode_bch_bits(data[i], length);
+	t_bits = get_time() - start;
+	start = get_time();
+	for (i = 0; i < BENCH_WORDS; i++)
+		sum += bch_encode(data[i], length);
+	t_table = get_time() - start;
+	start = get_time();
+	for (i = 0; i < BENCH_WORDS; i++) {
+		/* flip one bit, so the syndrome must be looked up */
+		word = words[i] ^ (1ULL << (i % length));
+		sum += bch_decode(&word, length);
+	}
+	t_decode = get_time() - start;
+
+	printf("BCH(%d,%d): bit encoder %.2f, table encoder %.2f, decoder %.2f mega words/sec (checksum %d)\n", length + BCH_REDUN, length, BENCH_WORDS / t_bits / 1e6, BENCH_WORDS / t_table / 1e6, BENCH_WORDS / t_decode / 1e6, sum);
+	printf("table encoder %s\n", (errors) ? "differs from bit encoder! FAILED!" : "equals bit encoder");
+}
+
+/* send words through a channel with given bit error rate and count word errors */
+static void ber_curve(int length)
+{
+	static const double ber[] = { 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0 };
+	uint64_t data, word, received;
+	int i, b, n, e;
+	int detect_errors, correct_errors, wrong;
+
+	printf("\nBER curve of BCH(%d,%d), %d words\n", length + BCH_REDUN, length, WORDS);
+	printf("   BER  WER (detect only)  WER (corrected)  wrong words\n");
+	for (i = 0; ber[i]; i++) {
+		detect_errors = correct_errors = wrong = 0;
+		for (n = 0; n < WORDS; n++) {
+			data = random_data(length);
+			word = (data << BCH_REDUN) | bch_encode(data, length);
+			received = word;
+			for (b = 0; b < length + BCH_REDUN; b++) {
+				if (random() < (long)(ber[i] * RAND_MAX))
+					received ^= 1ULL << b;
+			}
+			if (received != word)
+				detect_errors++;
+			e = bch_decode(&received, length);
+			if (e < 0)
+				correct_errors++;
+			else if (received != word)
+				wrong++;
+		}
+		printf("%6.3f  %17.5f  %15.5f  %11.5f\n", ber[i], (double)detect_errors / WORDS, (double)(correct_errors + wrong) / WORDS, (double)wrong / WORDS);
+	}
+}
+
+int main(void)
+{
+	uint64_t data, word, received;
+	int length, i, j, e, errors = 0;
+
+	bch_init();
+	srandom(1);
+
+	/* all single and double bit errors must be corrected */
+	for (length = 28; length <= 36; length += 8) {
+		data = random_data(length);
+		word = (data << BCH_REDUN) | bch_encode(data, length);
+		for (i = 0; i < length + BCH_REDUN; i++) {
+			for (j = i; j < length + BCH_REDUN; j++) {
+				received = word ^ (1ULL << i);
+				if (j != i)
+					received ^= 1ULL << j;
+				e = bch_decode(&received, length);
+				if (e != 1 + (j != i) || received != word)
+					errors++;
+			}
+		}
+	}
+	printf("single and double bit errors %s\n", (errors) ? "are not corrected! FAILED!" : "are corrected");
+
+	ber_curve(28);
+	ber_curve(36);
+
+	printf("\n");
+	bench_bch(28);
+	bench_bch(36);
+
+	return 0;
+}
+
@@ -0,0 +1,343 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libbitbuf/bitbuf.h"
+#include "../amps/amps.h"
+#include "../amps/main.h"
+#include "../amps/frame.h"
+#include "../amps/bch.h"
+#include "../libmobile/get_time.h"
+
+/* Encode FOCC frames with overhead train, control messages and fillers and
+ * FVC frames with orders and caller ID. Each FOCC word must have a valid
+ * BCH code. RECC frames of paging replies and originations are assembled and
+ * decoded, the decoder must report the message that was assembled. The
+ * output is compared with test_amps_frame.ref, which was recorded with the
+ * bit by bit frame coder that was used before.
+ */
+
+const int tacs = 0;
+
+static transaction_t *focc_trans, *fvc_trans;
+static char received_text[256];
+static int received;
+
+double get_time(void)
+{
+	return 0.0;
+}
+
+double amps_channel2freq(int __attribute__((unused)) channel, int __attribute__((unused)) uplink)
+{
+	return 0.0;
+}
+
+const char *amps_min22number(uint16_t __attribute__((unused)) min2)
+{
+	return "";
+}
+
+const char *amps_min12number(uint32_t __attribute__((unused)) min1)
+{
+	return "";
+}
+
+const char *amps_scm(uint8_t __attribute__((unused)) scm)
+{
+	return "";
+}
+
+/* overhead train with fixed registration ID, so the output does not depend on time */
+void prepare_sysinfo(amps_si *si)
+{
+	si->num = 3;
+	si->count = 0;
+}
+
+uint64_t get_sysinfo(amps_si *si, int debug)
+{
+	int count, end = 0;
+
+	count = si->count;
+	if (++si->count == si->num) {
+		end = 1;
+		si->num = 0;
+	}
+
+	switch (count) {
+	case 0:
+		return amps_encode_word1_system(si->dcc, si->word1.sid1, si->word1.ep, si->word1.auth, si->word1.pci, 2, debug);
+	case 1:
+		return amps_encode_word2_system(si->dcc, si->word2.s, si->word2.e, si->word2.regh, si->word2.regr, si->word2.dtx, si->word2.n_1, si->word2.rcf, si->word2.cpa, si->word2.cmax_1, end, debug);
+	default:
+		return amps_encode_registration_id(si->dcc, 1000, end, debug);
+	}
+}
+
+transaction_t *amps_tx_frame_focc(amps_t __attribute__((unused)) *amps)
+{
+	transaction_t *trans = focc_trans;
+
+	focc_trans = NULL;
+	return trans;
+}
+
+transaction_t *amps_tx_frame_fvc(amps_t __attribute__((unused)) *amps)
+{
+	transaction_t *trans = fvc_trans;
+
+	fvc_trans = NULL;
+	return trans;
+}
+
+void amps_rx_recc(amps_t __attribute__((unused)) *amps, uint8_t scm, uint8_t mpci, uint32_t esn, uint32_t min1, uint16_t min2, uint8_t msg_type, uint8_t ordq, uint8_t order, const char *dialing)
+{
+	snprintf(received_text, sizeof(received_text), "received SCM=%d MPCI=%d ESN=0x%08x MIN1=0x%06x MIN2=0x%03x TYPE=%d ORDQ=%d ORDER=%d DIALING=%s\n", scm, mpci, esn, min1, min2, msg_type, ordq, order, (dialing) ? dialing : "none");
+	received++;
+}
+
+static void print_frame(const char *name, int num, const bitbuf_t *bits, const bitbuf_t *busy_idle)
+{
+	int i;
+
+	printf("%s %2d: ", name, num);
+	for (i = 0; i < bits->length; i++)
+		putchar((bitbuf_bit(busy_idle, i)) ? 'i' : bitbuf_bit(bits, i) + '0');
+	printf("\n");
+}
+
+/* all FOCC words must have a valid BCH code */
+static int check_focc(const bitbuf_t *bits)
+{
+	uint64_t word;
+	int i, j;
+
+	for (i = 0; i < 10; i++) {
+		word = 0;
+		for (j = 0; j < 4; j++)
+			word = (word << 10) | bitbuf_extract(bits, 23 + i * 44 + j * 11, 10);
+		if (bch_decode(&word, 28) != 0) {
+			printf("FOCC word %d has invalid BCH code!\n", i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int test_focc(amps_t *amps)
+{
+	transaction_t page, assign;
+	bitbuf_t bits, busy_idle, data;
+	int i, failed = 0;
+
+	memset(&page, 0, sizeof(page));
+	page.min1 = 0x123456;
+	page.min2 = 0x2ab;
+	memset(&assign, 0, sizeof(assign));
+	assign.min1 = 0x654321;
+	assign.min2 = 0x155;
+	assign.chan = 334;
+
+	amps->dsp_mode = DSP_MODE_FRAME_RX_FRAME_TX;
+	for (i = 0; i < 40; i++) {
+		if (i == 5)
+			focc_trans = &page;
+		if (i == 20)
+			focc_trans = &assign;
+		if (amps_encode_frame_focc(amps, &bits, &busy_idle)) {
+			printf("FOCC %2d: no frame\n", i);
+			continue;
+		}
+		print_frame("FOCC", i, &bits, &busy_idle);
+		failed |= check_focc(&bits);
+		/* decoder gets the bits after sync */
+		bitbuf_clear(&data);
+		bitbuf_append_buf(&data, &bits, 22, bits.length - 22);
+		amps_decode_frame(amps, &data, 1.0, 1.0, 0);
+	}
+
+	/* FOCC frame received by RECC decoder is ignored */
+	received = 0;
+	bitbuf_clear(&data);
+	bitbuf_append_buf(&data, &bits, 22, 247);
+	if (amps_decode_frame(amps, &data, 1.0, 1.0, 0) || received) {
+		printf("FOCC frame is not ignored by RECC decoder!\n");
+		failed = 1;
+	}
+
+	return failed;
+}
+
+static void test_fvc(amps_t *amps, transaction_t *trans)
+{
+	bitbuf_t bits, busy_idle;
+	int i;
+
+	printf("FVC order %d, channel %d, caller ID \"%s\"\n", trans->order, trans->chan, trans->caller_id);
+	amps->dsp_mode = DSP_MODE_AUDIO_RX_FRAME_TX;
+	fvc_trans = trans;
+	for (i = 0; i < 20; i++) {
+		if (amps_encode_frame_fvc(amps, &bits, &busy_idle))
+			break;
+		print_frame("FVC", i, &bits, &busy_idle);
+	}
+}
+
+/* RECC words consist of 36 data bits and 12 bits BCH code */
+static void append_recc_word(bitbuf_t *bits, uint64_t data, int error)
+{
+	uint64_t word;
+	int i;
+
+	word = (data << 12) | bch_encode(data, 36);
+	/* five repetitions, the first one may have a bit error */
+	for (i = 0; i < 5; i++) {
+		if (i == 0 && error)
+			bitbuf_append(bits, word ^ (1ULL << 20), 48);
+		else
+			bitbuf_append(bits, word, 48);
+	}
+}
+
+static uint64_t word_a(int nawc, int t, int scm, uint32_t min1)
+{
+	return (1ULL << 35) | ((uint64_t)nawc << 32) | ((uint64_t)t << 31) | (1ULL << 30) | (1ULL << 29) | ((uint64_t)(scm & 15) << 24) | min1;
+}
+
+static uint64_t word_b(int nawc, int msg_type, int ordq, int order, int scm, int mpci, uint16_t min2)
+{
+	return ((uint64_t)nawc << 32) | ((uint64_t)msg_type << 27) | ((uint64_t)ordq << 24) | ((uint64_t)order << 19) | ((uint64_t)(scm >> 4) << 16) | ((uint64_t)mpci << 14) | min2;
+}
+
+static uint64_t word_c(int nawc, uint32_t esn)
+{
+	return ((uint64_t)nawc << 32) | esn;
+}
+
+static uint64_t word_d(int nawc, const char *digits)
+{
+	uint64_t word = (uint64_t)nawc << 32;
+	int i, digit;
+
+	for (i = 0; i < 8; i++) {
+		if (digits[i] == '0')
+			digit = 10;
+		else if (digits[i] == '*')
+			digit = 11;
+		else if (digits[i] == '#')
+			digit = 12;
+		else if (digits[i] >= '1' && digits[i] <= '9')
+			digit = digits[i] - '0';
+		else
+			digit = 0;
+		word |= (uint64_t)digit << (28 - i * 4);
+	}
+
+	return word;
+}
+
+static int test_recc(amps_t *amps, const char *name, uint8_t dcc_code, const uint64_t *words, int num, int error, int expect)
+{
+	bitbuf_t bits;
+	int i, more;
+
+	printf("RECC %s\n", name);
+	received = 0;
+	received_text[0] = '\0';
+	for (i = 0; i < num; i++) {
+		bitbuf_clear(&bits);
+		if (i == 0)
+			bitbuf_append(&bits, dcc_code, 7);
+		append_recc_word(&bits, words[i], error);
+		more = amps_decode_frame(amps, &bits, 1.0, 1.0, 0);
+		printf("word %d: more=%d\n", i, more);
+		if (!more)
+			break;
+	}
+	printf("%s", received_text);
+	if (received != expect) {
+		printf("Received %d messages, expecting %d!\n", received, expect);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	amps_t *amps;
+	transaction_t alert, handoff, release;
+	uint64_t words[8];
+	int failed = 0;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	init_frame();
+
+	amps = calloc(1, sizeof(*amps));
+	amps->sender.kanal = "test";
+	amps->sat = 1;
+	amps->si.overhead_repeat = 17;
+	amps->si.dcc = 1;
+	amps->si.vmac = 0;
+	amps->si.filler.cmac = 0;
+	amps->si.filler.wfom = 1;
+	amps->si.word1.sid1 = 1234;
+	amps->si.word2.s = 1;
+	amps->si.word2.e = 1;
+	amps->si.word2.regh = 1;
+	amps->si.word2.regr = 1;
+	amps->si.word2.n_1 = 20;
+	amps->si.word2.rcf = 1;
+	amps->si.word2.cpa = 1;
+	amps->si.word2.cmax_1 = 20;
+
+	failed |= test_focc(amps);
+
+	memset(&alert, 0, sizeof(alert));
+	alert.order = 17;
+	strcpy(alert.caller_id, "4912345678");
+	test_fvc(amps, &alert);
+	memset(&handoff, 0, sizeof(handoff));
+	handoff.chan = 400;
+	test_fvc(amps, &handoff);
+	memset(&release, 0, sizeof(release));
+	release.order = 3;
+	test_fvc(amps, &release);
+
+	/* paging reply: word A, B and serial number */
+	words[0] = word_a(2, 0, 0xb, 0x123456);
+	words[1] = word_b(1, 0, 0, 0, 0x1b, 1, 0x2ab);
+	words[2] = word_c(0, 0xdeadbeef);
+	failed |= test_recc(amps, "paging reply", 0x1f, words, 3, 0, 1);
+	failed |= test_recc(amps, "paging reply with bit errors", 0x1f, words, 3, 1, 1);
+	failed |= test_recc(amps, "paging reply with wrong DCC", 0x63, words, 3, 0, 0);
+
+	/* origination: word A, B, serial number and two words of digits */
+	words[0] = word_a(4, 1, 0xe, 0x654321);
+	words[1] = word_b(3, 0, 0, 0, 0x0e, 0, 0x155);
+	words[2] = word_c(2, 0x12345678);
+	words[3] = word_d(1, "01234567");
+	words[4] = word_d(0, "89*#");
+	failed |= test_recc(amps, "origination", 0x1f, words, 5, 0, 1);
+
+	/* registration without serial number */
+	amps->si.word2.s = 0;
+	words[0] = word_a(1, 0, 0x3, 0x000001);
+	words[1] = word_b(0, 0, 0, 0, 0x03, 0, 0x3ff);
+	failed |= test_recc(amps, "registration without ESN", 0x1f, words, 2, 0, 1);
+
+	free(amps);
+
+	if (failed) {
+		printf("Frames are not encoded or decoded correctly!\n");
+		return 1;
+	}
+	printf("All frames are encoded and decoded correctly.\n");
+
+	return 0;
+}
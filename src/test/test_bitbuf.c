@@ -0,0 +1,42 @@
+#include "stdio.h"
+#include "stdint.h"
+#include "string.h"
+#include "../libbitbuf/bitbuf.h"
+
+int main(void)
+{
+	bitbuf_t buf, out;
+	uint8_t bytes[5] = { 0x4a, 0x6f, 0x6c, 0x6c, 0x79 };
+	char string[BITBUF_MAX + 1];
+
+	/* append fields, across word boundary */
+	bitbuf_clear(&buf);
+	bitbuf_append(&buf, 0x2aaaf12, 26);
+	bitbuf_append(&buf, 0x123456789abcdef0, 64);
+	bitbuf_append_bytes(&buf, bytes, 36);
+	printf("Bits: %s\n", bitbuf_string(&buf, 0, buf.length, string));
+	printf("Extracted across word boundary: 0x%016llx (must be 0x123456789abcdef0)\n", (unsigned long long)bitbuf_extract(&buf, 26, 64));
+	printf("Sync matches %d of 26 bits (must be 26)\n", bitbuf_correlate(&buf, 0, 0x2aaaf12, 26));
+
+	/* overwrite field */
+	bitbuf_set(&buf, 60, 0, 8);
+	printf("Extracted after overwrite: 0x%016llx (must be 0x12345678803cdef0)\n", (unsigned long long)bitbuf_extract(&buf, 26, 64));
+
+	/* interleave 3 rows of 4 bits, then deinterleave */
+	bitbuf_clear(&buf);
+	bitbuf_append(&buf, 0xa5c, 12);
+	bitbuf_clear(&out);
+	bitbuf_interleave(&out, &buf, 0, 3, 4);
+	printf("Interleaved: %s (must be 101011100010)\n", bitbuf_string(&out, 0, out.length, string));
+	bitbuf_clear(&buf);
+	bitbuf_interleave(&buf, &out, 0, 4, 3);
+	printf("Deinterleaved: %s (must be 101001011100)\n", bitbuf_string(&buf, 0, buf.length, string));
+
+	/* invert */
+	bitbuf_invert(&buf);
+	printf("Inverted: %s (must be 010110100011)\n", bitbuf_string(&buf, 0, buf.length, string));
+
+	printf("Reversed: 0x%llx (must be 0x3a)\n", (unsigned long long)bitbuf_reverse(0x2e, 7));
+
+	return 0;
+}
@@ -0,0 +1,326 @@
+/* test of the polyphase channelizer, the combiner and the half-band decimator
+ *
+ * FM modulated tones of several channels are split by the channelizer and
+ * demodulated at channel rate. The demodulated tones must have the same
+ * amplitude and offset as those of the per-channel path, which mixes each
+ * channel to 0 Hz and demodulates it at the full rate.
+ *
+ * Tones of several channels are combined and compared with a reference that
+ * interpolates each channel by the prototype filter and shifts it to the
+ * center of its bin directly. The output is taken in blocks of different
+ * sizes, starting with the first sample after init.
+ *
+ * A tone inside a channel is decimated together with interferers that alias
+ * into the pass band. The amplitude of the tone must stay the same and the
+ * interferers must be rejected. The input is given in blocks of different
+ * sizes.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../libsample/sample.h"
+#include "../libfm/fm.h"
+#include "../libchannelizer/channelizer.h"
+
+#define SAMPLERATE	1000000.0
+#define BANDWIDTH	16000.0
+#define CHANNELS	3
+#define OUTPUT_NUM	4000
+#define MAX_BLOCK	700
+
+static const double offsets[CHANNELS] = { -248000.0, 12500.0, 397000.0 };
+static const double tones[CHANNELS] = { 2000.0, -3000.0, 5000.0 };
+
+#define CHAN_DEVIATION	3000.0		/* deviation of the modulating tones */
+#define CHAN_INPUT_NUM	100000		/* 100 ms of input samples */
+#define CHAN_SKIP	0.01		/* seconds until filters have settled */
+#define CHAN_DURATION	0.08		/* seconds to measure, all tones have integer periods */
+
+/* modulating tones of each channel */
+static const double fm_tones[CHANNELS] = { 1000.0, 1250.0, 2000.0 };
+
+#define DEC_OFFSET	123456.0	/* channel offset from center */
+#define DEC_TONE	3000.0		/* tone inside channel */
+#define DEC_SKIP	100		/* output samples until filters have settled */
+#define DEC_NUM		6250		/* output samples to measure, all tones have integer periods */
+#define DEC_MAX_BLOCK	4096
+#define DEC_INPUT_NUM	((DEC_SKIP + DEC_NUM) * 32)
+
+/* interferers alias to -5000 Hz and -2000 Hz at 62500 Hz and at 31250 Hz */
+static const double interferers[2] = { 57500.0, 248000.0 };
+
+static float baseband[OUTPUT_NUM * 2];
+static float narrowband[CHANNELS][(MAX_BLOCK + 1) * 2];
+static float wideband[DEC_INPUT_NUM * 2];
+static float decimated[(DEC_INPUT_NUM / 16 + 1) * 2];
+static float chan_wideband[CHAN_INPUT_NUM * 2];
+static float chan_narrowband[CHANNELS][(CHAN_INPUT_NUM / 2 + 1) * 2];
+static sample_t demodulated[CHAN_INPUT_NUM];
+
+/* amplitude of a tone and offset of demodulated frequency */
+static void tone_amplitude(const sample_t *x, int num, double rate, double f, double *ampl, double *offset)
+{
+	double re = 0.0, im = 0.0, sum = 0.0, a;
+	int s;
+
+	for (s = 0; s < num; s++) {
+		a = 2.0 * M_PI * f / rate * s;
+		re += x[s] * cos(a);
+		im += x[s] * sin(a);
+		sum += x[s];
+	}
+
+	*ampl = hypot(re, im) * 2.0 / num;
+	*offset = sum / num;
+}
+
+/* demodulate channels by channelizer and by mixing each channel at full rate */
+static int test_channelizer(void)
+{
+	static const int blocks[] = { 1, 7, 100, 333, 4096, 64, 8, 0 };
+	channelizer_t chan;
+	fm_demod_t demod;
+	float *output[CHANNELS];
+	int bin[CHANNELS];
+	double phase[CHANNELS] = { 0.0 }, rate, residual;
+	double mix_ampl, mix_offset, chan_ampl, chan_offset;
+	int c, s, b, length, num = 0, pos, failed = 0;
+
+	/* FM modulated tones with amplitude 1 / CHANNELS */
+	for (s = 0; s < CHAN_INPUT_NUM; s++) {
+		chan_wideband[s * 2] = chan_wideband[s * 2 + 1] = 0.0;
+		for (c = 0; c < CHANNELS; c++) {
+			phase[c] += 2.0 * M_PI * (offsets[c] + CHAN_DEVIATION * sin(2.0 * M_PI * fm_tones[c] / SAMPLERATE * s)) / SAMPLERATE;
+			chan_wideband[s * 2] += cos(phase[c]) / CHANNELS;
+			chan_wideband[s * 2 + 1] += sin(phase[c]) / CHANNELS;
+		}
+	}
+
+	if (channelizer_init(&chan, SAMPLERATE, BANDWIDTH)) {
+		printf("Failed to init channelizer\n");
+		return -1;
+	}
+	rate = channelizer_samplerate(&chan);
+	for (c = 0; c < CHANNELS; c++) {
+		bin[c] = channelizer_bin(&chan, offsets[c], &residual);
+		output[c] = chan_narrowband[c];
+	}
+	printf("Channelizer: %d bins, %d taps, decimation %d\n", chan.bins, chan.ntaps, chan.decimation);
+
+	/* input is given in blocks of different sizes */
+	for (b = 0, pos = 0; pos < CHAN_INPUT_NUM; b++, pos += length) {
+		length = blocks[b % 7];
+		if (length > CHAN_INPUT_NUM - pos)
+			length = CHAN_INPUT_NUM - pos;
+		for (c = 0; c < CHANNELS; c++)
+			output[c] = chan_narrowband[c] + num * 2;
+		num += channelizer_process(&chan, chan_wideband + pos * 2, length, bin, output, CHANNELS);
+	}
+	if (num != CHAN_INPUT_NUM / chan.decimation) {
+		printf("Channelizer returns %d samples in total, expecting %d FAILED!\n", num, CHAN_INPUT_NUM / chan.decimation);
+		failed = 1;
+	}
+
+	for (c = 0; c < CHANNELS; c++) {
+		/* per-channel path: mix channel to 0 Hz and demodulate at full rate */
+		fm_demod_init(&demod, SAMPLERATE, offsets[c], BANDWIDTH);
+		fm_demodulate_complex_fused(&demod, demodulated, CHAN_INPUT_NUM, chan_wideband, NULL);
+		fm_demod_exit(&demod);
+		tone_amplitude(demodulated + (int)(CHAN_SKIP * SAMPLERATE), (int)(CHAN_DURATION * SAMPLERATE), SAMPLERATE, fm_tones[c], &mix_ampl, &mix_offset);
+
+		/* channelizer path: demodulate output of bin at channel rate, shifted by the remaining offset */
+		channelizer_bin(&chan, offsets[c], &residual);
+		fm_demod_init(&demod, rate, residual, BANDWIDTH);
+		fm_demodulate_complex_fused(&demod, demodulated, num, chan_narrowband[c], NULL);
+		fm_demod_exit(&demod);
+		tone_amplitude(demodulated + (int)(CHAN_SKIP * rate), (int)(CHAN_DURATION * rate), rate, fm_tones[c], &chan_ampl, &chan_offset);
+
+		printf("Channel %d at %+.0f Hz: tone %.1f Hz (mixing), %.1f Hz (channelizer), offset %+.1f Hz (mixing), %+.1f Hz (channelizer)", c, offsets[c], mix_ampl, chan_ampl, mix_offset, chan_offset);
+		if (fabs(chan_ampl - mix_ampl) > CHAN_DEVIATION * 0.01 || fabs(chan_offset - mix_offset) > CHAN_DEVIATION * 0.01) {
+			printf(" FAILED!\n");
+			failed = 1;
+		} else
+			printf(" ok\n");
+	}
+	channelizer_exit(&chan);
+
+	return (failed) ? -1 : 0;
+}
+
+static int test_combiner(void)
+{
+	static const int blocks[] = { 1, 7, 100, 333, 700, 64, 8, 0 };
+	combiner_t comb;
+	float *input[CHANNELS];
+	int bin[CHANNELS], phase[CHANNELS] = { 0 };
+	double residual, rate, error, max_error = 0.0, x, y, a;
+	int c, b, s, t, n, l, num, length, pos = 0;
+
+	if (combiner_init(&comb, SAMPLERATE, BANDWIDTH, MAX_BLOCK)) {
+		printf("Failed to init combiner\n");
+		return -1;
+	}
+	rate = combiner_samplerate(&comb);
+	for (c = 0; c < CHANNELS; c++) {
+		bin[c] = combiner_bin(&comb, offsets[c], &residual);
+		input[c] = narrowband[c];
+	}
+	printf("Combiner: %d bins, %d taps, interpolation %d\n", comb.bins, comb.ntaps, comb.interpolation);
+
+	/* combine tones with amplitude 1 / CHANNELS */
+	for (b = 0; pos < OUTPUT_NUM; b++) {
+		length = blocks[b % 7];
+		if (length > OUTPUT_NUM - pos)
+			length = OUTPUT_NUM - pos;
+		num = combiner_input_num(&comb, length);
+		for (c = 0; c < CHANNELS; c++) {
+			for (s = 0; s < num; s++, phase[c]++) {
+				narrowband[c][s * 2] = cos(2.0 * M_PI * tones[c] / rate * phase[c]) / CHANNELS;
+				narrowband[c][s * 2 + 1] = sin(2.0 * M_PI * tones[c] / rate * phase[c]) / CHANNELS;
+			}
+		}
+		combiner_process(&comb, input, bin, CHANNELS, num, baseband + pos * 2, length);
+		pos += length;
+	}
+
+	/* reference: interpolate each input sample n by prototype filter, starting at output sample n * interpolation */
+	for (t = 0; t < OUTPUT_NUM; t++) {
+		x = y = 0.0;
+		for (c = 0; c < CHANNELS; c++) {
+			for (n = t / comb.interpolation; n >= 0; n--) {
+				l = t - n * comb.interpolation;
+				if (l >= comb.ntaps)
+					break;
+				a = 2.0 * M_PI * (tones[c] / rate * n + (double)bin[c] / comb.bins * t);
+				x += comb.taps[l] * cos(a) / CHANNELS;
+				y += comb.taps[l] * sin(a) / CHANNELS;
+			}
+		}
+		error = hypot(baseband[t * 2] - x, baseband[t * 2 + 1] - y);
+		if (error > max_error)
+			max_error = error;
+	}
+	combiner_exit(&comb);
+
+	printf("Maximum error of combined output against reference: %.7f", max_error);
+	if (max_error > 0.0001) {
+		printf(" FAILED!\n");
+		return -1;
+	}
+	printf(" ok\n");
+
+	return 0;
+}
+
+/* amplitude of a tone in the decimated signal */
+static double amplitude(const float *x, double rate, double f)
+{
+	double re = 0.0, im = 0.0, a;
+	int s;
+
+	for (s = 0; s < DEC_NUM; s++) {
+		a = -2.0 * M_PI * f / rate * s;
+		re += x[s * 2] * cos(a) - x[s * 2 + 1] * sin(a);
+		im += x[s * 2] * sin(a) + x[s * 2 + 1] * cos(a);
+	}
+
+	return hypot(re, im) / DEC_NUM;
+}
+
+/* decimate tone and interferers, stages is 0 to select them by bandwidth */
+static int test_decimator(int stages, int expect_stages)
+{
+	static const int blocks[] = { 1000, 7, 333, 4096, 64, 3, 0 };
+	decimator_t dec;
+	double rate, gain, rejection;
+	int s, i, b, length, expect, count, pos, num = 0, failed = 0;
+
+	/* tone and interferers, each with amplitude 1 / 3 */
+	for (s = 0; s < DEC_INPUT_NUM; s++) {
+		wideband[s * 2] = cos(2.0 * M_PI * (DEC_OFFSET + DEC_TONE) / SAMPLERATE * s) / 3.0;
+		wideband[s * 2 + 1] = sin(2.0 * M_PI * (DEC_OFFSET + DEC_TONE) / SAMPLERATE * s) / 3.0;
+		for (i = 0; i < 2; i++) {
+			wideband[s * 2] += cos(2.0 * M_PI * (DEC_OFFSET + interferers[i]) / SAMPLERATE * s) / 3.0;
+			wideband[s * 2 + 1] += sin(2.0 * M_PI * (DEC_OFFSET + interferers[i]) / SAMPLERATE * s) / 3.0;
+		}
+	}
+
+	if (decimator_init(&dec, SAMPLERATE, DEC_OFFSET, BANDWIDTH, DEC_MAX_BLOCK, stages)) {
+		printf("Failed to init decimator\n");
+		return -1;
+	}
+	rate = decimator_samplerate(&dec);
+	printf("Decimator: %d stages, decimation %d, sample rate %.0f Hz", dec.stages, dec.decimation, rate);
+	if (dec.stages != expect_stages || rate != SAMPLERATE / (double)(1 << expect_stages)) {
+		printf(" FAILED!\n");
+		decimator_exit(&dec);
+		return -1;
+	}
+	printf(" ok\n");
+
+	/* blocks of a multiple of the decimation must give exactly one output sample per decimation */
+	for (b = 0, pos = 0; pos < DEC_INPUT_NUM; b++, pos += length) {
+		length = blocks[b % 6];
+		if (stages)
+			length = length / dec.decimation * dec.decimation + dec.decimation;
+		if (length > DEC_MAX_BLOCK)
+			length = DEC_MAX_BLOCK;
+		if (length > DEC_INPUT_NUM - pos)
+			length = DEC_INPUT_NUM - pos;
+		expect = decimator_output_num(&dec, length);
+		count = decimator_process(&dec, wideband + pos * 2, length, decimated + num * 2);
+		if (count != expect || (stages && count != length / dec.decimation)) {
+			printf("Decimator returns %d samples for %d input samples FAILED!\n", count, length);
+			failed = 1;
+		}
+		num += count;
+	}
+	decimator_exit(&dec);
+	if (num != DEC_INPUT_NUM / dec.decimation) {
+		printf("Decimator returns %d samples in total, expecting %d FAILED!\n", num, DEC_INPUT_NUM / dec.decimation);
+		failed = 1;
+	}
+
+	gain = amplitude(decimated + DEC_SKIP * 2, rate, DEC_TONE) * 3.0;
+	printf("Gain of tone at %+.0f Hz: %.5f", DEC_TONE, gain);
+	if (fabs(gain - 1.0) > 0.001) {
+		printf(" FAILED!\n");
+		failed = 1;
+	} else
+		printf(" ok\n");
+	for (i = 0; i < 2; i++) {
+		rejection = -20.0 * log10(amplitude(decimated + DEC_SKIP * 2, rate, remainder(interferers[i], rate)) * 3.0);
+		printf("Rejection of interferer at %+.0f Hz (aliasing to %+.0f Hz): %.1f dB", interferers[i], remainder(interferers[i], rate), rejection);
+		if (rejection < 75.0) {
+			printf(" FAILED!\n");
+			failed = 1;
+		} else
+			printf(" ok\n");
+	}
+
+	return (failed) ? -1 : 0;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	fm_init(0);
+
+	if (test_channelizer())
+		failed = 1;
+	if (test_combiner())
+		failed = 1;
+	/* 1 MHz is decimated to 62500 Hz, which is between two and four times the bandwidth */
+	if (test_decimator(0, 4))
+		failed = 1;
+	/* 1 MHz is decimated by a given number of stages */
+	if (test_decimator(5, 5))
+		failed = 1;
+
+	fm_exit();
+
+	return failed;
+}
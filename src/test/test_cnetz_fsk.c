@@ -0,0 +1,291 @@
+/* compare the slope tracker of the C-Netz FSK decoder with a search of the whole window
+ *
+ * Without argument, synthesized FSK signals are used. With a wave file as
+ * argument, the recorded signal is used and every change that is detected is
+ * printed, so it can be compared with a reference. test_cnetz_fsk.sh does
+ * this with test_cnetz_fsk.wav, which holds 0.25 seconds of C-Netz FSK, as
+ * it is received from the radio: Transitions are shaped by the raised cosine
+ * ramp of the transmitter, the bit clock is 30 ppm off, the signal is low
+ * pass filtered by the receiver and has noise and a DC offset. It was created
+ * with '-w <wave file>'.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libwave/wave.h"
+#include "../cnetz/fsk_slope.h"
+
+#define BITRATE		5280.0
+#define CHUNK		1024
+#define BITS		20000
+
+static double get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* the window, as it was searched by the decoder for every sample */
+static sample_t *window;
+static int window_len, window_half, window_pos;
+
+static int search_window(sample_t *level)
+{
+	sample_t level_min = 0, level_max = 0, change_max = -1;
+	int change_at = -1, change_positive = -1;
+	sample_t s = 0, last_s = 0;
+	int i;
+
+	for (i = 0; i < window_len; i++) {
+		last_s = s;
+		s = window[window_pos++];
+		if (window_pos == window_len)
+			window_pos = 0;
+		if (i > 0) {
+			if (s - last_s > change_max) {
+				change_max = s - last_s;
+				change_at = i;
+				change_positive = 1;
+			} else if (last_s - s > change_max) {
+				change_max = last_s - s;
+				change_at = i;
+				change_positive = 0;
+			}
+		}
+		if (i == 0 || s > level_max)
+			level_max = s;
+		if (i == 0 || s < level_min)
+			level_min = s;
+	}
+	*level = level_max - level_min;
+
+	return (change_at == window_half) ? change_positive : -1;
+}
+
+static fsk_slope_t slope;
+static int changes, errors, sample_count, print_changes;
+
+static int init_window(int samplerate)
+{
+	window_len = (int)((double)samplerate / BITRATE + 0.5);
+	window_half = (int)((double)samplerate / BITRATE / 2.0 + 0.5);
+	window_pos = 0;
+	window = calloc(window_len, sizeof(*window));
+	if (!window)
+		return -1;
+	changes = errors = sample_count = 0;
+
+	return fsk_slope_init(&slope, window_len, window_half);
+}
+
+static void exit_window(void)
+{
+	fsk_slope_exit(&slope);
+	free(window);
+}
+
+/* feed samples to both and compare each decision */
+static void compare(sample_t *samples, int num)
+{
+	sample_t level_search, level_slope;
+	int change_search, change_slope;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		window[window_pos++] = samples[i];
+		if (window_pos == window_len)
+			window_pos = 0;
+		fsk_slope_add(&slope, samples[i]);
+		change_search = search_window(&level_search);
+		change_slope = fsk_slope_get(&slope, &level_slope);
+		if (change_search >= 0)
+			changes++;
+		if (print_changes && change_slope >= 0)
+			printf("change at sample %d to %s\n", sample_count, (change_slope) ? "high" : "low");
+		sample_count++;
+		if (change_search != change_slope || (change_search >= 0 && level_search != level_slope)) {
+			if (errors++ < 10)
+				printf("Decision differs: search %d (level %.6f) tracker %d (level %.6f)\n", change_search, level_search, change_slope, level_slope);
+		}
+	}
+}
+
+/* random bits, filtered and quantized like the received signal, plus noise */
+static int synthesize(sample_t *samples, int num, int samplerate, double noise, int quant)
+{
+	static double phase, lp;
+	static int bit;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		phase += BITRATE / (double)samplerate;
+		if (phase >= 1.0) {
+			phase -= 1.0;
+			if ((random() & 1))
+				bit = !bit;
+		}
+		lp += (((bit) ? 1.0 : -1.0) - lp) * 0.4;
+		samples[i] = lp + noise * ((double)(random() % 2001) / 1000.0 - 1.0);
+		if (quant)
+			samples[i] = round(samples[i] * quant) / quant;
+	}
+
+	return num;
+}
+
+#define CAPTURE_RATE	48000
+#define CAPTURE_LENGTH	0.25
+#define CAPTURE_CLOCK	1.00003
+
+/* C-Netz FSK, shaped like the transmitter does and filtered like the receiver does */
+static int write_capture(const char *filename)
+{
+	wave_rec_t rec;
+	sample_t buffer[CHUNK], *samples[1] = { buffer };
+	double phase = 0.0, lp = 0.0, dc = 0.05, noise = 0.03;
+	double level, last_level = -1.0, next_level = -1.0;
+	int i, num, count;
+
+	if (wave_create_record(&rec, filename, CAPTURE_RATE, 1, 1.0) < 0)
+		return -1;
+	num = (int)(CAPTURE_RATE * CAPTURE_LENGTH);
+	while (num > 0) {
+		count = (num > CHUNK) ? CHUNK : num;
+		for (i = 0; i < count; i++) {
+			phase += BITRATE * CAPTURE_CLOCK / (double)CAPTURE_RATE;
+			if (phase >= 1.0) {
+				phase -= 1.0;
+				last_level = next_level;
+				next_level = (random() & 1) ? 0.5 : -0.5;
+			}
+			/* raised cosine ramp over one bit */
+			level = last_level + (next_level - last_level) * (0.5 - 0.5 * cos(M_PI * phase));
+			lp += (level - lp) * 0.5;
+			buffer[i] = lp + dc + noise * ((double)(random() % 2001) / 1000.0 - 1.0);
+		}
+		wave_write(&rec, samples, count);
+		num -= count;
+	}
+	wave_destroy_record(&rec);
+
+	return 0;
+}
+
+static void bench(int samplerate)
+{
+	sample_t samples[CHUNK], level;
+	double start, t_search, t_slope;
+	int i, c, n, num = 0, sum = 0;
+
+	init_window(samplerate);
+	synthesize(samples, CHUNK, samplerate, 0.1, 0);
+	n = (int)((double)samplerate / BITRATE * BITS / CHUNK) + 1;
+
+	start = get_time();
+	for (c = 0; c < n; c++) {
+		for (i = 0; i < CHUNK; i++) {
+			window[window_pos++] = samples[i];
+			if (window_pos == window_len)
+				window_pos = 0;
+			sum += search_window(&level);
+		}
+		num += CHUNK;
+	}
+	t_search = (get_time() - start) / num * 1e9;
+
+	start = get_time();
+	for (c = 0; c < n; c++) {
+		for (i = 0; i < CHUNK; i++) {
+			fsk_slope_add(&slope, samples[i]);
+			sum -= fsk_slope_get(&slope, &level);
+		}
+	}
+	t_slope = (get_time() - start) / num * 1e9;
+
+	exit_window();
+	printf("%6d Hz: window of %2d samples, search %6.1f ns, tracker %6.1f ns per sample%s\n", samplerate, window_len, t_search, t_slope, (sum) ? " (result differs!)" : "");
+}
+
+int main(int argc, char *argv[])
+{
+	static const int rates[] = { 48000, 44100, 96000, 192000, 0 };
+	static const double noises[] = { 0.0, 0.05, 0.3, 1.0, -1 };
+	static const int quants[] = { 0, 8, 100, -1 };
+	sample_t buffer[CHUNK], *samples[1] = { buffer };
+	int r, n, q, i, num, got;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+
+	if (argc > 2 && !strcmp(argv[1], "-w")) {
+		srandom(1);
+		if (write_capture(argv[2]) < 0)
+			return 1;
+		printf("%s written\n", argv[2]);
+		return 0;
+	}
+
+	if (argc > 1) {
+		wave_play_t play;
+		int samplerate = 0, channels = 0;
+
+		/* use the 16 bit values, they are exact with float and double samples */
+		if (wave_create_playback(&play, argv[1], &samplerate, &channels, 32767.0) < 0)
+			return 1;
+		if (channels > 1) {
+			printf("Wave file must have one channel\n");
+			return 1;
+		}
+		if (init_window(samplerate) < 0)
+			return 1;
+		print_changes = 1;
+		while (play.left) {
+			got = wave_read(&play, samples, CHUNK);
+			if (!got) {
+				usleep(1000);
+				continue;
+			}
+			for (i = 0; i < got; i++)
+				buffer[i] = round(buffer[i]);
+			compare(buffer, got);
+		}
+		wave_destroy_playback(&play);
+		exit_window();
+		printf("%d changes detected, decisions %s\n", changes, (errors) ? "differ! FAILED!" : "match");
+		return (errors) ? 1 : 0;
+	}
+
+	srandom(1);
+
+	for (r = 0; rates[r]; r++) {
+		for (n = 0; noises[n] >= 0; n++) {
+			for (q = 0; quants[q] >= 0; q++) {
+				if (init_window(rates[r]) < 0)
+					return 1;
+				num = (int)((double)rates[r] / BITRATE * BITS);
+				while (num > 0) {
+					got = synthesize(buffer, (num > CHUNK) ? CHUNK : num, rates[r], noises[n], quants[q]);
+					compare(buffer, got);
+					num -= got;
+				}
+				exit_window();
+				printf("%6d Hz, noise %.2f, quantization %3d: %5d changes detected, decisions %s\n", rates[r], noises[n], quants[q], changes, (errors) ? "differ! FAILED!" : "match");
+			}
+		}
+	}
+
+	printf("\n");
+	for (r = 0; rates[r]; r++)
+		bench(rates[r]);
+
+	return 0;
+}
@@ -0,0 +1,20 @@
+#!/bin/sh
+
+# Detect the level changes of the C-Netz FSK capture with the slope tracker and
+# the search of the whole window. Both must take the same decisions and the
+# detected changes are compared with the reference output. Run this from the
+# build directory.
+
+srcdir=`dirname "$0"`
+
+./test_cnetz_fsk "$srcdir/test_cnetz_fsk.wav" 2>/dev/null > test_cnetz_fsk.out
+failed=$?
+if ! diff -u "$srcdir/test_cnetz_fsk.ref" test_cnetz_fsk.out; then
+	echo "Detected changes differ from reference!"
+	failed=1
+fi
+if [ $failed = 0 ]; then
+	echo "Detected changes match reference."
+fi
+
+exit $failed
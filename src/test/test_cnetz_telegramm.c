@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libbitbuf/bitbuf.h"
+#include "../cnetz/cnetz.h"
+#include "../cnetz/sysinfo.h"
+#include "../cnetz/telegramm.h"
+
+/* Encode every opcode with all parameters cleared, set and random. The
+ * telegramms used by the mobile station are decoded and encoded again, this
+ * must result in the same bits, also if correctable bit errors are added.
+ * The output is compared with test_cnetz_telegramm.ref, which was recorded
+ * with the bit by bit coder that was used before.
+ */
+
+static uint64_t rand_state = 0x123456789abcdef;
+
+static uint64_t random64(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state;
+}
+
+cnetz_si si;
+sender_t *sender_head = NULL;
+
+static telegramm_t tx_telegramm, rx_telegramm;
+static int received;
+
+void cnetz_sync_frame(cnetz_t __attribute__((unused)) *cnetz, double __attribute__((unused)) sync, int __attribute__((unused)) ts)
+{
+}
+
+const struct telegramm *cnetz_transmit_telegramm_rufblock(cnetz_t __attribute__((unused)) *cnetz)
+{
+	return &tx_telegramm;
+}
+
+const struct telegramm *cnetz_transmit_telegramm_meldeblock(cnetz_t __attribute__((unused)) *cnetz)
+{
+	return &tx_telegramm;
+}
+
+const struct telegramm *cnetz_transmit_telegramm_spk_k(cnetz_t __attribute__((unused)) *cnetz)
+{
+	return &tx_telegramm;
+}
+
+const struct telegramm *cnetz_transmit_telegramm_spk_v(cnetz_t __attribute__((unused)) *cnetz)
+{
+	return &tx_telegramm;
+}
+
+static void receive(struct telegramm *telegramm)
+{
+	memcpy(&rx_telegramm, telegramm, sizeof(rx_telegramm));
+	received = 1;
+}
+
+void cnetz_receive_telegramm_ogk(cnetz_t __attribute__((unused)) *cnetz, struct telegramm *telegramm, int __attribute__((unused)) block)
+{
+	receive(telegramm);
+}
+
+void cnetz_receive_telegramm_spk_k(cnetz_t __attribute__((unused)) *cnetz, struct telegramm *telegramm)
+{
+	receive(telegramm);
+}
+
+void cnetz_receive_telegramm_spk_v(cnetz_t __attribute__((unused)) *cnetz, struct telegramm *telegramm)
+{
+	receive(telegramm);
+}
+
+/* decode with every signaling mode, only the right one accepts the telegramm */
+static int decode(cnetz_t *cnetz, const bitbuf_t *bits)
+{
+	enum dsp_mode dsp_mode;
+	bitbuf_t data;
+
+	/* decoder gets the bits without sync */
+	bitbuf_clear(&data);
+	bitbuf_append_buf(&data, bits, 34, 150);
+	received = 0;
+	for (dsp_mode = DSP_MODE_OGK; dsp_mode <= DSP_MODE_SPK_V && !received; dsp_mode++) {
+		cnetz->dsp_mode = dsp_mode;
+		cnetz_decode_telegramm(cnetz, &data, 1.0, 0.0, 0.0);
+	}
+	cnetz->dsp_mode = DSP_MODE_SPK_K;
+
+	return (received) ? 0 : -1;
+}
+
+static int test_telegramm(cnetz_t *cnetz, int opcode, const char *fill)
+{
+	bitbuf_t bits, again;
+	char string[BITBUF_MAX + 1];
+	uint8_t *p;
+	size_t i;
+
+	memset(&tx_telegramm, (!strcmp(fill, "ones")) ? 0xff : 0x00, sizeof(tx_telegramm));
+	if (!strcmp(fill, "random")) {
+		for (i = 0, p = (uint8_t *)&tx_telegramm; i < sizeof(tx_telegramm); i++)
+			p[i] = random64();
+	}
+	tx_telegramm.opcode = opcode;
+	if (!strcmp(fill, "zeros"))
+		strcpy(tx_telegramm.wahlziffern, "");
+	else if (!strcmp(fill, "ones"))
+		strcpy(tx_telegramm.wahlziffern, "0987654321098765");
+	else
+		sprintf(tx_telegramm.wahlziffern, "%" PRIu64, (uint64_t)(random64() % 100000000000000ULL));
+	tx_telegramm.level = 0.0;
+	tx_telegramm.sync_time = 0.0;
+
+	cnetz_encode_telegramm(cnetz, &bits);
+	printf("%s %s: %s", telegramm_name(opcode), fill, bitbuf_string(&bits, 0, bits.length, string));
+
+	/* only telegramms from mobile station are decoded */
+	if (opcode >= 32) {
+		printf("\n");
+		return 0;
+	}
+
+	/* add two bit errors to first code word and one to the fourth, these can be corrected */
+	if (!strcmp(fill, "random")) {
+		bitbuf_set(&bits, 34 + 0, !bitbuf_bit(&bits, 34 + 0), 1);
+		bitbuf_set(&bits, 34 + 10, !bitbuf_bit(&bits, 34 + 10), 1);
+		bitbuf_set(&bits, 34 + 3, !bitbuf_bit(&bits, 34 + 3), 1);
+	}
+	if (decode(cnetz, &bits) < 0) {
+		printf(" -> not decoded\n");
+		return 0;
+	}
+	printf(" -> %s\n", telegramm_name(rx_telegramm.opcode));
+
+	memcpy(&tx_telegramm, &rx_telegramm, sizeof(tx_telegramm));
+	cnetz_encode_telegramm(cnetz, &again);
+	if (!strcmp(fill, "random")) {
+		bitbuf_set(&bits, 34 + 0, !bitbuf_bit(&bits, 34 + 0), 1);
+		bitbuf_set(&bits, 34 + 10, !bitbuf_bit(&bits, 34 + 10), 1);
+		bitbuf_set(&bits, 34 + 3, !bitbuf_bit(&bits, 34 + 3), 1);
+	}
+	if (again.length != bits.length || memcmp(bits.word, again.word, sizeof(bits.word))) {
+		printf("%s %s: encoded again to %s!\n", telegramm_name(opcode), fill, bitbuf_string(&again, 0, again.length, string));
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	cnetz_t *cnetz;
+	bitbuf_t bits, inverted;
+	int opcode, failed = 0;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	init_telegramm();
+	init_coding();
+
+	cnetz = calloc(1, sizeof(*cnetz));
+	cnetz->sender.kanal = "test";
+	cnetz->fsk_deviation = 1.0;
+	cnetz->dsp_mode = DSP_MODE_SPK_K;
+
+	for (opcode = 0; opcode < 64; opcode++) {
+		failed |= test_telegramm(cnetz, opcode, "zeros");
+		failed |= test_telegramm(cnetz, opcode, "ones");
+		failed |= test_telegramm(cnetz, opcode, "random");
+	}
+
+	/* negative polarity inverts all bits */
+	cnetz_encode_telegramm(cnetz, &bits);
+	cnetz->negative_polarity = 1;
+	cnetz_encode_telegramm(cnetz, &inverted);
+	bitbuf_invert(&inverted);
+	if (inverted.length != bits.length || memcmp(bits.word, inverted.word, sizeof(bits.word))) {
+		printf("Negative polarity does not invert the bits!\n");
+		failed = 1;
+	}
+
+	free(cnetz);
+
+	if (failed) {
+		printf("Telegramms do not survive decoding and encoding!\n");
+		return 1;
+	}
+	printf("All telegramms survive decoding and encoding.\n");
+
+	return 0;
+}
@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <sys/time.h>
+#include "../libfft/fft.h"
+
+struct timeval start_tv, tv;
+double duration;
+int tot_samples;
+
+#define T_START() \
+	gettimeofday(&start_tv, NULL); \
+	tot_samples = 0; \
+	while (1) {
+
+#define T_STOP(what, samples) \
+		gettimeofday(&tv, NULL); \
+		duration = (double)tv.tv_sec + (double)tv.tv_usec / 1e6; \
+		duration -= (double)start_tv.tv_sec + (double)start_tv.tv_usec / 1e6; \
+		tot_samples += samples; \
+		if (duration >= 1) \
+			break; \
+	} \
+	printf("%s: %.3f mega samples/sec\n", what, (double)tot_samples / duration / 1e6); \
+
+#define MAX_M	12
+#define N	(1 << MAX_M)
+
+static double ref_x[N], ref_y[N], x[N], y[N], data[N * 2 + 2], real[N];
+static float data_float[N * 2 + 2], real_float[N];
+
+/* radix-2 FFT that recalculates the twiddle factors at each call, as libfft did before */
+static void fft_textbook(int dir, int m, double *x, double *y)
+{
+	int	n, i, i1, j, k, i2, l, l1, l2;
+	double	c1, c2, tx, ty, t1, t2, u1, u2, z;
+
+	n = 1 << m;
+	i2 = n >> 1;
+	j = 0;
+	for (i = 0; i < n - 1; i++) {
+		if (i < j) {
+			tx = x[i];
+			ty = y[i];
+			x[i] = x[j];
+			y[i] = y[j];
+			x[j] = tx;
+			y[j] = ty;
+		}
+		k = i2;
+		while (k <= j) {
+			j -= k;
+			k >>= 1;
+		}
+		j += k;
+	}
+	c1 = -1.0;
+	c2 = 0.0;
+	l2 = 1;
+	for (l = 0; l < m; l++) {
+		l1 = l2;
+		l2 <<= 1;
+		u1 = 1.0;
+		u2 = 0.0;
+		for (j = 0; j < l1; j++) {
+			for (i = j; i < n; i += l2) {
+				i1 = i + l1;
+				t1 = u1 * x[i1] - u2 * y[i1];
+				t2 = u1 * y[i1] + u2 * x[i1];
+				x[i1] = x[i] - t1;
+				y[i1] = y[i] - t2;
+				x[i] += t1;
+				y[i] += t2;
+			}
+			z = u1 * c1 - u2 * c2;
+			u2 = u1 * c2 + u2 * c1;
+			u1 = z;
+		}
+		c2 = sqrt((1.0 - c1) / 2.0);
+		if (dir == 1)
+			c2 = -c2;
+		c1 = sqrt((1.0 + c1) / 2.0);
+	}
+	if (dir == 1) {
+		for (i = 0; i < n; i++) {
+			x[i] /= n;
+			y[i] /= n;
+		}
+	}
+}
+
+/* discrete fourier transformation, same scaling as FFT */
+static void dft(int dir, int n, const double *in_x, const double *in_y, double *out_x, double *out_y)
+{
+	int i, k;
+	double sign = (dir == 1) ? -1.0 : 1.0;
+
+	for (k = 0; k < n; k++) {
+		out_x[k] = 0;
+		out_y[k] = 0;
+		for (i = 0; i < n; i++) {
+			double a = sign * 2.0 * M_PI * (double)((long)i * k % n) / (double)n;
+			out_x[k] += in_x[i] * cos(a) - in_y[i] * sin(a);
+			out_y[k] += in_x[i] * sin(a) + in_y[i] * cos(a);
+		}
+		if (dir == 1) {
+			out_x[k] /= n;
+			out_y[k] /= n;
+		}
+	}
+}
+
+static void gen_random(double *samples, int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++)
+		samples[i] = (double)random() / (double)RAND_MAX * 2.0 - 1.0;
+}
+
+static void result(const char *what, int m, double diff, double limit)
+{
+	printf("%s with 2^%d points: max difference %.3g%s\n", what, m, diff, (diff > limit) ? " FAILED!" : " ok");
+}
+
+static void test_complex(int m, int dir)
+{
+	const fft_plan_t *plan = fft_plan_get(m, dir);
+	double in_x[N], in_y[N];
+	double diff, d;
+	int n = 1 << m;
+	int i;
+
+	gen_random(in_x, n);
+	gen_random(in_y, n);
+	dft(dir, n, in_x, in_y, ref_x, ref_y);
+
+	/* split */
+	memcpy(x, in_x, n * sizeof(*x));
+	memcpy(y, in_y, n * sizeof(*y));
+	fft_process(dir, m, x, y);
+	for (diff = 0, i = 0; i < n; i++) {
+		d = fabs(x[i] - ref_x[i]) + fabs(y[i] - ref_y[i]);
+		if (d > diff)
+			diff = d;
+	}
+	result((dir == 1) ? "forward split" : "reverse split", m, diff, 1e-9);
+
+	/* interleaved double */
+	for (i = 0; i < n; i++) {
+		data[i * 2] = in_x[i];
+		data[i * 2 + 1] = in_y[i];
+	}
+	fft_execute(plan, data);
+	for (diff = 0, i = 0; i < n; i++) {
+		d = fabs(data[i * 2] - ref_x[i]) + fabs(data[i * 2 + 1] - ref_y[i]);
+		if (d > diff)
+			diff = d;
+	}
+	result((dir == 1) ? "forward interleaved" : "reverse interleaved", m, diff, 1e-9);
+
+	/* interleaved float, relative to level of result */
+	for (i = 0; i < n; i++) {
+		data_float[i * 2] = in_x[i];
+		data_float[i * 2 + 1] = in_y[i];
+	}
+	fft_execute_float(plan, data_float);
+	for (diff = 0, i = 0; i < n; i++) {
+		d = fabs(data_float[i * 2] - ref_x[i]) + fabs(data_float[i * 2 + 1] - ref_y[i]);
+		if (d > diff)
+			diff = d;
+	}
+	if (dir != 1)
+		diff /= sqrt(n);
+	result((dir == 1) ? "forward float" : "reverse float", m, diff, 1e-5);
+}
+
+static void test_real(int m)
+{
+	fft_plan_t *forward = fft_plan_real_init(m, 1);
+	fft_plan_t *reverse = fft_plan_real_init(m, -1);
+	double in_x[N], zero[N];
+	double diff, d;
+	int n = 1 << m;
+	int i;
+
+	gen_random(in_x, n);
+	memset(zero, 0, sizeof(zero));
+	dft(1, n, in_x, zero, ref_x, ref_y);
+
+	fft_execute_real(forward, in_x, data);
+	for (diff = 0, i = 0; i <= n / 2; i++) {
+		d = fabs(data[i * 2] - ref_x[i]) + fabs(data[i * 2 + 1] - ref_y[i]);
+		if (d > diff)
+			diff = d;
+	}
+	result("forward real", m, diff, 1e-9);
+
+	fft_execute_real(reverse, data, real);
+	for (diff = 0, i = 0; i < n; i++) {
+		d = fabs(real[i] - in_x[i]);
+		if (d > diff)
+			diff = d;
+	}
+	result("forward and reverse real", m, diff, 1e-9);
+
+	for (i = 0; i < n; i++)
+		real_float[i] = in_x[i];
+	fft_execute_real_float(forward, real_float, data_float);
+	fft_execute_real_float(reverse, data_float, real_float);
+	for (diff = 0, i = 0; i < n; i++) {
+		d = fabs(real_float[i] - in_x[i]);
+		if (d > diff)
+			diff = d;
+	}
+	result("forward and reverse real float", m, diff, 1e-5);
+
+	fft_plan_exit(forward);
+	fft_plan_exit(reverse);
+}
+
+static void benchmark(int m)
+{
+	const fft_plan_t *plan = fft_plan_get(m, 1);
+	fft_plan_t *real_plan = fft_plan_real_init(m, 1);
+	int n = 1 << m;
+	char text[64];
+
+	gen_random(x, n);
+	gen_random(y, n);
+	gen_random(real, n);
+
+	sprintf(text, "2^%d points, textbook radix-2", m);
+	T_START()
+	fft_textbook(1, m, x, y);
+	T_STOP(text, n)
+
+	sprintf(text, "2^%d points, split", m);
+	T_START()
+	fft_execute_split(plan, x, y);
+	T_STOP(text, n)
+
+	sprintf(text, "2^%d points, interleaved", m);
+	T_START()
+	fft_execute(plan, data);
+	T_STOP(text, n)
+
+	sprintf(text, "2^%d points, interleaved float", m);
+	T_START()
+	fft_execute_float(plan, data_float);
+	T_STOP(text, n)
+
+	sprintf(text, "2^%d points, real", m);
+	T_START()
+	fft_execute_real(real_plan, real, data);
+	T_STOP(text, n)
+
+	sprintf(text, "2^%d points, real float", m);
+	T_START()
+	fft_execute_real_float(real_plan, real_float, data_float);
+	T_STOP(text, n)
+
+	fft_plan_exit(real_plan);
+}
+
+int main(void)
+{
+	int m;
+
+	printf("testing FFT against DFT\n");
+
+	for (m = 0; m <= 10; m++) {
+		test_complex(m, 1);
+		test_complex(m, -1);
+	}
+	for (m = 1; m <= 10; m++)
+		test_real(m);
+
+	printf("testing FFT performance\n");
+
+	benchmark(6);
+	benchmark(9);
+	benchmark(12);
+
+	return 0;
+}
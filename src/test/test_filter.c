@@ -35,6 +35,173 @@ static void gen_samples(sample_t *samples, double freq)
 	}
 }
 
+/* process I and Q of a baseband in blocks of different size with given kernel, return maximum difference to scalar kernel */
+static double compare_kernel(enum iir_kernel kernel, int iterations)
+{
+	static float ref[SAMPLERATE * 2], test[SAMPLERATE * 2];
+	iir_filter_t filter_i, filter_q;
+	double diff, max = 0.0;
+	int i, length;
+
+	for (i = 0; i < SAMPLERATE; i++) {
+		ref[i * 2] = cos(2.0 * M_PI * 997.0 / (double)SAMPLERATE * (double)i);
+		ref[i * 2 + 1] = sin(2.0 * M_PI * 3001.0 / (double)SAMPLERATE * (double)i);
+	}
+	memcpy(test, ref, sizeof(test));
+
+	iir_kernel_select(IIR_KERNEL_SCALAR);
+	iir_lowpass_init(&filter_i, 1000.0, SAMPLERATE, iterations);
+	iir_lowpass_init(&filter_q, 1000.0, SAMPLERATE, iterations);
+	for (i = 0; i < SAMPLERATE; i += length) {
+		length = (i % 7 + 1) * 13;
+		if (length > SAMPLERATE - i)
+			length = SAMPLERATE - i;
+		iir_process_iq(&filter_i, &filter_q, ref + i * 2, length);
+	}
+
+	iir_kernel_select(kernel);
+	iir_lowpass_init(&filter_i, 1000.0, SAMPLERATE, iterations);
+	iir_lowpass_init(&filter_q, 1000.0, SAMPLERATE, iterations);
+	for (i = 0; i < SAMPLERATE; i += length) {
+		length = (i % 7 + 1) * 13;
+		if (length > SAMPLERATE - i)
+			length = SAMPLERATE - i;
+		iir_process_iq(&filter_i, &filter_q, test + i * 2, length);
+	}
+
+	for (i = 0; i < SAMPLERATE * 2; i++) {
+		diff = fabs(test[i] - ref[i]);
+		if (diff > max)
+			max = diff;
+	}
+
+	iir_kernel_select(IIR_KERNEL_AUTO);
+
+	return max;
+}
+
+/* generate noise-like test signal */
+static void gen_random(sample_t *samples, int num)
+{
+	uint32_t r = 1;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		r = r * 1103515245 + 12345;
+		samples[i] = (double)(r >> 8) / (double)(1 << 23) - 1.0;
+	}
+}
+
+/* filter signal with direct FIR filter and with FFT FIR filter in blocks of different size, return maximum difference */
+static double compare_fir_fft(fir_filter_t *fir, int block)
+{
+	static sample_t ref[SAMPLERATE], test[SAMPLERATE];
+	fir_fft_t *fft;
+	double diff, max = 0.0;
+	int i, length, delay;
+
+	gen_random(ref, SAMPLERATE);
+	memcpy(test, ref, sizeof(test));
+	memset(fir->buffer, 0, fir->ntaps * sizeof(*fir->buffer));
+	fir->buffer_pos = 0;
+	fir_process(fir, ref, SAMPLERATE);
+
+	fft = fir_fft_init(fir, block);
+	for (i = 0; i < SAMPLERATE; i += length) {
+		length = (i % 7 + 1) * 13;
+		if (length > SAMPLERATE - i)
+			length = SAMPLERATE - i;
+		fir_fft_process(fft, test + i, length);
+	}
+	delay = fir_fft_get_delay(fft) - fir_get_delay(fir);
+	printf("block size %d with %d partitions: ", fft->block, fft->partitions);
+	fir_fft_exit(fft);
+
+	for (i = 0; i < SAMPLERATE - delay; i++) {
+		diff = fabs(test[i + delay] - ref[i]);
+		if (diff > max)
+			max = diff;
+	}
+
+	return max;
+}
+
+/* decimate signal and compare with every 'factor'th output sample of direct FIR filter
+ * with 'dual' set, a second (negated) signal is decimated in the same pass */
+static double compare_fir_decimate(fir_filter_t *fir, int factor, int dual)
+{
+	static sample_t ref[SAMPLERATE], test[SAMPLERATE], test2[SAMPLERATE];
+	fir_poly_t *poly, *poly2;
+	double diff, max = 0.0;
+	int i, num, num2;
+
+	gen_random(ref, SAMPLERATE);
+	memcpy(test, ref, sizeof(test));
+	for (i = 0; i < SAMPLERATE; i++)
+		test2[i] = -ref[i];
+	memset(fir->buffer, 0, fir->ntaps * sizeof(*fir->buffer));
+	fir->buffer_pos = 0;
+	fir_process(fir, ref, SAMPLERATE);
+
+	poly = fir_decimator_init(fir, factor);
+	poly2 = fir_decimator_init(fir, factor);
+	if (dual) {
+		num = fir_decimate_dual(poly, poly2, test, test2, SAMPLERATE / 2);
+		num2 = fir_decimate_dual(poly, poly2, test + SAMPLERATE / 2, test2 + SAMPLERATE / 2, SAMPLERATE - SAMPLERATE / 2);
+		memmove(test2 + num, test2 + SAMPLERATE / 2, num2 * sizeof(*test2));
+	} else {
+		num = fir_decimate(poly, test, SAMPLERATE / 2);
+		num2 = fir_decimate(poly, test + SAMPLERATE / 2, SAMPLERATE - SAMPLERATE / 2);
+	}
+	memmove(test + num, test + SAMPLERATE / 2, num2 * sizeof(*test));
+	num += num2;
+	fir_poly_exit(poly);
+	fir_poly_exit(poly2);
+
+	for (i = 0; i < num; i++) {
+		diff = fabs(test[i] - ref[i * factor + factor - 1]);
+		if (diff > max)
+			max = diff;
+		if (!dual)
+			continue;
+		diff = fabs(test2[i] + ref[i * factor + factor - 1]);
+		if (diff > max)
+			max = diff;
+	}
+
+	return max;
+}
+
+/* interpolate signal and compare with direct FIR filter of zero-stuffed signal */
+static double compare_fir_interpolate(fir_filter_t *fir, int factor)
+{
+	static sample_t ref[SAMPLERATE], test[SAMPLERATE], input[SAMPLERATE];
+	fir_poly_t *poly;
+	double diff, max = 0.0;
+	int i, num = SAMPLERATE / factor;
+
+	gen_random(input, num);
+	memset(ref, 0, sizeof(ref));
+	for (i = 0; i < num; i++)
+		ref[i * factor] = input[i] * (double)factor;
+	memset(fir->buffer, 0, fir->ntaps * sizeof(*fir->buffer));
+	fir->buffer_pos = 0;
+	fir_process(fir, ref, num * factor);
+
+	poly = fir_interpolator_init(fir, factor);
+	fir_interpolate(poly, input, num / 2, test);
+	fir_interpolate(poly, input + num / 2, num - num / 2, test + (num / 2) * factor);
+	fir_poly_exit(poly);
+
+	for (i = 0; i < num * factor; i++) {
+		diff = fabs(test[i] - ref[i]);
+		if (diff > max)
+			max = diff;
+	}
+
+	return max;
+}
+
 int num_kanal;
 
 int main(void)
@@ -123,6 +290,26 @@ int main(void)
 			printf("\n");
 	}
 
+	printf("testing vectorized IQ filter kernels against scalar kernel\n");
+
+	for (iter = 1; iter <= 4; iter++) {
+		enum iir_kernel kernel;
+		double diff;
+		for (kernel = IIR_KERNEL_VECTOR; kernel <= IIR_KERNEL_FLOAT; kernel++) {
+			if (iir_kernel_select(kernel) < 0) {
+				printf("%d iterations, %s kernel: not supported by CPU\n", iter, iir_kernel_name(kernel));
+				continue;
+			}
+			diff = compare_kernel(kernel, iter);
+			printf("%d iterations, %s kernel: max difference %.3g", iter, iir_kernel_name(kernel), diff);
+			if (kernel == IIR_KERNEL_FLOAT ? diff > 1e-5 : diff != 0.0)
+				printf(" FAILED!\n");
+			else
+				printf(" ok\n");
+		}
+	}
+	iter = 2;
+
 	double freq = 2000.0;
 	double tb = 400.0;
 	printf("testing low-pass FIR filter with %.0fHz transition bandwidth\n", tb);
@@ -140,6 +327,28 @@ int main(void)
 		else
 			printf("\n");
 	}
+
+	printf("testing FFT FIR filter against direct FIR filter\n");
+
+	for (i = 0; i < 4; i++) {
+		double diff;
+		int block = (i == 0) ? 0 : fir_low->ntaps >> i;
+		diff = compare_fir_fft(fir_low, block);
+		printf("max difference %.3g%s\n", diff, (diff > 1e-9) ? " FAILED!" : " ok");
+	}
+
+	printf("testing polyphase FIR decimator and interpolator against direct FIR filter\n");
+
+	for (i = 2; i <= 5; i++) {
+		double diff;
+		diff = compare_fir_decimate(fir_low, i, 0);
+		printf("decimation by %d: max difference %.3g%s\n", i, diff, (diff > 1e-9) ? " FAILED!" : " ok");
+		diff = compare_fir_decimate(fir_low, i, 1);
+		printf("dual decimation by %d: max difference %.3g%s\n", i, diff, (diff > 1e-9) ? " FAILED!" : " ok");
+		diff = compare_fir_interpolate(fir_low, i);
+		printf("interpolation by %d: max difference %.3g%s\n", i, diff, (diff > 1e-9) ? " FAILED!" : " ok");
+	}
+
 	fir_exit(fir_low);
 
 #if 0
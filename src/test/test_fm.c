@@ -0,0 +1,141 @@
+/* compare the fused FM demodulator with the exact FM demodulator
+ *
+ * A tone is swept up and down around the carrier and demodulated by both
+ * demodulators. The output of the fused demodulator must not differ more
+ * than 0.03 Hz at 50 kHz sample rate. The difference is a phase error of
+ * each sample, so the limit grows with the sample rate.
+ *
+ * The same sweep is modulated by the FM modulator and compared with a
+ * modulator that accumulates the phase in double precision and uses sin()
+ * and cos(). The IQ vector must not differ more than MOD_MAX_ERROR, after
+ * the transmitter has been ramped up.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../libsample/sample.h"
+#include "../libfm/fm.h"
+
+#define SAMPLES		100000
+#define MAX_ERROR	0.03	/* Hz at 50 kHz */
+#define MOD_MAX_ERROR	0.000002	/* distance of IQ vectors, relative to amplitude */
+
+static float baseband[SAMPLES * 2];
+static sample_t exact[SAMPLES], fused[SAMPLES], I[SAMPLES], Q[SAMPLES];
+static uint8_t power[SAMPLES];
+
+/* return 0 if the error is within the limit */
+static int compare(double samplerate, double offset, double sweep, double amplitude, int chunk)
+{
+	fm_demod_t demod_exact, demod_fused;
+	fm_demod_stats_t stats;
+	double phase = 0.0, f, error, max_error = 0.0, limit = MAX_ERROR * samplerate / 50000.0;
+	int s, num;
+
+	/* three sweeps of offset +- sweep */
+	for (s = 0; s < SAMPLES; s++) {
+		f = offset + sweep * sin(2.0 * M_PI * 3.0 * (double)s / SAMPLES);
+		phase += 2.0 * M_PI * f / samplerate;
+		baseband[s * 2] = cos(phase) * amplitude;
+		baseband[s * 2 + 1] = sin(phase) * amplitude;
+	}
+
+	fm_demod_init(&demod_exact, samplerate, offset, 10000.0);
+	fm_demod_init(&demod_fused, samplerate, offset, 10000.0);
+	for (s = 0; s < SAMPLES; s += num) {
+		num = (SAMPLES - s > chunk) ? chunk : SAMPLES - s;
+		fm_demodulate_complex(&demod_exact, exact + s, num, baseband + s * 2, I, Q);
+		fm_demodulate_complex_fused(&demod_fused, fused + s, num, baseband + s * 2, &stats);
+	}
+	fm_demod_exit(&demod_exact);
+	fm_demod_exit(&demod_fused);
+
+	for (s = 0; s < SAMPLES; s++) {
+		error = fabs(exact[s] - fused[s]);
+		if (error > max_error)
+			max_error = error;
+	}
+
+	printf("%7.0f Hz, offset %7.0f Hz, sweep %4.0f Hz, amplitude %5.3f, chunk %4d: max error %.4f Hz (limit %.4f Hz)", samplerate, offset, sweep, amplitude, chunk, max_error, limit);
+	if (max_error > limit) {
+		printf(" FAILED!\n");
+		return -1;
+	}
+	printf(" ok\n");
+
+	return 0;
+}
+
+/* return 0 if the error is within the limit */
+static int compare_mod(double samplerate, double offset, double sweep, double amplitude, int chunk)
+{
+	fm_mod_t mod;
+	double phase = 0.0, error, max_error = 0.0;
+	int s, num;
+
+	for (s = 0; s < SAMPLES; s++) {
+		exact[s] = sweep * sin(2.0 * M_PI * 3.0 * (double)s / SAMPLES);
+		power[s] = 1;
+		baseband[s * 2] = baseband[s * 2 + 1] = 0.0;
+	}
+
+	fm_mod_init(&mod, samplerate, offset, amplitude);
+	for (s = 0; s < SAMPLES; s += num) {
+		num = (SAMPLES - s > chunk) ? chunk : SAMPLES - s;
+		fm_modulate_complex(&mod, exact + s, power + s, num, baseband + s * 2);
+	}
+
+	for (s = 0; s < SAMPLES; s++) {
+		phase += 2.0 * M_PI * (offset + exact[s]) / samplerate;
+		/* skip ramp up */
+		if (s < mod.ramp_length)
+			continue;
+		error = hypot(baseband[s * 2] - cos(phase) * amplitude, baseband[s * 2 + 1] - sin(phase) * amplitude) / amplitude;
+		if (error > max_error)
+			max_error = error;
+	}
+	fm_mod_exit(&mod);
+
+	printf("%7.0f Hz, offset %7.0f Hz, sweep %4.0f Hz, amplitude %5.3f, chunk %4d: max modulator error %.7f (limit %.7f)", samplerate, offset, sweep, amplitude, chunk, max_error, MOD_MAX_ERROR);
+	if (max_error > MOD_MAX_ERROR) {
+		printf(" FAILED!\n");
+		return -1;
+	}
+	printf(" ok\n");
+
+	return 0;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	/* the exact demodulator does not use fast math */
+	fm_init(0);
+
+	if (compare(50000.0, 1000.0, 4000.0, 0.7, 160))
+		failed = 1;
+	if (compare(50000.0, 0.0, 4000.0, 0.7, 64))
+		failed = 1;
+	if (compare(48000.0, -7000.0, 4000.0, 0.001, 7))
+		failed = 1;
+	if (compare(24000.0, 3000.0, 2500.0, 1.0, 160))
+		failed = 1;
+	if (compare(1000000.0, 250000.0, 5000.0, 0.7, 1000))
+		failed = 1;
+
+	if (compare_mod(50000.0, 1000.0, 4000.0, 0.7, 160))
+		failed = 1;
+	if (compare_mod(48000.0, -7000.0, 4000.0, 0.001, 7))
+		failed = 1;
+	if (compare_mod(24000.0, 3000.0, 2500.0, 1.0, 1000))
+		failed = 1;
+	if (compare_mod(1000000.0, 250000.0, 5000.0, 0.7, 1000))
+		failed = 1;
+
+	fm_exit();
+
+	return failed;
+}
@@ -0,0 +1,23 @@
+#!/bin/sh
+
+# Run the frame codec tests and compare their output with the reference
+# output, which was recorded with the bit by bit coders that were used before
+# the frame codecs were ported onto the packed bit buffer.
+
+srcdir=`dirname "$0"`
+failed=0
+
+for name in mpt1327_message pocsag_frame nmt_frame r2000_frame cnetz_telegramm amps_frame; do
+	if ! ./test_$name 2>/dev/null > test_$name.out; then
+		echo "$name: frames do not survive encoding and decoding!"
+		failed=1
+	fi
+	if diff -u "$srcdir/test_$name.ref" test_$name.out; then
+		echo "$name: ok"
+	else
+		echo "$name: frames differ from reference!"
+		failed=1
+	fi
+done
+
+exit $failed
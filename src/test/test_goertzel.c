@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <math.h>
 #include <string.h>
+#include <time.h>
 #include "../libsample/sample.h"
 #include "../libgoertzel/goertzel.h"
 #include "../liblogging/logging.h"
@@ -22,6 +23,100 @@ static void gen_samples(sample_t *samples, double freq)
 	}
 }
 
+static double get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+#define BENCH_LENGTH	480
+#define BENCH_BLOCKS	2000
+
+/* compare bank with single filters and measure the time to process K tones */
+static void bench_bank(sample_t *samples)
+{
+	goertzel_t goertzel[GOERTZEL_BANK_MAX];
+	goertzel_bank_t bank;
+	goertzel_slide_t slide;
+	double freq[GOERTZEL_BANK_MAX];
+	double single[GOERTZEL_BANK_MAX], result[GOERTZEL_BANK_MAX];
+	double start, t_single, t_bank, t_slide;
+	int k, i, b, errors = 0;
+
+	printf("\ntesting goertzel bank with %d samples\n", BENCH_LENGTH);
+	printf(" K  single (us)  bank (us)  speedup  sliding (ns/sample)\n");
+
+	for (k = 1; k <= GOERTZEL_BANK_MAX; k++) {
+		for (i = 0; i < k; i++) {
+			freq[i] = 600.0 + 100.0 * i;
+			audio_goertzel_init(&goertzel[i], freq[i], SAMPLERATE);
+		}
+		goertzel_bank_init(&bank, freq, k, SAMPLERATE, BENCH_LENGTH);
+		goertzel_slide_init(&slide, freq, k, SAMPLERATE, BENCH_LENGTH);
+
+		/* results must be equal, also when using an offset */
+		for (b = 0; b < BENCH_LENGTH; b += 97) {
+			audio_goertzel(goertzel, samples, BENCH_LENGTH, b, single, k);
+			goertzel_bank(&bank, samples, b, result);
+			for (i = 0; i < k; i++) {
+				if (single[i] != result[i])
+					errors++;
+			}
+		}
+
+		start = get_time();
+		for (b = 0; b < BENCH_BLOCKS; b++)
+			audio_goertzel(goertzel, samples, BENCH_LENGTH, 0, single, k);
+		t_single = (get_time() - start) / BENCH_BLOCKS;
+		start = get_time();
+		for (b = 0; b < BENCH_BLOCKS; b++)
+			goertzel_bank(&bank, samples, 0, result);
+		t_bank = (get_time() - start) / BENCH_BLOCKS;
+		start = get_time();
+		for (b = 0; b < BENCH_BLOCKS; b++)
+			goertzel_slide(&slide, samples, BENCH_LENGTH, result);
+		t_slide = (get_time() - start) / BENCH_BLOCKS / BENCH_LENGTH;
+
+		printf("%2d  %11.2f  %9.2f  %6.1fx  %19.2f\n", k, t_single * 1e6, t_bank * 1e6, t_single / t_bank, t_slide * 1e9);
+
+		goertzel_slide_exit(&slide);
+		goertzel_bank_exit(&bank);
+	}
+
+	printf("bank results %s\n", (errors) ? "differ from single filters! FAILED!" : "equal single filters");
+}
+
+/* feed a tone that changes its frequency and show the level of the sliding filter */
+static void test_slide(sample_t *samples)
+{
+	goertzel_slide_t slide;
+	double freq[2] = { 1000.0, 1200.0 };
+	double result[2];
+	int i;
+
+	printf("\ntesting sliding goertzel with frequencies %.0f and %.0f Hz\n", freq[0], freq[1]);
+
+	goertzel_slide_init(&slide, freq, 2, SAMPLERATE, SAMPLERATE / 100);
+	gen_samples(samples, freq[0]);
+	for (i = 0; i < 5; i++) {
+		goertzel_slide(&slide, samples + i * SAMPLERATE / 200, SAMPLERATE / 200, result);
+		printf("%3d ms of %.0f Hz: %.0f Hz level=%.6f  %.0f Hz level=%.6f\n", (i + 1) * 5, freq[0], freq[0], result[0], freq[1], result[1]);
+	}
+	/* run for a long time to see if errors accumulate */
+	for (i = 0; i < 600; i++)
+		goertzel_slide(&slide, samples, SAMPLERATE, NULL);
+	goertzel_slide(&slide, samples, SAMPLERATE, result);
+	printf("after 10 minutes: %.0f Hz level=%.6f  %.0f Hz level=%.6f\n", freq[0], result[0], freq[1], result[1]);
+	gen_samples(samples, freq[1]);
+	for (i = 0; i < 3; i++) {
+		goertzel_slide(&slide, samples + i * SAMPLERATE / 200, SAMPLERATE / 200, result);
+		printf("%3d ms of %.0f Hz: %.0f Hz level=%.6f  %.0f Hz level=%.6f\n", (i + 1) * 5, freq[1], freq[0], result[0], freq[1], result[1]);
+	}
+	goertzel_slide_exit(&slide);
+}
+
 int num_kanal;
 
 int main(void)
@@ -46,6 +141,11 @@ int main(void)
 			printf("\n");
 	}
 
+	test_slide(samples);
+
+	gen_samples(samples, 1234.5);
+	bench_bank(samples);
+
 	return 0;
 }
 
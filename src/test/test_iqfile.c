@@ -0,0 +1,123 @@
+/* play back a recorded IQ file through the SDR layer and decode it
+ *
+ * test_iqfile_bnetz.cu8 holds the first 0.7 seconds of docs/bnetz.wav, FM
+ * modulated at 24000 samples/s, with the carrier 6 kHz above the center and
+ * 12.5 kHz deviation at full scale. The file is opened with the IQ file
+ * driver in free running mode, like --sdr-iq-rx and --sdr-iq-free-running
+ * do. The read thread of the SDR layer fills the ring buffer, the test waits
+ * on the descriptors of sdr_poll_fds() like the processing loop does, and
+ * reads demodulated samples with sdr_read(), until it reports the end of
+ * file. The B-Netz telegramms are decoded from the samples.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libfsk/fsk.h"
+#include "../libfm/fm.h"
+#include "../libsdr/sdr_config.h"
+#include "../libsdr/sdr.h"
+#include "../libmobile/sender.h"
+#include "bnetz_rx.h"
+
+#define CHUNK		240
+#define INTERVAL	10.0	/* ms */
+#define POLL_TIMEOUT	1000	/* ms, the file is read much faster */
+
+#define IQ_SAMPLERATE	24000
+#define IQ_DEVIATION	12500.0
+
+/* Single channels are placed one channel bandwidth (2 * (deviation +
+ * modulation)) above the center, so the channel is on the carrier. */
+#define MAX_DEVIATION	2000.0
+#define MAX_MODULATION	1000.0
+#define RX_FREQUENCY	(2.0 * (MAX_DEVIATION + MAX_MODULATION))
+
+int num_kanal = 1;
+int use_sdr = 1;
+
+/* no sender, so no measurements are displayed */
+sender_t *get_sender_by_empfangsfrequenz(double __attribute__((unused)) freq)
+{
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	void *sdr;
+	bnetz_rx_t bnetz;
+	struct pollfd pfd[1];
+	sample_t buffer[CHUNK], *samples[1] = { buffer };
+	double rx_frequency = RX_FREQUENCY;
+	int am = 0;
+	int i, num, got, cycles = 0;
+
+	if (argc < 2) {
+		printf("Usage: %s <cu8 IQ file>\n", argv[0]);
+		return 0;
+	}
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	fm_init(0);
+
+	sdr_config_init(0.0);
+	sdr_config->iqfile = 1;
+	sdr_config->iq_rx_file = argv[1];
+	sdr_config->iq_format = "cu8";
+	sdr_config->iq_free_running = 1;
+	sdr_config->samplerate = IQ_SAMPLERATE;
+	if (sdr_configure(IQ_SAMPLERATE) != 1)
+		return 1;
+
+	sdr = sdr_open(0, NULL, NULL, &rx_frequency, &am, 1, 0.0, IQ_SAMPLERATE, CHUNK, INTERVAL, MAX_DEVIATION, MAX_MODULATION, 0.0);
+	if (!sdr)
+		return 1;
+	if (bnetz_rx_init(&bnetz, IQ_SAMPLERATE) < 0)
+		return 1;
+	if (sdr_start(sdr) < 0)
+		return 1;
+
+	while (1) {
+		/* wait until samples of one interval are ready or end of file is reached */
+		num = sdr_poll_fds(sdr, pfd, 1);
+		if (num < 0) {
+			printf("No file descriptor to wait for (rc = %d)\n", num);
+			return 1;
+		}
+		if (num) {
+			if (poll(pfd, num, POLL_TIMEOUT) <= 0) {
+				printf("Timeout while waiting for IQ samples\n");
+				return 1;
+			}
+			if (!sdr_poll_revents(sdr, pfd, num))
+				continue;
+		}
+		got = sdr_read(sdr, samples, CHUNK, 1, NULL);
+		if (got == -EPERM)
+			break;
+		if (got < 0)
+			return 1;
+		/* demodulator gives the frequency offset in Hz */
+		for (i = 0; i < got; i++)
+			buffer[i] /= IQ_DEVIATION;
+		bnetz_rx_receive(&bnetz, buffer, got);
+		cycles++;
+	}
+
+	/* the number of cycles depends on the scheduling of the read thread, so it is not printed */
+	fprintf(stderr, "%d cycles\n", cycles);
+	printf("%.3f s of IQ samples, end of file reached\n", (double)bnetz.sample_count / IQ_SAMPLERATE);
+	printf("%d frames decoded\n", bnetz.frames);
+
+	bnetz_rx_exit(&bnetz);
+	sdr_close(sdr);
+	fm_exit();
+
+	return 0;
+}
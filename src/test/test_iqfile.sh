@@ -0,0 +1,21 @@
+#!/bin/sh
+
+# Play back the recorded IQ file with the IQ file driver and compare the
+# decoded frames with the reference output.
+
+srcdir=`dirname "$0"`
+
+if [ ! -x ./test_iqfile ]; then
+	echo "IQ file driver is not compiled, use --with-iqfile"
+	exit 0
+fi
+
+./test_iqfile "$srcdir/test_iqfile_bnetz.cu8" 2>/dev/null > test_iqfile_bnetz.out
+if diff -u "$srcdir/test_iqfile_bnetz.ref" test_iqfile_bnetz.out; then
+	echo "bnetz: ok"
+else
+	echo "bnetz: decoded frames differ from reference!"
+	exit 1
+fi
+
+exit 0
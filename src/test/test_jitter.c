@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "../liblogging/logging.h"
+#include "../libjitter/jitter.h"
+
+#define SAMPLERATE	8000
+#define FRAME		160
+#define FRAMES		10000
+
+static void save_frame(jitter_t *jb, uint16_t sequence)
+{
+	int16_t spl[FRAME];
+	jitter_frame_t *jf;
+	int i;
+
+	/* each sample holds its sequence number */
+	for (i = 0; i < FRAME; i++)
+		spl[i] = sequence;
+	jf = jitter_frame_alloc(jb, NULL, NULL, (uint8_t *)spl, sizeof(spl), 0, sequence, 12345 + sequence * FRAME, 1);
+	if (jf)
+		jitter_save(jb, jf);
+}
+
+int main(void)
+{
+	jitter_t jb;
+	int16_t spl[FRAME];
+	uint16_t order[4];
+	int i, j, expect, errors = 0, allocs = 0;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+
+	jitter_create(&jb, "test", SAMPLERATE, 0.060, 0.200, JITTER_FLAG_NONE);
+	/* unlock */
+	jitter_load_samples(&jb, (uint8_t *)spl, 1, sizeof(*spl), NULL, NULL);
+
+	/* save 4 frames in rotated order, then read 4 frames
+	 * each frame is also saved twice, so it must be dropped */
+	expect = -1;
+	for (i = 0; i < FRAMES; i += 4) {
+		for (j = 0; j < 4; j++)
+			order[j] = i + j;
+		for (j = 0; j < 4; j++) {
+			save_frame(&jb, order[(j + i / 4) % 4]);
+			save_frame(&jb, order[(j + i / 4) % 4]);
+		}
+		for (j = 0; j < 4; j++) {
+			jitter_load_samples(&jb, (uint8_t *)spl, FRAME, sizeof(*spl), NULL, NULL);
+			/* after the initial delay, the frames must be played in order */
+			if (expect < 0 && spl[FRAME - 1] > 0)
+				expect = spl[FRAME - 1];
+			if (expect >= 0) {
+				if (spl[0] != spl[FRAME - 1] || spl[0] != expect)
+					errors++;
+				expect++;
+			}
+		}
+		/* after 2 seconds, no memory must be allocated */
+		if (i == 100)
+			allocs = jb.alloc_count;
+	}
+	allocs = jb.alloc_count - allocs;
+	jitter_destroy(&jb);
+
+	printf("frames %s\n", (errors) ? "are not played in order! FAILED!" : "are played in order");
+	printf("memory allocations in steady state: %d%s\n", allocs, (allocs) ? " FAILED!" : "");
+
+	return 0;
+}
+
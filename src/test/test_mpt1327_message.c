@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include "../liblogging/logging.h"
+#include "../mpt1327/message.h"
+
+/* Encode every codeword type with all parameters cleared, set and random.
+ * Each codeword is decoded and encoded again, this must result in the same
+ * bits. The output is compared with test_mpt1327_message.ref, which was
+ * recorded with the bit by bit codeword coder that was used before.
+ */
+
+static uint64_t rand_state = 0x123456789abcdef;
+
+static uint64_t random64(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state;
+}
+
+static int decode(mpt1327_codeword_t *codeword, int specific, uint64_t bits)
+{
+	if (mpt1327_decode_codeword(codeword, specific, MPT_DOWN, bits) == 0)
+		return 0;
+	return mpt1327_decode_codeword(codeword, specific, MPT_UP, bits);
+}
+
+static int test_codeword(int type, const char *fill)
+{
+	mpt1327_codeword_t codeword, decoded;
+	uint64_t bits, again;
+	int p;
+
+	memset(&codeword, 0, sizeof(codeword));
+	codeword.type = type;
+	for (p = 0; p < _NUM_MPT_PARAMETERS; p++) {
+		if (!strcmp(fill, "ones"))
+			codeword.params[p] = ~0ULL;
+		else if (!strcmp(fill, "random"))
+			codeword.params[p] = random64();
+	}
+	bits = mpt1327_encode_codeword(&codeword);
+
+	if (decode(&decoded, type, bits) < 0) {
+		printf("type %d (%s): 0x%016" PRIx64 " cannot be decoded!\n", type, fill, bits);
+		return -1;
+	}
+	printf("%s %s: 0x%016" PRIx64 " ->", decoded.short_name, fill, bits);
+	for (p = 1; p < _NUM_MPT_PARAMETERS; p++) {
+		if (decoded.params[p])
+			printf(" %d=0x%" PRIx64, p, decoded.params[p]);
+	}
+	if (decode(&decoded, -1, bits) == 0)
+		printf(" (detected as %s)", decoded.short_name);
+	printf("\n");
+
+	/* encode decoded parameters again */
+	decode(&decoded, type, bits);
+	again = mpt1327_encode_codeword(&decoded);
+	if (again != bits) {
+		printf("type %d (%s): 0x%016" PRIx64 " encoded again to 0x%016" PRIx64 "!\n", type, fill, bits, again);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	int type, failed = 0;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	init_codeword();
+
+	for (type = 0; type < _NUM_MPT_DEFINITIONS; type++) {
+		failed |= test_codeword(type, "zeros");
+		failed |= test_codeword(type, "ones");
+		failed |= test_codeword(type, "random");
+	}
+
+	if (failed) {
+		printf("Codewords do not survive decoding and encoding!\n");
+		return 1;
+	}
+	printf("All codewords survive decoding and encoding.\n");
+
+	return 0;
+}
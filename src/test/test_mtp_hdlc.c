@@ -0,0 +1,262 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <osmocom/core/timer.h>
+#include "../liblogging/logging.h"
+#include "../libmtp/mtp.h"
+#include "../libmtp/crc16.h"
+
+#define MESSAGES	500
+#define STREAM_BYTES	50000
+#define BENCH_BYTES	2000000
+
+static uint8_t stream_bit[STREAM_BYTES], stream_block[STREAM_BYTES], bench[BENCH_BYTES];
+
+/* checksum over all frames that have been received */
+static uint32_t rx_sum;
+static int rx_frames;
+
+static void rx_add(int value)
+{
+	rx_sum = rx_sum * 31 + value;
+}
+
+static void receive_lssu(mtp_t __attribute__((unused)) *mtp, uint8_t fsn, uint8_t bib, uint8_t status)
+{
+	rx_add(fsn);
+	rx_add(bib);
+	rx_add(status);
+	rx_frames++;
+}
+
+static void receive_fisu(mtp_t __attribute__((unused)) *mtp, uint8_t bsn, uint8_t bib, uint8_t fsn, uint8_t fib)
+{
+	rx_add(bsn);
+	rx_add(bib);
+	rx_add(fsn);
+	rx_add(fib);
+	rx_frames++;
+}
+
+static void receive_msu(mtp_t __attribute__((unused)) *mtp, uint8_t bsn, uint8_t bib, uint8_t fsn, uint8_t fib, uint8_t sio, uint8_t *data, int len)
+{
+	int i;
+
+	rx_add(bsn);
+	rx_add(bib);
+	rx_add(fsn);
+	rx_add(fib);
+	rx_add(sio);
+	for (i = 0; i < len; i++)
+		rx_add(data[i]);
+	rx_frames++;
+}
+
+/* bit by bit CRC as it was used before */
+static uint16_t calc_crc16_bits(uint8_t *data, int length)
+{
+	uint16_t crc = 0xffff;
+	int i;
+
+	while (length--) {
+		for (i = 0; i < 8; i++) {
+			if ((crc ^ (*data >> i)) & 1)
+				crc = (crc >> 1) ^ 0x8408;
+			else
+				crc >>= 1;
+		}
+		data++;
+	}
+
+	return ~crc;
+}
+
+static double get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* create link in service with the same messages queued */
+static void init_sender(mtp_t *mtp)
+{
+	uint8_t data[60];
+	int i, j, len;
+
+	mtp_init(mtp, "test", NULL, NULL, 4800, 1, 0x83, 1, 2);
+	mtp->l2_state = MTP_L2STATE_IN_SERVICE;
+	mtp->tx_lssu = -1;
+	srandom(1);
+	for (i = 0; i < MESSAGES; i++) {
+		len = 1 + random() % sizeof(data);
+		/* many '1' bits, so bit stuffing is required */
+		for (j = 0; j < len; j++)
+			data[j] = (random() & 1) ? 0xff : random();
+		mtp_l3l2(mtp, MTP_PRIM_DATA, 0x83, data, len);
+	}
+}
+
+static void init_receiver(mtp_t *mtp)
+{
+	mtp_init(mtp, "test", NULL, NULL, 4800, 1, 0x83, 2, 1);
+}
+
+/* compare receiver states that are relevant for the next bits */
+static int compare_receiver(mtp_t *a, mtp_t *b)
+{
+	if (a->rx_byte_count != b->rx_byte_count
+	 || a->rx_bit_count != b->rx_bit_count
+	 || a->rx_receiving != b->rx_receiving
+	 || a->rx_stream != b->rx_stream
+	 || a->rx_octet_counting != b->rx_octet_counting
+	 || a->rx_octet_count != b->rx_octet_count
+	 || memcmp(a->rx_frame, b->rx_frame, a->rx_byte_count))
+		return -1;
+	if (a->rx_receiving && (a->rx_byte != b->rx_byte || a->rx_crc != b->rx_crc))
+		return -1;
+	return 0;
+}
+
+static void receive_bits(mtp_t *mtp, uint8_t *data, int len)
+{
+	int i, j;
+
+	for (i = 0; i < len; i++) {
+		for (j = 0; j < 8; j++)
+			mtp_receive_bit(mtp, (data[i] >> j) & 1);
+	}
+}
+
+int main(void)
+{
+	mtp_t tx_bit, tx_block, rx_bit, rx_block;
+	uint8_t data[300];
+	uint16_t crc;
+	uint32_t sum_bit;
+	int frames_bit;
+	int i, j, len, errors;
+	double start, t_bit, t_block;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+
+	func_mtp_receive_lssu = receive_lssu;
+	func_mtp_receive_fisu = receive_fisu;
+	func_mtp_receive_msu = receive_msu;
+
+	/* table CRC must equal bit by bit CRC, the residue must be constant */
+	srandom(1);
+	for (i = 0, errors = 0; i < 10000; i++) {
+		len = random() % 280;
+		for (j = 0; j < len; j++)
+			data[j] = random();
+		if (calc_crc16(data, len) != calc_crc16_bits(data, len))
+			errors++;
+		crc = calc_crc16(data, len);
+		data[len] = crc;
+		data[len + 1] = crc >> 8;
+		/* the CRC register is the inverted result */
+		crc = ~calc_crc16(data, len + 2);
+		if (crc != CRC16_GOOD)
+			errors++;
+	}
+	printf("table CRC %s\n", (errors) ? "differs from bit by bit CRC! FAILED!" : "equals bit by bit CRC");
+
+	/* transmit the same messages bit by bit and block by block
+	 * the blocks have random lengths and some bits are sent with mtp_send_bit() */
+	init_sender(&tx_bit);
+	init_sender(&tx_block);
+	for (i = 0; i < STREAM_BYTES; i++) {
+		for (j = 0, stream_bit[i] = 0; j < 8; j++)
+			stream_bit[i] |= mtp_send_bit(&tx_bit) << j;
+	}
+	for (i = 0; i < STREAM_BYTES; i += len) {
+		len = 1 + random() % 100;
+		if (len > STREAM_BYTES - i)
+			len = STREAM_BYTES - i;
+		if ((random() % 4)) {
+			mtp_send_block(&tx_block, stream_block + i, len);
+			continue;
+		}
+		for (len = 0; len < 3 && i + len < STREAM_BYTES; len++) {
+			for (j = 0, stream_block[i + len] = 0; j < 8; j++)
+				stream_block[i + len] |= mtp_send_bit(&tx_block) << j;
+		}
+	}
+	printf("transmitted block stream %s\n", (memcmp(stream_bit, stream_block, STREAM_BYTES)) ? "differs from bit stream! FAILED!" : "equals bit stream");
+	mtp_exit(&tx_bit);
+	mtp_exit(&tx_block);
+
+	/* receive the stream bit by bit and block by block, with bit errors and aborts */
+	for (i = 0; i < STREAM_BYTES; i++) {
+		if (random() % 200 == 0)
+			stream_bit[i] ^= 1 << (random() % 8);
+		if (random() % 2000 == 0)
+			stream_bit[i] = 0xff;
+	}
+	init_receiver(&rx_bit);
+	init_receiver(&rx_block);
+	rx_sum = 0;
+	rx_frames = 0;
+	receive_bits(&rx_bit, stream_bit, STREAM_BYTES);
+	sum_bit = rx_sum;
+	frames_bit = rx_frames;
+	rx_sum = 0;
+	rx_frames = 0;
+	for (i = 0, errors = 0; i < STREAM_BYTES; i += len) {
+		len = 1 + random() % 100;
+		if (len > STREAM_BYTES - i)
+			len = STREAM_BYTES - i;
+		mtp_receive_block(&rx_block, stream_bit + i, len);
+	}
+	errors = (rx_sum != sum_bit || rx_frames != frames_bit || compare_receiver(&rx_bit, &rx_block));
+	printf("received %d frames, block receiver %s\n", frames_bit, (errors) ? "differs from bit receiver! FAILED!" : "equals bit receiver");
+
+	/* random data must also give the same result */
+	for (i = 0; i < STREAM_BYTES; i++)
+		stream_block[i] = (random() & 1) ? 0x7e : random();
+	rx_sum = 0;
+	receive_bits(&rx_bit, stream_block, STREAM_BYTES);
+	sum_bit = rx_sum;
+	rx_sum = 0;
+	mtp_receive_block(&rx_block, stream_block, STREAM_BYTES);
+	errors = (rx_sum != sum_bit || compare_receiver(&rx_bit, &rx_block));
+	printf("random data: block receiver %s\n", (errors) ? "differs from bit receiver! FAILED!" : "equals bit receiver");
+	mtp_exit(&rx_bit);
+	mtp_exit(&rx_block);
+
+	/* measure bit rate of bit by bit and block processing */
+	init_sender(&tx_bit);
+	init_sender(&tx_block);
+	start = get_time();
+	for (i = 0; i < BENCH_BYTES; i++) {
+		for (j = 0, bench[i] = 0; j < 8; j++)
+			bench[i] |= mtp_send_bit(&tx_bit) << j;
+	}
+	t_bit = get_time() - start;
+	start = get_time();
+	mtp_send_block(&tx_block, bench, BENCH_BYTES);
+	t_block = get_time() - start;
+	printf("\nsend: bit by bit %.1f Mbit/s, block %.1f Mbit/s\n", BENCH_BYTES * 8 / t_bit / 1e6, BENCH_BYTES * 8 / t_block / 1e6);
+	mtp_exit(&tx_bit);
+	mtp_exit(&tx_block);
+
+	init_receiver(&rx_bit);
+	init_receiver(&rx_block);
+	start = get_time();
+	receive_bits(&rx_bit, bench, BENCH_BYTES);
+	t_bit = get_time() - start;
+	start = get_time();
+	mtp_receive_block(&rx_block, bench, BENCH_BYTES);
+	t_block = get_time() - start;
+	printf("receive: bit by bit %.1f Mbit/s, block %.1f Mbit/s\n", BENCH_BYTES * 8 / t_bit / 1e6, BENCH_BYTES * 8 / t_block / 1e6);
+	mtp_exit(&rx_bit);
+	mtp_exit(&rx_block);
+
+	return 0;
+}
+
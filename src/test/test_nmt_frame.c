@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libbitbuf/bitbuf.h"
+#include "../nmt/nmt.h"
+#include "../nmt/frame.h"
+
+/* Encode every message type with all parameters cleared, set and random.
+ * Each frame is decoded and encoded again, this must result in the same
+ * bits, unless the digits do not match any valid message type. The output
+ * is compared with test_nmt_frame.ref, which was recorded with the bit by bit
+ * frame coder that was used before.
+ */
+
+static uint64_t rand_state = 0x123456789abcdef;
+
+static uint64_t random64(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state;
+}
+
+const char *nmt_dir_name(enum nmt_direction __attribute__((unused)) dir)
+{
+	return "test";
+}
+
+static const char *frame_name(enum nmt_mt mt)
+{
+	if (mt == NMT_MESSAGE_UKN_MTX || mt == NMT_MESSAGE_UKN_BS_MS)
+		return "illegal";
+	return nmt_frame_name(mt);
+}
+
+static int test_frame(int nmt_system, enum nmt_mt mt, const char *fill)
+{
+	frame_t frame, decoded;
+	bitbuf_t bits, code, again;
+	char string[BITBUF_MAX + 1];
+	uint8_t *p;
+	size_t i;
+
+	memset(&frame, (!strcmp(fill, "ones")) ? 0xff : 0x00, sizeof(frame));
+	if (!strcmp(fill, "random")) {
+		for (i = 0, p = (uint8_t *)&frame; i < sizeof(frame); i++)
+			p[i] = random64();
+	}
+	frame.mt = mt;
+	encode_frame(nmt_system, &frame, &bits, 0);
+	printf("%d %s %s: %s", nmt_system, frame_name(mt), fill, bitbuf_string(&bits, 0, bits.length, string));
+
+	/* decode frame without sync, MTX_TO_XX and XX_TO_MTX cover both directions */
+	bitbuf_clear(&code);
+	bitbuf_append_buf(&code, &bits, 26, bits.length - 26);
+	decode_frame(nmt_system, &decoded, &code, MTX_TO_XX, 0);
+	encode_frame(nmt_system, &decoded, &again, 0);
+	if (memcmp(bits.word, again.word, sizeof(bits.word))) {
+		decode_frame(nmt_system, &decoded, &code, XX_TO_MTX, 0);
+		encode_frame(nmt_system, &decoded, &again, 0);
+	}
+	printf(" -> %s\n", frame_name(decoded.mt));
+	if (decoded.mt == NMT_MESSAGE_UKN_MTX || decoded.mt == NMT_MESSAGE_UKN_BS_MS)
+		return 0;
+	if (again.length != bits.length || memcmp(bits.word, again.word, sizeof(bits.word))) {
+		printf("%d %s %s: encoded again to %s!\n", nmt_system, frame_name(mt), fill, bitbuf_string(&again, 0, again.length, string));
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	int mt, failed = 0;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	init_frame();
+
+	for (mt = 0; mt <= NMT_MESSAGE_UKN_BS_MS; mt++) {
+		failed |= test_frame(450, mt, "zeros");
+		failed |= test_frame(450, mt, "ones");
+		failed |= test_frame(900, mt, "random");
+	}
+
+	if (failed) {
+		printf("Frames do not survive decoding and encoding!\n");
+		return 1;
+	}
+	printf("All frames survive decoding and encoding.\n");
+
+	return 0;
+}
@@ -1,11 +1,15 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <math.h>
 #include <string.h>
 #include <sys/time.h>
 #include "../libsample/sample.h"
 #include "../libfilter/iir_filter.h"
+#include "../libfilter/fir_filter.h"
 #include "../libfm/fm.h"
+#include "../libchannelizer/channelizer.h"
+#include "../libsamplerate/samplerate.h"
 #include "../liblogging/logging.h"
 
 struct timeval start_tv, tv;
@@ -34,8 +38,240 @@ uint8_t power[SAMPLES];
 float buff[SAMPLES * 2];
 fm_mod_t mod;
 fm_demod_t demod;
+fm_demod_stats_t demod_stats;
 iir_filter_t lp;
 
+#define IQ_SAMPLERATE	1000000.0
+#define IQ_SAMPLES	10000
+#define IQ_SPACING	12500.0
+#define IQ_BANDWIDTH	16000.0
+#define IQ_MODULATION	3000.0
+float iq_buff[IQ_SAMPLES * 2];
+sample_t iq_samples[IQ_SAMPLES], iq_narrow[IQ_SAMPLES], iq_I[IQ_SAMPLES], iq_Q[IQ_SAMPLES];
+fm_demod_stats_t iq_stats;
+uint8_t iq_power[IQ_SAMPLES];
+
+/* filter I and Q of a baseband with each kernel variant */
+static void iq_filter_performance(int iterations)
+{
+	iir_filter_t lp_i, lp_q;
+	enum iir_kernel kernel;
+	char text[64];
+
+	iir_lowpass_init(&lp_i, IQ_BANDWIDTH / 2.0, IQ_SAMPLERATE, iterations);
+	iir_lowpass_init(&lp_q, IQ_BANDWIDTH / 2.0, IQ_SAMPLERATE, iterations);
+	for (kernel = IIR_KERNEL_SCALAR; kernel <= IIR_KERNEL_FLOAT; kernel++) {
+		if (iir_kernel_select(kernel) < 0) {
+			printf("IQ low-pass filter (order %d, %s): not supported by CPU\n", iterations * 2, iir_kernel_name(kernel));
+			continue;
+		}
+		sprintf(text, "IQ low-pass filter (order %d, %s)", iterations * 2, iir_kernel_name(kernel));
+		T_START()
+		iir_process_iq(&lp_i, &lp_q, iq_buff, IQ_SAMPLES);
+		T_STOP(text, IQ_SAMPLES)
+	}
+	iir_kernel_select(IIR_KERNEL_AUTO);
+}
+
+/* modulate with ramps and measure the error against exact phase and sin/cos */
+static void fm_mod_performance(void)
+{
+	double phase = 0.0, error, max_error = 0.0;
+	int i, n;
+
+	for (i = 0; i < SAMPLES; i++)
+		samples[i] = 3000.0 * sin(2.0 * M_PI * 1000.0 / 50000.0 * i);
+
+	/* transmitter is turned off and on every 200 samples */
+	for (i = 0; i < SAMPLES; i++)
+		power[i] = (i % 400) < 200;
+	fm_mod_init(&mod, 50000, 1000.0, 0.333);
+	T_START()
+	fm_modulate_complex(&mod, samples, power, SAMPLES, buff);
+	T_STOP("FM modulate (with ramps)", SAMPLES)
+	fm_mod_exit(&mod);
+	memset(power, 1, sizeof(power));
+
+	fm_mod_init(&mod, 50000, 1000.0, 1.0);
+	for (n = 0; n < 1000; n++) {
+		memset(buff, 0, sizeof(buff));
+		fm_modulate_complex(&mod, samples, power, SAMPLES, buff);
+		for (i = 0; i < SAMPLES; i++) {
+			phase += 2.0 * M_PI * (1000.0 + samples[i]) / 50000.0;
+			/* skip ramp */
+			if (n == 0 && i < mod.ramp_length)
+				continue;
+			error = hypot(buff[i * 2] - cos(phase), buff[i * 2 + 1] - sin(phase));
+			if (error > max_error)
+				max_error = error;
+		}
+	}
+	fm_mod_exit(&mod);
+	printf("FM modulate: error after %d samples is %.1f dB\n", n * SAMPLES, 20.0 * log10(max_error));
+}
+
+/* compare direct FIR filter with FFT FIR filter of different block sizes */
+static void fir_performance(double transition_bandwidth)
+{
+	fir_filter_t *fir;
+	fir_fft_t *fft;
+	char text[64];
+	int block;
+
+	fir = fir_lowpass_init(50000, 5000.0, transition_bandwidth);
+	sprintf(text, "FIR low-pass filter (%d taps, direct)", fir->ntaps);
+	T_START()
+	fir_process(fir, samples, SAMPLES);
+	T_STOP(text, SAMPLES)
+	for (block = 0; block <= 64; block = (block) ? block * 4 : 16) {
+		fft = fir_fft_init(fir, block);
+		sprintf(text, "FIR low-pass filter (%d taps, FFT block %d)", fir->ntaps, fft->block);
+		T_START()
+		fir_fft_process(fft, samples, SAMPLES);
+		T_STOP(text, SAMPLES)
+		fir_fft_exit(fft);
+	}
+	fir_exit(fir);
+}
+
+/* compare demodulation of all channels at IQ rate with channelizer, demodulation at channel rate and interpolation to IQ rate */
+static void channelizer_performance(int channels)
+{
+	fm_demod_t *demods;
+	samplerate_t *interpolators;
+	channelizer_t chan;
+	int bin[channels];
+	float *narrowband[channels];
+	double offset, residual;
+	char text[64];
+	int c, num;
+
+	demods = calloc(channels, sizeof(*demods));
+	interpolators = calloc(channels, sizeof(*interpolators));
+	for (c = 0; c < channels; c++) {
+		offset = ((double)c - (double)channels / 2.0) * IQ_SPACING;
+		fm_demod_init(&demods[c], IQ_SAMPLERATE, offset, IQ_BANDWIDTH);
+	}
+	sprintf(text, "FM demodulate %d channels (mixing)", channels);
+	T_START()
+	for (c = 0; c < channels; c++)
+		fm_demodulate_complex_fused(&demods[c], iq_samples, IQ_SAMPLES, iq_buff, &iq_stats);
+	T_STOP(text, IQ_SAMPLES)
+	for (c = 0; c < channels; c++)
+		fm_demod_exit(&demods[c]);
+
+	channelizer_init(&chan, IQ_SAMPLERATE, IQ_BANDWIDTH);
+	for (c = 0; c < channels; c++) {
+		offset = ((double)c - (double)channels / 2.0) * IQ_SPACING;
+		bin[c] = channelizer_bin(&chan, offset, &residual);
+		fm_demod_init(&demods[c], channelizer_samplerate(&chan), residual, IQ_BANDWIDTH);
+		init_samplerate(&interpolators[c], channelizer_samplerate(&chan), IQ_SAMPLERATE, IQ_MODULATION);
+		narrowband[c] = calloc((IQ_SAMPLES / chan.decimation + 1) * 2, sizeof(*narrowband[c]));
+	}
+	sprintf(text, "FM demodulate %d channels (channelizer)", channels);
+	T_START()
+	num = channelizer_process(&chan, iq_buff, IQ_SAMPLES, bin, narrowband, channels);
+	for (c = 0; c < channels; c++) {
+		fm_demodulate_complex_fused(&demods[c], iq_narrow, num, narrowband[c], &iq_stats);
+		samplerate_upsample(&interpolators[c], iq_narrow, num, iq_samples, samplerate_upsample_output_num(&interpolators[c], num));
+	}
+	T_STOP(text, IQ_SAMPLES)
+	for (c = 0; c < channels; c++) {
+		fm_demod_exit(&demods[c]);
+		exit_samplerate(&interpolators[c]);
+		free(narrowband[c]);
+	}
+	channelizer_exit(&chan);
+
+	free(interpolators);
+	free(demods);
+}
+
+/* compare demodulation of one channel at IQ rate with decimation and demodulation at channel rate */
+static void decimator_performance(double samplerate)
+{
+	decimator_t dec;
+	float narrowband[(IQ_SAMPLES / 2 + 1) * 2];
+	char text[64];
+	int num;
+
+	fm_demod_init(&demod, samplerate, IQ_SPACING, IQ_BANDWIDTH);
+	sprintf(text, "FM demodulate at %.0f MS/s (mixing)", samplerate / 1e6);
+	T_START()
+	fm_demodulate_complex_fused(&demod, iq_samples, IQ_SAMPLES, iq_buff, &demod_stats);
+	T_STOP(text, IQ_SAMPLES)
+	printf("CPU per channel: %.1f %%\n", samplerate / ((double)tot_samples / duration) * 100.0);
+	fm_demod_exit(&demod);
+
+	decimator_init(&dec, samplerate, IQ_SPACING, IQ_BANDWIDTH, IQ_SAMPLES, 0);
+	fm_demod_init(&demod, decimator_samplerate(&dec), 0.0, IQ_BANDWIDTH);
+	sprintf(text, "FM demodulate at %.0f MS/s (decimator by %d)", samplerate / 1e6, dec.decimation);
+	T_START()
+	num = decimator_process(&dec, iq_buff, IQ_SAMPLES, narrowband);
+	fm_demodulate_complex_fused(&demod, iq_samples, num, narrowband, &demod_stats);
+	T_STOP(text, IQ_SAMPLES)
+	printf("CPU per channel: %.1f %%\n", samplerate / ((double)tot_samples / duration) * 100.0);
+	fm_demod_exit(&demod);
+	decimator_exit(&dec);
+}
+
+/* compare modulation of all channels at IQ rate with decimation, modulation at channel rate and combiner */
+static void combiner_performance(int channels)
+{
+	fm_mod_t *mods;
+	samplerate_t *decimators;
+	combiner_t comb;
+	int bin[channels];
+	float *narrowband[channels];
+	double offset, residual;
+	char text[64];
+	int c, num;
+
+	mods = calloc(channels, sizeof(*mods));
+	decimators = calloc(channels, sizeof(*decimators));
+	for (c = 0; c < channels; c++) {
+		offset = ((double)c - (double)channels / 2.0) * IQ_SPACING;
+		fm_mod_init(&mods[c], IQ_SAMPLERATE, offset, 1.0 / (double)channels);
+	}
+	sprintf(text, "FM modulate %d channels (mixing)", channels);
+	T_START()
+	memset(iq_buff, 0, sizeof(iq_buff));
+	for (c = 0; c < channels; c++)
+		fm_modulate_complex(&mods[c], iq_samples, iq_power, IQ_SAMPLES, iq_buff);
+	T_STOP(text, IQ_SAMPLES)
+	for (c = 0; c < channels; c++)
+		fm_mod_exit(&mods[c]);
+
+	combiner_init(&comb, IQ_SAMPLERATE, IQ_BANDWIDTH, IQ_SAMPLES);
+	for (c = 0; c < channels; c++) {
+		offset = ((double)c - (double)channels / 2.0) * IQ_SPACING;
+		bin[c] = combiner_bin(&comb, offset, &residual);
+		fm_mod_init(&mods[c], combiner_samplerate(&comb), residual, 1.0 / (double)channels);
+		init_samplerate(&decimators[c], combiner_samplerate(&comb), IQ_SAMPLERATE, IQ_MODULATION);
+		narrowband[c] = calloc((IQ_SAMPLES / comb.interpolation + 1) * 2, sizeof(*narrowband[c]));
+	}
+	sprintf(text, "FM modulate %d channels (combiner)", channels);
+	T_START()
+	num = combiner_input_num(&comb, IQ_SAMPLES);
+	for (c = 0; c < channels; c++) {
+		/* samples are decimated in place, like sdr_write() does */
+		samplerate_downsample(&decimators[c], iq_samples, IQ_SAMPLES);
+		memset(narrowband[c], 0, num * 2 * sizeof(*narrowband[c]));
+		fm_modulate_complex(&mods[c], iq_samples, iq_power, num, narrowband[c]);
+	}
+	combiner_process(&comb, narrowband, bin, channels, num, iq_buff, IQ_SAMPLES);
+	T_STOP(text, IQ_SAMPLES)
+	for (c = 0; c < channels; c++) {
+		fm_mod_exit(&mods[c]);
+		exit_samplerate(&decimators[c]);
+		free(narrowband[c]);
+	}
+	combiner_exit(&comb);
+
+	free(decimators);
+	free(mods);
+}
+
 int main(void)
 {
 	memset(power, 1, sizeof(power));
@@ -54,6 +290,12 @@ int main(void)
 	T_STOP("FM demodulate", SAMPLES)
 	fm_demod_exit(&demod);
 
+	fm_demod_init(&demod, 50000, 1000.0, 10000.0);
+	T_START()
+	fm_demodulate_complex_fused(&demod, samples, SAMPLES, buff, &demod_stats);
+	T_STOP("FM demodulate (fused)", SAMPLES)
+	fm_demod_exit(&demod);
+
 	fm_exit();
 	fm_init(1);
 
@@ -63,6 +305,8 @@ int main(void)
 	T_STOP("FM modulate (fast math)", SAMPLES)
 	fm_mod_exit(&mod);
 
+	fm_mod_performance();
+
 	fm_demod_init(&demod, 50000, 0, 10000.0);
 	T_START()
 	fm_demodulate_complex(&demod, samples, SAMPLES, buff, I, Q);
@@ -84,6 +328,33 @@ int main(void)
 	iir_process(&lp, samples, SAMPLES);
 	T_STOP("low-pass filter (eighth order)", SAMPLES)
 
+	fir_performance(500.0);
+	fir_performance(50.0);
+
+	iq_filter_performance(1);
+	iq_filter_performance(2);
+	iq_filter_performance(4);
+
+	channelizer_performance(1);
+	channelizer_performance(2);
+	channelizer_performance(4);
+	channelizer_performance(8);
+	channelizer_performance(16);
+	channelizer_performance(64);
+
+	decimator_performance(1e6);
+	decimator_performance(2e6);
+	decimator_performance(5e6);
+	decimator_performance(10e6);
+
+	memset(iq_power, 1, sizeof(iq_power));
+	combiner_performance(1);
+	combiner_performance(4);
+	combiner_performance(8);
+	combiner_performance(16);
+	combiner_performance(32);
+	combiner_performance(64);
+
 	fm_exit();
 
 	return 0;
@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../pocsag/pocsag.h"
+#include "../pocsag/frame.h"
+
+/* Queue a message and let the scheduler encode codewords until the
+ * transmitter turns off. Each codeword is printed and fed back into the
+ * receiver, which must return the same message. The output is compared with
+ * test_pocsag_frame.ref, which was recorded with the bit by bit encoder and
+ * decoder that were used before.
+ */
+
+const char *pocsag_function_name[4] = {
+	"numeric",
+	"beep1",
+	"beep2",
+	"alphanumeric",
+};
+
+static const char *expect_text;
+static uint32_t expect_ric;
+static enum pocsag_function expect_function;
+static char received_text[1024];
+static int received, failed;
+
+void pocsag_new_state(pocsag_t *pocsag, enum pocsag_state new_state)
+{
+	pocsag->state = new_state;
+}
+
+void pocsag_msg_destroy(pocsag_msg_t *msg)
+{
+	pocsag_msg_t **msgp;
+
+	msgp = &msg->pocsag->msg_list;
+	while ((*msgp) != msg)
+		msgp = &(*msgp)->next;
+	(*msgp) = msg->next;
+	if (msg == msg->pocsag->current_msg)
+		msg->pocsag->current_msg = NULL;
+	free(msg);
+}
+
+void pocsag_msg_done(pocsag_t __attribute__((unused)) *pocsag)
+{
+}
+
+void pocsag_msg_receive(enum pocsag_language __attribute__((unused)) language, const char __attribute__((unused)) *channel, uint32_t ric, enum pocsag_function function, const char *message)
+{
+	/* print after the batch, so the codewords are not interrupted */
+	snprintf(received_text, sizeof(received_text), "received RIC %u function %s: \"%s\"\n", ric, pocsag_function_name[function], message);
+	received++;
+	if (ric != expect_ric || function != expect_function || strncmp(message, expect_text, strlen(expect_text))) {
+		printf("Received message differs from transmitted message!\n");
+		failed = 1;
+	}
+}
+
+static void test_message(uint32_t ric, enum pocsag_function function, const char *text)
+{
+	pocsag_t *pocsag;
+	pocsag_msg_t *msg;
+	int64_t word;
+	int word_count;
+
+	printf("transmit RIC %u function %s: \"%s\"\n", ric, pocsag_function_name[function], text);
+
+	pocsag = calloc(1, sizeof(*pocsag));
+	pocsag->sender.kanal = "test";
+	pocsag->tx = 1;
+	pocsag->state = POCSAG_MESSAGE;
+	msg = calloc(1, sizeof(*msg));
+	msg->pocsag = pocsag;
+	msg->ric = ric;
+	msg->function = function;
+	msg->data_length = strlen(text);
+	memcpy(msg->data, text, msg->data_length);
+	msg->padding = 0x04;
+	pocsag->msg_list = msg;
+
+	expect_ric = ric;
+	expect_function = function;
+	expect_text = (function == POCSAG_FUNCTION_NUMERIC || function == POCSAG_FUNCTION_ALPHA) ? text : "";
+	received = 0;
+
+	while (pocsag->state != POCSAG_IDLE) {
+		word_count = pocsag->word_count;
+		word = get_codeword(pocsag);
+		if (word < 0)
+			break;
+		printf("%s%08x", (word_count) ? " " : "", (uint32_t)word);
+		if (word_count == 16)
+			printf("\n");
+		if (!word_count)
+			put_codeword(pocsag, word, -1, -1);
+		else
+			put_codeword(pocsag, word, (word_count - 1) >> 1, (word_count - 1) & 1);
+	}
+
+	printf("%s", received_text);
+	if (received != 1) {
+		printf("Received %d messages, expecting one!\n", received);
+		failed = 1;
+	}
+
+	free(pocsag);
+}
+
+int main(void)
+{
+	loglevel = LOGL_ERROR;
+	logging_init();
+
+	test_message(1234567, POCSAG_FUNCTION_NUMERIC, "0123456789");
+	test_message(1234568, POCSAG_FUNCTION_NUMERIC, "U-[] 42");
+	test_message(8, POCSAG_FUNCTION_BEEP1, "");
+	test_message(17, POCSAG_FUNCTION_BEEP2, "");
+	test_message(12, POCSAG_FUNCTION_ALPHA, "Hello World!");
+	test_message(2097151, POCSAG_FUNCTION_ALPHA, "A");
+	test_message(815, POCSAG_FUNCTION_ALPHA, "The quick brown fox jumps over the lazy dog. 0123456789 ~!@#$%^&*()_+{}|:\"<>?`-=[]\\;',./ THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG.");
+
+	if (failed) {
+		printf("Messages do not survive encoding and decoding!\n");
+		return 1;
+	}
+	printf("All messages survive encoding and decoding.\n");
+
+	return 0;
+}
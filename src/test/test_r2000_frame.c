@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "../liblogging/logging.h"
+#include "../libbitbuf/bitbuf.h"
+#include "../libhagelbarger/hagelbarger.h"
+#include "../r2000/frame.h"
+
+/* Encode every message type from relais to mobile with all elements cleared,
+ * set and random. Each frame is decoded and encoded again, this must result
+ * in the same bits. Random frames from mobile to relais are decoded. The
+ * output is compared with test_r2000_frame.ref, which was recorded with the
+ * bit by bit frame coder that was used before.
+ */
+
+static uint64_t rand_state = 0x123456789abcdef;
+
+static uint64_t random64(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state;
+}
+
+static void print_frame(frame_t *frame)
+{
+	int i;
+
+	printf(" V=%d C=%d R=%d M=%d D=%d I=%d P=%d T=%d t=%d r=%d f=%d m=%d d=%d a=%d c=%d s=%d i=%d n=%d digits=", frame->voie, frame->channel, frame->relais, frame->message, frame->deport, frame->agi, frame->sm_power, frame->taxe, frame->sm_type, frame->sm_relais, frame->sm_flotte, frame->sm_mor, frame->sm_mop_demandee, frame->chan_assign, frame->crins, frame->sequence, frame->invitation, frame->nconv);
+	for (i = 0; i < 10; i++)
+		printf("%x", frame->digit[i]);
+	printf("\n");
+}
+
+static int test_encode(int message, const char *fill)
+{
+	frame_t frame, decoded;
+	bitbuf_t bits, code, again;
+	char string[BITBUF_MAX + 1];
+	uint8_t *p;
+	size_t i;
+
+	memset(&frame, (!strcmp(fill, "ones")) ? 0xff : 0x00, sizeof(frame));
+	if (!strcmp(fill, "random")) {
+		for (i = 0, p = (uint8_t *)&frame; i < sizeof(frame); i++)
+			p[i] = random64();
+	}
+	frame.message = message;
+	encode_frame(&frame, &bits, 0);
+	printf("%s %s: %s\n", r2000_frame_name(message, REL_TO_SM), fill, bitbuf_string(&bits, 0, bits.length, string));
+
+	/* decode frame without sync */
+	bitbuf_clear(&code);
+	bitbuf_append_buf(&code, &bits, 32, bits.length - 32);
+	if (decode_frame(&decoded, &code) < 0) {
+		printf("%s %s: cannot be decoded!\n", r2000_frame_name(message, REL_TO_SM), fill);
+		return -1;
+	}
+	print_frame(&decoded);
+	encode_frame(&decoded, &again, 0);
+	if (again.length != bits.length || memcmp(bits.word, again.word, sizeof(bits.word))) {
+		printf("%s %s: encoded again to %s!\n", r2000_frame_name(message, REL_TO_SM), fill, bitbuf_string(&again, 0, again.length, string));
+		return -1;
+	}
+
+	return 0;
+}
+
+static void test_decode(int message)
+{
+	frame_t decoded;
+	bitbuf_t bits;
+	uint8_t data[9], code[19];
+	uint64_t value;
+	char string[BITBUF_MAX + 1];
+	int i;
+
+	/* random elements with given message type, followed by 8 tail bits */
+	value = random64();
+	value = (value & ~(0x1fULL << 40)) | ((uint64_t)message << 40);
+	for (i = 0; i < 8; i++)
+		data[i] = value >> (56 - i * 8);
+	data[8] = 0x00;
+	hagelbarger_encode(data, code, 72);
+	bitbuf_clear(&bits);
+	bitbuf_append_bytes(&bits, code, 144);
+	printf("%s: %s\n", r2000_frame_name(message, SM_TO_REL), bitbuf_string(&bits, 0, bits.length, string));
+	if (decode_frame(&decoded, &bits) < 0) {
+		printf(" not decoded\n");
+		return;
+	}
+	print_frame(&decoded);
+}
+
+int main(void)
+{
+	int message, failed = 0;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+
+	for (message = 0; message < 32; message++) {
+		if (!strncmp(r2000_frame_name(message, REL_TO_SM), "UNKNOWN", 7))
+			continue;
+		failed |= test_encode(message, "zeros");
+		failed |= test_encode(message, "ones");
+		failed |= test_encode(message, "random");
+	}
+
+	for (message = 0; message < 32; message++) {
+		if (!strncmp(r2000_frame_name(message, SM_TO_REL), "UNKNOWN", 7))
+			continue;
+		test_decode(message);
+	}
+
+	if (failed) {
+		printf("Frames do not survive decoding and encoding!\n");
+		return 1;
+	}
+	printf("All frames survive decoding and encoding.\n");
+
+	return 0;
+}
@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include "../libringbuffer/ringbuffer.h"
+
+#define STRESS_ELEMENTS	50000000
+#define LATENCY_EVENTS	500
+
+static ringbuffer_t rb;
+static int errors;
+
+static double get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* write sequence numbers in chunks of different size, using copy and span functions */
+static void *stress_producer(void __attribute__((unused)) *arg)
+{
+	uint32_t chunk[777], *data;
+	uint32_t seq = 0;
+	int i, num, span;
+
+	while (seq < STRESS_ELEMENTS) {
+		num = (seq % 777) + 1;
+		if (num > STRESS_ELEMENTS - (int)seq)
+			num = STRESS_ELEMENTS - seq;
+		if ((seq & 1)) {
+			for (i = 0; i < num; i++)
+				chunk[i] = seq + i;
+			num = ringbuffer_write(&rb, chunk, num);
+		} else {
+			span = ringbuffer_write_span(&rb, (void **)&data);
+			if (num > span)
+				num = span;
+			for (i = 0; i < num; i++)
+				data[i] = seq + i;
+			ringbuffer_write_commit(&rb, num);
+		}
+		seq += num;
+		if (!num)
+			ringbuffer_wait_write(&rb, 1, 1);
+	}
+
+	return NULL;
+}
+
+/* read and check sequence numbers */
+static void stress_consumer(void)
+{
+	uint32_t chunk[555], *data;
+	uint32_t seq = 0;
+	int i, num;
+
+	while (seq < STRESS_ELEMENTS) {
+		if ((seq & 1)) {
+			num = ringbuffer_read(&rb, chunk, (seq % 555) + 1);
+			data = chunk;
+		} else
+			num = ringbuffer_read_span(&rb, (void **)&data);
+		for (i = 0; i < num; i++) {
+			if (data[i] != seq + i) {
+				if (errors++ < 10)
+					printf("Sequence error: got %u, expected %u\n", data[i], seq + i);
+			}
+		}
+		if (!(seq & 1))
+			ringbuffer_read_commit(&rb, num);
+		seq += num;
+		if (!num)
+			ringbuffer_wait_read(&rb, 1, 1);
+	}
+}
+
+static void stress(int flags, int size)
+{
+	pthread_t tid;
+	double start, duration;
+
+	ringbuffer_init(&rb, size, sizeof(uint32_t), flags);
+	errors = 0;
+	start = get_time();
+	pthread_create(&tid, NULL, stress_producer, NULL);
+	stress_consumer();
+	pthread_join(tid, NULL);
+	duration = get_time() - start;
+	printf("%s, %d elements: %.1f mega elements/sec, %d errors%s\n", (flags & RINGBUFFER_WAKEUP) ? "eventfd" : "sleep", size, (double)STRESS_ELEMENTS / duration / 1e6, errors, (errors) ? " FAILED!" : "");
+	ringbuffer_exit(&rb);
+}
+
+/* write the current time every 2 ms */
+static void *latency_producer(void __attribute__((unused)) *arg)
+{
+	double now;
+	int i;
+
+	for (i = 0; i < LATENCY_EVENTS; i++) {
+		usleep(2000);
+		now = get_time();
+		ringbuffer_write(&rb, &now, 1);
+	}
+
+	return NULL;
+}
+
+static void latency(int flags, int timeout_ms)
+{
+	pthread_t tid;
+	double sent, now, delay, sum = 0.0, max = 0.0;
+	int i;
+
+	ringbuffer_init(&rb, 16, sizeof(double), flags);
+	pthread_create(&tid, NULL, latency_producer, NULL);
+	for (i = 0; i < LATENCY_EVENTS; ) {
+		if (!ringbuffer_wait_read(&rb, 1, timeout_ms))
+			continue;
+		now = get_time();
+		while (ringbuffer_read(&rb, &sent, 1)) {
+			delay = now - sent;
+			sum += delay;
+			if (delay > max)
+				max = delay;
+			i++;
+		}
+	}
+	pthread_join(tid, NULL);
+	printf("%s, timeout %d ms: average wake-up latency %.1f us, maximum %.1f us\n", (flags & RINGBUFFER_WAKEUP) ? "eventfd" : "sleep", timeout_ms, sum / LATENCY_EVENTS * 1e6, max * 1e6);
+	ringbuffer_exit(&rb);
+}
+
+/* wait by polling the eventfd, as done by a select loop */
+static void latency_poll(void)
+{
+	pthread_t tid;
+	struct pollfd pfd;
+	double sent, now, delay, sum = 0.0, max = 0.0;
+	int i;
+
+	ringbuffer_init(&rb, 16, sizeof(double), RINGBUFFER_WAKEUP);
+	pthread_create(&tid, NULL, latency_producer, NULL);
+	for (i = 0; i < LATENCY_EVENTS; ) {
+		if (!ringbuffer_arm_read(&rb, 1)) {
+			pfd.fd = ringbuffer_data_fd(&rb);
+			pfd.events = POLLIN;
+			poll(&pfd, 1, 100);
+			ringbuffer_disarm_read(&rb);
+		}
+		now = get_time();
+		while (ringbuffer_read(&rb, &sent, 1)) {
+			delay = now - sent;
+			sum += delay;
+			if (delay > max)
+				max = delay;
+			i++;
+		}
+	}
+	pthread_join(tid, NULL);
+	printf("eventfd, polled: average wake-up latency %.1f us, maximum %.1f us\n", sum / LATENCY_EVENTS * 1e6, max * 1e6);
+	ringbuffer_exit(&rb);
+}
+
+int main(void)
+{
+	printf("testing ring buffer throughput\n");
+
+	stress(0, 65536);
+	stress(RINGBUFFER_WAKEUP, 1024);
+	stress(RINGBUFFER_WAKEUP, 65536);
+
+	printf("testing ring buffer wake-up latency\n");
+
+	latency(0, 1);
+	latency(0, 10);
+	latency(RINGBUFFER_WAKEUP, 10);
+	latency(RINGBUFFER_WAKEUP, 100);
+	latency_poll();
+
+	return 0;
+}
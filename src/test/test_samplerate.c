@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libsamplerate/samplerate.h"
+
+#define CHUNKS		1000
+#define TONE_SECONDS	2
+#define BENCH_SECONDS	20
+
+static const char *quality_name[] = { "low", "medium", "high" };
+
+static double get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* process random chunks and check that the calculated numbers match the processed numbers */
+static int check_numbers(double low, double high)
+{
+	samplerate_t state;
+	static sample_t samples[20000];
+	int i, num, out, in, errors = 0;
+
+	init_samplerate(&state, low, high, 3400.0);
+	for (i = 0; i < CHUNKS; i++) {
+		/* downsample: given input, expect output */
+		num = random() % 10000;
+		out = samplerate_downsample_output_num(&state, num);
+		if (samplerate_downsample(&state, samples, num) != out)
+			errors++;
+		/* downsample: given output, expect input */
+		out = random() % 1000;
+		in = samplerate_downsample_input_num(&state, out);
+		if (samplerate_downsample_output_num(&state, in) != out)
+			errors++;
+		/* upsample: fails, if input does not match output */
+		num = random() % 10000;
+		in = samplerate_upsample_input_num(&state, num);
+		if (samplerate_upsample(&state, samples, in, samples, num) < 0)
+			errors++;
+		num = random() % 1000;
+		out = samplerate_upsample_output_num(&state, num);
+		if (samplerate_upsample(&state, samples, num, samples + num, out) < 0)
+			errors++;
+	}
+	exit_samplerate(&state);
+
+	return errors;
+}
+
+/* equal rates pass samples unchanged, wrong number of input samples is rejected */
+static int check_bypass(void)
+{
+	samplerate_t state;
+	sample_t samples[160], copy[160];
+	int i, errors = 0;
+
+	for (i = 0; i < 160; i++)
+		samples[i] = copy[i] = sin(2.0 * M_PI * 1000.0 / 8000.0 * i);
+	init_samplerate(&state, 8000.0, 8000.0, 3400.0);
+	if (samplerate_downsample_output_num(&state, 160) != 160 || samplerate_downsample(&state, samples, 160) != 160)
+		errors++;
+	if (samplerate_upsample_input_num(&state, 160) != 160 || samplerate_upsample(&state, samples, 160, samples, 160) < 0)
+		errors++;
+	if (memcmp(samples, copy, sizeof(samples)))
+		errors++;
+	exit_samplerate(&state);
+
+	init_samplerate(&state, 8000.0, 48000.0, 3400.0);
+	if (samplerate_upsample(&state, samples, 10, samples, 160) != -EINVAL)
+		errors++;
+	exit_samplerate(&state);
+
+	return errors;
+}
+
+/* return RMS of samples after removing the given tone */
+static double residual(sample_t *samples, int num, double frequency, double samplerate, double *tone)
+{
+	double si = 0.0, co = 0.0, x, sum = 0.0;
+	int i;
+
+	for (i = 0; i < num; i++) {
+		si += samples[i] * sin(2.0 * M_PI * frequency / samplerate * i);
+		co += samples[i] * cos(2.0 * M_PI * frequency / samplerate * i);
+	}
+	si = si * 2.0 / num;
+	co = co * 2.0 / num;
+	*tone = sqrt((si * si + co * co) / 2.0);
+	for (i = 0; i < num; i++) {
+		x = samples[i] - si * sin(2.0 * M_PI * frequency / samplerate * i) - co * cos(2.0 * M_PI * frequency / samplerate * i);
+		sum += x * x;
+	}
+
+	return sqrt(sum / num);
+}
+
+/* measure alias rejection of downsampling and image rejection of upsampling */
+static void rejection(double low, double high, enum samplerate_quality quality, double *alias, double *image)
+{
+	samplerate_t state;
+	sample_t *in, *out;
+	int i, num, skip, in_num, out_num;
+	double tone, level;
+
+	in_num = (int)(high * TONE_SECONDS);
+	in = calloc(in_num, sizeof(*in));
+	out = calloc(in_num, sizeof(*out));
+
+	/* a tone above the low sample rate's nyquist frequency mirrors into the pass band */
+	init_samplerate_quality(&state, low, high, 3400.0, quality);
+	for (i = 0; i < in_num; i++)
+		in[i] = sin(2.0 * M_PI * (low - 3000.0) / high * i);
+	num = samplerate_downsample(&state, in, in_num);
+	skip = num / 4;
+	residual(in + skip, num - skip, 3000.0, low, &tone);
+	exit_samplerate(&state);
+	level = tone;
+	init_samplerate_quality(&state, low, high, 3400.0, quality);
+	for (i = 0; i < in_num; i++)
+		in[i] = sin(2.0 * M_PI * 3000.0 / high * i);
+	num = samplerate_downsample(&state, in, in_num);
+	residual(in + skip, num - skip, 3000.0, low, &tone);
+	exit_samplerate(&state);
+	*alias = 20.0 * log10(tone / level);
+
+	/* images of a tone in the pass band appear above the low sample rate's nyquist frequency */
+	init_samplerate_quality(&state, low, high, 3400.0, quality);
+	out_num = in_num;
+	num = samplerate_upsample_input_num(&state, out_num);
+	for (i = 0; i < num; i++)
+		in[i] = sin(2.0 * M_PI * 3000.0 / low * i);
+	samplerate_upsample(&state, in, num, out, out_num);
+	skip = out_num / 4;
+	level = residual(out + skip, out_num - skip, 3000.0, high, &tone);
+	exit_samplerate(&state);
+	*image = 20.0 * log10(tone / level);
+
+	free(in);
+	free(out);
+}
+
+/* measure time for each output sample */
+static void bench(double low, double high, enum samplerate_quality quality, double *down, double *up)
+{
+	samplerate_t state;
+	sample_t *samples;
+	int i, num, chunk, down_num = 0;
+	double start;
+
+	chunk = (int)(high / 50.0);
+	samples = calloc(chunk, sizeof(*samples));
+	init_samplerate_quality(&state, low, high, 3400.0, quality);
+
+	start = get_time();
+	for (i = 0; i < BENCH_SECONDS * 50; i++)
+		down_num += samplerate_downsample(&state, samples, chunk);
+	*down = (get_time() - start) / down_num * 1e9;
+
+	start = get_time();
+	for (i = 0; i < BENCH_SECONDS * 50; i++) {
+		num = samplerate_upsample_input_num(&state, chunk);
+		samplerate_upsample(&state, samples, num, samples, chunk);
+	}
+	*up = (get_time() - start) / (BENCH_SECONDS * 50 * chunk) * 1e9;
+
+	exit_samplerate(&state);
+	free(samples);
+}
+
+int main(void)
+{
+	static const double rates[][2] = {
+		{ 8000.0, 48000.0 },
+		{ 8000.0, 44100.0 },
+		{ 8000.0, 48000.0 / 1.1 },
+		{ 0.0, 0.0 },
+	};
+	double alias, image, down, up;
+	int r, q, errors = 0;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	srandom(1);
+
+	for (r = 0; rates[r][0]; r++)
+		errors += check_numbers(rates[r][0], rates[r][1]);
+	printf("number of input and output samples %s\n", (errors) ? "do not match! FAILED!" : "match");
+	r = check_bypass();
+	printf("equal sample rates %s\n", (r) ? "change samples! FAILED!" : "pass samples unchanged");
+	errors += r;
+
+	for (r = 0; rates[r][0]; r++) {
+		printf("\n%.0f Hz <-> %.2f Hz\n", rates[r][0], rates[r][1]);
+		printf("quality  alias rejection  image rejection  downsample  upsample (ns per output sample)\n");
+		for (q = SAMPLERATE_QUALITY_LOW; q <= SAMPLERATE_QUALITY_HIGH; q++) {
+			rejection(rates[r][0], rates[r][1], q, &alias, &image);
+			bench(rates[r][0], rates[r][1], q, &down, &up);
+			printf("%-7s  %12.1f dB  %12.1f dB  %10.1f  %8.1f\n", quality_name[q], alias, image, down, up);
+		}
+	}
+
+	return (errors) ? 1 : 0;
+}
+
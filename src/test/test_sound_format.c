@@ -0,0 +1,103 @@
+/* test of the conversion from and to the sample formats of sound devices
+ *
+ * Samples are stored into an interleaved stereo buffer of each format and
+ * compared with the expected values. The paging signal uses the levels 32639
+ * and -32640, so these must be stored exactly. Then the samples are loaded
+ * again and must match the stored levels.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../libsample/sample.h"
+#include "../libsound/sound_format.h"
+
+#define NUM	7
+
+/* paging levels, clipping and common levels */
+static const sample_t levels[NUM] = { 32639.0, -32640.0, 40000.0, -40000.0, 0.0, 1000.0, -16384.0 };
+/* levels after clipping to the range of S16 */
+static const double clipped[NUM] = { 32639.0, -32640.0, 32767.0, -32767.0, 0.0, 1000.0, -16384.0 };
+
+static const char *format_name[] = { "S16", "S32", "FLOAT" };
+
+/* get stored value of frame and channel as S16 level */
+static double get_value(enum sound_format format, const void *buffer, int frame, int channel)
+{
+	int16_t s16;
+	int32_t s32;
+	float f;
+
+	switch (format) {
+	case SOUND_FORMAT_S16:
+		memcpy(&s16, (const int16_t *)buffer + frame * 2 + channel, sizeof(s16));
+		return s16;
+	case SOUND_FORMAT_S32:
+		memcpy(&s32, (const int32_t *)buffer + frame * 2 + channel, sizeof(s32));
+		if ((s32 & 0xffff))
+			return NAN;
+		return s32 / 65536;
+	case SOUND_FORMAT_FLOAT:
+		memcpy(&f, (const float *)buffer + frame * 2 + channel, sizeof(f));
+		return f * 32768.0;
+	}
+
+	return NAN;
+}
+
+static int test_format(enum sound_format format, int size)
+{
+	uint8_t buffer[NUM * 2 * 4];
+	sample_t samples[NUM], scaled[NUM];
+	double value;
+	int i, failed = 0;
+
+	/* left channel gets the levels, right channel gets silence, buffer is filled with garbage first */
+	memset(buffer, 0x55, sizeof(buffer));
+	for (i = 0; i < NUM; i++)
+		scaled[i] = levels[i] * 4.0;
+	sound_format_store(format, buffer, size * 2, scaled, 0.25, NUM);
+	sound_format_store(format, buffer + size, size * 2, NULL, 0.25, NUM);
+	for (i = 0; i < NUM; i++) {
+		value = get_value(format, buffer, i, 0);
+		if (value != clipped[i]) {
+			printf("%s: sample %.0f is stored as %.1f, expecting %.0f FAILED!\n", format_name[format], levels[i], value, clipped[i]);
+			failed = 1;
+		}
+		value = get_value(format, buffer, i, 1);
+		if (value != 0.0) {
+			printf("%s: silence is stored as %.1f FAILED!\n", format_name[format], value);
+			failed = 1;
+		}
+	}
+
+	/* load left channel, then add it again with a different scale */
+	sound_format_load(format, buffer, size * 2, samples, 2.0, 0, NUM);
+	sound_format_load(format, buffer, size * 2, samples, 1.0, 1, NUM);
+	for (i = 0; i < NUM; i++) {
+		if (samples[i] != clipped[i] * 3.0) {
+			printf("%s: sample %.0f is loaded as %.1f, expecting %.0f FAILED!\n", format_name[format], clipped[i], samples[i] / 3.0, clipped[i]);
+			failed = 1;
+		}
+	}
+
+	printf("%s: %d samples stored and loaded%s\n", format_name[format], NUM, (failed) ? " FAILED!" : " ok");
+
+	return failed;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	if (test_format(SOUND_FORMAT_S16, 2))
+		failed = 1;
+	if (test_format(SOUND_FORMAT_S32, 4))
+		failed = 1;
+	if (test_format(SOUND_FORMAT_FLOAT, 4))
+		failed = 1;
+
+	return failed;
+}
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../liblogging/logging.h"
+#include "../libtones/tones.h"
+#include <osmocom/cc/g711.h>
+
+/* Frames taken from the tones that are encoded once for all calls must be
+ * the same as frames that are read from the tone and encoded one by one. All
+ * tones of all tone sets are compared with L16 and G.711 codecs and frame
+ * sizes that do not fit into the repetition of a tone. Announcements that are
+ * not in the sample store are substituted, like they are in a call.
+ */
+
+static const char *tonesets[] = {
+	"german", "oldgerman", "morsegerman", "american", "oldamerican", "denmark", "japan", "france", NULL
+};
+
+static void encode_l16(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void __attribute__((unused)) *priv)
+{
+	uint8_t *data;
+	int i;
+
+	data = malloc(src_len);
+	for (i = 0; i < src_len; i += 2) {
+		data[i] = ((int16_t *)src_data)[i / 2] >> 8;
+		data[i + 1] = ((int16_t *)src_data)[i / 2];
+	}
+	*dst_data = data;
+	*dst_len = src_len;
+}
+
+static struct codec {
+	const char *name;
+	void (*encoder)(uint8_t *src_data, int src_len, uint8_t **dst_data, int *dst_len, void *priv);
+} codecs[] = {
+	{ "L16", encode_l16 },
+	{ "PCMA", g711_encode_alaw },
+	{ "PCMU", g711_encode_ulaw },
+	{ NULL, NULL },
+};
+
+static int encode(void *priv, int16_t *spl, int spl_count, uint8_t *payload)
+{
+	struct codec *codec = priv;
+	uint8_t *data;
+	int len;
+
+	codec->encoder((uint8_t *)spl, spl_count * 2, &data, &len, NULL);
+	memcpy(payload, data, len);
+	free(data);
+
+	return len;
+}
+
+/* compare frames of one tone, until it has been repeated twice */
+static int compare_tone(tones_data_t *data, enum tones_tone tone, struct codec *codec, int spl_count)
+{
+	tones_t shared, single;
+	int16_t spl[spl_count];
+	uint8_t payload[spl_count * 2], *frame;
+	int frames, i, len, payload_len;
+
+	tones_set_tone(data, &shared, tone);
+	tones_set_tone(data, &single, tone);
+	frames = data->spl_repeat[shared.tone] * 2 / spl_count + 2;
+
+	for (i = 0; i < frames; i++) {
+		frame = tones_read_encoded(&shared, codec, encode, codec, spl_count, &payload_len);
+		memset(spl, 0, sizeof(spl));
+		tones_read_tone(&single, spl, spl_count);
+		len = encode(codec, spl, spl_count, payload);
+		if (!data->spl_data[shared.tone]) {
+			/* nothing to play, so no frame */
+			if (frame) {
+				printf("Tone %d has no samples, but gives a frame!\n", tone);
+				return -1;
+			}
+			return 0;
+		}
+		if (!frame || payload_len != len || memcmp(frame, payload, len)) {
+			printf("Tone %d, codec %s, %d samples: frame %d differs!\n", tone, codec->name, spl_count, i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	tones_data_t data;
+	tones_t t;
+	int16_t spl[160];
+	int i, tone, c, num, failed = 0;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	g711_init();
+
+	for (i = 0; tonesets[i]; i++) {
+		if (tones_init(&data, tonesets[i], TONES_TDATA_SLIN16HOST)) {
+			printf("Tone set %s not found!\n", tonesets[i]);
+			return 1;
+		}
+		num = 0;
+		for (tone = 1; tone < 256; tone++) {
+			if (!data.seq[tone])
+				continue;
+			for (c = 0; codecs[c].name; c++) {
+				failed |= compare_tone(&data, tone, &codecs[c], 160);
+				failed |= compare_tone(&data, tone, &codecs[c], 97);
+			}
+			num++;
+		}
+		printf("Tone set %s: %d tones compared\n", tonesets[i], num);
+		tones_exit(&data);
+	}
+
+	/* tones that cannot be rendered are substituted, at last by silence without samples */
+	tones_init(&data, "german", TONES_TDATA_SLIN16STORE);
+	tones_set_tone(&data, &t, TONES_TONE_BUSY);
+	memset(spl, 0x55, sizeof(spl));
+	tones_read_tone(&t, spl, 160);
+	for (i = 0; i < 160; i++) {
+		if (spl[i] != 0x5555) {
+			printf("Tone that cannot be rendered gives samples!\n");
+			failed = 1;
+			break;
+		}
+	}
+	printf("Tone that cannot be rendered is substituted by tone %d\n", t.tone);
+	tones_exit(&data);
+
+	if (failed) {
+		printf("Shared encoded tones differ from encoding each frame!\n");
+		return 1;
+	}
+	printf("Shared encoded tones are the same as encoding each frame.\n");
+
+	return 0;
+}
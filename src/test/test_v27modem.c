@@ -0,0 +1,149 @@
+/* loopback of the V.27ter modem: scrambler, PSK modulator, PSK demodulator, descrambler
+ *
+ * Random bits are modulated and demodulated at different sample rates, with
+ * noise and with a clock offset (which also shifts the carrier frequency).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libv27/modem.h"
+
+#define SECONDS		5
+#define CHUNK		160
+#define SKIP		200	/* bits to skip, until phase, clock and descrambler are in sync */
+#define MAX_DELAY	64	/* maximum delay of the received bits */
+#define MAX_BITS	(SECONDS * 4800 + 1000)
+
+static uint8_t tx_bits[MAX_BITS], rx_bits[MAX_BITS];
+static int tx_count, rx_count;
+
+static double get_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int send_bit(void __attribute__((unused)) *inst)
+{
+	int bit = random() & 1;
+
+	if (tx_count < MAX_BITS)
+		tx_bits[tx_count++] = bit;
+	return bit;
+}
+
+static void receive_bit(void __attribute__((unused)) *inst, int bit)
+{
+	if (rx_count < MAX_BITS)
+		rx_bits[rx_count++] = bit;
+}
+
+/* gaussian noise with the given rms */
+static double noise(double rms)
+{
+	double u = ((double)random() + 1.0) / 2147483649.0, v = (double)random() / 2147483648.0;
+
+	return rms * sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+/* return number of bit errors, -1 if the received bits cannot be aligned */
+static int loopback(int samplerate, double snr_db, double ppm, double *ns)
+{
+	v27modem_t modem;
+	sample_t *tx, *rx;
+	double power = 0.0, rms, pos, start;
+	int num = samplerate * SECONDS, tx_num = num + num / 1000 + 2, i, s, delay, errors, best = -1;
+
+	tx_count = rx_count = 0;
+	/* transmit some more samples, so a clock offset up to 1000 ppm can be applied */
+	tx = calloc(tx_num, sizeof(*tx));
+	rx = calloc(num, sizeof(*rx));
+	if (!tx || !rx || v27_modem_init(&modem, NULL, send_bit, receive_bit, samplerate, 1)) {
+		printf("Failed to init modem\n");
+		exit(1);
+	}
+
+	for (s = 0; s < tx_num; s += CHUNK)
+		v27_modem_send(&modem, tx + s, (tx_num - s > CHUNK) ? CHUNK : tx_num - s);
+	for (s = 0; s < num; s++)
+		power += tx[s] * tx[s];
+	rms = (isinf(snr_db)) ? 0.0 : sqrt(power / num / pow(10.0, snr_db / 10.0));
+
+	/* change the clock by linear interpolation and add noise */
+	for (s = 0; s < num; s++) {
+		pos = (double)s * (1.0 + ppm / 1e6);
+		i = (int)pos;
+		rx[s] = tx[i] + (tx[i + 1] - tx[i]) * (pos - (double)i) + noise(rms);
+	}
+
+	start = get_time();
+	for (s = 0; s < num; s += CHUNK)
+		v27_modem_receive(&modem, rx + s, (num - s > CHUNK) ? CHUNK : num - s);
+	*ns = (get_time() - start) / num * 1e9;
+	v27_modem_exit(&modem);
+	free(tx);
+	free(rx);
+
+	/* find delay of received bits, then count errors */
+	for (delay = 0; delay < MAX_DELAY; delay++) {
+		errors = 0;
+		for (i = SKIP; i < tx_count - MAX_DELAY && i + delay < rx_count; i++)
+			errors += (tx_bits[i] != rx_bits[i + delay]);
+		if (best < 0 || errors < best)
+			best = errors;
+	}
+	if (best > (tx_count - SKIP) / 4)
+		return -1;
+
+	return best;
+}
+
+int main(void)
+{
+	static const struct {
+		int samplerate;
+		double snr_db, ppm;
+		int max_errors;
+	} tests[] = {
+		{ 48000, INFINITY, 0.0, 0 },
+		{ 96000, INFINITY, 0.0, 0 },
+		{ 192000, INFINITY, 0.0, 0 },
+		{ 48000, INFINITY, 500.0, 0 },
+		{ 48000, INFINITY, -500.0, 0 },
+		{ 48000, 15.0, 0.0, 0 },
+		{ 48000, 8.0, 0.0, 50 },
+		{ 0, 0.0, 0.0, 0 },
+	};
+	double ns;
+	int t, errors, failed = 0;
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	srandom(1);
+
+	for (t = 0; tests[t].samplerate; t++) {
+		errors = loopback(tests[t].samplerate, tests[t].snr_db, tests[t].ppm, &ns);
+		printf("%6d Hz, SNR %4.1f dB, clock offset %6.1f ppm: %d bits, ", tests[t].samplerate, tests[t].snr_db, tests[t].ppm, tx_count);
+		if (errors < 0)
+			printf("no sync");
+		else
+			printf("%d errors", errors);
+		printf(", demodulator %.1f ns per sample", ns);
+		if (errors < 0 || errors > tests[t].max_errors) {
+			printf(" FAILED!\n");
+			failed = 1;
+		} else
+			printf(" ok\n");
+	}
+
+	return failed;
+}
+
@@ -0,0 +1,162 @@
+/* decode recorded wave files, so the output of different sample types can be compared */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libfsk/fsk.h"
+#include "../libfm/fm.h"
+#include "../libfilter/iir_filter.h"
+#include "../libwave/wave.h"
+#include "bnetz_rx.h"
+
+#define CHUNK		480
+
+/* Eurosignal IDs, see eurosignal/dsp.c */
+#define EURO_FREQUENCY_MIN	313.3
+#define EURO_FREQUENCY_MAX	1153.1
+#define EURO_FREQUENCY_TOL	15.0
+#define EURO_DIGIT_DETECT	0.025	/* time for a tone to sustain */
+
+static const struct euro_digit {
+	char	digit;
+	double	frequency;
+} euro_digits[] = {
+	{ 'I', 1153.1 }, { 'R', 1062.9 }, { '0', 979.8 }, { '1', 903.1 }, { '2', 832.5 }, { '3', 767.4 },
+	{ '4', 707.4 }, { '5', 652.0 }, { '6', 601.0 }, { '7', 554.0 }, { '8', 510.7 }, { '9', 470.8 },
+	{ 'A', 433.9 }, { 'B', 400.0 }, { 'C', 368.7 }, { 'D', 339.9 }, { 'E', 313.3 }, { '\0', 0.0 },
+};
+
+static int samplerate;
+static uint32_t sample_count;
+static int frames;
+
+static struct euro_rx {
+	fm_demod_t	demod;
+	iir_filter_t	lp;
+	char		digit_last;
+	int		digit_count;
+	int		receiving;
+	char		digits[7];
+	int		index;
+} euro;
+
+static void euro_decode(sample_t *samples, int length)
+{
+	sample_t frequency[length], I[length], Q[length];
+	double f;
+	int detect = EURO_DIGIT_DETECT * samplerate;
+	int i, d;
+	char digit;
+
+	fm_demodulate_real(&euro.demod, frequency, length, samples, I, Q);
+	iir_process(&euro.lp, frequency, length);
+
+	for (i = 0; i < length; i++) {
+		f = frequency[i] + (EURO_FREQUENCY_MIN + EURO_FREQUENCY_MAX) / 2.0;
+		for (d = 0; euro_digits[d].digit; d++) {
+			if (f >= euro_digits[d].frequency - EURO_FREQUENCY_TOL && f <= euro_digits[d].frequency + EURO_FREQUENCY_TOL)
+				break;
+		}
+		digit = euro_digits[d].digit;
+		if (digit != euro.digit_last) {
+			euro.digit_last = digit;
+			euro.digit_count = 0;
+		}
+		if (++euro.digit_count != detect)
+			continue;
+		switch (digit) {
+		case 'I':
+			euro.receiving = 1;
+			euro.index = 0;
+			break;
+		case '\0':
+			euro.receiving = 0;
+			break;
+		default:
+			if (!euro.receiving)
+				break;
+			euro.digits[euro.index++] = digit;
+			if (euro.index == 6 || euro.digits[0] == 'R') {
+				euro.digits[euro.index] = '\0';
+				printf("%8.3f s: Eurosignal ID %s\n", (double)(sample_count + i) / samplerate, euro.digits);
+				frames++;
+				euro.receiving = 0;
+			}
+		}
+	}
+}
+
+int num_kanal = 1;
+
+/* read full chunks, so the decoder gets the same chunks, no matter how fast the file is read */
+static int read_chunk(wave_play_t *play, sample_t *buffer, int length)
+{
+	sample_t *samples[1];
+	int got, count = 0;
+
+	while (count < length && play->left) {
+		samples[0] = buffer + count;
+		got = wave_read(play, samples, length - count);
+		if (!got) {
+			usleep(1000);
+			continue;
+		}
+		count += got;
+	}
+
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	wave_play_t play;
+	bnetz_rx_t bnetz;
+	sample_t buffer[CHUNK];
+	int channels = 0;
+	int rc, got;
+
+	if (argc < 2) {
+		printf("Usage: %s <wave file>\n", argv[0]);
+		return 0;
+	}
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	fm_init(0);
+
+	samplerate = 0;
+	rc = wave_create_playback(&play, argv[1], &samplerate, &channels, 1.0);
+	if (rc < 0)
+		return 1;
+
+	/* not to stdout, so the output does not depend on the sample type */
+	fprintf(stderr, "Decoding '%s' with %d bit samples\n", argv[1], (int)sizeof(sample_t) * 8);
+
+	if (bnetz_rx_init(&bnetz, samplerate) < 0)
+		return 1;
+	memset(&euro, 0, sizeof(euro));
+	if (fm_demod_init(&euro.demod, samplerate, (EURO_FREQUENCY_MIN + EURO_FREQUENCY_MAX) / 2.0, EURO_FREQUENCY_MAX - EURO_FREQUENCY_MIN))
+		return 1;
+	iir_lowpass_init(&euro.lp, 25.0, samplerate, 2);
+
+	while (play.left) {
+		got = read_chunk(&play, buffer, CHUNK);
+		bnetz_rx_receive(&bnetz, buffer, got);
+		euro_decode(buffer, got);
+		sample_count += got;
+	}
+
+	printf("%d frames decoded\n", bnetz.frames + frames);
+
+	fm_demod_exit(&euro.demod);
+	bnetz_rx_exit(&bnetz);
+	wave_destroy_playback(&play);
+	fm_exit();
+
+	return 0;
+}
@@ -0,0 +1,34 @@
+#!/bin/sh
+
+# Decode the recorded wave files in docs/ and compare the decoded frames with
+# the reference output, which was created with the default (double) samples.
+# The receivers of C-Netz, NMT and AMPS are tested the same way with the wave
+# files in this directory, each with its own test program.
+# Run this from the build directory of each build, e.g. after configuring with
+# and without --enable-float-samples.
+
+srcdir=`dirname "$0"`
+top_srcdir="$srcdir/../.."
+failed=0
+
+for name in bnetz eurosignal; do
+	./test_wave_decode "$top_srcdir/docs/$name.wav" 2>/dev/null > test_wave_decode_$name.out
+	if diff -u "$srcdir/test_wave_decode_$name.ref" test_wave_decode_$name.out; then
+		echo "$name: ok"
+	else
+		echo "$name: decoded frames differ from reference!"
+		failed=1
+	fi
+done
+
+for name in cnetz nmt amps; do
+	./test_wave_decode_$name "$srcdir/test_wave_decode_$name.wav" 2>/dev/null > test_wave_decode_$name.out
+	if diff -u "$srcdir/test_wave_decode_$name.ref" test_wave_decode_$name.out; then
+		echo "$name: ok"
+	else
+		echo "$name: decoded frames differ from reference!"
+		failed=1
+	fi
+done
+
+exit $failed
@@ -0,0 +1,314 @@
+/* decode AMPS messages of the reverse control channel from a wave file with
+ * the receiver of amps/dsp.c
+ *
+ * test_wave_decode_amps.wav holds RECC messages at 96000 samples/s: a paging
+ * reply, an origination with inverted polarity and a registration with a bit
+ * error in the first repetition of each word. The transmitter of amps/dsp.c
+ * only sends forward channels, so the bursts of dotting, sync, coded DCC and
+ * words are Manchester coded with the same ramps here, with a bit clock that
+ * is 20 ppm fast. The signal is attenuated and noise is added, like it is
+ * received from the radio. It was created with '-w <wave file>'. The messages
+ * are decoded by sender_receive() and printed, so that the output of
+ * different sample types can be compared with test_wave_decode_amps.ref.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libbitbuf/bitbuf.h"
+#include "../libmobile/call.h"
+#include "../libmobile/get_time.h"
+#include "../amps/amps.h"
+#include "../amps/dsp.h"
+#include "../amps/frame.h"
+#include "../amps/bch.h"
+
+#define SAMPLERATE	96000
+#define CHUNK		960
+#define MAX_LEVEL	4.0	/* level of full scale in wave file */
+#define BITRATE		10000.0
+#define FSK_DEVIATION	(8000.0 / 2900.0)	/* 8 kHz, relative to speech deviation */
+#define TX_CLOCK_SPEED	20.0	/* ppm */
+#define RX_GAIN		0.7
+#define RX_NOISE	0.5
+#define DCC_CODE	0x1f	/* coded DCC 1 */
+#define GAP		(SAMPLERATE / 50)	/* silence between messages */
+
+const int tacs = 0;
+sender_t *sender_head = NULL;
+
+static int rx_count;
+static uint32_t sample_count;
+
+/* no display measurements */
+dispmeasparam_t *display_measurements_add(dispmeas_t __attribute__((unused)) *disp, char __attribute__((unused)) *name, char __attribute__((unused)) *format, enum display_measurements_type __attribute__((unused)) type, enum display_measurements_bar __attribute__((unused)) bar, double __attribute__((unused)) min, double __attribute__((unused)) max, double __attribute__((unused)) mark) { return NULL; }
+void display_measurements_update(dispmeasparam_t __attribute__((unused)) *param, double __attribute__((unused)) value, double __attribute__((unused)) value2) { }
+
+/* no call, no clock measurement and no forward channel */
+void sender_set_fm(sender_t __attribute__((unused)) *sender, double __attribute__((unused)) max_deviation, double __attribute__((unused)) max_modulation, double __attribute__((unused)) speech_deviation, double __attribute__((unused)) max_display) { }
+void call_up_audio(int __attribute__((unused)) callref, sample_t __attribute__((unused)) *samples, int __attribute__((unused)) count) { }
+double get_time(void) { return 0.0; }
+void amps_rx_sat(amps_t __attribute__((unused)) *amps, int __attribute__((unused)) tone, double __attribute__((unused)) quality) { }
+void amps_rx_signaling_tone(amps_t __attribute__((unused)) *amps, int __attribute__((unused)) tone, double __attribute__((unused)) quality) { }
+transaction_t *amps_tx_frame_focc(amps_t __attribute__((unused)) *amps) { return NULL; }
+transaction_t *amps_tx_frame_fvc(amps_t __attribute__((unused)) *amps) { return NULL; }
+
+double amps_channel2freq(int __attribute__((unused)) channel, int __attribute__((unused)) uplink)
+{
+	return 0.0;
+}
+
+const char *amps_min22number(uint16_t __attribute__((unused)) min2)
+{
+	return "";
+}
+
+const char *amps_min12number(uint32_t __attribute__((unused)) min1)
+{
+	return "";
+}
+
+const char *amps_scm(uint8_t __attribute__((unused)) scm)
+{
+	return "";
+}
+
+/* messages are reported with the time of the first sample of the chunk */
+void amps_rx_recc(amps_t __attribute__((unused)) *amps, uint8_t scm, uint8_t mpci, uint32_t esn, uint32_t min1, uint16_t min2, uint8_t msg_type, uint8_t ordq, uint8_t order, const char *dialing)
+{
+	printf("%8.3f s: RECC SCM=%d MPCI=%d ESN=0x%08x MIN1=0x%06x MIN2=0x%03x TYPE=%d ORDQ=%d ORDER=%d DIALING=%s\n", (double)sample_count / SAMPLERATE, scm, mpci, esn, min1, min2, msg_type, ordq, order, (dialing) ? dialing : "none");
+	rx_count++;
+}
+
+static uint64_t word_a(int nawc, int t, int scm, uint32_t min1)
+{
+	return (1ULL << 35) | ((uint64_t)nawc << 32) | ((uint64_t)t << 31) | (1ULL << 30) | (1ULL << 29) | ((uint64_t)(scm & 15) << 24) | min1;
+}
+
+static uint64_t word_b(int nawc, int msg_type, int ordq, int order, int scm, int mpci, uint16_t min2)
+{
+	return ((uint64_t)nawc << 32) | ((uint64_t)msg_type << 27) | ((uint64_t)ordq << 24) | ((uint64_t)order << 19) | ((uint64_t)(scm >> 4) << 16) | ((uint64_t)mpci << 14) | min2;
+}
+
+static uint64_t word_c(int nawc, uint32_t esn)
+{
+	return ((uint64_t)nawc << 32) | esn;
+}
+
+static uint64_t word_d(int nawc, const char *digits)
+{
+	uint64_t word = (uint64_t)nawc << 32;
+	int i, digit;
+
+	for (i = 0; i < 8 && digits[i]; i++) {
+		if (digits[i] == '0')
+			digit = 10;
+		else if (digits[i] >= '1' && digits[i] <= '9')
+			digit = digits[i] - '0';
+		else
+			digit = 0;
+		word |= (uint64_t)digit << (28 - i * 4);
+	}
+
+	return word;
+}
+
+/* dotting, sync, coded DCC and five repetitions of each word */
+static void encode_recc(bitbuf_t *bits, const uint64_t *words, int num, int error)
+{
+	uint64_t word;
+	int i, j;
+
+	bitbuf_clear(bits);
+	for (i = 0; i < 30; i += 2)
+		bitbuf_append(bits, 2, 2);
+	bitbuf_append(bits, 0x712, 11);
+	bitbuf_append(bits, DCC_CODE, 7);
+	for (i = 0; i < num; i++) {
+		word = (words[i] << 12) | bch_encode(words[i], 36);
+		for (j = 0; j < 5; j++) {
+			if (j == 0 && error)
+				bitbuf_append(bits, word ^ (1ULL << (20 + i)), 48);
+			else
+				bitbuf_append(bits, word, 48);
+		}
+	}
+}
+
+static sample_t tx_spl[SAMPLERATE];
+static int tx_length;
+static double tx_phase;
+static int tx_last;
+
+/* one half of a bit, ramp like the transmitter of amps/dsp.c does */
+static void encode_half(double from, double to)
+{
+	double step = 2.0 * BITRATE * (1.0 + TX_CLOCK_SPEED / 1e6) / SAMPLERATE;
+
+	do {
+		tx_spl[tx_length++] = from + (to - from) * (1.0 - cos(tx_phase * M_PI)) / 2.0;
+		tx_phase += step;
+	} while (tx_phase < 1.0);
+	tx_phase -= 1.0;
+}
+
+/* Manchester code: 1 changes from low to high, 0 from high to low */
+static void encode_bits(const bitbuf_t *bits, int invert)
+{
+	double dev = (invert) ? -FSK_DEVIATION : FSK_DEVIATION;
+	int i, bit;
+
+	tx_last = 0;
+	for (i = 0; i < bits->length; i++) {
+		bit = bitbuf_bit(bits, i);
+		if (bit) {
+			encode_half((tx_last) ? dev : -dev, -dev);
+			encode_half(-dev, dev);
+		} else {
+			encode_half((tx_last) ? dev : -dev, dev);
+			encode_half(dev, -dev);
+		}
+		tx_last = bit;
+	}
+	/* back to no deviation */
+	for (i = 0; i < GAP; i++)
+		tx_spl[tx_length++] = 0.0;
+}
+
+/* messages of the mobile station, as received by the radio */
+static int write_wave(const char *filename)
+{
+	wave_rec_t rec;
+	bitbuf_t bits;
+	uint64_t words[5];
+	sample_t *samples[1];
+	int i;
+
+	for (i = 0; i < GAP; i++)
+		tx_spl[tx_length++] = 0.0;
+
+	/* paging reply: word A, B and serial number */
+	words[0] = word_a(2, 0, 0xb, 0x123456);
+	words[1] = word_b(1, 0, 0, 0, 0x1b, 1, 0x2ab);
+	words[2] = word_c(0, 0xdeadbeef);
+	encode_recc(&bits, words, 3, 0);
+	encode_bits(&bits, 0);
+
+	/* origination: word A, B, serial number and two words of digits */
+	words[0] = word_a(4, 1, 0xe, 0x654321);
+	words[1] = word_b(3, 0, 0, 0, 0x0e, 0, 0x155);
+	words[2] = word_c(2, 0x12345678);
+	words[3] = word_d(1, "01234567");
+	words[4] = word_d(0, "89");
+	encode_recc(&bits, words, 5, 0);
+	encode_bits(&bits, 1);
+
+	/* registration: word A, B and serial number */
+	words[0] = word_a(2, 0, 0x3, 0x000001);
+	words[1] = word_b(1, 0, 0, 13, 0x03, 0, 0x001);
+	words[2] = word_c(0, 0x00c0ffee);
+	encode_recc(&bits, words, 3, 1);
+	encode_bits(&bits, 0);
+
+	if (wave_create_record(&rec, filename, SAMPLERATE, 1, MAX_LEVEL) < 0)
+		return -1;
+	srandom(1);
+	for (i = 0; i < tx_length; i++)
+		tx_spl[i] = tx_spl[i] * RX_GAIN + RX_NOISE * ((double)(random() % 2001) / 1000.0 - 1.0);
+	for (i = 0; i < tx_length; i += CHUNK) {
+		/* the file is written by a thread, so wait for space in its buffer */
+		while (ringbuffer_space(&rec.ring) < CHUNK * 2)
+			usleep(1000);
+		samples[0] = tx_spl + i;
+		wave_write(&rec, samples, (tx_length - i < CHUNK) ? tx_length - i : CHUNK);
+	}
+	wave_destroy_record(&rec);
+
+	return 0;
+}
+
+/* read full chunks, so the decoder gets the same chunks, no matter how fast the file is read */
+static int read_chunk(wave_play_t *play, sample_t *buffer, int length)
+{
+	sample_t *samples[1];
+	int got, count = 0;
+
+	while (count < length && play->left) {
+		samples[0] = buffer + count;
+		got = wave_read(play, samples, length - count);
+		if (!got) {
+			usleep(1000);
+			continue;
+		}
+		count += got;
+	}
+
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	wave_play_t play;
+	amps_t *amps;
+	sample_t buffer[CHUNK];
+	int samplerate = 0, channels = 0;
+	int got;
+
+	if (argc < 2) {
+		printf("Usage: %s [-w] <wave file>\n", argv[0]);
+		return 0;
+	}
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	init_frame();
+
+	if (argc > 2 && !strcmp(argv[1], "-w")) {
+		if (write_wave(argv[2]) < 0)
+			return 1;
+		printf("%s written\n", argv[2]);
+		return 0;
+	}
+
+	dsp_init();
+	amps = calloc(1, sizeof(*amps));
+	if (!amps)
+		return 1;
+	amps->sender.kanal = "334";
+	amps->sender.samplerate = SAMPLERATE;
+	amps->chan_type = CHAN_TYPE_CC;
+	amps->si.dcc = 1;
+	amps->si.word2.s = 1;
+	if (dsp_init_sender(amps, 0) < 0)
+		return 1;
+	amps_set_dsp_mode(amps, DSP_MODE_FRAME_RX_FRAME_TX, 247);
+
+	if (wave_create_playback(&play, argv[1], &samplerate, &channels, MAX_LEVEL) < 0)
+		return 1;
+	if (samplerate != SAMPLERATE || channels != 1) {
+		printf("Wave file must have one channel at %d samples/s\n", SAMPLERATE);
+		return 1;
+	}
+
+	/* not to stdout, so the output does not depend on the sample type */
+	fprintf(stderr, "Decoding '%s' with %d bit samples\n", argv[1], (int)sizeof(sample_t) * 8);
+
+	while (play.left) {
+		got = read_chunk(&play, buffer, CHUNK);
+		sender_receive(&amps->sender, buffer, got, 0.0);
+		sample_count += got;
+	}
+
+	printf("%d messages decoded\n", rx_count);
+
+	wave_destroy_playback(&play);
+	dsp_cleanup_sender(amps);
+	free(amps);
+
+	return 0;
+}
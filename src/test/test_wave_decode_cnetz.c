@@ -0,0 +1,267 @@
+/* decode C-Netz telegramms from a wave file with the receiver of cnetz/dsp.c
+ *
+ * test_wave_decode_cnetz.wav holds telegramms of mobile stations on the
+ * calling channel (OgK), sent by the transmitter of cnetz/dsp.c at 48000
+ * samples/s with negative polarity and a bit clock that is 20 ppm fast. The
+ * signal is attenuated and noise is added, like it is received from the radio.
+ * It was created with '-w <wave file>'. The telegramms are decoded by
+ * sender_receive() with both types of demodulator and printed, so that the
+ * output of different sample types can be compared with
+ * test_wave_decode_cnetz.ref.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../libbitbuf/bitbuf.h"
+#include "../libmobile/call.h"
+#include "../libmobile/get_time.h"
+#include "../cnetz/cnetz.h"
+#include "../cnetz/sysinfo.h"
+#include "../cnetz/telegramm.h"
+#include "../cnetz/dsp.h"
+
+#define SAMPLERATE	48000
+#define CHUNK		960
+#define MAX_LEVEL	2.0	/* level of full scale in wave file */
+#define SPEECH_DEVIATION 2400.0
+#define TX_CLOCK_SPEED	20.0	/* ppm */
+#define RX_GAIN		0.7
+#define RX_NOISE	0.2
+
+/* telegramms of 'Rufblock' and 'Meldeblock' of each time slot */
+static const uint8_t tx_opcodes[][2] = {
+	{ OPCODE_EM_R, OPCODE_MFT_M },
+	{ OPCODE_UM_R, OPCODE_MFT_M },
+	{ OPCODE_VWG_R, OPCODE_WUE_M },
+	{ OPCODE_SRG_R, OPCODE_MFT_M },
+};
+#define TX_SLOTS	(int)(sizeof(tx_opcodes) / sizeof(tx_opcodes[0]))
+
+cnetz_si si;
+sender_t *sender_head = NULL;
+int cant_recover = 0;
+
+static telegramm_t tx_telegramm;
+static int tx_slot, rx_count;
+static uint32_t sample_count;
+static const char *demod_name;
+
+/* no display measurements */
+dispmeasparam_t *display_measurements_add(dispmeas_t __attribute__((unused)) *disp, char __attribute__((unused)) *name, char __attribute__((unused)) *format, enum display_measurements_type __attribute__((unused)) type, enum display_measurements_bar __attribute__((unused)) bar, double __attribute__((unused)) min, double __attribute__((unused)) max, double __attribute__((unused)) mark) { return NULL; }
+void display_measurements_update(dispmeasparam_t __attribute__((unused)) *param, double __attribute__((unused)) value, double __attribute__((unused)) value2) { }
+
+/* no call and no clock measurement */
+void sender_set_fm(sender_t __attribute__((unused)) *sender, double __attribute__((unused)) max_deviation, double __attribute__((unused)) max_modulation, double __attribute__((unused)) speech_deviation, double __attribute__((unused)) max_display) { }
+void call_up_audio(int __attribute__((unused)) callref, sample_t __attribute__((unused)) *samples, int __attribute__((unused)) count) { }
+double get_time(void) { return 0.0; }
+
+void cnetz_sync_frame(cnetz_t __attribute__((unused)) *cnetz, double __attribute__((unused)) sync, int __attribute__((unused)) ts)
+{
+}
+
+/* telegramms with fixed parameters, so the wave file can be created again */
+static const struct telegramm *transmit(int meldeblock)
+{
+	if (tx_slot >= TX_SLOTS)
+		return NULL;
+
+	memset(&tx_telegramm, 0, sizeof(tx_telegramm));
+	tx_telegramm.opcode = tx_opcodes[tx_slot][meldeblock];
+	tx_telegramm.futln_nationalitaet = 2;
+	tx_telegramm.futln_heimat_fuvst_nr = 2 + tx_slot;
+	tx_telegramm.futln_rest_nr = 12345;
+	strcpy(tx_telegramm.wahlziffern, "0301234567");
+	if (meldeblock)
+		tx_slot++;
+
+	return &tx_telegramm;
+}
+
+const struct telegramm *cnetz_transmit_telegramm_rufblock(cnetz_t __attribute__((unused)) *cnetz)
+{
+	return transmit(0);
+}
+
+const struct telegramm *cnetz_transmit_telegramm_meldeblock(cnetz_t __attribute__((unused)) *cnetz)
+{
+	return transmit(1);
+}
+
+const struct telegramm *cnetz_transmit_telegramm_spk_k(cnetz_t __attribute__((unused)) *cnetz)
+{
+	return NULL;
+}
+
+const struct telegramm *cnetz_transmit_telegramm_spk_v(cnetz_t __attribute__((unused)) *cnetz)
+{
+	return NULL;
+}
+
+/* telegramms are reported with the time of the first sample of the chunk */
+void cnetz_receive_telegramm_ogk(cnetz_t __attribute__((unused)) *cnetz, struct telegramm *telegramm, int block)
+{
+	printf("%8.3f s: %s demod: block %d telegramm %s", (double)sample_count / SAMPLERATE, demod_name, block, telegramm_name(telegramm->opcode));
+	/* dialing is sent without subscriber number */
+	if (telegramm->opcode == OPCODE_WUE_M)
+		printf(" dialing %s\n", telegramm->wahlziffern);
+	else
+		printf(" from %d,%d,%d\n", telegramm->futln_nationalitaet, telegramm->futln_heimat_fuvst_nr, telegramm->futln_rest_nr);
+	rx_count++;
+}
+
+void cnetz_receive_telegramm_spk_k(cnetz_t __attribute__((unused)) *cnetz, struct telegramm __attribute__((unused)) *telegramm)
+{
+}
+
+void cnetz_receive_telegramm_spk_v(cnetz_t __attribute__((unused)) *cnetz, struct telegramm __attribute__((unused)) *telegramm)
+{
+}
+
+static cnetz_t *create_cnetz(enum demod_type demod, double tx_clock_speed)
+{
+	cnetz_t *cnetz;
+	double clock_speed[2] = { 0.0, tx_clock_speed };
+
+	cnetz = calloc(1, sizeof(*cnetz));
+	if (!cnetz)
+		return NULL;
+	cnetz->sender.kanal = "131";
+	cnetz->sender.samplerate = SAMPLERATE;
+	if (dsp_init_sender(cnetz, 0, clock_speed, demod, SPEECH_DEVIATION) < 0) {
+		free(cnetz);
+		return NULL;
+	}
+	cnetz->dsp_mode = DSP_MODE_OGK;
+
+	return cnetz;
+}
+
+static void destroy_cnetz(cnetz_t *cnetz)
+{
+	dsp_cleanup_sender(cnetz);
+	free(cnetz);
+}
+
+/* telegramms of the transmitter, as received by the radio */
+static int write_wave(const char *filename)
+{
+	wave_rec_t rec;
+	cnetz_t *cnetz;
+	sample_t buffer[CHUNK], *samples[1] = { buffer };
+	uint8_t power[CHUNK];
+	int i, silence = 0;
+
+	cnetz = create_cnetz(FSK_DEMOD_SLOPE, TX_CLOCK_SPEED);
+	if (!cnetz)
+		return -1;
+	/* phones send with negative polarity */
+	cnetz->negative_polarity = 1;
+
+	if (wave_create_record(&rec, filename, SAMPLERATE, 1, MAX_LEVEL) < 0)
+		return -1;
+	srandom(1);
+	/* silence of 0.1 s after the last telegramm */
+	while (silence < SAMPLERATE / 10) {
+		if (tx_slot == TX_SLOTS)
+			silence += CHUNK;
+		sender_send(&cnetz->sender, buffer, power, CHUNK);
+		for (i = 0; i < CHUNK; i++)
+			buffer[i] = buffer[i] * RX_GAIN + RX_NOISE * ((double)(random() % 2001) / 1000.0 - 1.0);
+		/* the file is written by a thread, so wait for space in its buffer */
+		while (ringbuffer_space(&rec.ring) < CHUNK * 2)
+			usleep(1000);
+		wave_write(&rec, samples, CHUNK);
+	}
+	wave_destroy_record(&rec);
+	destroy_cnetz(cnetz);
+
+	return 0;
+}
+
+/* read full chunks, so the decoder gets the same chunks, no matter how fast the file is read */
+static int read_chunk(wave_play_t *play, sample_t *buffer, int length)
+{
+	sample_t *samples[1];
+	int got, count = 0;
+
+	while (count < length && play->left) {
+		samples[0] = buffer + count;
+		got = wave_read(play, samples, length - count);
+		if (!got) {
+			usleep(1000);
+			continue;
+		}
+		count += got;
+	}
+
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	wave_play_t play;
+	cnetz_t *slope, *level;
+	sample_t buffer[CHUNK], copy[CHUNK];
+	int samplerate = 0, channels = 0;
+	int got;
+
+	if (argc < 2) {
+		printf("Usage: %s [-w] <wave file>\n", argv[0]);
+		return 0;
+	}
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	memset(&si, 0, sizeof(si));
+	si.timeslots = 0xffffffff;
+	dsp_init();
+	if (init_telegramm() < 0)
+		return 1;
+	init_coding();
+
+	if (argc > 2 && !strcmp(argv[1], "-w")) {
+		if (write_wave(argv[2]) < 0)
+			return 1;
+		printf("%s written\n", argv[2]);
+		return 0;
+	}
+
+	slope = create_cnetz(FSK_DEMOD_SLOPE, 0.0);
+	level = create_cnetz(FSK_DEMOD_LEVEL, 0.0);
+	if (!slope || !level)
+		return 1;
+
+	if (wave_create_playback(&play, argv[1], &samplerate, &channels, MAX_LEVEL) < 0)
+		return 1;
+	if (samplerate != SAMPLERATE || channels != 1) {
+		printf("Wave file must have one channel at %d samples/s\n", SAMPLERATE);
+		return 1;
+	}
+
+	/* not to stdout, so the output does not depend on the sample type */
+	fprintf(stderr, "Decoding '%s' with %d bit samples\n", argv[1], (int)sizeof(sample_t) * 8);
+
+	while (play.left) {
+		got = read_chunk(&play, buffer, CHUNK);
+		/* the receiver filters the samples in place */
+		memcpy(copy, buffer, got * sizeof(*copy));
+		demod_name = "slope";
+		sender_receive(&slope->sender, buffer, got, 0.0);
+		demod_name = "level";
+		sender_receive(&level->sender, copy, got, 0.0);
+		sample_count += got;
+	}
+
+	printf("%d telegramms decoded\n", rx_count);
+
+	wave_destroy_playback(&play);
+	destroy_cnetz(slope);
+	destroy_cnetz(level);
+
+	return 0;
+}
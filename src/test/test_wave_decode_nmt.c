@@ -0,0 +1,226 @@
+/* decode NMT frames from a wave file with the receiver of nmt/dsp.c
+ *
+ * test_wave_decode_nmt.wav holds frames of a calling channel, sent by the
+ * transmitter of nmt/dsp.c at 16000 samples/s with supervisory signal 1, as
+ * it is done with the internal loopback. The signal is attenuated and noise is
+ * added, like it is received from the radio. It was created with
+ * '-w <wave file>'. The frames and the supervisory signal are decoded by
+ * sender_receive() and printed, so that the output of different sample types
+ * can be compared with test_wave_decode_nmt.ref.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../libsample/sample.h"
+#include "../liblogging/logging.h"
+#include "../nmt/nmt.h"
+#include "../nmt/dsp.h"
+#include "../nmt/frame.h"
+#include "../nmt/transaction.h"
+
+#define SAMPLERATE	16000
+#define CHUNK		320
+#define MAX_LEVEL	2.0	/* level of full scale in wave file */
+#define RX_GAIN		0.7
+#define RX_NOISE	0.05
+
+static const enum nmt_mt tx_frames[] = {
+	NMT_MESSAGE_1a, NMT_MESSAGE_1b, NMT_MESSAGE_2a, NMT_MESSAGE_2b, NMT_MESSAGE_2c, NMT_MESSAGE_5a, NMT_MESSAGE_4,
+};
+#define TX_FRAMES	(int)(sizeof(tx_frames) / sizeof(tx_frames[0]))
+#define TX_REPEAT	2	/* detecting the supervisory signal takes 0.4 s */
+
+static int tx_count, rx_count;
+static uint32_t sample_count;
+
+/* no display measurements */
+dispmeasparam_t *display_measurements_add(dispmeas_t __attribute__((unused)) *disp, char __attribute__((unused)) *name, char __attribute__((unused)) *format, enum display_measurements_type __attribute__((unused)) type, enum display_measurements_bar __attribute__((unused)) bar, double __attribute__((unused)) min, double __attribute__((unused)) max, double __attribute__((unused)) mark) { return NULL; }
+void display_measurements_update(dispmeasparam_t __attribute__((unused)) *param, double __attribute__((unused)) value, double __attribute__((unused)) value2) { }
+
+/* no call, no transaction and no DMS */
+void sender_set_fm(sender_t __attribute__((unused)) *sender, double __attribute__((unused)) max_deviation, double __attribute__((unused)) max_modulation, double __attribute__((unused)) speech_deviation, double __attribute__((unused)) max_display) { }
+void call_up_audio(int __attribute__((unused)) callref, sample_t __attribute__((unused)) *samples, int __attribute__((unused)) count) { }
+transaction_t *get_transaction_by_callref(int __attribute__((unused)) callref) { return NULL; }
+int dms_send_bit(nmt_t __attribute__((unused)) *nmt) { return -1; }
+void fsk_receive_bit_dms(nmt_t __attribute__((unused)) *nmt, int __attribute__((unused)) bit, double __attribute__((unused)) quality, double __attribute__((unused)) level) { }
+
+const char *nmt_dir_name(enum nmt_direction __attribute__((unused)) dir)
+{
+	return "test";
+}
+
+/* frames with fixed parameters, so the wave file can be created again */
+int nmt_get_frame(nmt_t *nmt, bitbuf_t *bits)
+{
+	frame_t frame;
+
+	if (tx_count == TX_FRAMES * TX_REPEAT) {
+		nmt_set_dsp_mode(nmt, DSP_MODE_SILENCE);
+		return -1;
+	}
+
+	memset(&frame, 0, sizeof(frame));
+	frame.mt = tx_frames[tx_count % TX_FRAMES];
+	frame.channel_no = nmt_encode_channel(450, 201 + tx_count, 1);
+	frame.tc_no = nmt_encode_tc(450, 201, 1);
+	frame.traffic_area = nmt_encode_traffic_area(450, 201, 0x12);
+	frame.ms_country = nmt_digits2value("4", 1);
+	frame.ms_number = nmt_digits2value("123456", 6);
+	frame.idle = 0x12345;
+	frame.line_signal = tx_count;
+	encode_frame(450, &frame, bits, 0);
+	tx_count++;
+
+	return 0;
+}
+
+/* frames are reported with the time of the first sample of the chunk */
+void nmt_receive_frame(nmt_t __attribute__((unused)) *nmt, const bitbuf_t *bits, double __attribute__((unused)) quality, double __attribute__((unused)) level, int __attribute__((unused)) frames_elapsed)
+{
+	frame_t frame;
+	char string[BITBUF_MAX + 1];
+
+	decode_frame(450, &frame, bits, MTX_TO_XX, 0);
+	printf("%8.3f s: NMT frame %s\n", (double)sample_count / SAMPLERATE, (frame.mt == NMT_MESSAGE_UKN_MTX) ? "illegal" : nmt_frame_name(frame.mt));
+	printf("%s\n", bitbuf_string(bits, 0, bits->length, string));
+	rx_count++;
+}
+
+void nmt_rx_super(nmt_t __attribute__((unused)) *nmt, int tone, double __attribute__((unused)) quality)
+{
+	printf("%8.3f s: supervisory signal %s\n", (double)sample_count / SAMPLERATE, (tone) ? "detected" : "lost");
+}
+
+static nmt_t *create_nmt(void)
+{
+	nmt_t *nmt;
+
+	nmt = calloc(1, sizeof(*nmt));
+	if (!nmt)
+		return NULL;
+	nmt->sender.kanal = "201";
+	nmt->sender.samplerate = SAMPLERATE;
+	nmt->sender.loopback = 1;
+	nmt->sysinfo.system = 450;
+	nmt->sysinfo.chan_type = CHAN_TYPE_CC;
+	nmt->supervisory = 1;
+	if (dsp_init_sender(nmt, 1.0) < 0) {
+		free(nmt);
+		return NULL;
+	}
+
+	return nmt;
+}
+
+static void destroy_nmt(nmt_t *nmt)
+{
+	dsp_cleanup_sender(nmt);
+	free(nmt);
+}
+
+/* frames of the transmitter, as received by the radio */
+static int write_wave(nmt_t *nmt, const char *filename)
+{
+	wave_rec_t rec;
+	sample_t buffer[CHUNK], *samples[1] = { buffer };
+	uint8_t power[CHUNK];
+	int i, silence = 0;
+
+	if (wave_create_record(&rec, filename, SAMPLERATE, 1, MAX_LEVEL) < 0)
+		return -1;
+	srandom(1);
+	nmt_set_dsp_mode(nmt, DSP_MODE_FRAME);
+	/* silence of 0.5 s after the last frame, so the supervisory signal is lost */
+	while (silence < SAMPLERATE / 2) {
+		if (nmt->dsp_mode == DSP_MODE_SILENCE)
+			silence += CHUNK;
+		sender_send(&nmt->sender, buffer, power, CHUNK);
+		for (i = 0; i < CHUNK; i++)
+			buffer[i] = buffer[i] * RX_GAIN + RX_NOISE * ((double)(random() % 2001) / 1000.0 - 1.0);
+		/* the file is written by a thread, so wait for space in its buffer */
+		while (ringbuffer_space(&rec.ring) < CHUNK * 2)
+			usleep(1000);
+		wave_write(&rec, samples, CHUNK);
+	}
+	wave_destroy_record(&rec);
+
+	return 0;
+}
+
+/* read full chunks, so the decoder gets the same chunks, no matter how fast the file is read */
+static int read_chunk(wave_play_t *play, sample_t *buffer, int length)
+{
+	sample_t *samples[1];
+	int got, count = 0;
+
+	while (count < length && play->left) {
+		samples[0] = buffer + count;
+		got = wave_read(play, samples, length - count);
+		if (!got) {
+			usleep(1000);
+			continue;
+		}
+		count += got;
+	}
+
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	wave_play_t play;
+	nmt_t *nmt;
+	sample_t buffer[CHUNK];
+	int samplerate = 0, channels = 0;
+	int got;
+
+	if (argc < 2) {
+		printf("Usage: %s [-w] <wave file>\n", argv[0]);
+		return 0;
+	}
+
+	loglevel = LOGL_ERROR;
+	logging_init();
+	fm_init(0);
+	init_frame();
+	dsp_init();
+	nmt = create_nmt();
+	if (!nmt)
+		return 1;
+
+	if (argc > 2 && !strcmp(argv[1], "-w")) {
+		if (write_wave(nmt, argv[2]) < 0)
+			return 1;
+		printf("%s written\n", argv[2]);
+		destroy_nmt(nmt);
+		fm_exit();
+		return 0;
+	}
+
+	if (wave_create_playback(&play, argv[1], &samplerate, &channels, MAX_LEVEL) < 0)
+		return 1;
+	if (samplerate != SAMPLERATE || channels != 1) {
+		printf("Wave file must have one channel at %d samples/s\n", SAMPLERATE);
+		return 1;
+	}
+
+	/* not to stdout, so the output does not depend on the sample type */
+	fprintf(stderr, "Decoding '%s' with %d bit samples\n", argv[1], (int)sizeof(sample_t) * 8);
+
+	while (play.left) {
+		got = read_chunk(&play, buffer, CHUNK);
+		sender_receive(&nmt->sender, buffer, got, 0.0);
+		sample_count += got;
+	}
+
+	printf("%d frames decoded\n", rx_count);
+
+	wave_destroy_playback(&play);
+	destroy_nmt(nmt);
+	fm_exit();
+
+	return 0;
+}
@@ -521,6 +521,8 @@ int main(int argc, char *argv[])
 
 	/* inits */
 	fm_init(0);
+	/* select filter kernels once, before any thread uses them */
+	iir_kernel_select(IIR_KERNEL_AUTO);
 
 	if (!wave_file) {
 #ifdef HAVE_SDR